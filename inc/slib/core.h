@@ -46,7 +46,9 @@
 #include "core/sort.h"
 
 #include "core/hashtable.h"
+#include "core/flat_hashtable.h"
 #include "core/tree.h"
+#include "core/bplus_tree.h"
 #include "core/array.h"
 #include "core/array_std.h"
 #include "core/array2d.h"
@@ -75,6 +77,7 @@
 
 #include "core/io.h"
 #include "core/file.h"
+#include "core/file_btree.h"
 #include "core/pipe.h"
 #include "core/async.h"
 #include "core/dispatch.h"
@@ -93,6 +96,7 @@
 
 #include "core/json.h"
 #include "core/json_std.h"
+#include "core/msgpack.h"
 #include "core/xml.h"
 #include "core/base64.h"
 
@@ -17,6 +17,7 @@
 #include "iterator.h"
 #include "new_helper.h"
 #include "compare.h"
+#include "sort.h"
 
 namespace std
 {
@@ -142,6 +143,21 @@ namespace slib
 
 		CArray<T>* duplicate() const;
 
+		template < class COMPARE = Compare<T> >
+		void sort(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		// stable (MergeSort), returns false if the temporary buffer can't be allocated
+		template < class COMPARE = Compare<T> >
+		sl_bool sortStable(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		// sorts by multiple threads (ParallelSort), not stable
+		template < class COMPARE = Compare<T> >
+		sl_bool sortParallel(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null) const;
+
+		// stable radix sort by the integer or floating-point key returned by `getKey(const T&)`, the elements are the keys by default
+		template < class GET_KEY = _RadixSortValue<T> >
+		sl_bool sortByKey(sl_bool flagAscending = sl_true, const GET_KEY& getKey = GET_KEY()) const;
+
 		// range-based for loop
 		T* begin();
 
@@ -261,6 +277,18 @@ namespace slib
 
 		Array<T> duplicate() const;
 
+		template < class COMPARE = Compare<T> >
+		void sort(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortStable(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortParallel(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null) const;
+
+		template < class GET_KEY = _RadixSortValue<T> >
+		sl_bool sortByKey(sl_bool flagAscending = sl_true, const GET_KEY& getKey = GET_KEY()) const;
+
 		Iterator<T> toIterator() const;
 
 		sl_bool getData(ArrayData<T>& data) const;
@@ -32,6 +32,7 @@ namespace slib
 	class AsyncIoLoop;
 	class AsyncIoInstance;
 	class AsyncIoObject;
+	class AsyncIoOperation;
 	class AsyncStreamInstance;
 	class AsyncStream;
 	class AsyncStreamRequest;
@@ -74,6 +75,17 @@ namespace slib
 		// override
 		sl_bool dispatch(const Function<void()>& callback, sl_uint64 delay_ms);
 
+	public:
+		// Linux: the loops created after enabling are driven by io_uring instead of epoll when the kernel supports it (default: disabled)
+		static sl_bool isIoUringEnabled();
+
+		static void setIoUringEnabled(sl_bool flag);
+
+		sl_bool isUsingIoUring();
+
+		// available only on the loops using io_uring, and should be called in the loop thread. The completion is notified to `onEvent()` of the instance
+		sl_bool submitOperation(AsyncIoInstance* instance, AsyncIoOperation* operation);
+
 	protected:
 		sl_bool m_flagInit;
 		sl_bool m_flagRunning;
@@ -95,6 +107,16 @@ namespace slib
 		void __detachInstance(AsyncIoInstance* instance);
 		void __wake();
 
+#if defined(SLIB_PLATFORM_IS_LINUX) && !defined(SLIB_PLATFORM_IS_ANDROID)
+		static void* __createHandle_IoUring();
+		static void __closeHandle_IoUring(void* handle);
+		void __runLoop_IoUring(void* handle);
+		sl_bool __attachInstance_IoUring(void* handle, AsyncIoInstance* instance, AsyncIoMode mode);
+		void __detachInstance_IoUring(void* handle, AsyncIoInstance* instance);
+		static void __wake_IoUring(void* handle);
+		static sl_bool __submitOperation_IoUring(void* handle, AsyncIoInstance* instance, AsyncIoOperation* operation);
+#endif
+
 	protected:
 		void _stepBegin();
 		void _stepEnd();
@@ -102,6 +124,40 @@ namespace slib
 	};
 	
 	
+	enum class AsyncIoOperationType
+	{
+		Read = 0, // file, at `offset`
+		Write = 1, // file, at `offset`
+		Receive = 2, // socket
+		Send = 3, // socket
+		Poll = 4 // waits for `pollMode`
+	};
+	
+	class SLIB_EXPORT AsyncIoOperation
+	{
+	public:
+		AsyncIoOperationType type;
+		void* data;
+		sl_uint32 size;
+		sl_uint64 offset;
+		AsyncIoMode pollMode;
+		
+		// transferred size (or polled events) on success, negative error code on failure
+		sl_int32 result;
+		
+		// holds the instance while the operation is pending
+		Ref<AsyncIoInstance> instance;
+		
+	public:
+		AsyncIoOperation();
+		
+		~AsyncIoOperation();
+		
+	public:
+		sl_bool isPending() const;
+		
+	};
+	
 	class AsyncIoObject;
 	
 	class SLIB_EXPORT AsyncIoInstance : public Object
@@ -156,6 +212,7 @@ namespace slib
 			sl_bool flagIn;
 			sl_bool flagOut;
 			sl_bool flagError;
+			AsyncIoOperation* pOperation; // completed operation (io_uring), null on readiness events
 #endif
 		};
 		virtual void onEvent(EventDesc* pev) = 0;
@@ -231,6 +288,10 @@ namespace slib
 		Function<void(AsyncStreamResult*)> callback;
 		sl_bool flagRead;
 
+		// source of the request sent by kernel (`sendFile`), `data` is null in this case
+		Ref<File> file;
+		sl_uint64 fileOffset;
+
 	protected:
 		AsyncStreamRequest(void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback, sl_bool flagRead);
 	
@@ -239,6 +300,8 @@ namespace slib
 
 		static Ref<AsyncStreamRequest> createWrite(void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
 
+		static Ref<AsyncStreamRequest> createSendFile(File* file, sl_uint64 offset, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
+
 	public:
 		void runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError);
 
@@ -265,6 +328,10 @@ namespace slib
 
 		virtual sl_uint64 getSize();
 
+		virtual sl_bool isSendFileSupported();
+
+		virtual sl_bool sendFile(File* file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
+
 		sl_size getWaitingSizeForWrite();
 
 	protected:
@@ -316,6 +383,11 @@ namespace slib
 
 		virtual sl_uint64 getSize();
 
+		// returns true if the stream can write the contents of the files without copying them into user space (sendfile)
+		virtual sl_bool isSendFileSupported();
+
+		virtual sl_bool sendFile(File* file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
+
 		sl_bool readToMemory(const Memory& mem, const Function<void(AsyncStreamResult*)>& callback);
 	
 		sl_bool writeFromMemory(const Memory& mem, const Function<void(AsyncStreamResult*)>& callback);
@@ -353,6 +425,12 @@ namespace slib
 		// override
 		sl_uint64 getSize();
 
+		// override
+		sl_bool isSendFileSupported();
+
+		// override
+		sl_bool sendFile(File* file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
+
 		// override
 		sl_bool addTask(const Function<void()>& callback);
 
@@ -517,6 +595,11 @@ namespace slib
 
 		static Ref<AsyncStream> openIOCP(const String& path, FileMode mode);
 #endif
+
+		// returns null if the loop is not using io_uring
+		static Ref<AsyncStream> openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop);
+
+		static Ref<AsyncStream> openIoUring(const String& path, FileMode mode);
 	
 	public:
 		// override
@@ -719,6 +802,9 @@ namespace slib
 		sl_bool copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 
 		sl_uint64 getOutputLength() const;
+
+		// removes the first element, used by the writers framing the output by themselves
+		sl_bool popElement(Ref<AsyncOutputBufferElement>& outElement);
 	
 	protected:
 		sl_uint64 m_lengthOutput;
@@ -789,6 +875,8 @@ namespace slib
 	private:
 		void onWriteStream(AsyncStreamResult* result);
 
+		void onSendFile(AsyncStreamResult* result);
+
 	protected:
 		void _onError();
 
@@ -796,6 +884,8 @@ namespace slib
 
 		void _write(sl_bool flagCompleted);
 
+		sl_bool _sendFile();
+
 	protected:
 		Ref<AsyncStream> m_streamOutput;
 		sl_uint32 m_bufferSize;
@@ -810,6 +900,10 @@ namespace slib
 		sl_bool m_flagWriting;
 		sl_bool m_flagClosed;
 
+		Ref<File> m_fileSending;
+		sl_uint64 m_offsetFileSending;
+		sl_uint64 m_sizeFileSending;
+
 	};
 	
 	
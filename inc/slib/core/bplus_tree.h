@@ -0,0 +1,209 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_BPLUS_TREE
+#define CHECKHEADER_SLIB_CORE_BPLUS_TREE
+
+#include "definition.h"
+
+#include "constants.h"
+#include "compare.h"
+#include "list.h"
+#include "search.h"
+#include "cpp.h"
+
+// approximate size (in bytes) of the items stored in a node
+#define SLIB_BPLUSTREE_NODE_SIZE 256
+
+/*
+	BPlusTree is an in-memory B+ tree.
+
+	The keys and the values are stored inline in the nodes, which are
+	accessed by direct pointers, so a search touches a few contiguous
+	arrays instead of following one pointer per comparison. All items are
+	kept in the leaves, and the leaves are linked for ordered iteration.
+
+	Unlike BTree, the nodes can't be stored in other containers such as
+	files. The items having the same key (added by `MapPutMode::AddAlways`)
+	are kept in insertion order. The positions and the pointers to the items
+	are invalidated when the tree is modified.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT _BPlusTreeNode
+	{
+	public:
+		_BPlusTreeNode* parent;
+		sl_uint32 count;
+		sl_bool flagLeaf;
+
+	};
+
+	class SLIB_EXPORT BPlusTreePosition
+	{
+	public:
+		_BPlusTreeNode* leaf = sl_null;
+		sl_uint32 index = 0;
+
+	public:
+		sl_bool operator==(const BPlusTreePosition& other) const;
+
+		sl_bool operator!=(const BPlusTreePosition& other) const;
+
+		sl_bool isNull() const;
+
+		sl_bool isNotNull() const;
+
+		void setNull();
+
+	};
+
+	template < class KT, class VT, class KEY_COMPARE = Compare<KT> >
+	class SLIB_EXPORT BPlusTree
+	{
+	public:
+		BPlusTree(const KEY_COMPARE& compare = KEY_COMPARE());
+
+		~BPlusTree();
+
+	public:
+		sl_size getCount() const;
+
+		sl_bool search(const KT& key, BPlusTreePosition* pos = sl_null, VT* outValue = sl_null) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool searchKeyAndValue(const KT& key, const _VT& value, BPlusTreePosition* pos = sl_null, VT* outValue = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		// position of the first item whose key is not less than `key`
+		sl_bool getLowerBound(const KT& key, BPlusTreePosition* pos) const;
+
+		// position of the first item whose key is greater than `key`
+		sl_bool getUpperBound(const KT& key, BPlusTreePosition* pos) const;
+
+		sl_bool getAt(const BPlusTreePosition& pos, KT* key = sl_null, VT* value = sl_null) const;
+
+		KT* getKeyPointerAt(const BPlusTreePosition& pos) const;
+
+		VT* getValuePointerAt(const BPlusTreePosition& pos) const;
+
+		sl_bool getFirstPosition(BPlusTreePosition& pos, KT* key = sl_null, VT* value = sl_null) const;
+
+		// starts from the first item when `pos` is null
+		sl_bool getNextPosition(BPlusTreePosition& pos, KT* key = sl_null, VT* value = sl_null) const;
+
+		sl_bool getLastPosition(BPlusTreePosition& pos, KT* key = sl_null, VT* value = sl_null) const;
+
+		// starts from the last item when `pos` is null
+		sl_bool getPrevPosition(BPlusTreePosition& pos, KT* key = sl_null, VT* value = sl_null) const;
+
+		sl_bool get(const KT& key, VT* value = sl_null) const;
+
+		VT* getItemPointer(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		VT* getItemPointerByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		List<VT> getValues(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		List<VT> getValuesByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		sl_bool put(const KT& key, const VT& value, MapPutMode mode = MapPutMode::Default, sl_bool* pFlagExist = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_bool remove(const KT& key, VT* outValue = sl_null);
+
+		sl_size removeItems(const KT& key, List<VT>* outValues = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool removeKeyAndValue(const KT& key, const _VT& value, VT* outValue = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_size removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_bool removeAt(const BPlusTreePosition& pos);
+
+		sl_size removeAll();
+
+		sl_bool copyFrom(const BPlusTree<KT, VT, KEY_COMPARE>* other);
+
+	private:
+		enum
+		{
+			LeafCapacity = SLIB_BPLUSTREE_NODE_SIZE / (sizeof(KT) + sizeof(VT)) < 4 ? 4 : (SLIB_BPLUSTREE_NODE_SIZE / (sizeof(KT) + sizeof(VT)) > 64 ? 64 : SLIB_BPLUSTREE_NODE_SIZE / (sizeof(KT) + sizeof(VT))),
+			LeafMinimum = LeafCapacity / 2,
+			InnerCapacity = SLIB_BPLUSTREE_NODE_SIZE / (sizeof(KT) + sizeof(void*)) < 4 ? 4 : (SLIB_BPLUSTREE_NODE_SIZE / (sizeof(KT) + sizeof(void*)) > 64 ? 64 : SLIB_BPLUSTREE_NODE_SIZE / (sizeof(KT) + sizeof(void*))),
+			InnerMinimum = InnerCapacity / 2
+		};
+
+		class Leaf : public _BPlusTreeNode
+		{
+		public:
+			Leaf* prev;
+			Leaf* next;
+			KT keys[LeafCapacity];
+			VT values[LeafCapacity];
+		};
+
+		// `keys[i]` is not less than the keys in `children[i]`, and not greater than the keys in `children[i + 1]`
+		class Inner : public _BPlusTreeNode
+		{
+		public:
+			KT keys[InnerCapacity];
+			_BPlusTreeNode* children[InnerCapacity + 1];
+		};
+
+		_BPlusTreeNode* m_root;
+		sl_size m_nCount;
+		KEY_COMPARE m_compare;
+
+	private:
+		sl_uint32 _getLowerIndex(const KT* keys, sl_uint32 count, const KT& key) const;
+
+		sl_uint32 _getUpperIndex(const KT* keys, sl_uint32 count, const KT& key) const;
+
+		Leaf* _getLeaf(const KT& key, sl_bool flagUpper) const;
+
+		// on failure, `leaf` and `index` are set to the position for inserting `key`
+		sl_bool _search(const KT& key, Leaf*& leaf, sl_uint32& index) const;
+
+		Leaf* _getFirstLeaf() const;
+
+		Leaf* _getLastLeaf() const;
+
+		static Leaf* _createLeaf();
+
+		static Inner* _createInner();
+
+		static sl_uint32 _getIndexInParent(_BPlusTreeNode* node);
+
+		sl_bool _insertAt(Leaf* leaf, sl_uint32 index, const KT& key, const VT& value);
+
+		sl_bool _insertInParent(_BPlusTreeNode* left, const KT& key, _BPlusTreeNode* right);
+
+		void _removeAt(Leaf* leaf, sl_uint32 index);
+
+		void _rebalanceLeaf(Leaf* leaf);
+
+		void _removeInInner(Inner* node, sl_uint32 index);
+
+		static void _freeNode(_BPlusTreeNode* node);
+
+	};
+
+}
+
+#include "detail/bplus_tree.h"
+
+#endif
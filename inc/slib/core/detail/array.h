@@ -362,6 +362,34 @@ namespace slib
 		return create(m_data, m_count);
 	}
 
+	template <class T>
+	template <class COMPARE>
+	void CArray<T>::sort(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		QuickSort::sort(m_data, m_count, flagAscending, compare);
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool CArray<T>::sortStable(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		return MergeSort::sort(m_data, m_count, flagAscending, compare);
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool CArray<T>::sortParallel(sl_bool flagAscending, const COMPARE& compare, ThreadPool* pool) const
+	{
+		return ParallelSort::sort(m_data, m_count, flagAscending, compare, pool);
+	}
+
+	template <class T>
+	template <class GET_KEY>
+	sl_bool CArray<T>::sortByKey(sl_bool flagAscending, const GET_KEY& getKey) const
+	{
+		return RadixSort::sortByKey(m_data, m_count, getKey, flagAscending);
+	}
+
 	template <class T>
 	SLIB_INLINE T* CArray<T>::begin()
 	{
@@ -659,6 +687,49 @@ namespace slib
 		return sl_null;
 	}
 
+	template <class T>
+	template <class COMPARE>
+	void Array<T>::sort(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		CArray<T>* obj = ref._ptr;
+		if (obj) {
+			obj->sort(flagAscending, compare);
+		}
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool Array<T>::sortStable(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		CArray<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortStable(flagAscending, compare);
+		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool Array<T>::sortParallel(sl_bool flagAscending, const COMPARE& compare, ThreadPool* pool) const
+	{
+		CArray<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortParallel(flagAscending, compare, pool);
+		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class GET_KEY>
+	sl_bool Array<T>::sortByKey(sl_bool flagAscending, const GET_KEY& getKey) const
+	{
+		CArray<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortByKey(flagAscending, getKey);
+		}
+		return sl_true;
+	}
+
 	template <class T>
 	Iterator<T> Array<T>::toIterator() const
 	{
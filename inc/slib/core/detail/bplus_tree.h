@@ -0,0 +1,977 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_DETAIL_BPLUS_TREE
+#define CHECKHEADER_SLIB_CORE_DETAIL_BPLUS_TREE
+
+#include "../bplus_tree.h"
+
+namespace slib
+{
+
+	SLIB_INLINE sl_bool BPlusTreePosition::operator==(const BPlusTreePosition& other) const
+	{
+		return leaf == other.leaf && index == other.index;
+	}
+
+	SLIB_INLINE sl_bool BPlusTreePosition::operator!=(const BPlusTreePosition& other) const
+	{
+		return leaf != other.leaf || index != other.index;
+	}
+
+	SLIB_INLINE sl_bool BPlusTreePosition::isNull() const
+	{
+		return leaf == sl_null;
+	}
+
+	SLIB_INLINE sl_bool BPlusTreePosition::isNotNull() const
+	{
+		return leaf != sl_null;
+	}
+
+	SLIB_INLINE void BPlusTreePosition::setNull()
+	{
+		leaf = sl_null;
+		index = 0;
+	}
+
+
+	template <class KT, class VT, class KEY_COMPARE>
+	BPlusTree<KT, VT, KEY_COMPARE>::BPlusTree(const KEY_COMPARE& compare) : m_compare(compare)
+	{
+		m_root = sl_null;
+		m_nCount = 0;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	BPlusTree<KT, VT, KEY_COMPARE>::~BPlusTree()
+	{
+		if (m_root) {
+			_freeNode(m_root);
+		}
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	SLIB_INLINE sl_size BPlusTree<KT, VT, KEY_COMPARE>::getCount() const
+	{
+		return m_nCount;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::search(const KT& key, BPlusTreePosition* pos, VT* outValue) const
+	{
+		Leaf* leaf;
+		sl_uint32 index;
+		if (_search(key, leaf, index)) {
+			if (pos) {
+				pos->leaf = leaf;
+				pos->index = index;
+			}
+			if (outValue) {
+				*outValue = leaf->values[index];
+			}
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::searchKeyAndValue(const KT& key, const _VT& value, BPlusTreePosition* pos, VT* outValue, const VALUE_EQUALS& value_equals) const
+	{
+		BPlusTreePosition p;
+		if (getLowerBound(key, &p)) {
+			do {
+				Leaf* leaf = (Leaf*)(p.leaf);
+				if (m_compare(leaf->keys[p.index], key) != 0) {
+					break;
+				}
+				if (value_equals(leaf->values[p.index], value)) {
+					if (pos) {
+						*pos = p;
+					}
+					if (outValue) {
+						*outValue = leaf->values[p.index];
+					}
+					return sl_true;
+				}
+			} while (getNextPosition(p));
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::getLowerBound(const KT& key, BPlusTreePosition* pos) const
+	{
+		Leaf* leaf = _getLeaf(key, sl_false);
+		if (leaf) {
+			sl_uint32 index = _getLowerIndex(leaf->keys, leaf->count, key);
+			if (index >= leaf->count) {
+				leaf = leaf->next;
+				if (!leaf) {
+					return sl_false;
+				}
+				index = 0;
+			}
+			pos->leaf = leaf;
+			pos->index = index;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::getUpperBound(const KT& key, BPlusTreePosition* pos) const
+	{
+		Leaf* leaf = _getLeaf(key, sl_true);
+		if (leaf) {
+			sl_uint32 index = _getUpperIndex(leaf->keys, leaf->count, key);
+			if (index >= leaf->count) {
+				leaf = leaf->next;
+				if (!leaf) {
+					return sl_false;
+				}
+				index = 0;
+			}
+			pos->leaf = leaf;
+			pos->index = index;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::getAt(const BPlusTreePosition& pos, KT* key, VT* value) const
+	{
+		Leaf* leaf = (Leaf*)(pos.leaf);
+		if (leaf && pos.index < leaf->count) {
+			if (key) {
+				*key = leaf->keys[pos.index];
+			}
+			if (value) {
+				*value = leaf->values[pos.index];
+			}
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	KT* BPlusTree<KT, VT, KEY_COMPARE>::getKeyPointerAt(const BPlusTreePosition& pos) const
+	{
+		Leaf* leaf = (Leaf*)(pos.leaf);
+		if (leaf && pos.index < leaf->count) {
+			return leaf->keys + pos.index;
+		}
+		return sl_null;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	VT* BPlusTree<KT, VT, KEY_COMPARE>::getValuePointerAt(const BPlusTreePosition& pos) const
+	{
+		Leaf* leaf = (Leaf*)(pos.leaf);
+		if (leaf && pos.index < leaf->count) {
+			return leaf->values + pos.index;
+		}
+		return sl_null;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::getFirstPosition(BPlusTreePosition& pos, KT* key, VT* value) const
+	{
+		pos.setNull();
+		return getNextPosition(pos, key, value);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::getNextPosition(BPlusTreePosition& pos, KT* key, VT* value) const
+	{
+		Leaf* leaf;
+		sl_uint32 index;
+		if (pos.leaf) {
+			leaf = (Leaf*)(pos.leaf);
+			index = pos.index + 1;
+			if (index >= leaf->count) {
+				leaf = leaf->next;
+				index = 0;
+			}
+		} else {
+			leaf = _getFirstLeaf();
+			index = 0;
+		}
+		if (leaf && index < leaf->count) {
+			pos.leaf = leaf;
+			pos.index = index;
+			if (key) {
+				*key = leaf->keys[index];
+			}
+			if (value) {
+				*value = leaf->values[index];
+			}
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::getLastPosition(BPlusTreePosition& pos, KT* key, VT* value) const
+	{
+		pos.setNull();
+		return getPrevPosition(pos, key, value);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::getPrevPosition(BPlusTreePosition& pos, KT* key, VT* value) const
+	{
+		Leaf* leaf;
+		sl_uint32 index;
+		if (pos.leaf) {
+			leaf = (Leaf*)(pos.leaf);
+			if (pos.index > 0) {
+				index = pos.index - 1;
+			} else {
+				leaf = leaf->prev;
+				if (!leaf) {
+					return sl_false;
+				}
+				index = leaf->count - 1;
+			}
+		} else {
+			leaf = _getLastLeaf();
+			if (!leaf || !(leaf->count)) {
+				return sl_false;
+			}
+			index = leaf->count - 1;
+		}
+		pos.leaf = leaf;
+		pos.index = index;
+		if (key) {
+			*key = leaf->keys[index];
+		}
+		if (value) {
+			*value = leaf->values[index];
+		}
+		return sl_true;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::get(const KT& key, VT* value) const
+	{
+		return search(key, sl_null, value);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	VT* BPlusTree<KT, VT, KEY_COMPARE>::getItemPointer(const KT& key) const
+	{
+		BPlusTreePosition pos;
+		if (search(key, &pos)) {
+			return ((Leaf*)(pos.leaf))->values + pos.index;
+		}
+		return sl_null;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	VT* BPlusTree<KT, VT, KEY_COMPARE>::getItemPointerByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals) const
+	{
+		BPlusTreePosition pos;
+		if (searchKeyAndValue(key, value, &pos, sl_null, value_equals)) {
+			return ((Leaf*)(pos.leaf))->values + pos.index;
+		}
+		return sl_null;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	List<VT> BPlusTree<KT, VT, KEY_COMPARE>::getValues(const KT& key) const
+	{
+		List<VT> ret;
+		BPlusTreePosition pos;
+		if (getLowerBound(key, &pos)) {
+			do {
+				Leaf* leaf = (Leaf*)(pos.leaf);
+				if (m_compare(leaf->keys[pos.index], key) != 0) {
+					break;
+				}
+				ret.add_NoLock(leaf->values[pos.index]);
+			} while (getNextPosition(pos));
+		}
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	List<VT> BPlusTree<KT, VT, KEY_COMPARE>::getValuesByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals) const
+	{
+		List<VT> ret;
+		BPlusTreePosition pos;
+		if (getLowerBound(key, &pos)) {
+			do {
+				Leaf* leaf = (Leaf*)(pos.leaf);
+				if (m_compare(leaf->keys[pos.index], key) != 0) {
+					break;
+				}
+				if (value_equals(leaf->values[pos.index], value)) {
+					ret.add_NoLock(leaf->values[pos.index]);
+				}
+			} while (getNextPosition(pos));
+		}
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::put(const KT& key, const VT& value, MapPutMode mode, sl_bool* pFlagExist)
+	{
+		if (pFlagExist) {
+			*pFlagExist = sl_false;
+		}
+		if (!m_root) {
+			if (mode == MapPutMode::ReplaceExisting) {
+				return sl_false;
+			}
+			Leaf* leaf = _createLeaf();
+			if (!leaf) {
+				return sl_false;
+			}
+			leaf->keys[0] = key;
+			leaf->values[0] = value;
+			leaf->count = 1;
+			m_root = leaf;
+			m_nCount = 1;
+			return sl_true;
+		}
+		Leaf* leaf;
+		sl_uint32 index;
+		if (mode == MapPutMode::AddAlways) {
+			// same keys are added after the existing ones
+			leaf = _getLeaf(key, sl_true);
+			index = _getUpperIndex(leaf->keys, leaf->count, key);
+			if (pFlagExist) {
+				if (index) {
+					*pFlagExist = m_compare(leaf->keys[index - 1], key) == 0;
+				} else if (leaf->prev) {
+					*pFlagExist = m_compare(leaf->prev->keys[leaf->prev->count - 1], key) == 0;
+				}
+			}
+		} else {
+			if (_search(key, leaf, index)) {
+				if (pFlagExist) {
+					*pFlagExist = sl_true;
+				}
+				if (mode == MapPutMode::AddNew) {
+					return sl_false;
+				}
+				leaf->values[index] = value;
+				return sl_true;
+			}
+			if (mode == MapPutMode::ReplaceExisting) {
+				return sl_false;
+			}
+		}
+		return _insertAt(leaf, index, key, value);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist, const VALUE_EQUALS& value_equals)
+	{
+		if (pFlagExist) {
+			*pFlagExist = sl_false;
+		}
+		if (searchKeyAndValue(key, value, sl_null, sl_null, value_equals)) {
+			if (pFlagExist) {
+				*pFlagExist = sl_true;
+			}
+			return sl_false;
+		}
+		return put(key, value, MapPutMode::AddAlways);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::remove(const KT& key, VT* outValue)
+	{
+		BPlusTreePosition pos;
+		if (search(key, &pos)) {
+			Leaf* leaf = (Leaf*)(pos.leaf);
+			if (outValue) {
+				*outValue = Move(leaf->values[pos.index]);
+			}
+			_removeAt(leaf, pos.index);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_size BPlusTree<KT, VT, KEY_COMPARE>::removeItems(const KT& key, List<VT>* outValues)
+	{
+		sl_size n = 0;
+		BPlusTreePosition pos;
+		while (search(key, &pos)) {
+			Leaf* leaf = (Leaf*)(pos.leaf);
+			if (outValues) {
+				outValues->add_NoLock(Move(leaf->values[pos.index]));
+			}
+			_removeAt(leaf, pos.index);
+			n++;
+		}
+		return n;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::removeKeyAndValue(const KT& key, const _VT& value, VT* outValue, const VALUE_EQUALS& value_equals)
+	{
+		BPlusTreePosition pos;
+		if (searchKeyAndValue(key, value, &pos, sl_null, value_equals)) {
+			Leaf* leaf = (Leaf*)(pos.leaf);
+			if (outValue) {
+				*outValue = Move(leaf->values[pos.index]);
+			}
+			_removeAt(leaf, pos.index);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	sl_size BPlusTree<KT, VT, KEY_COMPARE>::removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues, const VALUE_EQUALS& value_equals)
+	{
+		sl_size n = 0;
+		BPlusTreePosition pos;
+		while (searchKeyAndValue(key, value, &pos, sl_null, value_equals)) {
+			Leaf* leaf = (Leaf*)(pos.leaf);
+			if (outValues) {
+				outValues->add_NoLock(Move(leaf->values[pos.index]));
+			}
+			_removeAt(leaf, pos.index);
+			n++;
+		}
+		return n;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::removeAt(const BPlusTreePosition& pos)
+	{
+		Leaf* leaf = (Leaf*)(pos.leaf);
+		if (leaf && pos.index < leaf->count) {
+			_removeAt(leaf, pos.index);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_size BPlusTree<KT, VT, KEY_COMPARE>::removeAll()
+	{
+		sl_size n = m_nCount;
+		if (m_root) {
+			_freeNode(m_root);
+			m_root = sl_null;
+		}
+		m_nCount = 0;
+		return n;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::copyFrom(const BPlusTree<KT, VT, KEY_COMPARE>* other)
+	{
+		if (this == other) {
+			return sl_true;
+		}
+		removeAll();
+		m_compare = other->m_compare;
+		// the items are sorted, so they are always appended to the last leaf
+		Leaf* leafSrc = other->_getFirstLeaf();
+		Leaf* leafDst = sl_null;
+		while (leafSrc) {
+			for (sl_uint32 i = 0; i < leafSrc->count; i++) {
+				if (leafDst) {
+					if (!(_insertAt(leafDst, leafDst->count, leafSrc->keys[i], leafSrc->values[i]))) {
+						return sl_false;
+					}
+					if (leafDst->next) {
+						leafDst = leafDst->next;
+					}
+				} else {
+					if (!(put(leafSrc->keys[i], leafSrc->values[i], MapPutMode::AddAlways))) {
+						return sl_false;
+					}
+					leafDst = (Leaf*)m_root;
+				}
+			}
+			leafSrc = leafSrc->next;
+		}
+		return sl_true;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	SLIB_INLINE sl_uint32 BPlusTree<KT, VT, KEY_COMPARE>::_getLowerIndex(const KT* keys, sl_uint32 count, const KT& key) const
+	{
+		sl_uint32 start = 0;
+		sl_uint32 end = count;
+		while (start < end) {
+			sl_uint32 mid = (start + end) >> 1;
+			if (m_compare(keys[mid], key) < 0) {
+				start = mid + 1;
+			} else {
+				end = mid;
+			}
+		}
+		return start;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	SLIB_INLINE sl_uint32 BPlusTree<KT, VT, KEY_COMPARE>::_getUpperIndex(const KT* keys, sl_uint32 count, const KT& key) const
+	{
+		sl_uint32 start = 0;
+		sl_uint32 end = count;
+		while (start < end) {
+			sl_uint32 mid = (start + end) >> 1;
+			if (m_compare(keys[mid], key) <= 0) {
+				start = mid + 1;
+			} else {
+				end = mid;
+			}
+		}
+		return start;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	typename BPlusTree<KT, VT, KEY_COMPARE>::Leaf* BPlusTree<KT, VT, KEY_COMPARE>::_getLeaf(const KT& key, sl_bool flagUpper) const
+	{
+		_BPlusTreeNode* node = m_root;
+		if (!node) {
+			return sl_null;
+		}
+		while (!(node->flagLeaf)) {
+			Inner* inner = (Inner*)node;
+			sl_uint32 index;
+			if (flagUpper) {
+				index = _getUpperIndex(inner->keys, inner->count, key);
+			} else {
+				index = _getLowerIndex(inner->keys, inner->count, key);
+			}
+			node = inner->children[index];
+		}
+		return (Leaf*)node;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::_search(const KT& key, Leaf*& leaf, sl_uint32& index) const
+	{
+		leaf = _getLeaf(key, sl_true);
+		if (!leaf) {
+			return sl_false;
+		}
+		sl_size pos = 0;
+		if (BinarySearch::search(leaf->keys, leaf->count, key, &pos, m_compare)) {
+			index = (sl_uint32)pos;
+			return sl_true;
+		}
+		index = (sl_uint32)pos;
+		if (!pos) {
+			// the last item not greater than `key` can be in the previous leaf
+			Leaf* prev = leaf->prev;
+			if (prev && m_compare(prev->keys[prev->count - 1], key) == 0) {
+				leaf = prev;
+				index = prev->count - 1;
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	typename BPlusTree<KT, VT, KEY_COMPARE>::Leaf* BPlusTree<KT, VT, KEY_COMPARE>::_getFirstLeaf() const
+	{
+		_BPlusTreeNode* node = m_root;
+		if (!node) {
+			return sl_null;
+		}
+		while (!(node->flagLeaf)) {
+			node = ((Inner*)node)->children[0];
+		}
+		return (Leaf*)node;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	typename BPlusTree<KT, VT, KEY_COMPARE>::Leaf* BPlusTree<KT, VT, KEY_COMPARE>::_getLastLeaf() const
+	{
+		_BPlusTreeNode* node = m_root;
+		if (!node) {
+			return sl_null;
+		}
+		while (!(node->flagLeaf)) {
+			node = ((Inner*)node)->children[node->count];
+		}
+		return (Leaf*)node;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	typename BPlusTree<KT, VT, KEY_COMPARE>::Leaf* BPlusTree<KT, VT, KEY_COMPARE>::_createLeaf()
+	{
+		Leaf* leaf = new Leaf;
+		if (leaf) {
+			leaf->parent = sl_null;
+			leaf->count = 0;
+			leaf->flagLeaf = sl_true;
+			leaf->prev = sl_null;
+			leaf->next = sl_null;
+		}
+		return leaf;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	typename BPlusTree<KT, VT, KEY_COMPARE>::Inner* BPlusTree<KT, VT, KEY_COMPARE>::_createInner()
+	{
+		Inner* inner = new Inner;
+		if (inner) {
+			inner->parent = sl_null;
+			inner->count = 0;
+			inner->flagLeaf = sl_false;
+		}
+		return inner;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_uint32 BPlusTree<KT, VT, KEY_COMPARE>::_getIndexInParent(_BPlusTreeNode* node)
+	{
+		Inner* parent = (Inner*)(node->parent);
+		sl_uint32 n = parent->count;
+		for (sl_uint32 i = 0; i <= n; i++) {
+			if (parent->children[i] == node) {
+				return i;
+			}
+		}
+		return n;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::_insertAt(Leaf* leaf, sl_uint32 index, const KT& key, const VT& value)
+	{
+		sl_uint32 n = leaf->count;
+		if (n < LeafCapacity) {
+			for (sl_uint32 i = n; i > index; i--) {
+				leaf->keys[i] = Move(leaf->keys[i - 1]);
+				leaf->values[i] = Move(leaf->values[i - 1]);
+			}
+			leaf->keys[index] = key;
+			leaf->values[index] = value;
+			leaf->count = n + 1;
+			m_nCount++;
+			return sl_true;
+		}
+		Leaf* right = _createLeaf();
+		if (!right) {
+			return sl_false;
+		}
+		// appending to the last leaf keeps the left one full, for the sorted insertions
+		sl_uint32 nLeft;
+		if (index == n && !(leaf->next)) {
+			nLeft = n;
+		} else {
+			nLeft = n / 2;
+		}
+		for (sl_uint32 i = nLeft; i < n; i++) {
+			right->keys[i - nLeft] = Move(leaf->keys[i]);
+			right->values[i - nLeft] = Move(leaf->values[i]);
+			leaf->keys[i] = KT();
+			leaf->values[i] = VT();
+		}
+		leaf->count = nLeft;
+		right->count = n - nLeft;
+		right->next = leaf->next;
+		if (right->next) {
+			right->next->prev = right;
+		}
+		right->prev = leaf;
+		leaf->next = right;
+		if (index <= nLeft && nLeft < n) {
+			for (sl_uint32 i = nLeft; i > index; i--) {
+				leaf->keys[i] = Move(leaf->keys[i - 1]);
+				leaf->values[i] = Move(leaf->values[i - 1]);
+			}
+			leaf->keys[index] = key;
+			leaf->values[index] = value;
+			leaf->count = nLeft + 1;
+		} else {
+			index -= nLeft;
+			sl_uint32 m = right->count;
+			for (sl_uint32 i = m; i > index; i--) {
+				right->keys[i] = Move(right->keys[i - 1]);
+				right->values[i] = Move(right->values[i - 1]);
+			}
+			right->keys[index] = key;
+			right->values[index] = value;
+			right->count = m + 1;
+		}
+		m_nCount++;
+		return _insertInParent(leaf, right->keys[0], right);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool BPlusTree<KT, VT, KEY_COMPARE>::_insertInParent(_BPlusTreeNode* left, const KT& key, _BPlusTreeNode* right)
+	{
+		Inner* parent = (Inner*)(left->parent);
+		if (!parent) {
+			Inner* root = _createInner();
+			if (!root) {
+				return sl_false;
+			}
+			root->keys[0] = key;
+			root->children[0] = left;
+			root->children[1] = right;
+			root->count = 1;
+			left->parent = root;
+			right->parent = root;
+			m_root = root;
+			return sl_true;
+		}
+		sl_uint32 index = _getIndexInParent(left);
+		sl_uint32 n = parent->count;
+		if (n < InnerCapacity) {
+			for (sl_uint32 i = n; i > index; i--) {
+				parent->keys[i] = Move(parent->keys[i - 1]);
+				parent->children[i + 1] = parent->children[i];
+			}
+			parent->keys[index] = key;
+			parent->children[index + 1] = right;
+			parent->count = n + 1;
+			right->parent = parent;
+			return sl_true;
+		}
+		Inner* sibling = _createInner();
+		if (!sibling) {
+			return sl_false;
+		}
+		KT keys[InnerCapacity + 1];
+		_BPlusTreeNode* children[InnerCapacity + 2];
+		sl_uint32 i;
+		for (i = 0; i < index; i++) {
+			keys[i] = Move(parent->keys[i]);
+		}
+		keys[index] = key;
+		for (i = index; i < n; i++) {
+			keys[i + 1] = Move(parent->keys[i]);
+		}
+		for (i = 0; i <= index; i++) {
+			children[i] = parent->children[i];
+		}
+		children[index + 1] = right;
+		for (i = index + 1; i <= n; i++) {
+			children[i + 1] = parent->children[i];
+		}
+		// the middle key moves up to the grand parent
+		sl_uint32 nLeft = (n + 1) / 2;
+		sl_uint32 nRight = n - nLeft;
+		for (i = 0; i < nLeft; i++) {
+			parent->keys[i] = Move(keys[i]);
+			parent->children[i] = children[i];
+			children[i]->parent = parent;
+		}
+		parent->children[nLeft] = children[nLeft];
+		children[nLeft]->parent = parent;
+		for (i = nLeft; i < n; i++) {
+			parent->keys[i] = KT();
+		}
+		parent->count = nLeft;
+		for (i = 0; i < nRight; i++) {
+			sibling->keys[i] = Move(keys[nLeft + 1 + i]);
+			sibling->children[i] = children[nLeft + 1 + i];
+			sibling->children[i]->parent = sibling;
+		}
+		sibling->children[nRight] = children[n + 1];
+		sibling->children[nRight]->parent = sibling;
+		sibling->count = nRight;
+		return _insertInParent(parent, keys[nLeft], sibling);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	void BPlusTree<KT, VT, KEY_COMPARE>::_removeAt(Leaf* leaf, sl_uint32 index)
+	{
+		sl_uint32 n = leaf->count - 1;
+		for (sl_uint32 i = index; i < n; i++) {
+			leaf->keys[i] = Move(leaf->keys[i + 1]);
+			leaf->values[i] = Move(leaf->values[i + 1]);
+		}
+		leaf->keys[n] = KT();
+		leaf->values[n] = VT();
+		leaf->count = n;
+		m_nCount--;
+		if (leaf == m_root) {
+			if (!n) {
+				delete leaf;
+				m_root = sl_null;
+			}
+			return;
+		}
+		if (n < LeafMinimum) {
+			_rebalanceLeaf(leaf);
+		}
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	void BPlusTree<KT, VT, KEY_COMPARE>::_rebalanceLeaf(Leaf* leaf)
+	{
+		Inner* parent = (Inner*)(leaf->parent);
+		sl_uint32 index = _getIndexInParent(leaf);
+		Leaf* left = index > 0 ? (Leaf*)(parent->children[index - 1]) : sl_null;
+		Leaf* right = index < parent->count ? (Leaf*)(parent->children[index + 1]) : sl_null;
+		sl_uint32 n = leaf->count;
+		sl_uint32 i;
+		if (left && left->count > LeafMinimum) {
+			for (i = n; i > 0; i--) {
+				leaf->keys[i] = Move(leaf->keys[i - 1]);
+				leaf->values[i] = Move(leaf->values[i - 1]);
+			}
+			sl_uint32 m = left->count - 1;
+			leaf->keys[0] = Move(left->keys[m]);
+			leaf->values[0] = Move(left->values[m]);
+			left->keys[m] = KT();
+			left->values[m] = VT();
+			left->count = m;
+			leaf->count = n + 1;
+			parent->keys[index - 1] = leaf->keys[0];
+			return;
+		}
+		if (right && right->count > LeafMinimum) {
+			leaf->keys[n] = Move(right->keys[0]);
+			leaf->values[n] = Move(right->values[0]);
+			leaf->count = n + 1;
+			sl_uint32 m = right->count - 1;
+			for (i = 0; i < m; i++) {
+				right->keys[i] = Move(right->keys[i + 1]);
+				right->values[i] = Move(right->values[i + 1]);
+			}
+			right->keys[m] = KT();
+			right->values[m] = VT();
+			right->count = m;
+			parent->keys[index] = right->keys[0];
+			return;
+		}
+		// merges the right leaf into the left one
+		if (left) {
+			right = leaf;
+			index--;
+		} else {
+			left = leaf;
+		}
+		sl_uint32 m = left->count;
+		for (i = 0; i < right->count; i++) {
+			left->keys[m + i] = Move(right->keys[i]);
+			left->values[m + i] = Move(right->values[i]);
+		}
+		left->count = m + right->count;
+		left->next = right->next;
+		if (left->next) {
+			left->next->prev = left;
+		}
+		delete right;
+		_removeInInner(parent, index);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	void BPlusTree<KT, VT, KEY_COMPARE>::_removeInInner(Inner* node, sl_uint32 index)
+	{
+		// removes `keys[index]` and `children[index + 1]`
+		sl_uint32 n = node->count - 1;
+		sl_uint32 i;
+		for (i = index; i < n; i++) {
+			node->keys[i] = Move(node->keys[i + 1]);
+			node->children[i + 1] = node->children[i + 2];
+		}
+		node->keys[n] = KT();
+		node->count = n;
+		if (node == m_root) {
+			if (!n) {
+				m_root = node->children[0];
+				m_root->parent = sl_null;
+				delete node;
+			}
+			return;
+		}
+		if (n >= InnerMinimum) {
+			return;
+		}
+		Inner* parent = (Inner*)(node->parent);
+		index = _getIndexInParent(node);
+		Inner* left = index > 0 ? (Inner*)(parent->children[index - 1]) : sl_null;
+		Inner* right = index < parent->count ? (Inner*)(parent->children[index + 1]) : sl_null;
+		if (left && left->count > InnerMinimum) {
+			node->children[n + 1] = node->children[n];
+			for (i = n; i > 0; i--) {
+				node->keys[i] = Move(node->keys[i - 1]);
+				node->children[i] = node->children[i - 1];
+			}
+			sl_uint32 m = left->count;
+			node->keys[0] = Move(parent->keys[index - 1]);
+			node->children[0] = left->children[m];
+			node->children[0]->parent = node;
+			node->count = n + 1;
+			parent->keys[index - 1] = Move(left->keys[m - 1]);
+			left->keys[m - 1] = KT();
+			left->count = m - 1;
+			return;
+		}
+		if (right && right->count > InnerMinimum) {
+			node->keys[n] = Move(parent->keys[index]);
+			node->children[n + 1] = right->children[0];
+			node->children[n + 1]->parent = node;
+			node->count = n + 1;
+			parent->keys[index] = Move(right->keys[0]);
+			sl_uint32 m = right->count - 1;
+			for (i = 0; i < m; i++) {
+				right->keys[i] = Move(right->keys[i + 1]);
+				right->children[i] = right->children[i + 1];
+			}
+			right->children[m] = right->children[m + 1];
+			right->keys[m] = KT();
+			right->count = m;
+			return;
+		}
+		// merges the right node and the separator into the left one
+		if (left) {
+			right = node;
+			index--;
+		} else {
+			left = node;
+		}
+		sl_uint32 m = left->count;
+		left->keys[m] = Move(parent->keys[index]);
+		for (i = 0; i < right->count; i++) {
+			left->keys[m + 1 + i] = Move(right->keys[i]);
+		}
+		for (i = 0; i <= right->count; i++) {
+			left->children[m + 1 + i] = right->children[i];
+			left->children[m + 1 + i]->parent = left;
+		}
+		left->count = m + 1 + right->count;
+		delete right;
+		_removeInInner(parent, index);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	void BPlusTree<KT, VT, KEY_COMPARE>::_freeNode(_BPlusTreeNode* node)
+	{
+		if (node->flagLeaf) {
+			delete (Leaf*)node;
+		} else {
+			Inner* inner = (Inner*)node;
+			for (sl_uint32 i = 0; i <= inner->count; i++) {
+				_freeNode(inner->children[i]);
+			}
+			delete inner;
+		}
+	}
+
+}
+
+#endif
@@ -25,7 +25,7 @@ namespace slib
 	template <class T1, class T2>
 	SLIB_INLINE int CompareDescending<T1, T2>::operator()(const T1& a, const T2& b) const
 	{
-		return -(Compare<T1, T2>::compare(a, b));
+		return -(Compare<T1, T2>()(a, b));
 	}
 
 	template <class T1, class T2>
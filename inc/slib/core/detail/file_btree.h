@@ -0,0 +1,382 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_DETAIL_FILE_BTREE
+#define CHECKHEADER_SLIB_CORE_DETAIL_FILE_BTREE
+
+#include "../file_btree.h"
+
+#include "../mio.h"
+
+/*
+	Layout of a node page
+
+	0: countTotal (64 bits)
+	8: countItems (32 bits)
+	16: linkParent (64 bits)
+	24: linkFirst (64 bits)
+	32: keys[order], values[order], links[order] (64 bits)
+*/
+#define _SLIB_FILE_BTREE_NODE_HEADER_SIZE 32
+
+namespace slib
+{
+
+	template <class KT, class VT, class KEY_COMPARE>
+	FileBTree<KT, VT, KEY_COMPARE>::FileBTree(const FileBTreeParam& param, const KEY_COMPARE& compare) : BTree<KT, VT, KEY_COMPARE>(compare, getOrderForPageSize(param.pageSize))
+	{
+		if (getOrderForPageSize(param.pageSize) < 2) {
+			return;
+		}
+		if (!(m_pager.open(param, sizeof(KT), sizeof(VT)))) {
+			return;
+		}
+		if (m_pager.getRootPage()) {
+			_updateMaxLength();
+			this->m_totalCount = this->getCount();
+		} else {
+			TreeNode node = createNode(sl_null);
+			if (node.isNull() || !(setRootNode(node)) || !(m_pager.flush())) {
+				m_pager.close();
+			}
+		}
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	FileBTree<KT, VT, KEY_COMPARE>::~FileBTree()
+	{
+		close();
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::isOpened() const
+	{
+		return m_pager.isOpened();
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::flush()
+	{
+		return m_pager.flush();
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	void FileBTree<KT, VT, KEY_COMPARE>::close()
+	{
+		if (m_pager.isOpened()) {
+			m_pager.flush();
+			m_pager.close();
+		}
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::bulkLoad(const KT* keys, const VT* values, sl_size count)
+	{
+		sl_uint64 root = m_pager.getRootPage();
+		if (!root) {
+			return sl_false;
+		}
+		BTree<KT, VT, KEY_COMPARE>::removeAll();
+		if (!(_bulkLoad(keys, values, count, root, 0))) {
+			return sl_false;
+		}
+		_updateMaxLength();
+		this->m_totalCount = count;
+		return sl_true;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::put(const KT& key, const VT& value, MapPutMode mode, sl_bool* pFlagExist)
+	{
+		sl_bool ret = BTree<KT, VT, KEY_COMPARE>::put(key, value, mode, pFlagExist);
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist, const VALUE_EQUALS& value_equals)
+	{
+		sl_bool ret = BTree<KT, VT, KEY_COMPARE>::addIfNewKeyAndValue(key, value, pFlagExist, value_equals);
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::remove(const KT& key, VT* outValue)
+	{
+		sl_bool ret = BTree<KT, VT, KEY_COMPARE>::remove(key, outValue);
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_size FileBTree<KT, VT, KEY_COMPARE>::removeItems(const KT& key, List<VT>* outValues)
+	{
+		sl_size ret = BTree<KT, VT, KEY_COMPARE>::removeItems(key, outValues);
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::removeKeyAndValue(const KT& key, const _VT& value, VT* outValue, const VALUE_EQUALS& value_equals)
+	{
+		sl_bool ret = BTree<KT, VT, KEY_COMPARE>::removeKeyAndValue(key, value, outValue, value_equals);
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	template <class _VT, class VALUE_EQUALS>
+	sl_size FileBTree<KT, VT, KEY_COMPARE>::removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues, const VALUE_EQUALS& value_equals)
+	{
+		sl_size ret = BTree<KT, VT, KEY_COMPARE>::removeItemsByKeyAndValue(key, value, outValues, value_equals);
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::removeAt(const TreePosition& pos)
+	{
+		sl_bool ret = BTree<KT, VT, KEY_COMPARE>::removeAt(pos);
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::removeNode(const TreeNode& node)
+	{
+		sl_bool ret = BTree<KT, VT, KEY_COMPARE>::removeNode(node);
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_size FileBTree<KT, VT, KEY_COMPARE>::removeAll()
+	{
+		sl_size ret = BTree<KT, VT, KEY_COMPARE>::removeAll();
+		m_pager.checkDirtyPages();
+		return ret;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_uint32 FileBTree<KT, VT, KEY_COMPARE>::getOrderForPageSize(sl_uint32 pageSize)
+	{
+		if (pageSize <= _SLIB_FILE_BTREE_NODE_HEADER_SIZE) {
+			return 0;
+		}
+		return (pageSize - _SLIB_FILE_BTREE_NODE_HEADER_SIZE) / (sl_uint32)(sizeof(KT) + sizeof(VT) + 8);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	TreeNode FileBTree<KT, VT, KEY_COMPARE>::getRootNode() const
+	{
+		TreeNode node;
+		node.position = m_pager.getRootPage();
+		return node;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::setRootNode(TreeNode node)
+	{
+		if (node.isNull()) {
+			return sl_false;
+		}
+		m_pager.setRootPage(node.position);
+		return sl_true;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	TreeNode FileBTree<KT, VT, KEY_COMPARE>::createNode(NodeData* data)
+	{
+		TreeNode node;
+		sl_uint64 page = m_pager.allocatePage();
+		if (page) {
+			sl_uint8* p = m_pager.writePage(page);
+			if (p) {
+				node.position = page;
+				if (data) {
+					_writePage(p, data);
+					this->_freeNodeData(data);
+				}
+			}
+		}
+		return node;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::deleteNode(TreeNode node)
+	{
+		if (node.isNull()) {
+			return sl_false;
+		}
+		return m_pager.freePage(node.position);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	typename FileBTree<KT, VT, KEY_COMPARE>::NodeData* FileBTree<KT, VT, KEY_COMPARE>::readNodeData(const TreeNode& node) const
+	{
+		if (node.isNull()) {
+			return sl_null;
+		}
+		const sl_uint8* p = m_pager.readPage(node.position);
+		if (!p) {
+			return sl_null;
+		}
+		sl_uint32 n = MIO::readUint32LE(p + 8);
+		sl_uint32 order = this->m_order;
+		if (n > order) {
+			return sl_null;
+		}
+		NodeData* data = ((FileBTree*)this)->_createNodeData();
+		if (!data) {
+			return sl_null;
+		}
+		data->countTotal = MIO::readUint64LE(p);
+		data->countItems = n;
+		data->linkParent.position = MIO::readUint64LE(p + 16);
+		data->linkFirst.position = MIO::readUint64LE(p + 24);
+		const sl_uint8* keys = p + _SLIB_FILE_BTREE_NODE_HEADER_SIZE;
+		const sl_uint8* values = keys + sizeof(KT) * order;
+		const sl_uint8* links = values + sizeof(VT) * order;
+		Base::copyMemory(data->keys, keys, sizeof(KT) * n);
+		Base::copyMemory(data->values, values, sizeof(VT) * n);
+		for (sl_uint32 i = 0; i < n; i++) {
+			data->links[i].position = MIO::readUint64LE(links + (i << 3));
+		}
+		return data;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::writeNodeData(const TreeNode& node, NodeData* data)
+	{
+		if (node.isNull()) {
+			return sl_false;
+		}
+		if (!data) {
+			return sl_false;
+		}
+		sl_uint8* p = m_pager.writePage(node.position);
+		if (!p) {
+			return sl_false;
+		}
+		_writePage(p, data);
+		return sl_true;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	void FileBTree<KT, VT, KEY_COMPARE>::releaseNodeData(NodeData* data)
+	{
+		this->_freeNodeData(data);
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	void FileBTree<KT, VT, KEY_COMPARE>::_writePage(sl_uint8* p, NodeData* data)
+	{
+		sl_uint32 n = data->countItems;
+		sl_uint32 order = this->m_order;
+		MIO::writeUint64LE(p, data->countTotal);
+		MIO::writeUint32LE(p + 8, n);
+		MIO::writeUint32LE(p + 12, 0);
+		MIO::writeUint64LE(p + 16, data->linkParent.position);
+		MIO::writeUint64LE(p + 24, data->linkFirst.position);
+		sl_uint8* keys = p + _SLIB_FILE_BTREE_NODE_HEADER_SIZE;
+		sl_uint8* values = keys + sizeof(KT) * order;
+		sl_uint8* links = values + sizeof(VT) * order;
+		Base::copyMemory(keys, data->keys, sizeof(KT) * n);
+		Base::copyMemory(values, data->values, sizeof(VT) * n);
+		for (sl_uint32 i = 0; i < n; i++) {
+			MIO::writeUint64LE(links + (i << 3), data->links[i].position);
+		}
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	void FileBTree<KT, VT, KEY_COMPARE>::_updateMaxLength()
+	{
+		// depth of the leftmost path
+		sl_uint32 depth = 0;
+		sl_uint64 page = m_pager.getRootPage();
+		while (page) {
+			const sl_uint8* p = m_pager.readPage(page);
+			if (!p) {
+				break;
+			}
+			page = MIO::readUint64LE(p + 24);
+			if (page) {
+				depth++;
+			}
+		}
+		this->m_maxLength = depth;
+	}
+
+	template <class KT, class VT, class KEY_COMPARE>
+	sl_bool FileBTree<KT, VT, KEY_COMPARE>::_bulkLoad(const KT* keys, const VT* values, sl_size count, sl_uint64 page, sl_uint64 parent)
+	{
+		sl_uint32 order = this->m_order;
+		NodeData* data = this->_createNodeData();
+		if (!data) {
+			return sl_false;
+		}
+		data->countTotal = count;
+		data->linkParent.position = parent;
+		if (count <= order) {
+			// leaf
+			for (sl_size i = 0; i < count; i++) {
+				data->keys[i] = keys[i];
+				data->values[i] = values[i];
+			}
+			data->countItems = (sl_uint32)count;
+		} else {
+			// capacity of the subtrees in the smallest height holding `count` items
+			sl_uint64 capacitySubtree = order;
+			while ((capacitySubtree + 1) * (order + 1) - 1 < count) {
+				capacitySubtree = (capacitySubtree + 1) * (order + 1) - 1;
+			}
+			sl_size nChildren = (sl_size)((count + capacitySubtree + 1) / (capacitySubtree + 1));
+			sl_size nItemsInChildren = count - (nChildren - 1);
+			sl_size q = nItemsInChildren / nChildren;
+			sl_size r = nItemsInChildren % nChildren;
+			sl_size offset = 0;
+			for (sl_size i = 0; i < nChildren; i++) {
+				sl_size m = q + (i < r ? 1 : 0);
+				sl_uint64 child = m_pager.allocatePage();
+				if (!child) {
+					this->_freeNodeData(data);
+					return sl_false;
+				}
+				if (i) {
+					data->links[i - 1].position = child;
+				} else {
+					data->linkFirst.position = child;
+				}
+				if (!(_bulkLoad(keys + offset, values + offset, m, child, page))) {
+					this->_freeNodeData(data);
+					return sl_false;
+				}
+				offset += m;
+				if (i + 1 < nChildren) {
+					data->keys[i] = keys[offset];
+					data->values[i] = values[offset];
+					offset++;
+				}
+			}
+			data->countItems = (sl_uint32)(nChildren - 1);
+		}
+		TreeNode node;
+		node.position = page;
+		sl_bool flagSuccess = writeNodeData(node, data);
+		this->_freeNodeData(data);
+		return flagSuccess;
+	}
+
+}
+
+#endif
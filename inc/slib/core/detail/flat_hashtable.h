@@ -0,0 +1,658 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_DETAIL_FLAT_HASHTABLE
+#define CHECKHEADER_SLIB_CORE_DETAIL_FLAT_HASHTABLE
+
+#include "../flat_hashtable.h"
+
+#include <new>
+
+#if defined(SLIB_ARCH_IS_X64)
+#include <emmintrin.h>
+#endif
+
+namespace slib
+{
+
+#if defined(SLIB_ARCH_IS_X64)
+
+	SLIB_INLINE sl_uint32 _FlatHashTableGroup::match(const sl_uint8* ctrl, sl_uint8 h2)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)ctrl);
+		return (sl_uint32)(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)h2))));
+	}
+
+	SLIB_INLINE sl_uint32 _FlatHashTableGroup::matchEmpty(const sl_uint8* ctrl)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)ctrl);
+		return (sl_uint32)(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)Empty))));
+	}
+
+	SLIB_INLINE sl_uint32 _FlatHashTableGroup::matchEmptyOrDeleted(const sl_uint8* ctrl)
+	{
+		// the control bytes of the empty and deleted slots have the high bit
+		__m128i v = _mm_loadu_si128((const __m128i*)ctrl);
+		return (sl_uint32)(_mm_movemask_epi8(v));
+	}
+
+#else
+
+	SLIB_INLINE sl_uint32 _FlatHashTableGroup::match(const sl_uint8* ctrl, sl_uint8 h2)
+	{
+		sl_uint32 mask = 0;
+		for (sl_uint32 i = 0; i < _SLIB_FLAT_HASHTABLE_GROUP_SIZE; i++) {
+			if (ctrl[i] == h2) {
+				mask |= (1 << i);
+			}
+		}
+		return mask;
+	}
+
+	SLIB_INLINE sl_uint32 _FlatHashTableGroup::matchEmpty(const sl_uint8* ctrl)
+	{
+		return match(ctrl, Empty);
+	}
+
+	SLIB_INLINE sl_uint32 _FlatHashTableGroup::matchEmptyOrDeleted(const sl_uint8* ctrl)
+	{
+		sl_uint32 mask = 0;
+		for (sl_uint32 i = 0; i < _SLIB_FLAT_HASHTABLE_GROUP_SIZE; i++) {
+			if (ctrl[i] & 0x80) {
+				mask |= (1 << i);
+			}
+		}
+		return mask;
+	}
+
+#endif
+
+	SLIB_INLINE sl_uint32 _FlatHashTableGroup::matchFull(const sl_uint8* ctrl)
+	{
+		return (~(matchEmptyOrDeleted(ctrl))) & 0xFFFF;
+	}
+
+	SLIB_INLINE sl_uint32 _FlatHashTableGroup::getFirstIndex(sl_uint32 mask)
+	{
+#if defined(SLIB_COMPILER_IS_GCC)
+		return (sl_uint32)(__builtin_ctz(mask));
+#else
+		return Math::getLeastSignificantBits(mask);
+#endif
+	}
+
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashTable<KT, VT, HASH, KEY_EQUALS>::FlatHashTable(sl_uint32 capacity, const HASH& hash, const KEY_EQUALS& equals) : m_hash(hash), m_equals(equals)
+	{
+		if (capacity < _SLIB_FLAT_HASHTABLE_MIN_CAPACITY) {
+			capacity = _SLIB_FLAT_HASHTABLE_MIN_CAPACITY;
+		} else if (capacity > _SLIB_FLAT_HASHTABLE_MAX_CAPACITY) {
+			capacity = _SLIB_FLAT_HASHTABLE_MAX_CAPACITY;
+		} else {
+			capacity = Math::roundUpToPowerOfTwo32(capacity);
+		}
+		m_nCapacityMin = capacity;
+		_init();
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashTable<KT, VT, HASH, KEY_EQUALS>::~FlatHashTable()
+	{
+		_free();
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	SLIB_INLINE sl_size FlatHashTable<KT, VT, HASH, KEY_EQUALS>::getCount() const
+	{
+		return m_nSize;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	SLIB_INLINE sl_size FlatHashTable<KT, VT, HASH, KEY_EQUALS>::getCapacity() const
+	{
+		return m_nCapacity;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashEntry<KT, VT>* FlatHashTable<KT, VT, HASH, KEY_EQUALS>::getFirstEntry() const
+	{
+		if (m_nSize == 0) {
+			return sl_null;
+		}
+		for (sl_uint32 i = 0; i < m_nCapacity; i += _SLIB_FLAT_HASHTABLE_GROUP_SIZE) {
+			sl_uint32 bits = _FlatHashTableGroup::matchFull(m_ctrl + i);
+			if (bits) {
+				return m_slots + (i + _FlatHashTableGroup::getFirstIndex(bits));
+			}
+		}
+		return sl_null;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashEntry<KT, VT>* FlatHashTable<KT, VT, HASH, KEY_EQUALS>::getNextEntry(FlatHashEntry<KT, VT>* entry) const
+	{
+		sl_uint32 index = (sl_uint32)(entry - m_slots) + 1;
+		while (index < m_nCapacity) {
+			sl_uint32 base = index & ~(sl_uint32)(_SLIB_FLAT_HASHTABLE_GROUP_SIZE - 1);
+			sl_uint32 bits = _FlatHashTableGroup::matchFull(m_ctrl + base) >> (index - base);
+			if (bits) {
+				return m_slots + (index + _FlatHashTableGroup::getFirstIndex(bits));
+			}
+			index = base + _SLIB_FLAT_HASHTABLE_GROUP_SIZE;
+		}
+		return sl_null;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	SLIB_INLINE sl_uint32 FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_mixHash(sl_uint32 hash)
+	{
+		// the probing uses both of the high and low bits, so spread the entropy of weak hashes
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6b;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class CALLBACK>
+	void FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_searchSlots(sl_uint32 hash, const KT& key, const CALLBACK& callback) const
+	{
+		// calls `callback(index)` for every slot having the key, until the callback returns false
+		sl_uint8 h2 = (sl_uint8)(hash & 0x7F);
+		sl_uint32 maskGroups = (m_nCapacity / _SLIB_FLAT_HASHTABLE_GROUP_SIZE) - 1;
+		sl_uint32 group = (hash >> 7) & maskGroups;
+		sl_uint32 step = 0;
+		for (;;) {
+			sl_uint32 base = group * _SLIB_FLAT_HASHTABLE_GROUP_SIZE;
+			const sl_uint8* ctrl = m_ctrl + base;
+			sl_uint32 bits = _FlatHashTableGroup::match(ctrl, h2);
+			while (bits) {
+				sl_uint32 index = base + _FlatHashTableGroup::getFirstIndex(bits);
+				if (m_equals(m_slots[index].key, key)) {
+					if (!(callback(index))) {
+						return;
+					}
+				}
+				bits &= bits - 1;
+			}
+			if (_FlatHashTableGroup::matchEmpty(ctrl)) {
+				return;
+			}
+			step++;
+			if (step > maskGroups) {
+				return;
+			}
+			group = (group + step) & maskGroups;
+		}
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_uint32 FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_findInsertSlot(sl_uint32 hash) const
+	{
+		sl_uint32 maskGroups = (m_nCapacity / _SLIB_FLAT_HASHTABLE_GROUP_SIZE) - 1;
+		sl_uint32 group = (hash >> 7) & maskGroups;
+		sl_uint32 step = 0;
+		for (;;) {
+			sl_uint32 base = group * _SLIB_FLAT_HASHTABLE_GROUP_SIZE;
+			sl_uint32 bits = _FlatHashTableGroup::matchEmptyOrDeleted(m_ctrl + base);
+			if (bits) {
+				return base + _FlatHashTableGroup::getFirstIndex(bits);
+			}
+			step++;
+			group = (group + step) & maskGroups;
+		}
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashEntry<KT, VT>* FlatHashTable<KT, VT, HASH, KEY_EQUALS>::search(const KT& key) const
+	{
+		if (m_nCapacity == 0) {
+			return sl_null;
+		}
+		Entry* ret = sl_null;
+		Entry* slots = m_slots;
+		_searchSlots(_mixHash(m_hash(key)), key, [&ret, slots](sl_uint32 index) {
+			ret = slots + index;
+			return sl_false;
+		});
+		return ret;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	FlatHashEntry<KT, VT>* FlatHashTable<KT, VT, HASH, KEY_EQUALS>::searchKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals) const
+	{
+		if (m_nCapacity == 0) {
+			return sl_null;
+		}
+		Entry* ret = sl_null;
+		Entry* slots = m_slots;
+		_searchSlots(_mixHash(m_hash(key)), key, [&](sl_uint32 index) {
+			if (value_equals(slots[index].value, value)) {
+				ret = slots + index;
+				return sl_false;
+			}
+			return sl_true;
+		});
+		return ret;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::get(const KT& key, VT* value) const
+	{
+		Entry* entry = search(key);
+		if (entry) {
+			if (value) {
+				*value = entry->value;
+			}
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	VT* FlatHashTable<KT, VT, HASH, KEY_EQUALS>::getItemPointer(const KT& key) const
+	{
+		Entry* entry = search(key);
+		if (entry) {
+			return &(entry->value);
+		}
+		return sl_null;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	VT* FlatHashTable<KT, VT, HASH, KEY_EQUALS>::getItemPointerByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals) const
+	{
+		Entry* entry = searchKeyAndValue(key, value, value_equals);
+		if (entry) {
+			return &(entry->value);
+		}
+		return sl_null;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	List<VT> FlatHashTable<KT, VT, HASH, KEY_EQUALS>::getValues(const KT& key) const
+	{
+		List<VT> ret;
+		if (m_nCapacity == 0) {
+			return ret;
+		}
+		Entry* slots = m_slots;
+		_searchSlots(_mixHash(m_hash(key)), key, [&ret, slots](sl_uint32 index) {
+			ret.add_NoLock(slots[index].value);
+			return sl_true;
+		});
+		return ret;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	List<VT> FlatHashTable<KT, VT, HASH, KEY_EQUALS>::getValuesByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals) const
+	{
+		List<VT> ret;
+		if (m_nCapacity == 0) {
+			return ret;
+		}
+		Entry* slots = m_slots;
+		_searchSlots(_mixHash(m_hash(key)), key, [&](sl_uint32 index) {
+			if (value_equals(slots[index].value, value)) {
+				ret.add_NoLock(slots[index].value);
+			}
+			return sl_true;
+		});
+		return ret;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_addEntry(sl_uint32 hash, const KT& key, const VT& value)
+	{
+		sl_uint32 index = _findInsertSlot(hash);
+		if (m_nGrowthLeft == 0 && m_ctrl[index] == _FlatHashTableGroup::Empty) {
+			sl_uint32 capacity = m_nCapacity;
+			// reclaim the deleted slots without growing when the table is not crowded
+			if (m_nSize * 32 > (sl_size)capacity * 25) {
+				capacity += capacity;
+			}
+			if (!(_rehash(capacity))) {
+				return sl_false;
+			}
+			index = _findInsertSlot(hash);
+		}
+		if (m_ctrl[index] == _FlatHashTableGroup::Empty) {
+			m_nGrowthLeft--;
+		}
+		m_ctrl[index] = (sl_uint8)(hash & 0x7F);
+		new (m_slots + index) Entry(key, value);
+		m_nSize++;
+		return sl_true;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::put(const KT& key, const VT& value, MapPutMode mode, sl_bool* pFlagExist)
+	{
+		if (pFlagExist) {
+			*pFlagExist = sl_false;
+		}
+		if (m_nCapacity == 0) {
+			return sl_false;
+		}
+
+		sl_uint32 hash = _mixHash(m_hash(key));
+
+		if (mode != MapPutMode::AddAlways) {
+			Entry* entry = sl_null;
+			Entry* slots = m_slots;
+			_searchSlots(hash, key, [&entry, slots](sl_uint32 index) {
+				entry = slots + index;
+				return sl_false;
+			});
+			if (entry) {
+				if (pFlagExist) {
+					*pFlagExist = sl_true;
+				}
+				if (mode == MapPutMode::AddNew) {
+					return sl_false;
+				}
+				entry->value = value;
+				return sl_true;
+			}
+			if (mode == MapPutMode::ReplaceExisting) {
+				return sl_false;
+			}
+		}
+
+		return _addEntry(hash, key, value);
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist, const VALUE_EQUALS& value_equals)
+	{
+		if (pFlagExist) {
+			*pFlagExist = sl_false;
+		}
+		if (m_nCapacity == 0) {
+			return sl_false;
+		}
+
+		sl_uint32 hash = _mixHash(m_hash(key));
+
+		sl_bool flagExist = sl_false;
+		Entry* slots = m_slots;
+		_searchSlots(hash, key, [&](sl_uint32 index) {
+			if (value_equals(slots[index].value, value)) {
+				flagExist = sl_true;
+				return sl_false;
+			}
+			return sl_true;
+		});
+		if (flagExist) {
+			if (pFlagExist) {
+				*pFlagExist = sl_true;
+			}
+			return sl_false;
+		}
+
+		return _addEntry(hash, key, value);
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	void FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_removeSlot(sl_uint32 index)
+	{
+		(m_slots + index)->~Entry();
+		sl_uint32 base = index & ~(sl_uint32)(_SLIB_FLAT_HASHTABLE_GROUP_SIZE - 1);
+		// a probe sequence never passes a group having an empty slot, so the slot can be emptied in such groups
+		if (_FlatHashTableGroup::matchEmpty(m_ctrl + base)) {
+			m_ctrl[index] = _FlatHashTableGroup::Empty;
+			m_nGrowthLeft++;
+		} else {
+			m_ctrl[index] = _FlatHashTableGroup::Deleted;
+		}
+		m_nSize--;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	void FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_compact()
+	{
+		if (m_nCapacity > m_nCapacityMin && m_nSize <= (m_nCapacity >> 2)) {
+			// half capacity
+			_rehash(m_nCapacity >> 1);
+		}
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::remove(const KT& key, VT* outValue)
+	{
+		if (m_nCapacity == 0) {
+			return sl_false;
+		}
+		sl_bool flagFound = sl_false;
+		_searchSlots(_mixHash(m_hash(key)), key, [&](sl_uint32 index) {
+			if (outValue) {
+				*outValue = Move(m_slots[index].value);
+			}
+			_removeSlot(index);
+			flagFound = sl_true;
+			return sl_false;
+		});
+		if (flagFound) {
+			_compact();
+		}
+		return flagFound;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_size FlatHashTable<KT, VT, HASH, KEY_EQUALS>::removeItems(const KT& key, List<VT>* outValues)
+	{
+		if (m_nCapacity == 0) {
+			return 0;
+		}
+		sl_size oldSize = m_nSize;
+		_searchSlots(_mixHash(m_hash(key)), key, [&](sl_uint32 index) {
+			if (outValues) {
+				outValues->add_NoLock(m_slots[index].value);
+			}
+			_removeSlot(index);
+			return sl_true;
+		});
+		if (oldSize == m_nSize) {
+			return 0;
+		}
+		_compact();
+		return oldSize - m_nSize;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::removeKeyAndValue(const KT& key, const _VT& value, VT* outValue, const VALUE_EQUALS& value_equals)
+	{
+		if (m_nCapacity == 0) {
+			return sl_false;
+		}
+		sl_bool flagFound = sl_false;
+		_searchSlots(_mixHash(m_hash(key)), key, [&](sl_uint32 index) {
+			if (value_equals(m_slots[index].value, value)) {
+				if (outValue) {
+					*outValue = Move(m_slots[index].value);
+				}
+				_removeSlot(index);
+				flagFound = sl_true;
+				return sl_false;
+			}
+			return sl_true;
+		});
+		if (flagFound) {
+			_compact();
+		}
+		return flagFound;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_size FlatHashTable<KT, VT, HASH, KEY_EQUALS>::removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues, const VALUE_EQUALS& value_equals)
+	{
+		if (m_nCapacity == 0) {
+			return 0;
+		}
+		sl_size oldSize = m_nSize;
+		_searchSlots(_mixHash(m_hash(key)), key, [&](sl_uint32 index) {
+			if (value_equals(m_slots[index].value, value)) {
+				if (outValues) {
+					outValues->add_NoLock(m_slots[index].value);
+				}
+				_removeSlot(index);
+			}
+			return sl_true;
+		});
+		if (oldSize == m_nSize) {
+			return 0;
+		}
+		_compact();
+		return oldSize - m_nSize;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_size FlatHashTable<KT, VT, HASH, KEY_EQUALS>::removeAll()
+	{
+		if (m_nCapacity == 0) {
+			return 0;
+		}
+		sl_size oldSize = m_nSize;
+		_free();
+		_init();
+		return oldSize;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::copyFrom(const FlatHashTable<KT, VT, HASH, KEY_EQUALS>* other)
+	{
+		_free();
+		m_nCapacityMin = other->m_nCapacityMin;
+		if (other->m_nCapacity == 0) {
+			_init();
+			return sl_false;
+		}
+		if (!(_createTable(other->m_nCapacity))) {
+			_init();
+			return sl_false;
+		}
+		// same capacity and same hash function: the layout can be copied as it is
+		Base::copyMemory(m_ctrl, other->m_ctrl, m_nCapacity);
+		for (sl_uint32 i = 0; i < m_nCapacity; i += _SLIB_FLAT_HASHTABLE_GROUP_SIZE) {
+			sl_uint32 bits = _FlatHashTableGroup::matchFull(m_ctrl + i);
+			while (bits) {
+				sl_uint32 index = i + _FlatHashTableGroup::getFirstIndex(bits);
+				Entry* src = other->m_slots + index;
+				new (m_slots + index) Entry(src->key, src->value);
+				bits &= bits - 1;
+			}
+		}
+		m_nSize = other->m_nSize;
+		m_nGrowthLeft = other->m_nGrowthLeft;
+		return sl_true;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	void FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_init()
+	{
+		if (!(_createTable(m_nCapacityMin))) {
+			m_ctrl = sl_null;
+			m_slots = sl_null;
+			m_nSize = 0;
+			m_nCapacity = 0;
+			m_nGrowthLeft = 0;
+		}
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	void FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_free()
+	{
+		sl_uint8* ctrl = m_ctrl;
+		Entry* slots = m_slots;
+		sl_uint32 nCapacity = m_nCapacity;
+		m_ctrl = sl_null;
+		m_slots = sl_null;
+		m_nSize = 0;
+		m_nCapacity = 0;
+		m_nGrowthLeft = 0;
+		if (ctrl) {
+			for (sl_uint32 i = 0; i < nCapacity; i += _SLIB_FLAT_HASHTABLE_GROUP_SIZE) {
+				sl_uint32 bits = _FlatHashTableGroup::matchFull(ctrl + i);
+				while (bits) {
+					(slots + i + _FlatHashTableGroup::getFirstIndex(bits))->~Entry();
+					bits &= bits - 1;
+				}
+			}
+			Base::freeMemory(ctrl);
+			Base::freeMemory(slots);
+		}
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_createTable(sl_uint32 capacity)
+	{
+		if (capacity > _SLIB_FLAT_HASHTABLE_MAX_CAPACITY || capacity < m_nCapacityMin) {
+			return sl_false;
+		}
+		sl_uint8* ctrl = (sl_uint8*)(Base::createMemory(capacity));
+		if (!ctrl) {
+			return sl_false;
+		}
+		Entry* slots = (Entry*)(Base::createMemory(sizeof(Entry) * capacity));
+		if (!slots) {
+			Base::freeMemory(ctrl);
+			return sl_false;
+		}
+		Base::resetMemory(ctrl, _FlatHashTableGroup::Empty, capacity);
+		m_ctrl = ctrl;
+		m_slots = slots;
+		m_nSize = 0;
+		m_nCapacity = capacity;
+		// maximum load factor: 7/8
+		m_nGrowthLeft = capacity - (capacity >> 3);
+		return sl_true;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashTable<KT, VT, HASH, KEY_EQUALS>::_rehash(sl_uint32 capacity)
+	{
+		sl_uint8* ctrlOld = m_ctrl;
+		Entry* slotsOld = m_slots;
+		sl_uint32 nCapacityOld = m_nCapacity;
+		sl_size nSize = m_nSize;
+		if (!(_createTable(capacity))) {
+			return sl_false;
+		}
+		for (sl_uint32 i = 0; i < nCapacityOld; i += _SLIB_FLAT_HASHTABLE_GROUP_SIZE) {
+			sl_uint32 bits = _FlatHashTableGroup::matchFull(ctrlOld + i);
+			while (bits) {
+				Entry* src = slotsOld + i + _FlatHashTableGroup::getFirstIndex(bits);
+				sl_uint32 hash = _mixHash(m_hash(src->key));
+				sl_uint32 index = _findInsertSlot(hash);
+				m_ctrl[index] = (sl_uint8)(hash & 0x7F);
+				new (m_slots + index) Entry(Move(src->key), Move(src->value));
+				src->~Entry();
+				bits &= bits - 1;
+			}
+		}
+		m_nSize = nSize;
+		m_nGrowthLeft -= (sl_uint32)nSize;
+		Base::freeMemory(ctrlOld);
+		Base::freeMemory(slotsOld);
+		return sl_true;
+	}
+
+}
+
+#endif
@@ -908,6 +908,51 @@ namespace slib
 		ObjectLocker lock(this);
 		QuickSort::sort(m_data, m_count, flagAscending, compare);
 	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool CList<T>::sortStable_NoLock(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		return MergeSort::sort(m_data, m_count, flagAscending, compare);
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool CList<T>::sortStable(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		ObjectLocker lock(this);
+		return MergeSort::sort(m_data, m_count, flagAscending, compare);
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool CList<T>::sortParallel_NoLock(sl_bool flagAscending, const COMPARE& compare, ThreadPool* pool) const
+	{
+		return ParallelSort::sort(m_data, m_count, flagAscending, compare, pool);
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool CList<T>::sortParallel(sl_bool flagAscending, const COMPARE& compare, ThreadPool* pool) const
+	{
+		ObjectLocker lock(this);
+		return ParallelSort::sort(m_data, m_count, flagAscending, compare, pool);
+	}
+
+	template <class T>
+	template <class GET_KEY>
+	sl_bool CList<T>::sortByKey_NoLock(sl_bool flagAscending, const GET_KEY& getKey) const
+	{
+		return RadixSort::sortByKey(m_data, m_count, getKey, flagAscending);
+	}
+
+	template <class T>
+	template <class GET_KEY>
+	sl_bool CList<T>::sortByKey(sl_bool flagAscending, const GET_KEY& getKey) const
+	{
+		ObjectLocker lock(this);
+		return RadixSort::sortByKey(m_data, m_count, getKey, flagAscending);
+	}
 	
 	template <class T>
 	Iterator<T> CList<T>::toIterator() const
@@ -1876,6 +1921,72 @@ namespace slib
 		}
 	}
 
+	template <class T>
+	template <class COMPARE>
+	sl_bool List<T>::sortStable_NoLock(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		CList<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortStable_NoLock(flagAscending, compare);
+		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool List<T>::sortStable(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		CList<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortStable(flagAscending, compare);
+		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool List<T>::sortParallel_NoLock(sl_bool flagAscending, const COMPARE& compare, ThreadPool* pool) const
+	{
+		CList<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortParallel_NoLock(flagAscending, compare, pool);
+		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool List<T>::sortParallel(sl_bool flagAscending, const COMPARE& compare, ThreadPool* pool) const
+	{
+		CList<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortParallel(flagAscending, compare, pool);
+		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class GET_KEY>
+	sl_bool List<T>::sortByKey_NoLock(sl_bool flagAscending, const GET_KEY& getKey) const
+	{
+		CList<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortByKey_NoLock(flagAscending, getKey);
+		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class GET_KEY>
+	sl_bool List<T>::sortByKey(sl_bool flagAscending, const GET_KEY& getKey) const
+	{
+		CList<T>* obj = ref._ptr;
+		if (obj) {
+			return obj->sortByKey(flagAscending, getKey);
+		}
+		return sl_true;
+	}
+
 	template <class T>
 	Iterator<T> List<T>::toIterator() const
 	{
@@ -2372,8 +2483,41 @@ namespace slib
 	{
 		Ref< CList<T> > obj(ref);
 		if (obj.isNotNull()) {
-			obj->sortBy(flagAscending, compare);
+			obj->sort(flagAscending, compare);
+		}
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool Atomic< List<T> >::sortStable(sl_bool flagAscending, const COMPARE& compare) const
+	{
+		Ref< CList<T> > obj(ref);
+		if (obj.isNotNull()) {
+			return obj->sortStable(flagAscending, compare);
 		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class COMPARE>
+	sl_bool Atomic< List<T> >::sortParallel(sl_bool flagAscending, const COMPARE& compare, ThreadPool* pool) const
+	{
+		Ref< CList<T> > obj(ref);
+		if (obj.isNotNull()) {
+			return obj->sortParallel(flagAscending, compare, pool);
+		}
+		return sl_true;
+	}
+
+	template <class T>
+	template <class GET_KEY>
+	sl_bool Atomic< List<T> >::sortByKey(sl_bool flagAscending, const GET_KEY& getKey) const
+	{
+		Ref< CList<T> > obj(ref);
+		if (obj.isNotNull()) {
+			return obj->sortByKey(flagAscending, getKey);
+		}
+		return sl_true;
 	}
 
 	template <class T>
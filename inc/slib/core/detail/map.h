@@ -163,12 +163,87 @@ namespace slib
 	};
 	
 	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	class FlatHashMapKeyIterator : public IIterator<KT>
+	{
+	protected:
+		const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* m_map;
+		FlatHashEntry<KT, VT>* m_entry;
+		sl_size m_index;
+		Ref<Referable> m_refer;
+
+	public:
+		FlatHashMapKeyIterator(const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* map, Referable* refer);
+
+	public:
+		// override
+		sl_bool hasNext();
+
+		// override
+		sl_bool next(KT* _out);
+
+		// override
+		sl_reg getIndex();
+
+	};
+	
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	class FlatHashMapValueIterator : public IIterator<VT>
+	{
+	protected:
+		const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* m_map;
+		FlatHashEntry<KT, VT>* m_entry;
+		sl_size m_index;
+		Ref<Referable> m_refer;
+
+	public:
+		FlatHashMapValueIterator(const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* map, Referable* refer);
+
+	public:
+		// override
+		sl_bool hasNext();
+
+		// override
+		sl_bool next(VT* _out);
+
+		// override
+		sl_reg getIndex();
+
+	};
+	
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	class FlatHashMapIterator : public IIterator< Pair<KT, VT> >
+	{
+	protected:
+		const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* m_map;
+		FlatHashEntry<KT, VT>* m_entry;
+		sl_size m_index;
+		Ref<Referable> m_refer;
+
+	public:
+		FlatHashMapIterator(const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* map, Referable* refer);
+
+	public:
+		// override
+		sl_bool hasNext();
+
+		// override
+		sl_bool next(Pair<KT, VT>* out);
+
+		// override
+		sl_reg getIndex();
+
+	};
+	
+	
 	template <class KT, class VT, class KEY_COMPARE>
 	class TreeMapKeyIterator : public IIterator<KT>
 	{
 	protected:
 		const TreeMap<KT, VT, KEY_COMPARE>* m_map;
-		TreePosition m_pos;
+		BPlusTreePosition m_pos;
 		sl_size m_index;
 		Ref<Referable> m_refer;
 
@@ -192,7 +267,7 @@ namespace slib
 	{
 	protected:
 		const TreeMap<KT, VT, KEY_COMPARE>* m_map;
-		TreePosition m_pos;
+		BPlusTreePosition m_pos;
 		sl_size m_index;
 		Ref<Referable> m_refer;
 
@@ -216,7 +291,7 @@ namespace slib
 	{
 	protected:
 		const TreeMap<KT, VT, KEY_COMPARE>* m_map;
-		TreePosition m_pos;
+		BPlusTreePosition m_pos;
 		sl_size m_index;
 		Ref<Referable> m_refer;
 
@@ -1015,17 +1090,17 @@ namespace slib
 	}
 	
 	
-	template <class KT, class VT, class KEY_COMPARE>
-	TreeMap<KT, VT, KEY_COMPARE>::TreeMap(const KEY_COMPARE& key_compare) : tree(key_compare)
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashMap<KT, VT, HASH, KEY_EQUALS>::FlatHashMap(sl_uint32 capacity, const HASH& hash, const KEY_EQUALS& key_equals) : table(capacity, hash, key_equals)
 	{
 	}
 	
-	template <class KT, class VT, class KEY_COMPARE>
-	TreeMap<KT, VT, KEY_COMPARE>* TreeMap<KT, VT, KEY_COMPARE>::create(const KEY_COMPARE& key_compare)
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashMap<KT, VT, HASH, KEY_EQUALS>* FlatHashMap<KT, VT, HASH, KEY_EQUALS>::create(sl_uint32 capacity, const HASH& hash, const KEY_EQUALS& key_equals)
 	{
-		TreeMap<KT, VT, KEY_COMPARE>* ret = new TreeMap<KT, VT, KEY_COMPARE>(key_compare);
+		FlatHashMap<KT, VT, HASH, KEY_EQUALS>* ret = new FlatHashMap<KT, VT, HASH, KEY_EQUALS>(capacity, hash, key_equals);
 		if (ret) {
-			if (ret->tree.isValid()) {
+			if (ret->table.getCapacity() > 0) {
 				return ret;
 			}
 			delete ret;
@@ -1033,6 +1108,224 @@ namespace slib
 		return sl_null;
 	}
 	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	VT FlatHashMap<KT, VT, HASH, KEY_EQUALS>::operator[](const KT& key) const
+	{
+		ObjectLocker lock(this);
+		VT* p = table.getItemPointer(key);
+		if (p) {
+			return *p;
+		} else {
+			return VT();
+		}
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_size FlatHashMap<KT, VT, HASH, KEY_EQUALS>::getCount() const
+	{
+		return (sl_size)(table.getCount());
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	VT* FlatHashMap<KT, VT, HASH, KEY_EQUALS>::getItemPointer(const KT& key) const
+	{
+		return table.getItemPointer(key);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	List<VT> FlatHashMap<KT, VT, HASH, KEY_EQUALS>::getValues_NoLock(const KT& key) const
+	{
+		return table.getValues(key);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::put_NoLock(const KT& key, const VT& value, MapPutMode mode, sl_bool* pFlagExist)
+	{
+		return table.put(key, value, mode, pFlagExist);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::addIfNewKeyAndValue_NoLock(const KT& key, const _VT& value, sl_bool* pFlagExist, const VALUE_EQUALS& value_equals)
+	{
+		return table.addIfNewKeyAndValue(key, value, pFlagExist, value_equals);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist, const VALUE_EQUALS& value_equals)
+	{
+		ObjectLocker lock(this);
+		return table.addIfNewKeyAndValue(key, value, pFlagExist, value_equals);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::remove_NoLock(const KT& key, VT* outValue)
+	{
+		return table.remove(key, outValue);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_size FlatHashMap<KT, VT, HASH, KEY_EQUALS>::removeItems_NoLock(const KT& key, List<VT>* outValues)
+	{
+		return table.removeItems(key, outValues);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::removeKeyAndValue_NoLock(const KT& key, const _VT& value, VT* outValue, const VALUE_EQUALS& value_equals)
+	{
+		return table.removeKeyAndValue(key, value, outValue, value_equals);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::removeKeyAndValue(const KT& key, const _VT& value, VT* outValue, const VALUE_EQUALS& value_equals)
+	{
+		ObjectLocker lock(this);
+		return table.removeKeyAndValue(key, value, outValue, value_equals);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_size FlatHashMap<KT, VT, HASH, KEY_EQUALS>::removeItemsByKeyAndValue_NoLock(const KT& key, const _VT& value, List<VT>* outValues, const VALUE_EQUALS& value_equals)
+	{
+		return table.removeItemsByKeyAndValue(key, value, outValues, value_equals);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_size FlatHashMap<KT, VT, HASH, KEY_EQUALS>::removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues, const VALUE_EQUALS& value_equals)
+	{
+		ObjectLocker lock(this);
+		return table.removeItemsByKeyAndValue(key, value, outValues, value_equals);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_size FlatHashMap<KT, VT, HASH, KEY_EQUALS>::removeAll_NoLock()
+	{
+		return table.removeAll();
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::contains_NoLock(const KT& key) const
+	{
+		return table.search(key) != sl_null;
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::containsKeyAndValue_NoLock(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals) const
+	{
+		return table.searchKeyAndValue(key, value, value_equals) != sl_null;
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	template <class _VT, class VALUE_EQUALS>
+	sl_bool FlatHashMap<KT, VT, HASH, KEY_EQUALS>::containsKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals) const
+	{
+		ObjectLocker lock(this);
+		return table.searchKeyAndValue(key, value, value_equals) != sl_null;
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	IMap<KT, VT>* FlatHashMap<KT, VT, HASH, KEY_EQUALS>::duplicate_NoLock() const
+	{
+		FlatHashMap<KT, VT, HASH, KEY_EQUALS>* ret = new FlatHashMap<KT, VT, HASH, KEY_EQUALS>;
+		if (ret) {
+			if (ret->table.copyFrom(&table)) {
+				return ret;
+			}
+			delete ret;
+		}
+		return sl_null;
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	Iterator<KT> FlatHashMap<KT, VT, HASH, KEY_EQUALS>::getKeyIteratorWithRefer(Referable* refer) const
+	{
+		return new FlatHashMapKeyIterator<KT, VT, HASH, KEY_EQUALS>(this, refer);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	List<KT> FlatHashMap<KT, VT, HASH, KEY_EQUALS>::getAllKeys_NoLock() const
+	{
+		CList<KT>* ret = new CList<KT>;
+		if (ret) {
+			FlatHashEntry<KT, VT>* entry = table.getFirstEntry();
+			while (entry) {
+				if (!(ret->add_NoLock(entry->key))) {
+					delete ret;
+					return sl_null;
+				}
+				entry = table.getNextEntry(entry);
+			}
+			return ret;
+		}
+		return sl_null;
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	Iterator<VT> FlatHashMap<KT, VT, HASH, KEY_EQUALS>::getValueIteratorWithRefer(Referable* refer) const
+	{
+		return new FlatHashMapValueIterator<KT, VT, HASH, KEY_EQUALS>(this, refer);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	List<VT> FlatHashMap<KT, VT, HASH, KEY_EQUALS>::getAllValues_NoLock() const
+	{
+		CList<VT>* ret = new CList<VT>;
+		if (ret) {
+			FlatHashEntry<KT, VT>* entry = table.getFirstEntry();
+			while (entry) {
+				if (!(ret->add_NoLock(entry->value))) {
+					delete ret;
+					return sl_null;
+				}
+				entry = table.getNextEntry(entry);
+			}
+			return ret;
+		}
+		return sl_null;
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	Iterator< Pair<KT, VT> > FlatHashMap<KT, VT, HASH, KEY_EQUALS>::toIteratorWithRefer(Referable* refer) const
+	{
+		return new FlatHashMapIterator<KT, VT, HASH, KEY_EQUALS>(this, refer);
+	}
+	
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	List< Pair<KT, VT> > FlatHashMap<KT, VT, HASH, KEY_EQUALS>::toList_NoLock() const
+	{
+		CList< Pair<KT, VT> >* ret = new CList< Pair<KT, VT> >;
+		if (ret) {
+			FlatHashEntry<KT, VT>* entry = table.getFirstEntry();
+			while (entry) {
+				Pair<KT, VT> pair(entry->key, entry->value);
+				if (!(ret->add_NoLock(pair))) {
+					delete ret;
+					return sl_null;
+				}
+				entry = table.getNextEntry(entry);
+			}
+			return ret;
+		}
+		return sl_null;
+	}
+	
+	
+	template <class KT, class VT, class KEY_COMPARE>
+	TreeMap<KT, VT, KEY_COMPARE>::TreeMap(const KEY_COMPARE& key_compare) : tree(key_compare)
+	{
+	}
+	
+	template <class KT, class VT, class KEY_COMPARE>
+	TreeMap<KT, VT, KEY_COMPARE>* TreeMap<KT, VT, KEY_COMPARE>::create(const KEY_COMPARE& key_compare)
+	{
+		return new TreeMap<KT, VT, KEY_COMPARE>(key_compare);
+	}
+	
 	template <class KT, class VT, class KEY_COMPARE>
 	VT TreeMap<KT, VT, KEY_COMPARE>::operator[](const KT& key) const
 	{
@@ -1158,16 +1451,10 @@ namespace slib
 	{
 		TreeMap<KT, VT, KEY_COMPARE>* ret = new TreeMap<KT, VT, KEY_COMPARE>;
 		if (ret) {
-			TreePosition pos;
-			KT key;
-			VT value;
-			while (tree.getNextPosition(pos, &key, &value)) {
-				if (!(ret->tree.put(key, value, MapPutMode::AddAlways))) {
-					delete ret;
-					return sl_null;
-				}
+			if (ret->tree.copyFrom(&tree)) {
+				return ret;
 			}
-			return ret;
+			delete ret;
 		}
 		return sl_null;
 	}
@@ -1183,7 +1470,7 @@ namespace slib
 	{
 		CList<KT>* ret = new CList<KT>;
 		if (ret) {
-			TreePosition pos;
+			BPlusTreePosition pos;
 			KT key;
 			while (tree.getNextPosition(pos, &key, sl_null)) {
 				if (!(ret->add_NoLock(key))) {
@@ -1207,7 +1494,7 @@ namespace slib
 	{
 		CList<VT>* ret = new CList<VT>;
 		if (ret) {
-			TreePosition pos;
+			BPlusTreePosition pos;
 			VT value;
 			while (tree.getNextPosition(pos, sl_null, &value)) {
 				if (!(ret->add_NoLock(value))) {
@@ -1231,7 +1518,7 @@ namespace slib
 	{
 		CList< Pair<KT, VT> >* ret = new CList< Pair<KT, VT> >;
 		if (ret) {
-			TreePosition pos;
+			BPlusTreePosition pos;
 			Pair<KT, VT> pair;
 			while (tree.getNextPosition(pos, &(pair.key), &(pair.value))) {
 				if (!(ret->add_NoLock(pair))) {
@@ -1265,6 +1552,13 @@ namespace slib
 		return HashMap<KT, VT, HASH, KEY_EQUALS>::create(initialCapacity, hash, key_equals);
 	}
 	
+	template <class KT, class VT>
+	template <class HASH, class KEY_EQUALS>
+	Map<KT, VT> Map<KT, VT>::createFlatHash(sl_uint32 initialCapacity, const HASH& hash, const KEY_EQUALS& key_equals)
+	{
+		return FlatHashMap<KT, VT, HASH, KEY_EQUALS>::create(initialCapacity, hash, key_equals);
+	}
+	
 	template <class KT, class VT>
 	template <class KEY_COMPARE>
 	Map<KT, VT> Map<KT, VT>::createTree(const KEY_COMPARE& key_compare)
@@ -1299,6 +1593,13 @@ namespace slib
 		ref = HashMap<KT, VT, HASH, KEY_EQUALS>::create(initialCapacity, hash, key_equals);
 	}
 	
+	template <class KT, class VT>
+	template <class HASH, class KEY_EQUALS>
+	void Map<KT, VT>::initFlatHash(sl_uint32 initialCapacity, const HASH& hash, const KEY_EQUALS& key_equals)
+	{
+		ref = FlatHashMap<KT, VT, HASH, KEY_EQUALS>::create(initialCapacity, hash, key_equals);
+	}
+	
 	template <class KT, class VT>
 	template <class KEY_COMPARE>
 	void Map<KT, VT>::initTree(const KEY_COMPARE& key_compare)
@@ -1786,6 +2087,13 @@ namespace slib
 		ref = HashMap<KT, VT, HASH, KEY_EQUALS>::create(initialCapacity, hash, key_equals);
 	}
 
+	template <class KT, class VT>
+	template <class HASH, class KEY_EQUALS>
+	void Atomic< Map<KT, VT> >::initFlatHash(sl_uint32 initialCapacity, const HASH& hash, const KEY_EQUALS& key_equals)
+	{
+		ref = FlatHashMap<KT, VT, HASH, KEY_EQUALS>::create(initialCapacity, hash, key_equals);
+	}
+
 	template <class KT, class VT>
 	template <class KEY_COMPARE>
 	void Atomic< Map<KT, VT> >::initTree(const KEY_COMPARE& key_compare)
@@ -2251,6 +2559,106 @@ namespace slib
 	}
 
 
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashMapKeyIterator<KT, VT, HASH, KEY_EQUALS>::FlatHashMapKeyIterator(const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* map, Referable* refer)
+	: m_map(map), m_entry(map->table.getFirstEntry()), m_index(0), m_refer(refer)
+	{
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMapKeyIterator<KT, VT, HASH, KEY_EQUALS>::hasNext()
+	{
+		return m_entry != sl_null;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMapKeyIterator<KT, VT, HASH, KEY_EQUALS>::next(KT* _out)
+	{
+		if (m_entry) {
+			if (_out) {
+				*_out = m_entry->key;
+			}
+			m_entry = m_map->table.getNextEntry(m_entry);
+			m_index++;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_reg FlatHashMapKeyIterator<KT, VT, HASH, KEY_EQUALS>::getIndex()
+	{
+		return (sl_reg)m_index - 1;
+	}
+
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashMapValueIterator<KT, VT, HASH, KEY_EQUALS>::FlatHashMapValueIterator(const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* map, Referable* refer)
+	: m_map(map), m_entry(map->table.getFirstEntry()), m_index(0), m_refer(refer)
+	{
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMapValueIterator<KT, VT, HASH, KEY_EQUALS>::hasNext()
+	{
+		return m_entry != sl_null;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMapValueIterator<KT, VT, HASH, KEY_EQUALS>::next(VT* _out)
+	{
+		if (m_entry) {
+			if (_out) {
+				*_out = m_entry->value;
+			}
+			m_entry = m_map->table.getNextEntry(m_entry);
+			m_index++;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_reg FlatHashMapValueIterator<KT, VT, HASH, KEY_EQUALS>::getIndex()
+	{
+		return (sl_reg)m_index - 1;
+	}
+
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashMapIterator<KT, VT, HASH, KEY_EQUALS>::FlatHashMapIterator(const FlatHashMap<KT, VT, HASH, KEY_EQUALS>* map, Referable* refer)
+	: m_map(map), m_entry(map->table.getFirstEntry()), m_index(0), m_refer(refer)
+	{
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMapIterator<KT, VT, HASH, KEY_EQUALS>::hasNext()
+	{
+		return m_entry != sl_null;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_bool FlatHashMapIterator<KT, VT, HASH, KEY_EQUALS>::next(Pair<KT, VT>* _out)
+	{
+		if (m_entry) {
+			if (_out) {
+				_out->key = m_entry->key;
+				_out->value = m_entry->value;
+			}
+			m_entry = m_map->table.getNextEntry(m_entry);
+			m_index++;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	sl_reg FlatHashMapIterator<KT, VT, HASH, KEY_EQUALS>::getIndex()
+	{
+		return (sl_reg)m_index - 1;
+	}
+
+
 	template <class KT, class VT, class KEY_COMPARE>
 	TreeMapKeyIterator<KT, VT, KEY_COMPARE>::TreeMapKeyIterator(const TreeMap<KT, VT, KEY_COMPARE>* map, Referable* refer)
 	: m_map(map), m_index(0), m_refer(refer)
@@ -2260,7 +2668,7 @@ namespace slib
 	template <class KT, class VT, class KEY_COMPARE>
 	sl_bool TreeMapKeyIterator<KT, VT, KEY_COMPARE>::hasNext()
 	{
-		TreePosition pos = m_pos;
+		BPlusTreePosition pos = m_pos;
 		return m_map->tree.getNextPosition(pos);
 	}
 
@@ -2290,7 +2698,7 @@ namespace slib
 	template <class KT, class VT, class KEY_COMPARE>
 	sl_bool TreeMapValueIterator<KT, VT, KEY_COMPARE>::hasNext()
 	{
-		TreePosition pos = m_pos;
+		BPlusTreePosition pos = m_pos;
 		return m_map->tree.getNextPosition(pos);
 	}
 
@@ -2320,7 +2728,7 @@ namespace slib
 	template <class KT, class VT, class KEY_COMPARE>
 	sl_bool TreeMapIterator<KT, VT, KEY_COMPARE>::hasNext()
 	{
-		TreePosition pos = m_pos;
+		BPlusTreePosition pos = m_pos;
 		return m_map->tree.getNextPosition(pos);
 	}
 
@@ -52,27 +52,42 @@ namespace slib
 		return sl_null;
 	}
 	
-	template <class KT, class VT, class KEY_COMPARE>
-	TreeMap<KT, VT, KEY_COMPARE>::TreeMap(const std::initializer_list< Pair<KT, VT> >& l, const KEY_COMPARE& key_compare) : tree(key_compare)
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashMap<KT, VT, HASH, KEY_EQUALS>::FlatHashMap(const std::initializer_list< Pair<KT, VT> >& l, sl_uint32 capacity, const HASH& hash, const KEY_EQUALS& key_equals) : table(capacity, hash, key_equals)
 	{
 		const Pair<KT, VT>* data = l.begin();
 		for (sl_size i = 0; i < l.size(); i++) {
-			tree.put(data[i].key, data[i].value, MapPutMode::AddAlways, sl_null);
+			table.put(data[i].key, data[i].value, MapPutMode::AddAlways, sl_null);
 		}
 	}
 	
-	template <class KT, class VT, class KEY_COMPARE>
-	TreeMap<KT, VT, KEY_COMPARE>* TreeMap<KT, VT, KEY_COMPARE>::create(const std::initializer_list< Pair<KT, VT> >& l, const KEY_COMPARE& key_compare)
+	template <class KT, class VT, class HASH, class KEY_EQUALS>
+	FlatHashMap<KT, VT, HASH, KEY_EQUALS>* FlatHashMap<KT, VT, HASH, KEY_EQUALS>::create(const std::initializer_list< Pair<KT, VT> >& l, sl_uint32 capacity, const HASH& hash, const KEY_EQUALS& key_equals)
 	{
-		TreeMap<KT, VT, KEY_COMPARE>* ret = new TreeMap<KT, VT, KEY_COMPARE>(l, key_compare);
+		FlatHashMap<KT, VT, HASH, KEY_EQUALS>* ret = new FlatHashMap<KT, VT, HASH, KEY_EQUALS>(l, capacity, hash, key_equals);
 		if (ret) {
-			if (ret->tree.isValid()) {
+			if (ret->table.getCapacity() > 0) {
 				return ret;
 			}
 			delete ret;
 		}
 		return sl_null;
 	}
+	
+	template <class KT, class VT, class KEY_COMPARE>
+	TreeMap<KT, VT, KEY_COMPARE>::TreeMap(const std::initializer_list< Pair<KT, VT> >& l, const KEY_COMPARE& key_compare) : tree(key_compare)
+	{
+		const Pair<KT, VT>* data = l.begin();
+		for (sl_size i = 0; i < l.size(); i++) {
+			tree.put(data[i].key, data[i].value, MapPutMode::AddAlways, sl_null);
+		}
+	}
+	
+	template <class KT, class VT, class KEY_COMPARE>
+	TreeMap<KT, VT, KEY_COMPARE>* TreeMap<KT, VT, KEY_COMPARE>::create(const std::initializer_list< Pair<KT, VT> >& l, const KEY_COMPARE& key_compare)
+	{
+		return new TreeMap<KT, VT, KEY_COMPARE>(l, key_compare);
+	}
 
 	
 	template <class KT, class VT>
@@ -94,6 +109,13 @@ namespace slib
 		return HashMap<KT, VT, HASH, KEY_EQUALS>::create(l, initialCapacity, hash, key_equals);
 	}
 	
+	template <class KT, class VT>
+	template <class HASH, class KEY_EQUALS>
+	Map<KT, VT> Map<KT, VT>::createFlatHash(const std::initializer_list< Pair<KT, VT> >& l, sl_uint32 initialCapacity, const HASH& hash, const KEY_EQUALS& key_equals)
+	{
+		return FlatHashMap<KT, VT, HASH, KEY_EQUALS>::create(l, initialCapacity, hash, key_equals);
+	}
+	
 	template <class KT, class VT>
 	template <class KEY_COMPARE>
 	Map<KT, VT> Map<KT, VT>::createTree(const std::initializer_list< Pair<KT, VT> >& l, const KEY_COMPARE& key_compare)
@@ -13,11 +13,119 @@
 
 #include "../ref.h"
 
+#if defined(SLIB_COMPILER_IS_VC)
+#include <intrin.h>
+#endif
+
 namespace slib
 {
 	struct _Ref_Const;
 	extern const _Ref_Const _Ref_Null;
 
+	/*
+		Hazard pointers
+
+		A thread publishes the object it is about to retain in its hazard slot, and checks that the atomic reference still holds the object.
+		The thread detaching an object from an atomic reference waits until no slot holds the object before releasing it.
+	*/
+
+	// hazard slot of the current thread
+	void** _Ref_getHazardSlot();
+
+	// waits until no thread protects `object` by its hazard slot
+	void _Ref_waitHazard(const void* object);
+
+	SLIB_INLINE static void* _Ref_loadPtr(void* const* p)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		return *((void* const volatile*)p);
+#else
+		return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	// sequentially consistent
+	SLIB_INLINE static void* _Ref_exchangePtr(void** p, void* value)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		return _InterlockedExchangePointer(p, value);
+#else
+		return __atomic_exchange_n(p, value, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static void _Ref_releasePtr(void** p)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		*((void* volatile*)p) = sl_null;
+#else
+		__atomic_store_n(p, sl_null, __ATOMIC_RELEASE);
+#endif
+	}
+
+	// returns the object after protecting it by `slot`, null if the atomic reference is emptied
+	SLIB_INLINE static void* _Ref_protectPtr(void** slot, void* const* p)
+	{
+		void* ptr = _Ref_loadPtr(p);
+		while (ptr) {
+			_Ref_exchangePtr(slot, ptr);
+			void* check = _Ref_loadPtr(p);
+			if (check == ptr) {
+				return ptr;
+			}
+			ptr = check;
+		}
+		_Ref_releasePtr(slot);
+		return sl_null;
+	}
+
+	SLIB_INLINE sl_reg Referable::increaseReference()
+	{
+		if (m_nRefCount >= 0) {
+#ifdef SLIB_DEBUG_REFERENCE
+			_checkValid();
+#endif
+#if defined(SLIB_COMPILER_IS_VC)
+#	if defined(SLIB_ARCH_IS_64BIT)
+			return (sl_reg)(_InterlockedIncrement64((__int64*)&m_nRefCount));
+#	else
+			return (sl_reg)(_InterlockedIncrement((long*)&m_nRefCount));
+#	endif
+#else
+			return __atomic_add_fetch(&m_nRefCount, 1, __ATOMIC_RELAXED);
+#endif
+		}
+		return 1;
+	}
+
+	SLIB_INLINE sl_reg Referable::decreaseReferenceNoFree()
+	{
+		if (m_nRefCount > 0) {
+#ifdef SLIB_DEBUG_REFERENCE
+			_checkValid();
+#endif
+#if defined(SLIB_COMPILER_IS_VC)
+#	if defined(SLIB_ARCH_IS_64BIT)
+			return (sl_reg)(_InterlockedDecrement64((__int64*)&m_nRefCount));
+#	else
+			return (sl_reg)(_InterlockedDecrement((long*)&m_nRefCount));
+#	endif
+#else
+			return __atomic_sub_fetch(&m_nRefCount, 1, __ATOMIC_ACQ_REL);
+#endif
+		}
+		return 1;
+	}
+
+	SLIB_INLINE sl_reg Referable::decreaseReference()
+	{
+		sl_reg nRef = decreaseReferenceNoFree();
+		if (nRef == 0) {
+			_free();
+		}
+		return nRef;
+	}
+
 	template <class T, class... ARGS>
 	SLIB_INLINE Ref<T> New(ARGS&&... args)
 	{
@@ -1024,10 +1132,11 @@ namespace slib
 	SLIB_INLINE T* Atomic< Ref<T> >::_retainObject() const
 	{
 		if (_ptr) {
-			SpinLocker lock(&m_lock);
-			T* ptr = _ptr;
+			void** slot = _Ref_getHazardSlot();
+			T* ptr = (T*)(_Ref_protectPtr(slot, (void* const*)(&_ptr)));
 			if (ptr) {
 				ptr->increaseReference();
+				_Ref_releasePtr(slot);
 			}
 			return ptr;
 		} else {
@@ -1038,13 +1147,9 @@ namespace slib
 	template <class T>
 	SLIB_INLINE void Atomic< Ref<T> >::_replaceObject(T* other)
 	{
-		T* before;
-		{
-			SpinLocker lock(&m_lock);
-			before = _ptr;
-			_ptr = other;
-		}
+		T* before = (T*)(_Ref_exchangePtr((void**)(&_ptr), other));
 		if (before) {
+			_Ref_waitHazard(before);
 			before->decreaseReference();
 		}
 	}
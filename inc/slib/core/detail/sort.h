@@ -193,7 +193,7 @@ namespace slib
 		for(;;) {
 			sl_size n = end - start + 1;
 			if (n < 8) {
-				InsertionSort::sortAsc(list + start, n);
+				InsertionSort::sortAsc(list + start, n, compare);
 			} else {
 				sl_size mid = start + (n / 2);
 				Swap(list[mid], list[start]);
@@ -205,7 +205,7 @@ namespace slib
 						if (border2 > end) {
 							break;
 						}
-						if (compare(list[border2], list[start]) > 0) {
+						if (compare(list[border2], list[start]) >= 0) {
 							break;
 						}
 					};
@@ -214,7 +214,7 @@ namespace slib
 						if (border1 <= start) {
 							break;
 						}
-						if (compare(list[border1], list[start]) < 0) {
+						if (compare(list[border1], list[start]) <= 0) {
 							break;
 						}
 					}
@@ -272,7 +272,7 @@ namespace slib
 		for(;;) {
 			sl_size n = end - start + 1;
 			if (n < 8) {
-				InsertionSort::sortDesc(list + start, n);
+				InsertionSort::sortDesc(list + start, n, compare);
 			} else {
 				sl_size mid = start + (n / 2);
 				Swap(list[mid], list[start]);
@@ -284,7 +284,7 @@ namespace slib
 						if (border2 > end) {
 							break;
 						}
-						if (compare(list[border2], list[start]) < 0) {
+						if (compare(list[border2], list[start]) <= 0) {
 							break;
 						}
 					};
@@ -293,7 +293,7 @@ namespace slib
 						if (border1 <= start) {
 							break;
 						}
-						if (compare(list[border1], list[start]) > 0) {
+						if (compare(list[border1], list[start]) >= 0) {
 							break;
 						}
 					}
@@ -348,6 +348,494 @@ namespace slib
 		}
 	}
 
+
+	template <class TYPE, class COMPARE>
+	class _SortCompareReverse
+	{
+	public:
+		const COMPARE& compare;
+
+	public:
+		SLIB_INLINE _SortCompareReverse(const COMPARE& _compare) : compare(_compare) {}
+
+	public:
+		SLIB_INLINE int operator()(const TYPE& a, const TYPE& b) const
+		{
+			return compare(b, a);
+		}
+
+	};
+
+
+#define _SLIB_MERGE_SORT_RUN 32
+
+	template <class TYPE, class COMPARE>
+	void MergeSort::merge(const TYPE* src1, sl_size n1, const TYPE* src2, sl_size n2, TYPE* dst, const COMPARE& compare)
+	{
+		sl_size i = 0;
+		sl_size j = 0;
+		if (n1 && n2) {
+			for (;;) {
+				if (compare(src2[j], src1[i]) < 0) {
+					*(dst++) = src2[j++];
+					if (j == n2) {
+						break;
+					}
+				} else {
+					*(dst++) = src1[i++];
+					if (i == n1) {
+						break;
+					}
+				}
+			}
+		}
+		for (; i < n1; i++) {
+			*(dst++) = src1[i];
+		}
+		for (; j < n2; j++) {
+			*(dst++) = src2[j];
+		}
+	}
+
+	template <class TYPE, class COMPARE>
+	sl_bool MergeSort::sortAsc(TYPE* list, sl_size size, const COMPARE& compare)
+	{
+		if (size <= _SLIB_MERGE_SORT_RUN) {
+			InsertionSort::sortAsc(list, size, compare);
+			return sl_true;
+		}
+		TYPE* temp = NewHelper<TYPE>::create(size);
+		if (!temp) {
+			return sl_false;
+		}
+		sl_size i;
+		for (i = 0; i < size; i += _SLIB_MERGE_SORT_RUN) {
+			sl_size n = size - i;
+			if (n > _SLIB_MERGE_SORT_RUN) {
+				n = _SLIB_MERGE_SORT_RUN;
+			}
+			InsertionSort::sortAsc(list + i, n, compare);
+		}
+		TYPE* src = list;
+		TYPE* dst = temp;
+		for (sl_size width = _SLIB_MERGE_SORT_RUN; width < size; width <<= 1) {
+			for (i = 0; i < size; i += (width << 1)) {
+				sl_size n1 = size - i;
+				if (n1 > width) {
+					n1 = width;
+				}
+				sl_size n2 = size - i - n1;
+				if (n2 > width) {
+					n2 = width;
+				}
+				if (n2 && compare(src[i + n1], src[i + n1 - 1]) < 0) {
+					merge(src + i, n1, src + i + n1, n2, dst + i, compare);
+				} else {
+					// already in order
+					sl_size n = n1 + n2;
+					for (sl_size k = 0; k < n; k++) {
+						dst[i + k] = src[i + k];
+					}
+				}
+			}
+			Swap(src, dst);
+		}
+		if (src != list) {
+			for (i = 0; i < size; i++) {
+				list[i] = src[i];
+			}
+		}
+		NewHelper<TYPE>::free(temp, size);
+		return sl_true;
+	}
+
+	template <class TYPE, class COMPARE>
+	sl_bool MergeSort::sortDesc(TYPE* list, sl_size size, const COMPARE& compare)
+	{
+		return sortAsc(list, size, _SortCompareReverse<TYPE, COMPARE>(compare));
+	}
+
+	template <class TYPE, class COMPARE>
+	sl_bool MergeSort::sort(TYPE* list, sl_size size, sl_bool flagAsc, const COMPARE& compare)
+	{
+		if (flagAsc) {
+			return sortAsc(list, size, compare);
+		} else {
+			return sortDesc(list, size, compare);
+		}
+	}
+
+
+	template <sl_size SIZE>
+	class _RadixSortUnsigned;
+
+	template <>
+	class _RadixSortUnsigned<1> { public: typedef sl_uint8 Type; };
+
+	template <>
+	class _RadixSortUnsigned<2> { public: typedef sl_uint16 Type; };
+
+	template <>
+	class _RadixSortUnsigned<4> { public: typedef sl_uint32 Type; };
+
+	template <>
+	class _RadixSortUnsigned<8> { public: typedef sl_uint64 Type; };
+
+	// maps the value to the unsigned integer having the same order
+	template <class T>
+	class _RadixSortKey
+	{
+	public:
+		typedef typename _RadixSortUnsigned<sizeof(T)>::Type Type;
+
+		static const Type SignBit = (T)(-1) < (T)0 ? (Type)((Type)1 << (sizeof(T) * 8 - 1)) : (Type)0;
+
+		SLIB_INLINE static Type get(T value)
+		{
+			return (Type)value ^ SignBit;
+		}
+	};
+
+	template <>
+	class _RadixSortKey<float>
+	{
+	public:
+		typedef sl_uint32 Type;
+
+		SLIB_INLINE static Type get(float value)
+		{
+			union {
+				float f;
+				sl_uint32 n;
+			} u;
+			u.f = value;
+			// negatives are reversed
+			return (u.n & 0x80000000) ? ~(u.n) : (u.n | 0x80000000);
+		}
+	};
+
+	template <>
+	class _RadixSortKey<double>
+	{
+	public:
+		typedef sl_uint64 Type;
+
+		SLIB_INLINE static Type get(double value)
+		{
+			union {
+				double f;
+				sl_uint64 n;
+			} u;
+			u.f = value;
+			return (u.n & SLIB_UINT64(0x8000000000000000)) ? ~(u.n) : (u.n | SLIB_UINT64(0x8000000000000000));
+		}
+	};
+
+	template <class TYPE>
+	class _RadixSortValue
+	{
+	public:
+		SLIB_INLINE const TYPE& operator()(const TYPE& value) const
+		{
+			return value;
+		}
+	};
+
+	template <class TYPE, class GET_KEY, class VALUE>
+	class _RadixSortCompare
+	{
+	public:
+		typedef typename _RadixSortKey<VALUE>::Type KEY;
+		const GET_KEY& getKey;
+		KEY mask;
+
+	public:
+		SLIB_INLINE _RadixSortCompare(const GET_KEY& _getKey, KEY _mask) : getKey(_getKey), mask(_mask) {}
+
+	public:
+		SLIB_INLINE int operator()(const TYPE& a, const TYPE& b) const
+		{
+			KEY k1 = _RadixSortKey<VALUE>::get(getKey(a)) ^ mask;
+			KEY k2 = _RadixSortKey<VALUE>::get(getKey(b)) ^ mask;
+			return k1 < k2 ? -1 : (k1 > k2 ? 1 : 0);
+		}
+
+	};
+
+#define _SLIB_RADIX_SORT_MIN 64
+
+	// `sample` is used to deduce the type of the keys
+	template <class TYPE, class GET_KEY, class VALUE>
+	sl_bool _RadixSort_sort(TYPE* list, sl_size size, const GET_KEY& getKey, const VALUE& sample, sl_bool flagDesc)
+	{
+		typedef _RadixSortKey<VALUE> KeyHelper;
+		typedef typename KeyHelper::Type KEY;
+		KEY mask = flagDesc ? (KEY)(~((KEY)0)) : (KEY)0;
+		if (size < _SLIB_RADIX_SORT_MIN) {
+			InsertionSort::sortAsc(list, size, _RadixSortCompare<TYPE, GET_KEY, VALUE>(getKey, mask));
+			return sl_true;
+		}
+		const sl_uint32 nDigits = sizeof(KEY);
+		sl_size counts[nDigits][256];
+		Base::zeroMemory(counts, sizeof(counts));
+		sl_size i;
+		sl_uint32 d;
+		KEY keyFirst = KeyHelper::get(sample) ^ mask;
+		KEY keyLast = keyFirst;
+		sl_bool flagSorted = sl_true;
+		for (i = 0; i < size; i++) {
+			KEY key = KeyHelper::get(getKey(list[i])) ^ mask;
+			for (d = 0; d < nDigits; d++) {
+				counts[d][(sl_uint8)(key >> (d << 3))]++;
+			}
+			if (key < keyLast) {
+				flagSorted = sl_false;
+			}
+			keyLast = key;
+		}
+		if (flagSorted) {
+			return sl_true;
+		}
+		TYPE* temp = sl_null;
+		TYPE* src = list;
+		TYPE* dst = sl_null;
+		for (d = 0; d < nDigits; d++) {
+			sl_size* count = counts[d];
+			sl_uint32 shift = d << 3;
+			// skips the digit which is the same in all keys
+			if (count[(sl_uint8)(keyFirst >> shift)] == size) {
+				continue;
+			}
+			if (!temp) {
+				temp = NewHelper<TYPE>::create(size);
+				if (!temp) {
+					return sl_false;
+				}
+				dst = temp;
+			}
+			sl_size offsets[256];
+			sl_size sum = 0;
+			for (sl_uint32 k = 0; k < 256; k++) {
+				offsets[k] = sum;
+				sum += count[k];
+			}
+			for (i = 0; i < size; i++) {
+				KEY key = KeyHelper::get(getKey(src[i])) ^ mask;
+				dst[offsets[(sl_uint8)(key >> shift)]++] = Move(src[i]);
+			}
+			Swap(src, dst);
+		}
+		if (temp) {
+			if (src != list) {
+				for (i = 0; i < size; i++) {
+					list[i] = Move(src[i]);
+				}
+			}
+			NewHelper<TYPE>::free(temp, size);
+		}
+		return sl_true;
+	}
+
+	template <class TYPE>
+	sl_bool RadixSort::sortAsc(TYPE* list, sl_size size)
+	{
+		if (size < 2) {
+			return sl_true;
+		}
+		return _RadixSort_sort(list, size, _RadixSortValue<TYPE>(), list[0], sl_false);
+	}
+
+	template <class TYPE>
+	sl_bool RadixSort::sortDesc(TYPE* list, sl_size size)
+	{
+		if (size < 2) {
+			return sl_true;
+		}
+		return _RadixSort_sort(list, size, _RadixSortValue<TYPE>(), list[0], sl_true);
+	}
+
+	template <class TYPE>
+	sl_bool RadixSort::sort(TYPE* list, sl_size size, sl_bool flagAsc)
+	{
+		if (flagAsc) {
+			return sortAsc(list, size);
+		} else {
+			return sortDesc(list, size);
+		}
+	}
+
+	template <class TYPE, class GET_KEY>
+	sl_bool RadixSort::sortByKeyAsc(TYPE* list, sl_size size, const GET_KEY& getKey)
+	{
+		if (size < 2) {
+			return sl_true;
+		}
+		return _RadixSort_sort(list, size, getKey, getKey(list[0]), sl_false);
+	}
+
+	template <class TYPE, class GET_KEY>
+	sl_bool RadixSort::sortByKeyDesc(TYPE* list, sl_size size, const GET_KEY& getKey)
+	{
+		if (size < 2) {
+			return sl_true;
+		}
+		return _RadixSort_sort(list, size, getKey, getKey(list[0]), sl_true);
+	}
+
+	template <class TYPE, class GET_KEY>
+	sl_bool RadixSort::sortByKey(TYPE* list, sl_size size, const GET_KEY& getKey, sl_bool flagAsc)
+	{
+		if (flagAsc) {
+			return sortByKeyAsc(list, size, getKey);
+		} else {
+			return sortByKeyDesc(list, size, getKey);
+		}
+	}
+
+
+#define _SLIB_PARALLEL_SORT_MAX_THREADS 64
+
+	template <class TYPE, class COMPARE>
+	class _ParallelSortContext
+	{
+	public:
+		TYPE* list;
+		sl_size size;
+		const COMPARE* compare;
+		sl_uint32 nThreads;
+		// the list is split into `nThreads` parts
+		sl_size bounds[_SLIB_PARALLEL_SORT_MAX_THREADS + 1];
+
+		// merge round: the runs of `step` parts are merged in pairs, and every pair is split into `nPieces` tasks
+		TYPE* src;
+		TYPE* dst;
+		sl_uint32 step;
+		sl_uint32 nPieces;
+
+	public:
+		static void runSort(void* _context, sl_uint32 index)
+		{
+			_ParallelSortContext* context = (_ParallelSortContext*)_context;
+			sl_size start = context->bounds[index];
+			QuickSort::sortAsc(context->list + start, context->bounds[index + 1] - start, *(context->compare));
+		}
+
+		static void runMerge(void* _context, sl_uint32 index)
+		{
+			_ParallelSortContext* context = (_ParallelSortContext*)_context;
+			const COMPARE& compare = *(context->compare);
+			sl_uint32 nParts = context->nThreads;
+			sl_uint32 indexPart = (index / context->nPieces) * (context->step << 1);
+			sl_uint32 indexPiece = index % context->nPieces;
+			sl_uint32 indexMid = indexPart + context->step;
+			if (indexMid > nParts) {
+				indexMid = nParts;
+			}
+			sl_uint32 indexEnd = indexMid + context->step;
+			if (indexEnd > nParts) {
+				indexEnd = nParts;
+			}
+			sl_size start = context->bounds[indexPart];
+			sl_size mid = context->bounds[indexMid];
+			sl_size len = context->bounds[indexEnd] - start;
+			sl_size d1 = (sl_size)((sl_uint64)len * indexPiece / context->nPieces);
+			sl_size d2 = (sl_size)((sl_uint64)len * (indexPiece + 1) / context->nPieces);
+			const TYPE* a = context->src + start;
+			const TYPE* b = context->src + mid;
+			sl_size na = mid - start;
+			sl_size nb = len - na;
+			// merge-path: the count of the elements taken from `a` for the first `d` elements of the output
+			sl_size i1 = _getSplit(a, na, b, nb, d1, compare);
+			sl_size i2 = _getSplit(a, na, b, nb, d2, compare);
+			MergeSort::merge(a + i1, i2 - i1, b + (d1 - i1), (d2 - i2) - (d1 - i1), context->dst + start + d1, compare);
+		}
+
+		static void runCopy(void* _context, sl_uint32 index)
+		{
+			_ParallelSortContext* context = (_ParallelSortContext*)_context;
+			sl_size start = context->bounds[index];
+			sl_size end = context->bounds[index + 1];
+			for (sl_size i = start; i < end; i++) {
+				context->dst[i] = context->src[i];
+			}
+		}
+
+		static sl_size _getSplit(const TYPE* a, sl_size na, const TYPE* b, sl_size nb, sl_size d, const COMPARE& compare)
+		{
+			sl_size low = d > nb ? d - nb : 0;
+			sl_size high = d < na ? d : na;
+			while (low < high) {
+				sl_size i = (low + high) >> 1;
+				// `a[i]` precedes `b[d - i - 1]` (the elements of `a` come first when equal)
+				if (compare(b[d - i - 1], a[i]) >= 0) {
+					low = i + 1;
+				} else {
+					high = i;
+				}
+			}
+			return low;
+		}
+
+	};
+
+	template <class TYPE, class COMPARE>
+	sl_bool ParallelSort::sortAsc(TYPE* list, sl_size size, const COMPARE& compare, ThreadPool* pool)
+	{
+		sl_uint32 nThreads = getThreadsCount(size, pool);
+		if (nThreads < 2) {
+			QuickSort::sortAsc(list, size, compare);
+			return sl_true;
+		}
+		if (nThreads > _SLIB_PARALLEL_SORT_MAX_THREADS) {
+			nThreads = _SLIB_PARALLEL_SORT_MAX_THREADS;
+		}
+		TYPE* temp = NewHelper<TYPE>::create(size);
+		if (!temp) {
+			return sl_false;
+		}
+		typedef _ParallelSortContext<TYPE, COMPARE> Context;
+		Context context;
+		context.list = list;
+		context.size = size;
+		context.compare = &compare;
+		context.nThreads = nThreads;
+		for (sl_uint32 i = 0; i <= nThreads; i++) {
+			context.bounds[i] = (sl_size)((sl_uint64)size * i / nThreads);
+		}
+		runTasks(pool, nThreads, &(Context::runSort), &context);
+		context.src = list;
+		context.dst = temp;
+		for (sl_uint32 step = 1; step < nThreads; step <<= 1) {
+			sl_uint32 nPairs = (nThreads + (step << 1) - 1) / (step << 1);
+			context.step = step;
+			context.nPieces = (nThreads + nPairs - 1) / nPairs;
+			runTasks(pool, nPairs * context.nPieces, &(Context::runMerge), &context);
+			Swap(context.src, context.dst);
+		}
+		if (context.src != list) {
+			context.dst = list;
+			runTasks(pool, nThreads, &(Context::runCopy), &context);
+		}
+		NewHelper<TYPE>::free(temp, size);
+		return sl_true;
+	}
+
+	template <class TYPE, class COMPARE>
+	sl_bool ParallelSort::sortDesc(TYPE* list, sl_size size, const COMPARE& compare, ThreadPool* pool)
+	{
+		return sortAsc(list, size, _SortCompareReverse<TYPE, COMPARE>(compare), pool);
+	}
+
+	template <class TYPE, class COMPARE>
+	sl_bool ParallelSort::sort(TYPE* list, sl_size size, sl_bool flagAsc, const COMPARE& compare, ThreadPool* pool)
+	{
+		if (flagAsc) {
+			return sortAsc(list, size, compare, pool);
+		} else {
+			return sortDesc(list, size, compare, pool);
+		}
+	}
+
 }
 
 #endif
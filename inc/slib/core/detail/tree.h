@@ -904,8 +904,77 @@ namespace slib
 				return removeAt(nextPos);
 			}
 		}
+		if (n <= 1 && pos.node == getRootNode() && data->linkFirst.isNotNull()) {
+			// the root takes over the items of its remaining child
+			TreeNode child = data->linkFirst;
+			NodeDataScope childData(this, child);
+			if (childData.isNull()) {
+				return sl_false;
+			}
+			sl_uint32 m = childData->countItems;
+			data->countTotal = childData->countTotal;
+			data->countItems = m;
+			data->linkFirst = childData->linkFirst;
+			for (sl_uint32 i = 0; i < m; i++) {
+				data->keys[i] = childData->keys[i];
+				data->values[i] = childData->values[i];
+				data->links[i] = childData->links[i];
+			}
+			if (!writeNodeData(pos.node, data.data)) {
+				return sl_false;
+			}
+			m_totalCount = data->countTotal;
+			for (sl_uint32 i = 0; i <= m; i++) {
+				TreeNode link = i ? data->links[i - 1] : data->linkFirst;
+				if (link.isNotNull()) {
+					NodeDataScope linkData(this, link);
+					if (linkData.isNotNull()) {
+						linkData->linkParent = pos.node;
+						writeNodeData(link, linkData.data);
+					}
+				}
+			}
+			return deleteNode(child);
+		}
 		if (n <= 1 && pos.node != getRootNode()) {
-			return removeNode(pos.node);
+			TreeNode child = data->linkFirst;
+			if (child.isNull()) {
+				return removeNode(pos.node);
+			}
+			// the remaining child takes the place of the emptied node
+			TreeNode parent = data->linkParent;
+			NodeDataScope parentData(this, parent);
+			if (parentData.isNull()) {
+				return sl_false;
+			}
+			if (parentData->linkFirst == pos.node) {
+				parentData->linkFirst = child;
+			} else {
+				sl_uint32 i;
+				sl_uint32 m = parentData->countItems;
+				for (i = 0; i < m; i++) {
+					if (parentData->links[i] == pos.node) {
+						parentData->links[i] = child;
+						break;
+					}
+				}
+				if (i == m) {
+					return sl_false;
+				}
+			}
+			parentData->countTotal--;
+			if (!writeNodeData(parent, parentData.data)) {
+				return sl_false;
+			}
+			_changeParentTotalCount(parentData.data, -1);
+			NodeDataScope childData(this, child);
+			if (childData.isNotNull()) {
+				childData->linkParent = parent;
+				if (!writeNodeData(child, childData.data)) {
+					return sl_false;
+				}
+			}
+			return deleteNode(pos.node);
 		}
 		for (sl_uint32 i = pos.item; i < n - 1; i++) {
 			data->keys[i] = data->keys[i + 1];
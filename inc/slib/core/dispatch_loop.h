@@ -16,6 +16,7 @@
 #include "dispatch.h"
 #include "thread.h"
 #include "time.h"
+#include "tree.h"
 
 namespace slib
 {
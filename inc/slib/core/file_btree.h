@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_FILE_BTREE
+#define CHECKHEADER_SLIB_CORE_FILE_BTREE
+
+#include "definition.h"
+
+#include "tree.h"
+#include "file.h"
+#include "flat_hashtable.h"
+
+/*
+	FileBTree is a BTree whose nodes are stored in the fixed-size pages of a file.
+
+	The recently used pages are kept in an LRU cache, and the modified pages
+	stay in memory until `flush()` is called, or until a modification of the tree
+	leaves more of them than `maximumDirtyPagesCount` (the tree is flushed
+	automatically then, only between the modifications through `FileBTree`).
+	`bulkLoad()` keeps all of its pages until the next flush. When the write-ahead log is
+	enabled, `flush()` writes all modified pages to `path.wal` and syncs it
+	before updating the tree file, so the file always reflects the tree as of
+	a completed flush, even after a crash. The pending log is replayed when
+	the file is opened again.
+
+	The keys and the values are copied into the pages as raw bytes, so they
+	must be plain data types (no pointers or reference-counted objects).
+	The pointers to the values in the nodes (`getItemPointer`, ...) are not
+	available because the node data is released after each access.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT FileBTreeParam
+	{
+	public:
+		String path;
+
+		// size of a node page in bytes, default: 4096
+		sl_uint32 pageSize;
+		// maximum number of the unmodified pages kept in memory, default: 1024
+		sl_uint32 cachedPagesCount;
+		// maximum number of the modified pages kept in memory after a modification, default: 4096 (0: unlimited)
+		sl_uint32 maximumDirtyPagesCount;
+		// default: true
+		sl_bool flagWriteAheadLog;
+
+	public:
+		FileBTreeParam();
+
+		~FileBTreeParam();
+
+	};
+
+	class _FileBTreePage;
+
+	class SLIB_EXPORT FileBTreePager
+	{
+	public:
+		FileBTreePager();
+
+		~FileBTreePager();
+
+	public:
+		// `keySize` and `valueSize` are stored in the file to validate the layout of the pages
+		sl_bool open(const FileBTreeParam& param, sl_uint32 keySize, sl_uint32 valueSize);
+
+		// discards the modified pages which are not flushed
+		void close();
+
+		sl_bool isOpened() const;
+
+		sl_uint32 getPageSize() const;
+
+		sl_uint64 getRootPage() const;
+
+		void setRootPage(sl_uint64 page);
+
+		// returns 0 on failure
+		sl_uint64 allocatePage();
+
+		sl_bool freePage(sl_uint64 page);
+
+		// the returned buffer is valid until the next call to the pager
+		const sl_uint8* readPage(sl_uint64 page);
+
+		// the returned buffer is valid until the next call to the pager, and is written to the file on flush
+		sl_uint8* writePage(sl_uint64 page);
+
+		sl_bool flush();
+
+		sl_uint32 getDirtyPagesCount() const;
+
+		// flushes when the modified pages exceed the maximum count, should be called when the tree is consistent
+		sl_bool checkDirtyPages();
+
+	private:
+		_FileBTreePage* _getPage(sl_uint64 page, sl_bool flagLoad);
+
+		void _linkPage(_FileBTreePage* page, _FileBTreePage*& head, _FileBTreePage*& tail);
+
+		void _unlinkPage(_FileBTreePage* page, _FileBTreePage*& head, _FileBTreePage*& tail);
+
+		void _shrinkCache();
+
+		sl_bool _writeLog();
+
+		sl_bool _recoverLog();
+
+		void _writeHeader(sl_uint8* buf);
+
+		void _freeCache();
+
+	private:
+		Ref<File> m_file;
+		Ref<File> m_fileLog;
+
+		sl_uint32 m_pageSize;
+		sl_uint32 m_nCachedPagesMax;
+		sl_uint32 m_nDirtyPagesMax;
+		sl_uint32 m_keySize;
+		sl_uint32 m_valueSize;
+
+		// the header in page 0
+		sl_uint64 m_nPages;
+		sl_uint64 m_pageRoot;
+		sl_uint64 m_pageFree;
+		sl_bool m_flagHeaderModified;
+
+		// number of the pages existing in the file
+		sl_uint64 m_nPagesInFile;
+
+		FlatHashTable<sl_uint64, _FileBTreePage*> m_mapPages;
+		// unmodified pages, from the most recently used
+		_FileBTreePage* m_pageCleanFirst;
+		_FileBTreePage* m_pageCleanLast;
+		sl_uint32 m_nCleanPages;
+		_FileBTreePage* m_pageDirtyFirst;
+		_FileBTreePage* m_pageDirtyLast;
+		sl_uint32 m_nDirtyPages;
+
+	};
+
+	template < class KT, class VT, class KEY_COMPARE = Compare<KT> >
+	class SLIB_EXPORT FileBTree : public BTree<KT, VT, KEY_COMPARE>
+	{
+	public:
+		typedef typename BTree<KT, VT, KEY_COMPARE>::NodeData NodeData;
+
+	public:
+		FileBTree(const FileBTreeParam& param, const KEY_COMPARE& compare = KEY_COMPARE());
+
+		~FileBTree();
+
+	public:
+		sl_bool isOpened() const;
+
+		sl_bool flush();
+
+		// flushes the modified pages and closes the file
+		void close();
+
+		// replaces the items of the tree, `keys` must be sorted
+		sl_bool bulkLoad(const KT* keys, const VT* values, sl_size count);
+
+	public:
+		// the modifications below flush the tree when it holds too many modified pages
+
+		sl_bool put(const KT& key, const VT& value, MapPutMode mode = MapPutMode::Default, sl_bool* pFlagExist = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_bool remove(const KT& key, VT* outValue = sl_null);
+
+		sl_size removeItems(const KT& key, List<VT>* outValues = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool removeKeyAndValue(const KT& key, const _VT& value, VT* outValue = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_size removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_bool removeAt(const TreePosition& pos);
+
+		sl_bool removeNode(const TreeNode& node);
+
+		sl_size removeAll();
+
+		static sl_uint32 getOrderForPageSize(sl_uint32 pageSize);
+
+	protected:
+		// override
+		TreeNode getRootNode() const;
+
+		// override
+		sl_bool setRootNode(TreeNode node);
+
+		// override
+		TreeNode createNode(NodeData* data);
+
+		// override
+		sl_bool deleteNode(TreeNode node);
+
+		// override
+		NodeData* readNodeData(const TreeNode& node) const;
+
+		// override
+		sl_bool writeNodeData(const TreeNode& node, NodeData* data);
+
+		// override
+		void releaseNodeData(NodeData* data);
+
+	private:
+		using BTree<KT, VT, KEY_COMPARE>::getValuePointerAt;
+		using BTree<KT, VT, KEY_COMPARE>::getItemPointer;
+		using BTree<KT, VT, KEY_COMPARE>::getItemPointerByKeyAndValue;
+
+	private:
+		void _writePage(sl_uint8* page, NodeData* data);
+
+		void _updateMaxLength();
+
+		sl_bool _bulkLoad(const KT* keys, const VT* values, sl_size count, sl_uint64 page, sl_uint64 parent);
+
+	private:
+		mutable FileBTreePager m_pager;
+
+	};
+
+}
+
+#include "detail/file_btree.h"
+
+#endif
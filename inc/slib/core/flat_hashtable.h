@@ -0,0 +1,173 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_FLAT_HASHTABLE
+#define CHECKHEADER_SLIB_CORE_FLAT_HASHTABLE
+
+#include "definition.h"
+
+#include "constants.h"
+#include "hash.h"
+#include "compare.h"
+#include "list.h"
+#include "math.h"
+#include "cpp.h"
+
+#define _SLIB_FLAT_HASHTABLE_GROUP_SIZE 16
+#define _SLIB_FLAT_HASHTABLE_MIN_CAPACITY 16
+#define _SLIB_FLAT_HASHTABLE_MAX_CAPACITY 0x40000000
+
+/*
+	FlatHashTable is an open-addressing hash table (Swiss table layout).
+
+	Entries are stored inline in a single slot array and every slot has a
+	control byte: the low 7 bits of the hash for the used slots, or a marker
+	for the empty and deleted slots. The control bytes are probed by the group
+	of 16 slots (using SSE2 on x64), so a lookup usually compares one or two
+	keys without chasing any pointer.
+
+	Unlike HashTable, the entries are not kept in insertion order, and the
+	pointers to the entries are invalidated when the table is resized.
+*/
+
+namespace slib
+{
+
+	template <class KT, class VT>
+	struct FlatHashEntry
+	{
+		KT key;
+		VT value;
+
+		template <class KEY, class VALUE>
+		SLIB_INLINE FlatHashEntry(KEY&& _key, VALUE&& _value) : key(Forward<KEY>(_key)), value(Forward<VALUE>(_value)) {}
+
+	};
+
+	class SLIB_EXPORT _FlatHashTableGroup
+	{
+	public:
+		enum
+		{
+			Empty = 0x80,
+			Deleted = 0xFE
+		};
+
+	public:
+		// bit mask of the slots having `h2` as the control byte
+		static sl_uint32 match(const sl_uint8* ctrl, sl_uint8 h2);
+
+		static sl_uint32 matchEmpty(const sl_uint8* ctrl);
+
+		static sl_uint32 matchEmptyOrDeleted(const sl_uint8* ctrl);
+
+		static sl_uint32 matchFull(const sl_uint8* ctrl);
+
+		static sl_uint32 getFirstIndex(sl_uint32 mask);
+
+	};
+
+	template < class KT, class VT, class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
+	class SLIB_EXPORT FlatHashTable
+	{
+	public:
+		FlatHashTable(sl_uint32 capacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+
+		~FlatHashTable();
+
+	public:
+		sl_size getCount() const;
+
+		sl_size getCapacity() const;
+
+		FlatHashEntry<KT, VT>* getFirstEntry() const;
+
+		FlatHashEntry<KT, VT>* getNextEntry(FlatHashEntry<KT, VT>* entry) const;
+
+		FlatHashEntry<KT, VT>* search(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		FlatHashEntry<KT, VT>* searchKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		sl_bool get(const KT& key, VT* outValue = sl_null) const;
+
+		VT* getItemPointer(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		VT* getItemPointerByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		List<VT> getValues(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		List<VT> getValuesByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		sl_bool put(const KT& key, const VT& value, MapPutMode mode = MapPutMode::Default, sl_bool* pFlagExist = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_bool remove(const KT& key, VT* outValue = sl_null);
+
+		sl_size removeItems(const KT& key, List<VT>* outValues = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool removeKeyAndValue(const KT& key, const _VT& value, VT* outValue = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_size removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_size removeAll();
+
+		sl_bool copyFrom(const FlatHashTable<KT, VT, HASH, KEY_EQUALS>* other);
+
+	private:
+		typedef FlatHashEntry<KT, VT> Entry;
+
+		sl_uint8* m_ctrl;
+		Entry* m_slots;
+		sl_size m_nSize;
+
+		sl_uint32 m_nCapacity;
+		sl_uint32 m_nCapacityMin;
+		// number of the empty slots which can be used before growing the table
+		sl_uint32 m_nGrowthLeft;
+
+		HASH m_hash;
+		KEY_EQUALS m_equals;
+
+	private:
+		static sl_uint32 _mixHash(sl_uint32 hash);
+
+		template <class CALLBACK>
+		void _searchSlots(sl_uint32 hash, const KT& key, const CALLBACK& callback) const;
+
+		sl_uint32 _findInsertSlot(sl_uint32 hash) const;
+
+		void _init();
+
+		void _free();
+
+		sl_bool _createTable(sl_uint32 capacity);
+
+		sl_bool _rehash(sl_uint32 capacity);
+
+		sl_bool _addEntry(sl_uint32 hash, const KT& key, const VT& value);
+
+		void _removeSlot(sl_uint32 index);
+
+		void _compact();
+
+	};
+
+}
+
+#include "detail/flat_hashtable.h"
+
+#endif
@@ -29,8 +29,20 @@ namespace slib
 		return Rehash((sl_uint32)(x ^ (x >> 32)));
 	}
 
+	// hashes the bytes with the per-process seed (see `GetHashSeed`)
 	sl_uint32 HashBytes(const void* buf, sl_size n);
 
+	// 64-bit hash (wyhash) of the bytes
+	sl_uint64 HashBytes64(const void* buf, sl_size n, sl_uint64 seed = 0);
+
+	/*
+		Seed used by `HashBytes` and the hash codes of the strings.
+		It is randomly generated once per process, so the hash values of the keys coming from
+		outside (for example, HTTP requests) can't be predicted to flood hash tables.
+		Define `SLIB_HASH_DISABLE_RANDOM_SEED` when building the library to use a fixed seed.
+	*/
+	sl_uint64 GetHashSeed();
+
 	template <>
 	class Hash<char>
 	{
@@ -240,6 +240,27 @@ namespace slib
 		template < class COMPARE = Compare<T> >
 		void sort(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
 
+		// stable (MergeSort), returns false if the temporary buffer can't be allocated
+		template < class COMPARE = Compare<T> >
+		sl_bool sortStable_NoLock(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortStable(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		// sorts by multiple threads (ParallelSort), not stable
+		template < class COMPARE = Compare<T> >
+		sl_bool sortParallel_NoLock(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortParallel(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null) const;
+
+		// stable radix sort by the integer or floating-point key returned by `getKey(const T&)`, the elements are the keys by default
+		template < class GET_KEY = _RadixSortValue<T> >
+		sl_bool sortByKey_NoLock(sl_bool flagAscending = sl_true, const GET_KEY& getKey = GET_KEY()) const;
+
+		template < class GET_KEY = _RadixSortValue<T> >
+		sl_bool sortByKey(sl_bool flagAscending = sl_true, const GET_KEY& getKey = GET_KEY()) const;
+
 		Iterator<T> toIterator() const;
 
 		// range-based for loop
@@ -494,6 +515,24 @@ namespace slib
 		template < class COMPARE = Compare<T> >
 		void sort_NoLock(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
 
+		template < class COMPARE = Compare<T> >
+		sl_bool sortStable(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortStable_NoLock(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortParallel(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortParallel_NoLock(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null) const;
+
+		template < class GET_KEY = _RadixSortValue<T> >
+		sl_bool sortByKey(sl_bool flagAscending = sl_true, const GET_KEY& getKey = GET_KEY()) const;
+
+		template < class GET_KEY = _RadixSortValue<T> >
+		sl_bool sortByKey_NoLock(sl_bool flagAscending = sl_true, const GET_KEY& getKey = GET_KEY()) const;
+
 		Iterator<T> toIterator() const;
 
 		const Mutex* getLocker() const;
@@ -615,6 +654,15 @@ namespace slib
 
 		template < class COMPARE = Compare<T> >
 		void sort(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortStable(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE()) const;
+
+		template < class COMPARE = Compare<T> >
+		sl_bool sortParallel(sl_bool flagAscending = sl_true, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null) const;
+
+		template < class GET_KEY = _RadixSortValue<T> >
+		sl_bool sortByKey(sl_bool flagAscending = sl_true, const GET_KEY& getKey = GET_KEY()) const;
 	
 		// range-based for loop
 		ListPosition<T> begin() const;
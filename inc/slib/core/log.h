@@ -17,11 +17,18 @@
 #include "object.h"
 #include "list.h"
 #include "variant.h"
+#include "memory.h"
+#include "spin_lock.h"
+#include "time.h"
 
 namespace slib
 {
 
 	class LoggerSet;
+	class FileLoggerParam;
+	class File;
+	class Thread;
+	class Event;
 	
 	class SLIB_EXPORT Console
 	{
@@ -61,27 +68,104 @@ namespace slib
 
 		static Ref<Logger> createFileLogger(const String& fileName);
 
+		static Ref<Logger> createFileLogger(const FileLoggerParam& param);
+
 		static void logGlobal(const String& tag, const String& content);
 
 		static void logGlobalError(const String& tag, const String& content);
 	
 	};
 	
+	class SLIB_EXPORT FileLoggerParam
+	{
+	public:
+		String fileName;
+		
+		// writes the lines from a background thread, default: false
+		sl_bool flagAsync;
+		// size of the line buffer used in asynchronous mode, default: 1MB
+		sl_uint32 bufferSize;
+		// milliseconds, default: 1000 (minimum: 10)
+		sl_uint32 flushInterval;
+		
+		// rotates the log file when it exceeds this size, default: 0 (disabled)
+		sl_uint64 maximumFileSize;
+		// seconds, rotates the log file periodically, default: 0 (disabled)
+		sl_uint32 rotationInterval;
+		// rotated files are named as `fileName.1`, `fileName.2`, ..., default: 5
+		sl_uint32 maximumBackupsCount;
+		
+	public:
+		FileLoggerParam();
+		
+		~FileLoggerParam();
+		
+	};
+	
 	class SLIB_EXPORT FileLogger : public Logger
 	{
 	public:
 		FileLogger();
 
 		FileLogger(const String& fileName);
+		
+		FileLogger(const FileLoggerParam& param);
 
 		~FileLogger();
 	
 	public:
 		// override
 		void log(const String& tag, const String& content);
+		
+		void flush();
+		
+		sl_bool isAsync();
+		
+		// number of the lines dropped because the buffer was full (asynchronous mode)
+		sl_uint64 getDroppedLinesCount();
 	
 	public:
 		SLIB_PROPERTY(AtomicString, FileName)
+		
+	protected:
+		void _init(const FileLoggerParam& param);
+		
+		void _writeLine(const String& line);
+		
+		sl_bool _prepareFile(sl_size sizeWrite);
+		
+		void _writeFile(const void* data, sl_size size);
+		
+		sl_bool _openFile();
+		
+		void _rotate();
+		
+		void _flushBuffer();
+		
+		void _runFlush();
+		
+	protected:
+		sl_bool m_flagAsync;
+		sl_uint32 m_flushInterval;
+		sl_uint64 m_maximumFileSize;
+		sl_uint32 m_rotationInterval;
+		sl_uint32 m_maximumBackupsCount;
+		
+		Mutex m_lockFile;
+		Ref<File> m_file;
+		String m_fileNameOpened;
+		sl_uint64 m_sizeFile;
+		Time m_timeOpened;
+		
+		SpinLock m_lockBuffer;
+		Memory m_buffer;
+		sl_uint64 m_posBufferRead;
+		sl_uint64 m_posBufferWrite;
+		sl_uint64 m_nLinesDropped;
+		sl_uint64 m_nLinesDroppedNotReported;
+		
+		Ref<Thread> m_thread;
+		Ref<Event> m_eventFlush;
 	
 	};
 	
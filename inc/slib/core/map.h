@@ -17,7 +17,8 @@
 #include "iterator.h"
 #include "list.h"
 #include "hashtable.h"
-#include "tree.h"
+#include "flat_hashtable.h"
+#include "bplus_tree.h"
 
 namespace std
 {
@@ -361,16 +362,107 @@ namespace slib
 	};
 	
 	
+	template < class KT, class VT, class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
+	class SLIB_EXPORT FlatHashMap : public IMap<KT, VT>
+	{
+	public:
+		FlatHashTable<KT, VT, HASH, KEY_EQUALS> table;
+
+	public:
+		FlatHashMap(sl_uint32 capacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+		
+		FlatHashMap(const std::initializer_list< Pair<KT, VT> >& l, sl_uint32 capacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+		
+	public:
+		static FlatHashMap<KT, VT, HASH, KEY_EQUALS>* create(sl_uint32 capacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+		
+		static FlatHashMap<KT, VT, HASH, KEY_EQUALS>* create(const std::initializer_list< Pair<KT, VT> >& l, sl_uint32 capacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+		
+		VT operator[](const KT& key) const;
+	
+		// override
+		sl_size getCount() const;
+
+		// override
+		VT* getItemPointer(const KT& key) const;
+
+		// override
+		List<VT> getValues_NoLock(const KT& key) const;
+
+		// override
+		sl_bool put_NoLock(const KT& key, const VT& value, MapPutMode mode = MapPutMode::Default, sl_bool* pFlagExist = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool addIfNewKeyAndValue_NoLock(const KT& key, const _VT& value, sl_bool* pFlagExist = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		// override
+		sl_bool remove_NoLock(const KT& key, VT* outValue = sl_null);
+
+		// override
+		sl_size removeItems_NoLock(const KT& key, List<VT>* outValues = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool removeKeyAndValue_NoLock(const KT& key, const _VT& value, VT* outValue = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool removeKeyAndValue(const KT& key, const _VT& value, VT* outValue = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_size removeItemsByKeyAndValue_NoLock(const KT& key, const _VT& value, List<VT>* outValues = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_size removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		// override
+		sl_size removeAll_NoLock();
+
+		// override
+		sl_bool contains_NoLock(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool containsKeyAndValue_NoLock(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool containsKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		// override
+		IMap<KT, VT>* duplicate_NoLock() const;
+
+		// override
+		Iterator<KT> getKeyIteratorWithRefer(Referable* refer) const;
+
+		// override
+		List<KT> getAllKeys_NoLock() const;
+
+		// override
+		Iterator<VT> getValueIteratorWithRefer(Referable* refer) const;
+
+		// override
+		List<VT> getAllValues_NoLock() const;
+
+		// override
+		Iterator< Pair<KT, VT> > toIteratorWithRefer(Referable* refer) const;
+
+		// override
+		List< Pair<KT, VT> > toList_NoLock() const;
+	
+	};
+	
+	
 /*
- TreeMap class Definition                                             
-	Now TreeMap is based on BTree, but should be changed to Red-Black
-	Tree implementation which is a little better for in-memory structure.
+ TreeMap class Definition
+	TreeMap is based on the in-memory BPlusTree. The items are iterated
+	in the order of the keys, and `tree` provides the range queries
+	(`getLowerBound`, `getUpperBound`, `getNextPosition`, ...).
 */
 	template < class KT, class VT, class KEY_COMPARE = Compare<KT> >
 	class SLIB_EXPORT TreeMap : public IMap<KT, VT>
 	{
 	public:
-		BTree<KT, VT, KEY_COMPARE> tree;
+		BPlusTree<KT, VT, KEY_COMPARE> tree;
 
 	public:
 		TreeMap(const KEY_COMPARE& key_compare = KEY_COMPARE());
@@ -480,6 +572,12 @@ namespace slib
 		
 		template < class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
 		static Map<KT, VT> createHash(const std::initializer_list< Pair<KT, VT> >& l, sl_uint32 initialCapacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+		
+		template < class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
+		static Map<KT, VT> createFlatHash(sl_uint32 initialCapacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+		
+		template < class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
+		static Map<KT, VT> createFlatHash(const std::initializer_list< Pair<KT, VT> >& l, sl_uint32 initialCapacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
 	
 		template < class KEY_COMPARE = Compare<KT> >
 		static Map<KT, VT> createTree(const KEY_COMPARE& key_compare = KEY_COMPARE());
@@ -499,6 +597,9 @@ namespace slib
 		template < class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
 		void initHash(sl_uint32 initialCapacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
 
+		template < class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
+		void initFlatHash(sl_uint32 initialCapacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+
 		template < class KEY_COMPARE = Compare<KT> >
 		void initTree(const KEY_COMPARE& key_compare = KEY_COMPARE());
 
@@ -618,6 +719,9 @@ namespace slib
 		template < class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
 		void initHash(sl_uint32 initialCapacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
 
+		template < class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
+		void initFlatHash(sl_uint32 initialCapacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+
 		template < class KEY_COMPARE = Compare<KT> >
 		void initTree(const KEY_COMPARE& key_compare = KEY_COMPARE());
 
@@ -0,0 +1,264 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_MSGPACK
+#define CHECKHEADER_SLIB_CORE_MSGPACK
+
+#include "definition.h"
+
+#include "json.h"
+#include "io.h"
+
+/********************************************************************
+	MessagePack (https://github.com/msgpack/msgpack/blob/master/spec.md)
+
+	Variant           MessagePack
+	---------------------------------------------------
+	Null, Pointer     nil
+	Boolean           bool
+	Int32, Int64      int (the smallest encoding)
+	Uint32, Uint64    int (the smallest encoding)
+	Float, Double     float 32, float 64
+	String*, Sz*      str (utf-8)
+	Time              ext -1 (timestamp 32/64/96)
+	Memory            bin
+	VariantList       array
+	VariantMap        map (string keys)
+	VariantMapList    array of maps
+
+	All multi-byte values are big-endian.
+********************************************************************/
+
+#define SLIB_MSGPACK_WRITER_BUFFER_SIZE 8192
+// nesting limit of arrays and maps when the encoded data is converted to variants
+#define SLIB_MSGPACK_MAX_DEPTH 256
+#define SLIB_MSGPACK_EXT_TIMESTAMP -1
+
+namespace slib
+{
+
+	enum class MsgPackType
+	{
+		Invalid = 0,
+		Nil = 1,
+		Boolean = 2,
+		Integer = 3,
+		Float = 4,
+		Double = 5,
+		String = 6,
+		Binary = 7,
+		Array = 8,
+		Map = 9,
+		Extension = 10
+	};
+
+	// encodes the values into the internal buffer, and writes the buffer to `IWriter` when it is full or flushed
+	class SLIB_EXPORT MsgPackWriter
+	{
+	public:
+		MsgPackWriter(IWriter* writer);
+
+		// flushes the remaining data
+		~MsgPackWriter();
+
+	public:
+		sl_bool writeNil();
+
+		sl_bool writeBoolean(sl_bool value);
+
+		sl_bool writeInt64(sl_int64 value);
+
+		sl_bool writeUint64(sl_uint64 value);
+
+		sl_bool writeFloat(float value);
+
+		sl_bool writeDouble(double value);
+
+		// `str` must be utf-8
+		sl_bool writeString(const sl_char8* str, sl_size len);
+
+		sl_bool writeString(const String& str);
+
+		sl_bool writeBinary(const void* data, sl_size size);
+
+		// followed by `count` values
+		sl_bool writeArrayHeader(sl_uint32 count);
+
+		// followed by `count` pairs of the key and the value
+		sl_bool writeMapHeader(sl_uint32 count);
+
+		sl_bool writeExtension(sl_int8 type, const void* data, sl_uint32 size);
+
+		sl_bool writeTime(const Time& time);
+
+		// the values which can't be represented (objects other than lists, maps and memories) are written as nil
+		sl_bool writeVariant(const Variant& value);
+
+		sl_bool flush();
+
+		// true if any writing has failed
+		sl_bool isError() const;
+
+	private:
+		sl_bool _write(const void* data, sl_size size);
+
+		sl_bool _writeHeader(sl_uint8 type, sl_uint64 value, sl_uint32 sizeValue);
+
+		sl_bool _writeVariantList(const List<Variant>& list, sl_uint32 depth);
+
+		sl_bool _writeVariantMap(const Map<String, Variant>& map, sl_uint32 depth);
+
+		sl_bool _writeVariantMapList(const List< Map<String, Variant> >& list, sl_uint32 depth);
+
+		sl_bool _writeVariant(const Variant& value, sl_uint32 depth);
+
+	private:
+		IWriter* m_writer;
+		sl_uint32 m_sizeBuffer;
+		sl_bool m_flagError;
+		sl_uint8 m_buffer[SLIB_MSGPACK_WRITER_BUFFER_SIZE];
+
+	};
+
+	/*
+		A view to one encoded value, reading it from the buffer without copying.
+		The buffer must outlive the reader unless it is given as `Memory`.
+	*/
+	class SLIB_EXPORT MsgPackReader
+	{
+	public:
+		MsgPackReader();
+
+		// `size` is the number of the bytes available from `data`, the value may be followed by other data
+		MsgPackReader(const void* data, sl_size size);
+
+		MsgPackReader(const Memory& mem);
+
+		MsgPackReader(const MsgPackReader& other);
+
+		~MsgPackReader();
+
+	public:
+		MsgPackReader& operator=(const MsgPackReader& other);
+
+	public:
+		// false if the header is malformed or truncated
+		sl_bool isValid() const;
+
+		MsgPackType getType() const;
+
+		sl_bool isNil() const;
+
+		sl_bool isBoolean() const;
+
+		sl_bool isInteger() const;
+
+		// true for integers, floats and doubles
+		sl_bool isNumber() const;
+
+		sl_bool isString() const;
+
+		sl_bool isBinary() const;
+
+		sl_bool isArray() const;
+
+		sl_bool isMap() const;
+
+		sl_bool isExtension() const;
+
+		sl_bool isTime() const;
+
+		// the size of the whole encoded value including the children, 0 if it is malformed
+		sl_size getEncodedSize() const;
+
+		sl_bool getBoolean(sl_bool def = sl_false) const;
+
+		sl_int64 getInt64(sl_int64 def = 0) const;
+
+		sl_uint64 getUint64(sl_uint64 def = 0) const;
+
+		double getDouble(double def = 0) const;
+
+		Time getTime(const Time& def = Time::zero()) const;
+
+		// points the utf-8 bytes of the string in the buffer (not null-terminated)
+		const sl_char8* getStringData(sl_size* outLength) const;
+
+		// copies the string
+		String getString(const String& def = String::null()) const;
+
+		sl_bool equalsString(const sl_char8* str, sl_size len) const;
+
+		// points the payload of the binary or the extension in the buffer
+		const void* getBinaryData(sl_size* outSize) const;
+
+		// refers the source memory if the reader is created from `Memory`, otherwise copies the payload
+		Memory getBinary() const;
+
+		sl_int8 getExtensionType() const;
+
+		// the number of the elements of an array, or the number of the pairs of a map
+		sl_uint32 getCount() const;
+
+		// the first element of an array, or the first key of a map (followed by its value)
+		MsgPackReader getFirstChild() const;
+
+		// the value following this value. The caller bounds the iteration by the count of the parent
+		MsgPackReader getNext() const;
+
+		MsgPackReader getElement(sl_uint32 index) const;
+
+		// finds the value of the string key in a map
+		MsgPackReader getItem(const sl_char8* key, sl_size len) const;
+
+		MsgPackReader getItem(const String& key) const;
+
+		// materializes the value (and the children)
+		Variant toVariant() const;
+
+		Json toJson() const;
+
+	private:
+		void _parse(const sl_uint8* data, sl_size size);
+
+		MsgPackReader _getReader(const sl_uint8* data, sl_size size) const;
+
+	private:
+		const sl_uint8* m_data;
+		// bytes available from `m_data`
+		sl_size m_size;
+		Memory m_mem;
+
+		MsgPackType m_type;
+		sl_bool m_flagSigned;
+		sl_int8 m_extType;
+		sl_uint32 m_sizeHeader;
+		// integer, bits of float, length of str/bin/ext or count of array/map
+		sl_uint64 m_value;
+
+	};
+
+	class SLIB_EXPORT MsgPack
+	{
+	public:
+		static Memory serialize(const Variant& value);
+
+		static sl_bool serialize(IWriter* writer, const Variant& value);
+
+		static Variant deserialize(const void* data, sl_size size);
+
+		// strings are copied, and binaries refer `mem`
+		static Variant deserialize(const Memory& mem);
+
+	};
+
+}
+
+#endif
@@ -36,13 +36,27 @@ namespace slib
 		Mutex& operator=(const Mutex& other);
 	
 	private:
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		// 0: unlocked, 1: locked, 2: locked and waited by other threads
+		mutable sl_int32 m_state;
+		// recursive locks held by the owner
+		mutable sl_uint32 m_countRecursion;
+		// thread holding the lock, 0 when unlocked
+		mutable sl_size m_owner;
+#else
+		// native mutex, created on the first lock
 		mutable void* m_pObject;
+#endif
 
 	private:
 		void _init();
 
 		void _free();
 
+#if !defined(SLIB_PLATFORM_IS_LINUX)
+		void* _getObject() const;
+#endif
+
 	};
 	
 #define SLIB_MAX_LOCK_MUTEX 16
@@ -382,8 +382,6 @@ namespace slib
 
 	public:
 		T* _ptr;
-	private:
-		SpinLock m_lock;
 	
 	};
 
@@ -663,7 +661,6 @@ namespace slib
 
 	public:
 		Referable* m_object;
-		SpinLock m_lock;
 
 	public:
 		static CWeakRef* create(Referable* object);
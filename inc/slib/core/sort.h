@@ -15,6 +15,7 @@
 
 #include "cpp.h"
 #include "compare.h"
+#include "new_helper.h"
 
 namespace slib
 {
@@ -69,6 +70,88 @@ namespace slib
 		static void sort(TYPE* list, sl_size size, sl_bool flagAscending, const COMPARE& compare = COMPARE());
 
 	};
+	
+	/*
+		Stable sort merging the runs between the list and a temporary buffer of the same size.
+		Returns false (leaving the list unsorted) when the buffer can't be allocated.
+	*/
+	class SLIB_EXPORT MergeSort
+	{
+	public:
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static sl_bool sortAsc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE());
+
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static sl_bool sortDesc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE());
+
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static sl_bool sort(TYPE* list, sl_size size, sl_bool flagAscending, const COMPARE& compare = COMPARE());
+
+		// merges the sorted runs `src1[0, n1)` and `src2[0, n2)` into `dst` (equal elements of `src1` come first)
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static void merge(const TYPE* src1, sl_size n1, const TYPE* src2, sl_size n2, TYPE* dst, const COMPARE& compare = COMPARE());
+
+	};
+	
+	/*
+		Stable LSD radix sort by 8-bit digits for integer and floating-point keys, without comparisons.
+		The passes over the digits that are the same in all keys are skipped.
+		Floating-point keys are ordered as -inf < negatives < -0 < +0 < positives < +inf, and NaNs go to the ends by their sign bits.
+		Returns false (leaving the list unsorted) when the temporary buffer can't be allocated.
+	*/
+	class SLIB_EXPORT RadixSort
+	{
+	public:
+		// `TYPE` is an integer or floating-point type
+		template <class TYPE>
+		static sl_bool sortAsc(TYPE* list, sl_size size);
+
+		template <class TYPE>
+		static sl_bool sortDesc(TYPE* list, sl_size size);
+
+		template <class TYPE>
+		static sl_bool sort(TYPE* list, sl_size size, sl_bool flagAscending);
+
+		// `getKey(const TYPE&)` returns an integer or floating-point key, it is called once per element in every pass
+		template <class TYPE, class GET_KEY>
+		static sl_bool sortByKeyAsc(TYPE* list, sl_size size, const GET_KEY& getKey);
+
+		template <class TYPE, class GET_KEY>
+		static sl_bool sortByKeyDesc(TYPE* list, sl_size size, const GET_KEY& getKey);
+
+		template <class TYPE, class GET_KEY>
+		static sl_bool sortByKey(TYPE* list, sl_size size, const GET_KEY& getKey, sl_bool flagAscending);
+
+	};
+	
+	class ThreadPool;
+	
+	/*
+		Sorts the parts of the list by QuickSort in parallel, and merges them in rounds where every merge is split by the merge-path into the tasks for all threads.
+		The sort is not stable. The tasks run on `pool` and the calling thread, so it also completes when the pool is busy.
+		If `pool` is null, the default pool having a thread per processor is used. Small lists are sorted in the calling thread.
+		Returns false (leaving the list unsorted) when the temporary buffer can't be allocated.
+	*/
+	class SLIB_EXPORT ParallelSort
+	{
+	public:
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static sl_bool sortAsc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null);
+
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static sl_bool sortDesc(TYPE* list, sl_size size, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null);
+
+		template < class TYPE, class COMPARE = Compare<TYPE> >
+		static sl_bool sort(TYPE* list, sl_size size, sl_bool flagAscending, const COMPARE& compare = COMPARE(), ThreadPool* pool = sl_null);
+
+	public:
+		// the number of the threads (including the calling thread) to be used for sorting `size` elements, 1 for the small lists
+		static sl_uint32 getThreadsCount(sl_size size, ThreadPool* pool = sl_null);
+
+		// calls `callback(context, index)` for every `index` in [0, nTasks), and returns after all calls are completed
+		static void runTasks(ThreadPool* pool, sl_uint32 nTasks, void (*callback)(void* context, sl_uint32 index), void* context);
+
+	};
 
 }
 
@@ -320,7 +320,7 @@ namespace slib
 		void setLength(sl_size len);
 		
 		/**
-		 * @return the hash code.
+		 * @return the hash code, seeded per process. It equals the hash code of a `String16` having the same code units.
 		 */
 		sl_uint32 getHashCode() const;
 		
@@ -48,6 +48,8 @@ namespace slib
 
 		static sl_uint32 getThreadId();
 
+		static sl_uint32 getProcessorsCount();
+
 		static sl_bool createProcess(const String& pathExecutable, const String* command, sl_uint32 nCommands);
 
 		static void exec(const String& pathExecutable, const String* command, sl_uint32 nCommands);
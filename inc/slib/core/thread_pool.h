@@ -16,10 +16,20 @@
 #include "queue.h"
 #include "thread.h"
 #include "dispatch.h"
+#include "time.h"
+#include "tree.h"
 
 namespace slib
 {
 	
+	class _ThreadPoolWorker;
+	
+	/*
+		Every worker owns a task deque. The tasks added by a worker are pushed to its own deque,
+		and the idle workers steal the tasks from the others before parking.
+		Every deque is run in the order of adding (FIFO) by its owner and the thieves,
+		but the tasks in different deques are run in no particular order.
+	*/
 	class SLIB_EXPORT ThreadPool : public Dispatcher
 	{
 		SLIB_DECLARE_OBJECT
@@ -46,17 +56,51 @@ namespace slib
 	
 	public:
 		SLIB_PROPERTY(sl_uint32, MinimumThreadsCount)
+		// should be set before adding the first task
 		SLIB_PROPERTY(sl_uint32, MaximumThreadsCount)
 		SLIB_PROPERTY(sl_uint32, ThreadStackSize)
+		// binds the workers to the processors in turn (default: false)
+		SLIB_BOOLEAN_PROPERTY(CpuAffinity)
 	
 	protected:
-		void onRunWorker();
+		void onRunWorker(_ThreadPoolWorker* worker);
 	
 	protected:
-		CList< Ref<Thread> > m_threadWorkers;
-		LinkedQueue< Function<void()> > m_tasks;
+		sl_bool _initWorkers();
+		
+		sl_bool _pushTask(const Function<void()>& task);
+		
+		sl_bool _startWorker(const Function<void()>& task);
+		
+		void _wakeParkedWorker();
+		
+		sl_bool _popTask(_ThreadPoolWorker* worker, Function<void()>& task);
+		
+		sl_int32 _processTimeTasks(_ThreadPoolWorker* worker);
+		
+	protected:
+		_ThreadPoolWorker** m_workers;
+		sl_uint32 m_nWorkerSlots;
+		sl_int32 m_nWorkersActive;
+		sl_int32 m_nWorkersParked;
+		sl_int32 m_nTasks;
+		sl_uint32 m_indexWorkerNext;
+		// index + 1 of the worker waiting for the time tasks
+		sl_int32 m_indexWorkerTimeWaiting;
 	
 		sl_bool m_flagRunning;
+		
+		TimeCounter m_timeCounter;
+		struct TimeTask
+		{
+			sl_uint64 time;
+			Function<void()> task;
+		};
+		BTree<sl_uint64, TimeTask> m_timeTasks;
+		sl_uint64 m_timeNextTask;
+		Mutex m_lockTimeTasks;
+		
+		friend class _ThreadPoolWorker;
 
 	};
 
@@ -173,17 +173,18 @@ namespace slib
 
 		friend class NodeDataScope;
 
-	private:
+	protected:
 		sl_uint32 m_order;
 		sl_uint32 m_maxLength;
 		sl_uint64 m_totalCount;
 		KEY_COMPARE m_compare;
 	
-	private:
+	protected:
 		NodeData* _createNodeData();
 
 		void _freeNodeData(NodeData* data);
 
+	private:
 		sl_bool _insertItemInNode(const TreeNode& node, sl_uint32 at, const TreeNode& after, const KT& key, const VT& value, const TreeNode& link);
 
 		void _changeTotalCount(const TreeNode& node, sl_int64 n);
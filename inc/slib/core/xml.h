@@ -40,6 +40,7 @@ namespace slib
 	class XmlComment;
 	class XmlParseControl;
 	class StringBuffer;
+	class IReader;
 	
 	enum class XmlNodeType
 	{
@@ -528,6 +529,47 @@ namespace slib
 
 	};
 	
+	/*
+		Incremental SAX parser fed by utf-8 chunks.
+		The events are reported to `XmlParseParam::listener` and no document is created. Only the markup or the text left unfinished at the end of a chunk is kept, so the memory is bounded by the largest tag or text instead of the document.
+		`XmlParseControl::source` is the chunk being parsed, and changing the source is not supported.
+		Differences from `Xml::parseXml` with `flagCreateDocument` unset:
+		 - `flagCheckWellFormed` is applied as when a document is created: the source must have exactly one root element and no text out of it.
+		 - A leading utf-8 BOM is skipped (as `Xml::parseXmlFromTextFile`), while `parseXml(const char*)` reports it as text.
+	*/
+	class SLIB_EXPORT XmlStreamParser : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		XmlStreamParser();
+
+		~XmlStreamParser();
+
+	public:
+		static Ref<XmlStreamParser> create(const XmlParseParam& param);
+
+	public:
+		// returns false on an error, and the parser can't continue after the error
+		virtual sl_bool feed(const void* data, sl_size size) = 0;
+
+		// reads all the data from `reader` into the internal buffer in chunks
+		virtual sl_bool feedFromReader(IReader* reader) = 0;
+
+		// parses the remaining data and checks the document is complete
+		virtual sl_bool end() = 0;
+
+	public:
+		sl_bool isError() const;
+
+		// the output fields (`flagError`, `errorPosition`, ...) are updated on an error
+		const XmlParseParam& getParam() const;
+
+	protected:
+		XmlParseParam m_param;
+
+	};
+
 	class SLIB_EXPORT Xml
 	{
 	public:
@@ -554,6 +596,12 @@ namespace slib
 		static Ref<XmlDocument> parseXmlFromTextFile(const String& filePath);
 
 
+		// SAX parsing of utf-8 source by chunks (see XmlStreamParser), `param.flagCreateDocument` is ignored
+		static sl_bool parseXmlStream(IReader* reader, XmlParseParam& param);
+
+		static sl_bool parseXmlStreamFromFile(const String& filePath, XmlParseParam& param);
+
+
 		static String makeEscapedText(const String& text);
 
 		static sl_bool buildEscapedText(const String& text, StringBuffer& output);
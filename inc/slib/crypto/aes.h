@@ -23,6 +23,8 @@
 
 	User Key Size - 128 bits (16 bytes), 192 bits (24 bytes), 256 bits (32 bytes)
 	Block Size - 128 bits (16 bytes)
+
+	The AES-NI instructions are used instead of the T-tables when the processor supports them
 */
 
 namespace slib
@@ -38,6 +40,14 @@ namespace slib
 	public:
 		static sl_uint32 getBlockSize();
 
+		// true when the AES-NI instructions are available on the running processor
+		static sl_bool isHardwareAccelerated();
+
+		sl_bool isUsingHardware() const;
+
+		// the T-tables are used when `flag` is false, or when the processor has no AES-NI
+		void setUsingHardware(sl_bool flag);
+
 		sl_bool setKey(const void* key, sl_uint32 lenKey /* 16, 24, 32 bytes */);
 
 		void setKey_SHA256(const String& key);
@@ -52,6 +62,9 @@ namespace slib
 		// 128 bit (16 byte) block
 		void decryptBlock(const void* src, void* dst) const;
 
+		// CTR mode on whole blocks: `counter` (16 bytes) is increased by `nBlocks`, only in the low 32 bits when `flagIncrease32` is true (inc32 of GCM)
+		void encrypt_CTR_Blocks(const void* src, void* dst, sl_size nBlocks, void* counter, sl_bool flagIncrease32 = sl_false) const;
+
 	public: /* common functions for block ciphers */
 		sl_size encryptBlocks(const void* src, void* dst, sl_size size) const;
 
@@ -88,6 +101,11 @@ namespace slib
 		sl_uint32 m_roundKeyDec[64];
 		sl_uint32 m_nCountRounds;
 
+		// round keys in the byte order, used by the AES-NI instructions
+		sl_uint8 m_roundKeyEncBytes[240];
+		sl_uint8 m_roundKeyDecBytes[240];
+		sl_bool m_flagHardware;
+
 	};
 	
 	class SLIB_EXPORT AES_GCM : public Object, public GCM<AES>
@@ -25,6 +25,9 @@
 GCM is constructed from an approved symmetric key block cipher with a block size of 128 bits,
 such as the Advanced Encryption Standard (AES) algorithm
 
+GHASH is calculated by the carry-less multiplication (PCLMULQDQ) when the processor supports it,
+otherwise by Shoup's 4-bit table
+
 */
 
 namespace slib
@@ -34,6 +37,8 @@ namespace slib
 	{
 	public:
 		Uint128 M[16]; // Shoup's, 4-bit table
+		Uint128 HP[4]; // H, H^2, H^3, H^4, used by the carry-less multiplication
+		sl_bool flagCLMUL;
 	
 	public:
 		void generateTable(const void* H /* 16 bytes */);
@@ -34,6 +34,12 @@ namespace slib
 	public:
 		sl_uint32 getLength() const;
 
+		// Montgomery context of N, created on the first use and recreated when N is changed
+		Ref<BigIntMontgomery> getMontgomeryN() const;
+
+	private:
+		mutable AtomicRef<BigIntMontgomery> m_montN;
+
 	};
 	
 	class SLIB_EXPORT RSAPrivateKey
@@ -59,6 +65,18 @@ namespace slib
 	public:
 		sl_uint32 getLength() const;
 
+		// Montgomery contexts of the moduli, created on the first use and recreated when the modulus is changed
+		Ref<BigIntMontgomery> getMontgomeryN() const;
+
+		Ref<BigIntMontgomery> getMontgomeryP() const;
+
+		Ref<BigIntMontgomery> getMontgomeryQ() const;
+
+	private:
+		mutable AtomicRef<BigIntMontgomery> m_montN;
+		mutable AtomicRef<BigIntMontgomery> m_montP;
+		mutable AtomicRef<BigIntMontgomery> m_montQ;
+
 	};
 	
 	class SLIB_EXPORT RSA
@@ -17,11 +17,113 @@
 #include "../core/list.h"
 #include "../core/map.h"
 #include "../core/variant.h"
+#include "../core/function.h"
 
 namespace slib
 {
 	
 	class Database;
+
+	enum class DatabaseColumnType
+	{
+		Int64 = 0,
+		Double = 1,
+		// UTF-8 text
+		String = 2,
+		Blob = 3
+	};
+
+	class SLIB_EXPORT DatabaseBatchColumn
+	{
+	public:
+		DatabaseColumnType type;
+
+		// `Int64` and `Double` columns: the values of the rows
+		union {
+			sl_int64* valuesInt64;
+			double* valuesDouble;
+		};
+
+		// `String` and `Blob` columns: the row `i` is stored at [offsets[i], offsets[i + 1]) in `arena`
+		sl_size* offsets;
+		sl_uint8* arena;
+		sl_size sizeArena;
+		sl_size capacityArena;
+
+		// non-zero for NULL values
+		sl_uint8* nulls;
+
+	};
+
+	/*
+		DatabaseBatch holds the rows fetched by `DatabaseCursor::fetchBatch()` in typed column vectors.
+		The memory is allocated once by `setColumns()` and reused by the following fetches,
+		so no object is created for each cell.
+	*/
+	class SLIB_EXPORT DatabaseBatch
+	{
+	public:
+		DatabaseBatch();
+
+		~DatabaseBatch();
+
+	public:
+		// the column `i` of the batch is filled from the column `i` of the cursor
+		sl_bool setColumns(const DatabaseColumnType* types, sl_uint32 nColumns, sl_uint32 maxRows);
+
+		sl_bool setColumns(const std::initializer_list<DatabaseColumnType>& types, sl_uint32 maxRows);
+
+		sl_uint32 getColumnsCount() const;
+
+		DatabaseColumnType getColumnType(sl_uint32 column) const;
+
+		const DatabaseBatchColumn* getColumn(sl_uint32 column) const;
+
+		sl_uint32 getMaxRowsCount() const;
+
+		sl_uint32 getRowsCount() const;
+
+		sl_bool isNull(sl_uint32 column, sl_uint32 row) const;
+
+		// returns the values of the rows in an `Int64` column
+		const sl_int64* getInt64Values(sl_uint32 column) const;
+
+		// returns the values of the rows in a `Double` column
+		const double* getDoubleValues(sl_uint32 column) const;
+
+		// `String` or `Blob` column, the data is valid until the next fetch
+		const sl_uint8* getData(sl_uint32 column, sl_uint32 row, sl_size* outSize = sl_null) const;
+
+		sl_size getDataSize(sl_uint32 column, sl_uint32 row) const;
+
+		String getString(sl_uint32 column, sl_uint32 row) const;
+
+		Memory getBlob(sl_uint32 column, sl_uint32 row) const;
+
+	public:
+		// used by the cursors filling the batch, the rows should be filled in order
+
+		void setRowsCount(sl_uint32 count);
+
+		void setNull(sl_uint32 column, sl_uint32 row);
+
+		void setInt64(sl_uint32 column, sl_uint32 row, sl_int64 value);
+
+		void setDouble(sl_uint32 column, sl_uint32 row, double value);
+
+		// appends `data` to the arena of a `String` or `Blob` column
+		sl_bool setData(sl_uint32 column, sl_uint32 row, const void* data, sl_size size);
+
+	private:
+		void _free();
+
+	private:
+		DatabaseBatchColumn* m_columns;
+		sl_uint32 m_nColumns;
+		sl_uint32 m_maxRows;
+		sl_uint32 m_nRows;
+
+	};
 	
 	class SLIB_EXPORT DatabaseCursor : public Object
 	{
@@ -101,7 +203,65 @@ namespace slib
 	
 
 		virtual sl_bool moveNext() = 0;
-	
+
+
+		// moves to the next rows and fills `batch` with up to `batch.getMaxRowsCount()` rows, returns the count of the fetched rows (0 at the end)
+		virtual sl_uint32 fetchBatch(DatabaseBatch& batch);
+
+
+		void readValue(sl_uint32 index, sl_int64& _out);
+
+		void readValue(sl_uint32 index, sl_uint64& _out);
+
+		void readValue(sl_uint32 index, sl_int32& _out);
+
+		void readValue(sl_uint32 index, sl_uint32& _out);
+
+		void readValue(sl_uint32 index, float& _out);
+
+		void readValue(sl_uint32 index, double& _out);
+
+		void readValue(sl_uint32 index, sl_bool& _out);
+
+		void readValue(sl_uint32 index, String& _out);
+
+		void readValue(sl_uint32 index, Time& _out);
+
+		void readValue(sl_uint32 index, Memory& _out);
+
+		void readValue(sl_uint32 index, Variant& _out);
+
+		/*
+			reads the current row into the fields of `row`: the column `i` is stored into `fields[i]`
+			ex) cursor->readRow(item, &Item::id, &Item::name);
+		*/
+		template <class T, class... FIELDS>
+		void readRow(T& row, FIELDS T::*... fields)
+		{
+			sl_uint32 index = 0;
+			int order[] = {0, (readValue(index++, row.*fields), 0)...};
+			SLIB_UNUSED(order)
+		}
+
+		// reads the remaining rows by `readRow()`
+		template <class T, class... FIELDS>
+		List<T> readRows(FIELDS T::*... fields)
+		{
+			CList<T>* list = new CList<T>;
+			if (list) {
+				T row;
+				while (moveNext()) {
+					readRow(row, fields...);
+					list->add_NoLock(row);
+				}
+			}
+			return list;
+		}
+
+	protected:
+		// stores the column `index` of the current row into `batch`, called by `fetchBatch()`
+		virtual void setBatchValue(DatabaseBatch& batch, sl_uint32 index, sl_uint32 row);
+
 	protected:
 		Ref<Database> m_db;
 
@@ -267,6 +427,45 @@ namespace slib
 
 	
 	};
+	
+	/*
+		DatabasePool keeps a connection for each thread, so that the threads
+		don't wait for each other on the lock of a shared connection.
+		The connection of a thread is released when the thread is exited,
+		including the threads not created by `Thread` (main thread, std::thread).
+	*/
+	class SLIB_EXPORT DatabasePool : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		DatabasePool();
+
+		~DatabasePool();
+
+	public:
+		// `connector` opens a new connection, called at the first use in each thread
+		static Ref<DatabasePool> create(const Function<Ref<Database>()>& connector);
+
+	public:
+		// returns the connection of the calling thread
+		Ref<Database> getDatabase();
+
+		sl_size getDatabasesCount();
+
+		// releases the connections, the threads open new connections at the next use
+		void clear();
+
+	protected:
+		void _removeDatabase(sl_uint64 threadId);
+
+	protected:
+		Function<Ref<Database>()> m_connector;
+		HashMap< sl_uint64, Ref<Database> > m_databases;
+
+		friend class _DatabasePoolThreadHandler;
+
+	};
 
 }
 
@@ -16,6 +16,27 @@
 namespace slib
 {
 
+	class SLIB_EXPORT SQLiteParam
+	{
+	public:
+		String path;
+
+		// creates the database file if it doesn't exist (default: false)
+		sl_bool flagCreate;
+		// journal_mode=WAL: the readers don't block the writer, and the writer doesn't block the readers (default: false)
+		sl_bool flagWAL;
+		// milliseconds waiting for the locks held by the other connections, 0 returns SQLITE_BUSY immediately (default: 0)
+		sl_uint32 busyTimeout;
+		// maximum number of the idle prepared statements kept by their SQL text (default: 32)
+		sl_uint32 statementCacheSize;
+
+	public:
+		SQLiteParam();
+
+		~SQLiteParam();
+
+	};
+
 	class SLIB_EXPORT SQLiteDatabase : public Database
 	{
 		SLIB_DECLARE_OBJECT
@@ -28,6 +49,11 @@ namespace slib
 	public:
 		static Ref<SQLiteDatabase> connect(const String& filePath);
 
+		static Ref<SQLiteDatabase> connect(const SQLiteParam& param);
+
+		// the connections are opened in WAL mode: the threads read concurrently, and the writers are serialized by SQLite (waiting up to `busyTimeout`)
+		static Ref<DatabasePool> createPool(const SQLiteParam& param);
+
 	};
 
 }
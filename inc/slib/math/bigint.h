@@ -743,6 +743,60 @@ namespace slib
 	};
 	
 	
+	/*
+		Precomputed context of Montgomery Reduction for a fixed modulus
+	
+		Available Input:
+			M - an odd value (M%2=1), M>0
+	
+		The context is not modified after creation, so it can be shared by the threads
+	*/
+	class SLIB_EXPORT BigIntMontgomery : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		BigIntMontgomery();
+
+		~BigIntMontgomery();
+
+	public:
+		static Ref<BigIntMontgomery> create(const BigInt& M);
+
+	public:
+		sl_bool initialize(const CBigInt& M);
+
+		sl_bool isInitialized() const;
+
+		// copy of the modulus given on initialization
+		BigInt getModulus() const;
+
+		/*
+			C = A^E mod M
+			Available Input:
+				E >= 0
+		*/
+		sl_bool pow(CBigInt& C, const CBigInt& A, const CBigInt& E) const;
+
+		BigInt pow(const BigInt& A, const BigInt& E) const;
+
+	private:
+		void _free();
+
+	private:
+		BigInt m_modulus;
+
+		// little-endian 64-bit limbs
+		sl_uint64* m_M;
+		// R^2 mod M, R = 2^(64*m_n)
+		sl_uint64* m_R2;
+		sl_size m_n;
+		// -(M^-1) mod 2^64
+		sl_uint64 m_MI;
+
+	};
+	
+	
 	sl_bool operator==(const BigInt& a, const BigInt& b);
 	
 	sl_bool operator==(const BigInt& a, sl_int32 v);
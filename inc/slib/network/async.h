@@ -135,6 +135,7 @@ namespace slib
 		sl_bool flagIPv6; // default: false
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
+		sl_bool flagReusePort; // default: false
 		Ref<AsyncIoLoop> ioLoop;
 		
 		Ptr<IAsyncTcpServerListener> listener;
@@ -17,6 +17,7 @@
 	
 		libpcap (unix) and winpcap (win32)
 		, raw sockets, packet sockets (linux)
+		, memory-mapped ring of packet sockets (linux, TPACKET_V3)
 		
 *****************************************************************/
 
@@ -65,6 +66,23 @@ namespace slib
 		
 	};
 	
+	class SLIB_EXPORT NetCaptureStatistics
+	{
+	public:
+		// packets delivered to the listener
+		sl_uint64 countPackets;
+		// bytes of the packets delivered to the listener
+		sl_uint64 sizePackets;
+		// packets dropped by the kernel because the buffer was full, counted in Packet Ring mode
+		sl_uint64 countDropped;
+		
+	public:
+		NetCaptureStatistics();
+		
+		~NetCaptureStatistics();
+		
+	};
+	
 	class NetCapture;
 	
 	class SLIB_EXPORT INetCaptureListener
@@ -77,6 +95,9 @@ namespace slib
 	public:
 		virtual void onCapturePacket(NetCapture* capture, NetCapturePacket* packet) = 0;
 		
+		// called with the packets of a block in Packet Ring mode, the default implementation calls `onCapturePacket` for each packet
+		virtual void onCapturePackets(NetCapture* capture, NetCapturePacket* packets, sl_uint32 count);
+		
 	};
 	
 	class SLIB_EXPORT NetCaptureParam
@@ -90,10 +111,19 @@ namespace slib
 		
 		NetworkLinkDeviceType preferedLinkDeviceType; // NetworkLinkDeviceType, used in Packet Socket mode. now supported Ethernet and Raw
 		
+		sl_uint32 sizeRingBlock; // size of a block in the ring buffer, used in Packet Ring mode (default: 1MB)
+		sl_uint32 countRingBlocks; // count of the blocks in the ring buffer of each thread, used in Packet Ring mode (default: 64)
+		sl_uint32 timeoutRingBlock; // in milliseconds, the kernel delivers a block not filled after the timeout, used in Packet Ring mode (default: 10)
+		// count of the capturing threads, used in Packet Ring mode (default: 1)
+		// when it is larger than 1, the packets are distributed to the threads by the flow hash (PACKET_FANOUT_HASH), and the callbacks are called in the threads at the same time
+		sl_uint32 countFanoutThreads;
+		
 		sl_bool flagAutoStart; // default: true
 		
 		Ptr<INetCaptureListener> listener;
 		Function<void(NetCapture*, NetCapturePacket*)> onCapturePacket;
+		// called with the packets of a block only in Packet Ring mode, after `onCapturePacket` is called for each packet
+		Function<void(NetCapture*, NetCapturePacket*, sl_uint32)> onCapturePackets;
 		
 	public:
 		NetCaptureParam();
@@ -121,6 +151,9 @@ namespace slib
 		// raw socket
 		static Ref<NetCapture> createRawIPv4(const NetCaptureParam& param);
 		
+		// memory-mapped ring (TPACKET_V3) of linux packet sockets
+		static Ref<NetCapture> createPacketRing(const NetCaptureParam& param);
+		
 	public:
 		virtual void release() = 0;
 		
@@ -137,6 +170,8 @@ namespace slib
 		
 		virtual String getLastErrorMessage();
 		
+		virtual void getStatistics(NetCaptureStatistics& _out);
+		
 		// Pcap Utiltities
 		static List<NetCaptureDeviceInfo> getAllPcapDevices();
 		
@@ -147,9 +182,15 @@ namespace slib
 		
 		void _onCapturePacket(NetCapturePacket* packet);
 		
+		void _onCapturePackets(NetCapturePacket* packets, sl_uint32 count);
+		
 	protected:
 		Ptr<INetCaptureListener> m_listener;
 		Function<void(NetCapture*, NetCapturePacket*)> m_onCapturePacket;
+		Function<void(NetCapture*, NetCapturePacket*, sl_uint32)> m_onCapturePackets;
+		
+		sl_int64 m_countPackets;
+		sl_int64 m_sizePackets;
 		
 	};
 	
@@ -27,6 +27,7 @@
 *****************************************/
 
 #include "http_common.h"
+#include "http2.h"
 #include "http_service.h"
 
 #endif
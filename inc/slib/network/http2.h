@@ -0,0 +1,297 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_NETWORK_HTTP2
+#define CHECKHEADER_SLIB_NETWORK_HTTP2
+
+#include "definition.h"
+
+#include "../core/string.h"
+#include "../core/list.h"
+
+/********************************************************************
+	HTTP/2 from RFC 7540, HPACK from RFC 7541
+
+- Connection Preface (client)
+	"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n" followed by a SETTINGS frame
+
+- Frame Format
+    +-----------------------------------------------+
+    |                 Length (24)                   |
+    +---------------+---------------+---------------+
+    |   Type (8)    |   Flags (8)   |
+    +-+-------------+---------------+-------------------------------+
+    |R|                 Stream Identifier (31)                      |
+    +=+=============================================================+
+    |                   Frame Payload (0...)                      ...
+    +---------------------------------------------------------------+
+
+- HEADERS Frame Payload
+    +---------------+
+    |Pad Length? (8)|
+    +-+-------------+-----------------------------------------------+
+    |E|                 Stream Dependency? (31)                     |
+    +-+-------------+-----------------------------------------------+
+    |  Weight? (8)  |
+    +-+-------------+-----------------------------------------------+
+    |                   Header Block Fragment (*)                 ...
+    +---------------------------------------------------------------+
+    |                           Padding (*)                       ...
+    +---------------------------------------------------------------+
+
+- SETTINGS Frame Payload: repeated
+    +-------------------------------+
+    |       Identifier (16)         |
+    +-------------------------------+-------------------------------+
+    |                        Value (32)                             |
+    +---------------------------------------------------------------+
+
+- HPACK Header Field Representations
+	1xxxxxxx: Indexed Header Field (7-bit index)
+	01xxxxxx: Literal Header Field with Incremental Indexing (6-bit name index)
+	0000xxxx: Literal Header Field without Indexing (4-bit name index)
+	0001xxxx: Literal Header Field Never Indexed (4-bit name index)
+	001xxxxx: Dynamic Table Size Update (5-bit size)
+	String Literal: H(1 bit, Huffman coded) + Length(7-bit prefix) + Octets
+
+********************************************************************/
+
+#define SLIB_HTTP2_CONNECTION_PREFACE "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define SLIB_HTTP2_CONNECTION_PREFACE_SIZE 24
+
+#define SLIB_HTTP2_FRAME_HEADER_SIZE 9
+#define SLIB_HTTP2_DEFAULT_MAX_FRAME_SIZE 16384
+#define SLIB_HTTP2_MAX_FRAME_SIZE 16777215
+#define SLIB_HTTP2_DEFAULT_WINDOW_SIZE 65535
+#define SLIB_HTTP2_MAX_WINDOW_SIZE 0x7fffffff
+#define SLIB_HTTP2_DEFAULT_WEIGHT 16
+
+#define SLIB_HTTP2_FLAG_END_STREAM 0x01
+#define SLIB_HTTP2_FLAG_ACK 0x01
+#define SLIB_HTTP2_FLAG_END_HEADERS 0x04
+#define SLIB_HTTP2_FLAG_PADDED 0x08
+#define SLIB_HTTP2_FLAG_PRIORITY 0x20
+
+#define SLIB_HPACK_DEFAULT_TABLE_SIZE 4096
+#define SLIB_HPACK_STATIC_TABLE_SIZE 61
+// overhead of an entry in the dynamic table
+#define SLIB_HPACK_ENTRY_OVERHEAD 32
+
+namespace slib
+{
+
+	enum class Http2FrameType
+	{
+		Data = 0,
+		Headers = 1,
+		Priority = 2,
+		ResetStream = 3,
+		Settings = 4,
+		PushPromise = 5,
+		Ping = 6,
+		GoAway = 7,
+		WindowUpdate = 8,
+		Continuation = 9
+	};
+
+	enum class Http2ErrorCode
+	{
+		NoError = 0,
+		ProtocolError = 1,
+		InternalError = 2,
+		FlowControlError = 3,
+		SettingsTimeout = 4,
+		StreamClosed = 5,
+		FrameSizeError = 6,
+		RefusedStream = 7,
+		Cancel = 8,
+		CompressionError = 9,
+		ConnectError = 10,
+		EnhanceYourCalm = 11,
+		InadequateSecurity = 12,
+		Http11Required = 13
+	};
+
+	enum class Http2SettingId
+	{
+		HeaderTableSize = 1,
+		EnablePush = 2,
+		MaxConcurrentStreams = 3,
+		InitialWindowSize = 4,
+		MaxFrameSize = 5,
+		MaxHeaderListSize = 6
+	};
+
+	class SLIB_EXPORT Http2FrameHeader
+	{
+	public:
+		// 24 bits, the size of the payload
+		sl_uint32 getLength() const;
+
+		// 24 bits, the size of the payload
+		void setLength(sl_uint32 length);
+
+		Http2FrameType getType() const;
+
+		void setType(Http2FrameType type);
+
+		sl_uint8 getFlags() const;
+
+		void setFlags(sl_uint8 flags);
+
+		sl_bool isFlag(sl_uint8 flag) const;
+
+		// 31 bits
+		sl_uint32 getStreamId() const;
+
+		// 31 bits
+		void setStreamId(sl_uint32 streamId);
+
+		const sl_uint8* getPayload() const;
+
+		sl_uint8* getPayload();
+
+	private:
+		sl_uint8 _length[3];
+		sl_uint8 _type;
+		sl_uint8 _flags;
+		sl_uint8 _streamId[4];
+
+	};
+
+
+	class SLIB_EXPORT HPackHeader
+	{
+	public:
+		String name;
+		String value;
+
+	public:
+		HPackHeader();
+
+		HPackHeader(const String& name, const String& value);
+
+		~HPackHeader();
+
+	public:
+		// the size counted in the dynamic table
+		sl_uint32 getEntrySize() const;
+
+	};
+
+	// entries are indexed from the most recently added one, starting at 0
+	class SLIB_EXPORT HPackDynamicTable
+	{
+	public:
+		HPackDynamicTable();
+
+		~HPackDynamicTable();
+
+	public:
+		sl_uint32 getCount() const;
+
+		sl_uint32 getSize() const;
+
+		sl_uint32 getMaxSize() const;
+
+		// evicts the oldest entries exceeding the new size
+		void setMaxSize(sl_uint32 size);
+
+		const HPackHeader* getEntry(sl_uint32 index) const;
+
+		// an entry larger than the maximum size empties the table
+		void add(const String& name, const String& value);
+
+		// returns the index of the entry matching the name (and the value if possible), -1 if not found
+		sl_int32 find(const String& name, const String& value, sl_bool& outFlagValueMatched) const;
+
+		void clear();
+
+	private:
+		void _evict(sl_uint32 sizeLimit);
+
+	private:
+		HPackHeader* m_entries;
+		sl_uint32 m_capacity;
+		sl_uint32 m_first;
+		sl_uint32 m_count;
+		sl_uint32 m_size;
+		sl_uint32 m_maxSize;
+
+	};
+
+	class SLIB_EXPORT HPack
+	{
+	public:
+		// `index` starts at 1
+		static const HPackHeader* getStaticEntry(sl_uint32 index);
+
+		// returns the index (starting at 1) of the entry matching the name (and the value if possible), 0 if not found
+		static sl_uint32 findStaticEntry(const String& name, const String& value, sl_bool& outFlagValueMatched);
+
+		static sl_size getHuffmanEncodedLength(const void* data, sl_size size);
+
+		static void encodeHuffman(const void* data, sl_size size, sl_uint8* output);
+
+		static sl_bool decodeHuffman(const void* data, sl_size size, String& output);
+
+	};
+
+	class SLIB_EXPORT HPackDecoder
+	{
+	public:
+		HPackDecoder();
+
+		~HPackDecoder();
+
+	public:
+		// SETTINGS_HEADER_TABLE_SIZE announced to the encoder (default: 4096)
+		void setMaxTableSize(sl_uint32 size);
+
+		// limit of the decoded header list including the entry overheads, 0 means unlimited (default: 0)
+		void setMaxHeaderListSize(sl_size size);
+
+		// decodes a complete header block, returns false on a compression error (the connection can't continue)
+		sl_bool decode(const void* data, sl_size size, List<HPackHeader>& outHeaders);
+
+	private:
+		HPackDynamicTable m_table;
+		sl_uint32 m_maxTableSize;
+		sl_size m_maxHeaderListSize;
+
+	};
+
+	class SLIB_EXPORT HPackEncoder
+	{
+	public:
+		HPackEncoder();
+
+		~HPackEncoder();
+
+	public:
+		// applies SETTINGS_HEADER_TABLE_SIZE of the decoder. The encoder uses up to 4096 bytes, and the change is signaled at the start of the next header block
+		void setMaxTableSize(sl_uint32 size);
+
+		// starts a header block
+		void begin(CList<sl_uint8>& output);
+
+		// `name` must be lowercase. The field is added to the dynamic table when `flagIndexing` is true
+		void encode(CList<sl_uint8>& output, const String& name, const String& value, sl_bool flagIndexing = sl_true);
+
+	private:
+		HPackDynamicTable m_table;
+		sl_uint32 m_maxTableSizeAllowed;
+		sl_bool m_flagTableSizeUpdate;
+
+	};
+
+}
+
+#endif
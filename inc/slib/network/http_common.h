@@ -44,6 +44,9 @@
 
 #include "async.h"
 
+// maximum number of the request headers indexed without building the header map
+#define SLIB_HTTP_HEADER_INDEX_SIZE 32
+
 namespace slib
 {
 
@@ -138,6 +141,17 @@ namespace slib
 	};
 	
 	
+	// position of a header in the raw header section, relative to the start of the section
+	class SLIB_EXPORT HttpHeaderSlice
+	{
+	public:
+		sl_uint32 name;
+		sl_uint32 nameLength;
+		sl_uint32 value;
+		sl_uint32 valueLength;
+		
+	};
+	
 	class SLIB_EXPORT HttpHeaders
 	{
 	public:
@@ -147,6 +161,9 @@ namespace slib
 		static const String& AcceptEncoding;
 		static const String& TransferEncoding;
 		static const String& ContentEncoding;
+		static const String& Connection;
+		static const String& Upgrade;
+		static const String& HTTP2Settings;
 		
 		static const String& Range;
 		static const String& ContentRange;
@@ -165,6 +182,13 @@ namespace slib
 		 */
 		static sl_reg parseHeaders(Map<String, String>& outMap, const void* headers, sl_size size);
 		
+		/*
+		 Stores the positions of the names and the values instead of copying them.
+		 `outCount` is set to the number of the headers, which can be greater than `maxCount`.
+		 Returns same as above
+		 */
+		static sl_reg parseHeaders(HttpHeaderSlice* outSlices, sl_uint32 maxCount, sl_uint32& outCount, const void* headers, sl_size size);
+		
 	};
 	
 	
@@ -198,11 +222,17 @@ namespace slib
 		
 		void setRequestVersion(const String& version);
 		
+		// restores the initial state, keeping the containers for reuse
+		void resetRequest();
+		
 		
 		const Map<String, String>& getRequestHeaders() const;
 		
 		String getRequestHeader(String name) const;
 		
+		// `outValue` refers to the raw header section instead of a copy when possible
+		sl_bool getRequestHeaderData(const String& name, StringData& outValue) const;
+		
 		List<String> getRequestHeaderValues(String name) const;
 		
 		void setRequestHeader(String name, String value);
@@ -281,6 +311,14 @@ namespace slib
 		
 		sl_bool containsPostParameter(String name) const;
 		
+		// parameters captured from the path by the router, such as `{id}` in `/users/{id}`
+		const Map<String, String>& getPathParameters() const;
+		
+		String getPathParameter(const String& name) const;
+		
+		// also added to the parameters
+		void setPathParameter(const String& name, const String& value);
+		
 		void applyPostParameters(const void* data, sl_size size);
 		
 		void applyPostParameters(const String& str);
@@ -301,6 +339,20 @@ namespace slib
 		 */
 		sl_reg parseRequestPacket(const void* packet, sl_size size);
 		
+		// keeps `packet` to look up the headers without copying them into the header map
+		sl_reg parseRequestPacket(const Memory& packet);
+		
+	protected:
+		// fills the header map from the index, can be called by several threads reading the request
+		void _buildRequestHeaders() const;
+		
+		// the header map replaces the index to be modified
+		void _detachRequestHeaderIndex();
+		
+		sl_bool _findRequestHeader(const String& name, sl_uint32 start, sl_uint32& outIndex) const;
+		
+		String _getIndexedRequestHeader(sl_uint32 index) const;
+		
 	protected:
 		HttpMethod m_method;
 		String m_methodText;
@@ -309,10 +361,21 @@ namespace slib
 		String m_query;
 		String m_requestVersion;
 		
-		Map<String, String> m_requestHeaders;
+		mutable Map<String, String> m_requestHeaders;
+		
+		// while the index is used, the header map is empty and is built on demand
+		Memory m_requestHeaderPacket;
+		sl_uint32 m_requestHeaderSection;
+		HttpHeaderSlice m_requestHeaderIndex[SLIB_HTTP_HEADER_INDEX_SIZE];
+		sl_uint32 m_nRequestHeaderIndex;
+		sl_bool m_flagRequestHeaderIndex;
+		mutable sl_bool m_flagRequestHeaderMapBuilt;
+		SpinLock m_lockRequestHeaderMap;
+		
 		Map<String, String> m_parameters;
 		Map<String, String> m_queryParameters;
 		Map<String, String> m_postParameters;
+		Map<String, String> m_pathParameters;
 		
 	};
 	
@@ -336,6 +399,9 @@ namespace slib
 		
 		void setResponseVersion(const String& version);
 		
+		// restores the initial state, keeping the containers for reuse
+		void resetResponse();
+		
 		
 		const Map<String, String>& getResponseHeaders() const;
 		
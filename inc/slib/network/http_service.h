@@ -22,6 +22,7 @@ namespace slib
 
 	class HttpService;
 	class HttpServiceConnection;
+	class _Http2ServiceSession;
 	
 	class SLIB_EXPORT HttpServiceContext : public Object, public HttpRequest, public HttpResponse, public HttpOutputBuffer
 	{
@@ -64,6 +65,9 @@ namespace slib
 		
 		void completeResponse();
 		
+		// identifier of the HTTP/2 stream carrying the request, 0 for HTTP/1.x
+		sl_uint32 getStreamId() const;
+		
 	public:
 		SLIB_BOOLEAN_PROPERTY(ClosingConnection);
 		SLIB_BOOLEAN_PROPERTY(ProcessingByThread);
@@ -75,11 +79,16 @@ namespace slib
 		MemoryQueue m_requestBodyBuffer;
 		AtomicMemory m_requestBody;
 		sl_bool m_flagAsynchronousResponse;
+		sl_uint32 m_streamId;
 		
 	private:
 		WeakRef<HttpServiceConnection> m_connection;
 		
+	private:
+		void _reset();
+		
 		friend class HttpServiceConnection;
+		friend class _Http2ServiceSession;
 		
 	};
 	
@@ -133,20 +142,36 @@ namespace slib
 		Ref<AsyncOutput> m_output;
 		
 		AtomicRef<HttpServiceContext> m_contextCurrent;
+		// context of the last request, reused when no one else holds it
+		Ref<HttpServiceContext> m_contextLast;
 		
 		sl_bool m_flagClosed;
 		Memory m_bufRead;
 		sl_bool m_flagReading;
 		
+		// pipelined input following the request being processed
+		Memory m_bufPending;
+		sl_bool m_flagProcessingInline;
+		sl_bool m_flagCompletedInline;
+		
+		// set when the connection is switched to HTTP/2
+		AtomicRef<_Http2ServiceSession> m_http2;
+		
 	protected:
 		void _read();
 		
+		Ref<HttpServiceContext> _createContext();
+		
 		void _processInput(const void* data, sl_uint32 size);
 		
 		void _processContext(const Ref<HttpServiceContext>& context);
 		
 		void _completeResponse(HttpServiceContext* context);
 		
+		void _startHttp2(const void* data, sl_uint32 size);
+		
+		sl_bool _upgradeHttp2(const Ref<HttpServiceContext>& context, const void* data, sl_uint32 size);
+		
 	protected:
 		void onReadStream(AsyncStreamResult* result);
 		
@@ -157,6 +182,7 @@ namespace slib
 		void onAsyncOutputError(AsyncOutput* output);
 		
 		friend class HttpServiceContext;
+		friend class _Http2ServiceSession;
 		
 	};
 	
@@ -199,6 +225,9 @@ namespace slib
 		IPAddress addressBind;
 		sl_uint16 port;
 		
+		// each I/O loop runs on its own thread with its own listener and connections. 0 means the count of the processors (default: 1)
+		sl_uint32 ioLoopsCount;
+		
 		sl_uint32 maxThreadsCount;
 		sl_bool flagProcessByThreads;
 		
@@ -211,6 +240,14 @@ namespace slib
 		sl_bool flagAllowCrossOrigin;
 		sl_bool flagAlwaysRespondAcceptRangesHeader;
 		
+		// sends the files by kernel (sendfile) when the connection supports it
+		sl_bool flagUseSendFile;
+		
+		// accepts HTTP/2 over cleartext TCP (h2c), by prior knowledge or `Upgrade: h2c` (default: true)
+		sl_bool flagUseHttp2;
+		// SETTINGS_MAX_CONCURRENT_STREAMS of HTTP/2 connections (default: 100)
+		sl_uint32 http2MaxConcurrentStreams;
+		
 		sl_bool flagLogDebug;
 		
 		Ptr<IHttpServiceProcessor> processor;
@@ -244,6 +281,8 @@ namespace slib
 		
 		Ref<AsyncIoLoop> getAsyncIoLoop();
 		
+		List< Ref<AsyncIoLoop> > getAsyncIoLoops();
+		
 		Ref<ThreadPool> getThreadPool();
 		
 		const HttpServiceParam& getParam();
@@ -258,6 +297,8 @@ namespace slib
 		virtual sl_bool processAsset(const Ref<HttpServiceContext>& context, const String& path);
 		
 		sl_bool processFile(const Ref<HttpServiceContext>& context, const String& path);
+
+		Ref<AsyncStream> openFile(const Ref<HttpServiceContext>& context, const String& path, sl_bool flagSendFile);
 		
 		sl_bool processRangeRequest(const Ref<HttpServiceContext>& context, sl_uint64 totalLength, const String& range, sl_uint64& outStart, sl_uint64& outLength);
 		
@@ -291,12 +332,16 @@ namespace slib
 	protected:
 		sl_bool _init(const HttpServiceParam& param);
 		
+		Map< HttpServiceConnection*, Ref<HttpServiceConnection> > _getConnectionTable(HttpServiceConnection* connection);
+		
 	protected:
 		AtomicRef<AsyncIoLoop> m_ioLoop;
+		CList< Ref<AsyncIoLoop> > m_ioLoops;
 		AtomicRef<ThreadPool> m_threadPool;
 		sl_bool m_flagRunning;
 		
-		HashMap< HttpServiceConnection*, Ref<HttpServiceConnection> > m_connections;
+		// connection table per I/O loop
+		CList< Map< HttpServiceConnection*, Ref<HttpServiceConnection> > > m_connectionTables;
 		
 		CList< Ptr<IHttpServiceProcessor> > m_processors;
 		AtomicList< Ptr<IHttpServiceProcessor> > m_processorsCached;
@@ -20,6 +20,7 @@
 
 #include "../core/object.h"
 #include "../core/map.h"
+#include "../core/spin_lock.h"
 
 /*
 	If you are usiing kernel-mode NAT on linux (for example on port range 40000~60000), following configuration will avoid to conflict with kernel-networking.
@@ -28,6 +29,8 @@
 		sysctl -w net.ipv4.ip_local_port_range="30000 39000"
 */ 
 
+#define SLIB_NAT_TABLE_SHARDS_COUNT 16
+
 namespace slib
 {
 
@@ -36,7 +39,8 @@ namespace slib
 	public:
 		sl_bool flagActive;
 		SocketAddress addressSource;
-		Time timeLastAccess;
+		// tick count
+		sl_uint32 timeLastAccess;
 		
 	public:
 		_NatTablePort();
@@ -45,6 +49,27 @@ namespace slib
 		
 	};
 	
+	/*
+		The port at the index `i` in the range belongs to the shard `i % (count of shards)`,
+		and the internal address is mapped in the shard selected by its hash,
+		so that the packets of different connections are translated without waiting for each other.
+	*/
+	class _NatTableMappingShard
+	{
+	public:
+		SpinLock lock;
+		FlatHashMap< SocketAddress, sl_uint16 > mapPorts;
+		sl_uint32 nPorts;
+		// the position in the shard to be allocated next
+		sl_uint32 pos;
+		
+	public:
+		_NatTableMappingShard();
+		
+		~_NatTableMappingShard();
+		
+	};
+	
 	class _NatTableMapping : public Object
 	{
 	public:
@@ -53,21 +78,28 @@ namespace slib
 		~_NatTableMapping();
 		
 	public:
-		void setup(sl_uint16 portBegin, sl_uint16 portEnd);
+		// `timeout`: idle time in milliseconds to expire the mappings, 0 means no expiry
+		void setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 timeout);
 		
 		sl_bool mapToExternalPort(const SocketAddress& address, sl_uint16& port);
 		
 		sl_bool mapToInternalAddress(sl_uint16 port, SocketAddress& address);
 		
+		void removeExpiredPorts();
+		
 	protected:
-		HashMap< SocketAddress, sl_uint16 > m_mapPorts;
+		sl_bool _isExpired(_NatTablePort& port, sl_uint32 now);
 		
+	protected:
 		_NatTablePort* m_ports;
-		sl_uint16 m_nPorts;
-		sl_uint16 m_pos;
+		sl_uint32 m_nPorts;
 		
 		sl_uint16 m_portBegin;
 		sl_uint16 m_portEnd;
+		sl_uint32 m_timeout;
+		
+		_NatTableMappingShard m_shards[SLIB_NAT_TABLE_SHARDS_COUNT];
+		sl_uint32 m_nShards;
 		
 	};
 	
@@ -84,6 +116,12 @@ namespace slib
 		
 		sl_uint16 icmpEchoIdentifier;
 		
+		// idle time in milliseconds to expire a TCP mapping (default: 7440000, 2 hours 4 minutes of RFC 5382), 0 means no expiry
+		sl_uint32 tcpMappingTimeout;
+		
+		// idle time in milliseconds to expire a UDP mapping (default: 300000, 5 minutes of RFC 4787), 0 means no expiry
+		sl_uint32 udpMappingTimeout;
+		
 	public:
 		NatTableParam();
 		
@@ -91,6 +129,11 @@ namespace slib
 		
 	};
 	
+	/*
+		NatTable can be used by multiple threads at the same time after `setup()` is called.
+		The checksums are adjusted incrementally (RFC 1624) for the rewritten fields,
+		so they are not verified, and the corrupted packets keep the invalid checksums after the translation.
+	*/
 	class SLIB_EXPORT NatTable : public Object
 	{
 	public:
@@ -110,6 +153,9 @@ namespace slib
 		
 		sl_uint16 getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address);
 		
+		// releases the mappings idle for longer than the timeouts. The expired mappings are also reused when the ports are allocated
+		void removeExpiredMappings();
+		
 	protected:
 		NatTableParam m_param;
 		
@@ -127,6 +173,7 @@ namespace slib
 		
 		HashMap<IcmpEchoAddress, IcmpEchoElement> m_mapIcmpEchoOutgoing;
 		HashMap<sl_uint32, IcmpEchoElement> m_mapIcmpEchoIncoming;
+		SpinLock m_lockIcmpEcho;
 		
 	};
 
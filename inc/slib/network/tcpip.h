@@ -97,6 +97,12 @@ namespace slib
 
 		static sl_uint16 calculateChecksum(const void* data, sl_size size);
 
+		// RFC 1624: returns the checksum adjusted for the 16-bit field changed from `oldValue` to `newValue`
+		static sl_uint16 adjustChecksum(sl_uint16 checksum, sl_uint16 oldValue, sl_uint16 newValue);
+
+		// RFC 1624: returns the checksum adjusted for the address changed from `oldAddress` to `newAddress`
+		static sl_uint16 adjustChecksum(sl_uint16 checksum, const IPv4Address& oldAddress, const IPv4Address& newAddress);
+
 	};
 
 	class SLIB_EXPORT IPv4Packet
@@ -327,6 +333,9 @@ namespace slib
 
 		sl_bool check(IPv4Packet* ip, sl_uint32 sizeContent) const;
 
+		// checks the sizes without verifying the checksum
+		sl_bool checkSize(sl_uint32 sizeContent) const;
+
 		sl_uint16 getUrgentPointer() const;
 		
 		void setUrgentPointer(sl_uint16 urgentPointer);
@@ -385,6 +394,9 @@ namespace slib
 		sl_bool checkChecksum(const IPv4Packet* ipv4) const;
 
 		sl_bool check(IPv4Packet* ip, sl_uint32 sizeContent) const;
+
+		// checks the sizes without verifying the checksum
+		sl_bool checkSize(sl_uint32 sizeContent) const;
 		
 		const sl_uint8* getContent() const;
 		
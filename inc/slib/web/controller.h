@@ -19,11 +19,28 @@
 
 #define SWEB_HANDLER_PARAMS_LIST const slib::Ref<slib::HttpServiceContext>& context, HttpMethod method, const slib::String& path
 
+// maximum number of the parameters captured from a path
+#define SLIB_WEB_ROUTE_MAX_PARAMS 16
+
 namespace slib
 {
 
 	typedef Function<Variant(SWEB_HANDLER_PARAMS_LIST)> WebHandler;
+	
+	class _WebRouteNode;
 
+	/*
+		The handlers are dispatched by a trie of the path segments, which is
+		rebuilt when a handler is registered, and is looked up without
+		allocation.
+	 
+		A segment of the registered path can be
+		 - a literal, matching the same segment
+		 - `{name}`, matching any segment
+		 - `*` or `{name*}` as the last segment, matching the rest of the path
+		Literals take priority over `{name}`, and `{name}` over the wildcard.
+		The captured segments are set as the path parameters of the context.
+	*/
 	class WebController : public Object, public IHttpServiceProcessor
 	{
 		SLIB_DECLARE_OBJECT
@@ -31,6 +48,8 @@ namespace slib
 	protected:
 		WebController();
 		
+		~WebController();
+		
 	public:
 		static Ref<WebController> create();
 		
@@ -42,10 +61,14 @@ namespace slib
 		sl_bool onHttpRequest(const Ref<HttpServiceContext>& context);
 		
 	protected:
-		static String _getHandlerSignature(HttpMethod method, const String& path);
-		
-	protected:
-		TreeMap<String, WebHandler> m_handlers;
+		struct _Route
+		{
+			HttpMethod method;
+			String path;
+			WebHandler handler;
+		};
+		CList<_Route> m_routes;
+		AtomicRef<_WebRouteNode> m_routeRoot;
 		
 		friend class WebModule;
 		
@@ -91,6 +114,7 @@ namespace SWEB_MODULE_##NAME { \
 	slib::Variant NAME(SWEB_HANDLER_PARAMS_LIST)
 
 #define SWEB_STRING_PARAM(NAME) slib::String NAME = context->getParameter(#NAME);
+#define SWEB_PATH_PARAM(NAME) slib::String NAME = context->getPathParameter(#NAME);
 #define SWEB_INT_PARAM(NAME, ...) sl_int32 NAME = context->getParameter(#NAME).parseInt32(10, ##__VA_ARGS__);
 #define SWEB_INT64_PARAM(NAME, ...) sl_int64 NAME = context->getParameter(#NAME).parseInt64(10, ##__VA_ARGS__);
 #define SWEB_FLOAT_PARAM(NAME, ...) float NAME = context->getParameter(#NAME).parseFloat(##__VA_ARGS__);
@@ -8,6 +8,8 @@
  *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include "async_config.h"
+
 #include "../../../inc/slib/core/async.h"
 
 #include "../../../inc/slib/core/safe_static.h"
@@ -132,6 +134,30 @@ namespace slib
 		return addTask(callback);
 	}
 
+	static sl_bool _g_async_io_loop_flagIoUringEnabled = sl_false;
+
+	sl_bool AsyncIoLoop::isIoUringEnabled()
+	{
+		return _g_async_io_loop_flagIoUringEnabled;
+	}
+
+	void AsyncIoLoop::setIoUringEnabled(sl_bool flag)
+	{
+		_g_async_io_loop_flagIoUringEnabled = flag;
+	}
+
+#if !defined(ASYNC_USE_IO_URING)
+	sl_bool AsyncIoLoop::isUsingIoUring()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncIoLoop::submitOperation(AsyncIoInstance* instance, AsyncIoOperation* operation)
+	{
+		return sl_false;
+	}
+#endif
+
 	void AsyncIoLoop::wake()
 	{
 		ObjectLocker lock(this);
@@ -182,7 +208,7 @@ namespace slib
 			LinkedQueue< Function<void()> > tasks;
 			tasks.merge(&m_queueTasks);
 			Function<void()> task;
-			while (m_queueTasks.pop(&task)) {
+			while (tasks.pop(&task)) {
 				task();
 			}
 		}
@@ -212,6 +238,29 @@ namespace slib
 		}
 	}
 
+/*************************************
+		AsyncIoOperation
+**************************************/
+
+	AsyncIoOperation::AsyncIoOperation()
+	{
+		type = AsyncIoOperationType::Read;
+		data = sl_null;
+		size = 0;
+		offset = 0;
+		pollMode = AsyncIoMode::In;
+		result = 0;
+	}
+
+	AsyncIoOperation::~AsyncIoOperation()
+	{
+	}
+
+	sl_bool AsyncIoOperation::isPending() const
+	{
+		return instance.isNotNull();
+	}
+
 /*************************************
 		AsyncIoInstance
 **************************************/
@@ -384,7 +433,7 @@ namespace slib
 		Referable* _userObject,
 		const Function<void(AsyncStreamResult*)>& _callback,
 		sl_bool _flagRead)
-	 : data(_data), size(_size), userObject(_userObject), callback(_callback), flagRead(_flagRead)
+	 : data(_data), size(_size), userObject(_userObject), callback(_callback), flagRead(_flagRead), fileOffset(0)
 	{
 	}
 
@@ -406,6 +455,21 @@ namespace slib
 		return new AsyncStreamRequest(data, size, userObject, callback, sl_false);
 	}
 
+	Ref<AsyncStreamRequest> AsyncStreamRequest::createSendFile(
+		File* file,
+		sl_uint64 offset,
+		sl_uint32 size,
+		Referable* userObject,
+		const Function<void(AsyncStreamResult*)>& callback)
+	{
+		Ref<AsyncStreamRequest> ret = new AsyncStreamRequest(sl_null, size, userObject, callback, sl_false);
+		if (ret.isNotNull()) {
+			ret->file = file;
+			ret->fileOffset = offset;
+		}
+		return ret;
+	}
+
 	void AsyncStreamRequest::runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError)
 	{
 		if (callback.isNotNull()) {
@@ -472,6 +536,26 @@ namespace slib
 		return 0;
 	}
 
+	sl_bool AsyncStreamInstance::isSendFileSupported()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamInstance::sendFile(File* file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		if (!file || size == 0) {
+			return sl_false;
+		}
+		if (!(isSendFileSupported())) {
+			return sl_false;
+		}
+		Ref<AsyncStreamRequest> req = AsyncStreamRequest::createSendFile(file, offset, size, userObject, callback);
+		if (req.isNotNull()) {
+			return addWriteRequest(req);
+		}
+		return sl_false;
+	}
+
 	sl_size AsyncStreamInstance::getWaitingSizeForWrite()
 	{
 		return m_sizeWriteWaiting;
@@ -566,6 +650,16 @@ namespace slib
 		return 0;
 	}
 
+	sl_bool AsyncStream::isSendFileSupported()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStream::sendFile(File* file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		return sl_false;
+	}
+
 	sl_bool AsyncStream::readToMemory(const Memory& mem, const Function<void(AsyncStreamResult*)>& callback)
 	{
 		sl_size size = mem.getSize();
@@ -692,6 +786,31 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamBase::isSendFileSupported()
+	{
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			return instance->isSendFileSupported();
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamBase::sendFile(File* file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			if (instance->sendFile(file, offset, size, callback, userObject)) {
+				loop->requestOrder(instance.get());
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
 	sl_bool AsyncStreamBase::addTask(const Function<void()>& callback)
 	{
 		Ref<AsyncIoLoop> loop = getIoLoop();
@@ -1046,6 +1165,18 @@ namespace slib
 		return AsyncFile::open(path, FileMode::Append, dispatcher);
 	}
 
+#if !defined(ASYNC_USE_IO_URING)
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop)
+	{
+		return sl_null;
+	}
+
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode)
+	{
+		return sl_null;
+	}
+#endif
+
 	Ref<File> AsyncFile::getFile()
 	{
 		return m_file;
@@ -1607,6 +1738,16 @@ namespace slib
 		return m_lengthOutput;
 	}
 
+	sl_bool AsyncOutputBuffer::popElement(Ref<AsyncOutputBufferElement>& outElement)
+	{
+		ObjectLocker lock(this);
+		if (m_queueOutput.pop(&outElement)) {
+			m_lengthOutput -= outElement->getHeader().getSize() + outElement->getBodySize();
+			return sl_true;
+		}
+		return sl_false;
+	}
+
 /**********************************************
 				AsyncOutput
 **********************************************/
@@ -1645,6 +1786,9 @@ namespace slib
 
 		m_bufferCount = 1;
 		m_bufferSize = 0x10000;
+
+		m_offsetFileSending = 0;
+		m_sizeFileSending = 0;
 	}
 
 	AsyncOutput::~AsyncOutput()
@@ -1664,6 +1808,7 @@ namespace slib
 			copy->close();
 		}
 		m_copy.setNull();
+		m_fileSending.setNull();
 		m_streamOutput.setNull();
 	}
 
@@ -1741,6 +1886,21 @@ namespace slib
 			if (sizeBody != 0 && body.isNotNull()) {
 				m_flagWriting = sl_true;
 				m_elementWriting.setNull();
+				if (AsyncFile* file = CastInstance<AsyncFile>(body.get())) {
+					if (m_streamOutput->isSendFileSupported()) {
+						// file contents are directly sent by kernel, without passing through the copy buffers
+						m_fileSending = file->getFile();
+						if (m_fileSending.isNotNull()) {
+							m_offsetFileSending = m_fileSending->getPosition();
+							m_sizeFileSending = sizeBody;
+							if (!(_sendFile())) {
+								m_flagWriting = sl_false;
+								_onError();
+							}
+							return;
+						}
+					}
+				}
 				AsyncCopyParam param;
 				param.source = body;
 				param.target = m_streamOutput;
@@ -1783,6 +1943,47 @@ namespace slib
 		_write(sl_true);
 	}
 
+#define ASYNC_OUTPUT_SEND_FILE_SEGMENT 0x1000000
+
+	sl_bool AsyncOutput::_sendFile()
+	{
+		sl_uint32 size = ASYNC_OUTPUT_SEND_FILE_SEGMENT;
+		if (m_sizeFileSending < size) {
+			size = (sl_uint32)m_sizeFileSending;
+		}
+		return m_streamOutput->sendFile(m_fileSending.get(), m_offsetFileSending, size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onSendFile, this));
+	}
+
+	void AsyncOutput::onSendFile(AsyncStreamResult* result)
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		if (result->flagError || result->size != result->requestSize) {
+			m_flagWriting = sl_false;
+			m_fileSending.setNull();
+			lock.unlock();
+			_onError();
+			return;
+		}
+		m_offsetFileSending += result->size;
+		m_sizeFileSending -= result->size;
+		if (m_sizeFileSending > 0) {
+			if (!(_sendFile())) {
+				m_flagWriting = sl_false;
+				m_fileSending.setNull();
+				lock.unlock();
+				_onError();
+			}
+			return;
+		}
+		m_fileSending.setNull();
+		m_flagWriting = sl_false;
+		lock.unlock();
+		_write(sl_true);
+	}
+
 	void AsyncOutput::_onError()
 	{
 		PtrLocker<IAsyncOutputListener> listener(m_listener);
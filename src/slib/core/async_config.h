@@ -19,10 +19,16 @@
 #define ASYNC_USE_KQUEUE
 #elif defined(SLIB_PLATFORM_IS_LINUX)
 #define ASYNC_USE_EPOLL
+#if !defined(SLIB_PLATFORM_IS_ANDROID)
+// io_uring is tried first when enabled by `AsyncIoLoop::setIoUringEnabled`, and epoll is used otherwise or when it is not available at runtime
+#define ASYNC_USE_IO_URING
+#endif
 #elif defined(SLIB_PLATFORM_IS_FREEBSD)
 #define ASYNC_USE_KEVENT
 #endif
 
 #define ASYNC_MAX_WAIT_EVENT 256
 
+#define ASYNC_IO_URING_ENTRIES 1024
+
 #endif
@@ -30,10 +30,27 @@ namespace slib
 	{
 		int fdEpoll;
 		Ref<PipeEvent> eventWake;
+#if defined(ASYNC_USE_IO_URING)
+		void* uring;
+#endif
 	};
 
 	void* AsyncIoLoop::__createHandle()
 	{
+#if defined(ASYNC_USE_IO_URING)
+		if (isIoUringEnabled()) {
+			void* uring = __createHandle_IoUring();
+			if (uring) {
+				_AsyncIoLoopHandle* handle = new _AsyncIoLoopHandle;
+				if (handle) {
+					handle->fdEpoll = -1;
+					handle->uring = uring;
+					return handle;
+				}
+				__closeHandle_IoUring(uring);
+			}
+		}
+#endif
 		Ref<PipeEvent> pipe = PipeEvent::create();
 		if (pipe.isNull()) {
 			return 0;
@@ -49,6 +66,9 @@ namespace slib
 			if (handle) {
 				handle->fdEpoll = fdEpoll;
 				handle->eventWake = pipe;
+#if defined(ASYNC_USE_IO_URING)
+				handle->uring = sl_null;
+#endif
 				// register wake event
 				epoll_event ev;
 				ev.data.ptr = sl_null;
@@ -66,6 +86,13 @@ namespace slib
 	void AsyncIoLoop::__closeHandle(void* _handle)
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			__closeHandle_IoUring(handle->uring);
+			delete handle;
+			return;
+		}
+#endif
 		::close(handle->fdEpoll);
 		delete handle;
 	}
@@ -73,6 +100,13 @@ namespace slib
 	void AsyncIoLoop::__runLoop()
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+		
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			__runLoop_IoUring(handle->uring);
+			return;
+		}
+#endif
 
 		epoll_event waitEvents[ASYNC_MAX_WAIT_EVENT];
 
@@ -100,6 +134,7 @@ namespace slib
 						desc.flagIn = sl_false;
 						desc.flagOut = sl_false;
 						desc.flagError = sl_false;
+						desc.pOperation = sl_null;
 						int re = ev.events;
 						if (re & (EPOLLIN | EPOLLPRI)) {
 							desc.flagIn = sl_true;
@@ -131,12 +166,23 @@ namespace slib
 	void AsyncIoLoop::__wake()
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			__wake_IoUring(handle->uring);
+			return;
+		}
+#endif
 		handle->eventWake->set();
 	}
 
 	sl_bool AsyncIoLoop::__attachInstance(AsyncIoInstance* instance, AsyncIoMode mode)
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			return __attachInstance_IoUring(handle->uring, instance, mode);
+		}
+#endif
 		int hObject = (int)(instance->getHandle());
 		epoll_event ev;
 		ev.data.ptr = (void*)instance;
@@ -171,12 +217,40 @@ namespace slib
 	void AsyncIoLoop::__detachInstance(AsyncIoInstance* instance)
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			__detachInstance_IoUring(handle->uring, instance);
+			return;
+		}
+#endif
 		int hObject = (int)(instance->getHandle());
 		epoll_event ev;
 		int ret = ::epoll_ctl(handle->fdEpoll, EPOLL_CTL_DEL, hObject, &ev);
 		SLIB_UNUSED(ret);
 	}
 
+#if defined(ASYNC_USE_IO_URING)
+	sl_bool AsyncIoLoop::isUsingIoUring()
+	{
+		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+		if (handle) {
+			return handle->uring != sl_null;
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncIoLoop::submitOperation(AsyncIoInstance* instance, AsyncIoOperation* operation)
+	{
+		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+		if (handle && handle->uring) {
+			if (instance && operation && instance->isOpened() && !(operation->isPending())) {
+				return __submitOperation_IoUring(handle->uring, instance, operation);
+			}
+		}
+		return sl_false;
+	}
+#endif
+
 }
 
 #endif
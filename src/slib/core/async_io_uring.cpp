@@ -0,0 +1,627 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "async_config.h"
+
+#if defined(ASYNC_USE_IO_URING)
+
+#include "../../../inc/slib/core/async.h"
+#include "../../../inc/slib/core/map.h"
+
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <sys/utsname.h>
+#include <linux/io_uring.h>
+
+#ifndef IORING_POLL_ADD_MULTI
+#define IORING_POLL_ADD_MULTI (1U << 0)
+#endif
+#ifndef IORING_CQE_F_MORE
+#define IORING_CQE_F_MORE (1U << 1)
+#endif
+#ifndef IORING_ASYNC_CANCEL_ALL
+#define IORING_ASYNC_CANCEL_ALL (1U << 0)
+#endif
+#ifndef IORING_ASYNC_CANCEL_FD
+#define IORING_ASYNC_CANCEL_FD (1U << 1)
+#endif
+#ifndef IORING_ASYNC_CANCEL_ANY
+#define IORING_ASYNC_CANCEL_ANY (1U << 2)
+#endif
+#ifndef POLLRDHUP
+#define POLLRDHUP 0x2000
+#endif
+
+// user_data of the submissions: (poll id << 2) or operation pointer (aligned by 8 bytes), | tag
+#define IO_URING_TAG_POLL 0
+#define IO_URING_TAG_OPERATION 1
+#define IO_URING_TAG_WAKE 2
+#define IO_URING_TAG_INTERNAL 3
+#define IO_URING_TAG_MASK 3
+
+namespace slib
+{
+
+	struct _AsyncIoUringHandle
+	{
+		int fd;
+
+		sl_uint32* sqHead;
+		sl_uint32* sqTail;
+		sl_uint32 sqMask;
+		sl_uint32 sqEntries;
+		sl_uint32* sqArray;
+		io_uring_sqe* sqes;
+		sl_uint32 sqTailLocal;
+		sl_uint32 nToSubmit;
+
+		sl_uint32* cqHead;
+		sl_uint32* cqTail;
+		sl_uint32 cqMask;
+		io_uring_cqe* cqes;
+
+		void* ptrRing;
+		sl_size sizeRing;
+		sl_size sizeSqes;
+
+		int fdWake;
+		sl_uint64 valueWake;
+
+		// polls are identified by sequence numbers, so that the stale completions of a detached instance are not delivered to another instance at the same address
+		HashMap< sl_uint64, Ref<AsyncIoInstance> > polls;
+		HashMap< AsyncIoInstance*, sl_uint64 > pollIds;
+		sl_uint64 lastPollId;
+		sl_size nOperationsPending;
+	};
+
+	static int _AsyncIoUring_enter(_AsyncIoUringHandle* handle, sl_uint32 nMinComplete)
+	{
+		__atomic_store_n(handle->sqTail, handle->sqTailLocal, __ATOMIC_RELEASE);
+		for (;;) {
+			unsigned int flags = 0;
+			if (nMinComplete) {
+				flags |= IORING_ENTER_GETEVENTS;
+			}
+			int ret = (int)(::syscall(__NR_io_uring_enter, handle->fd, handle->nToSubmit, nMinComplete, flags, sl_null, 0));
+			if (ret >= 0) {
+				if ((sl_uint32)ret >= handle->nToSubmit) {
+					handle->nToSubmit = 0;
+				} else {
+					handle->nToSubmit -= ret;
+				}
+				return ret;
+			}
+			int err = errno;
+			if (err != EINTR) {
+				return -err;
+			}
+		}
+	}
+
+	static io_uring_sqe* _AsyncIoUring_getSqe(_AsyncIoUringHandle* handle)
+	{
+		sl_uint32 head = __atomic_load_n(handle->sqHead, __ATOMIC_ACQUIRE);
+		if (handle->sqTailLocal - head >= handle->sqEntries) {
+			// submission queue is full: flush the prepared entries
+			_AsyncIoUring_enter(handle, 0);
+			head = __atomic_load_n(handle->sqHead, __ATOMIC_ACQUIRE);
+			if (handle->sqTailLocal - head >= handle->sqEntries) {
+				return sl_null;
+			}
+		}
+		sl_uint32 index = handle->sqTailLocal & handle->sqMask;
+		io_uring_sqe* sqe = handle->sqes + index;
+		Base::zeroMemory(sqe, sizeof(io_uring_sqe));
+		handle->sqArray[index] = index;
+		handle->sqTailLocal++;
+		handle->nToSubmit++;
+		return sqe;
+	}
+
+	static sl_uint32 _AsyncIoUring_getPollEvents(AsyncIoMode mode)
+	{
+		switch (mode) {
+			case AsyncIoMode::In:
+				return POLLIN | POLLPRI | POLLRDHUP;
+			case AsyncIoMode::Out:
+				return POLLOUT;
+			case AsyncIoMode::InOut:
+				return POLLIN | POLLPRI | POLLOUT | POLLRDHUP;
+			default:
+				break;
+		}
+		return 0;
+	}
+
+	static sl_bool _AsyncIoUring_addPoll(_AsyncIoUringHandle* handle, int fd, sl_uint32 events, sl_uint64 userData, sl_bool flagMultiShot)
+	{
+		io_uring_sqe* sqe = _AsyncIoUring_getSqe(handle);
+		if (sqe) {
+			sqe->opcode = IORING_OP_POLL_ADD;
+			sqe->fd = fd;
+			sqe->poll32_events = events;
+			if (flagMultiShot) {
+				sqe->len = IORING_POLL_ADD_MULTI;
+			}
+			sqe->user_data = userData;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	static sl_bool _AsyncIoUring_checkKernel()
+	{
+		// multi-shot poll (5.13) and cancellation by descriptor (5.19) are required
+		struct utsname name;
+		if (::uname(&name) != 0) {
+			return sl_false;
+		}
+		int major = 0;
+		int minor = 0;
+		const char* s = name.release;
+		while (*s >= '0' && *s <= '9') {
+			major = major * 10 + (*s - '0');
+			s++;
+		}
+		if (*s == '.') {
+			s++;
+			while (*s >= '0' && *s <= '9') {
+				minor = minor * 10 + (*s - '0');
+				s++;
+			}
+		}
+		return major > 5 || (major == 5 && minor >= 19);
+	}
+
+	void* AsyncIoLoop::__createHandle_IoUring()
+	{
+		if (!(_AsyncIoUring_checkKernel())) {
+			return sl_null;
+		}
+		io_uring_params params;
+		Base::zeroMemory(&params, sizeof(params));
+		int fd = (int)(::syscall(__NR_io_uring_setup, ASYNC_IO_URING_ENTRIES, &params));
+		if (fd < 0) {
+			return sl_null;
+		}
+		if (params.features & IORING_FEAT_SINGLE_MMAP) {
+			sl_size sizeSq = params.sq_off.array + params.sq_entries * sizeof(sl_uint32);
+			sl_size sizeCq = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			sl_size sizeRing = sizeSq > sizeCq ? sizeSq : sizeCq;
+			sl_size sizeSqes = params.sq_entries * sizeof(io_uring_sqe);
+			void* ptrRing = ::mmap(sl_null, sizeRing, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+			if (ptrRing != MAP_FAILED) {
+				void* ptrSqes = ::mmap(sl_null, sizeSqes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+				if (ptrSqes != MAP_FAILED) {
+					int fdWake = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+					if (fdWake >= 0) {
+						_AsyncIoUringHandle* handle = new _AsyncIoUringHandle;
+						if (handle) {
+							sl_uint8* p = (sl_uint8*)ptrRing;
+							handle->fd = fd;
+							handle->sqHead = (sl_uint32*)(p + params.sq_off.head);
+							handle->sqTail = (sl_uint32*)(p + params.sq_off.tail);
+							handle->sqMask = *((sl_uint32*)(p + params.sq_off.ring_mask));
+							handle->sqEntries = *((sl_uint32*)(p + params.sq_off.ring_entries));
+							handle->sqArray = (sl_uint32*)(p + params.sq_off.array);
+							handle->sqes = (io_uring_sqe*)ptrSqes;
+							handle->sqTailLocal = *(handle->sqTail);
+							handle->nToSubmit = 0;
+							handle->cqHead = (sl_uint32*)(p + params.cq_off.head);
+							handle->cqTail = (sl_uint32*)(p + params.cq_off.tail);
+							handle->cqMask = *((sl_uint32*)(p + params.cq_off.ring_mask));
+							handle->cqes = (io_uring_cqe*)(p + params.cq_off.cqes);
+							handle->ptrRing = ptrRing;
+							handle->sizeRing = sizeRing;
+							handle->sizeSqes = sizeSqes;
+							handle->fdWake = fdWake;
+							handle->valueWake = 0;
+							handle->nOperationsPending = 0;
+							handle->lastPollId = 0;
+							if (_AsyncIoUring_addPoll(handle, fdWake, POLLIN, IO_URING_TAG_WAKE, sl_true)) {
+								if (_AsyncIoUring_enter(handle, 0) >= 0) {
+									return handle;
+								}
+							}
+							delete handle;
+						}
+						::close(fdWake);
+					}
+					::munmap(ptrSqes, sizeSqes);
+				}
+				::munmap(ptrRing, sizeRing);
+			}
+		}
+		::close(fd);
+		return sl_null;
+	}
+
+	void AsyncIoLoop::__closeHandle_IoUring(void* _handle)
+	{
+		_AsyncIoUringHandle* handle = (_AsyncIoUringHandle*)_handle;
+		::munmap(handle->sqes, handle->sizeSqes);
+		::munmap(handle->ptrRing, handle->sizeRing);
+		::close(handle->fd);
+		::close(handle->fdWake);
+		delete handle;
+	}
+
+	void AsyncIoLoop::__runLoop_IoUring(void* _handle)
+	{
+		_AsyncIoUringHandle* handle = (_AsyncIoUringHandle*)_handle;
+
+		sl_bool flagCancelled = sl_false;
+
+		for (;;) {
+
+			if (m_flagRunning) {
+				_stepBegin();
+			} else {
+				// cancel all pending requests, to release the instances held by the operations
+				if (!flagCancelled) {
+					flagCancelled = sl_true;
+					handle->polls.removeAll();
+					handle->pollIds.removeAll();
+					io_uring_sqe* sqe = _AsyncIoUring_getSqe(handle);
+					if (sqe) {
+						sqe->opcode = IORING_OP_ASYNC_CANCEL;
+						sqe->fd = -1;
+						sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+						sqe->user_data = IO_URING_TAG_INTERNAL;
+					}
+				}
+				if (!(handle->nOperationsPending)) {
+					_AsyncIoUring_enter(handle, 0);
+					break;
+				}
+			}
+
+			sl_uint32 head = *(handle->cqHead);
+			sl_uint32 tail = __atomic_load_n(handle->cqTail, __ATOMIC_ACQUIRE);
+
+			// submits all the prepared requests in one system call, and waits for the completions
+			if (_AsyncIoUring_enter(handle, head == tail ? 1 : 0) < 0) {
+				if (!m_flagRunning) {
+					break;
+				}
+			}
+
+			tail = __atomic_load_n(handle->cqTail, __ATOMIC_ACQUIRE);
+			if (head == tail) {
+				m_queueInstancesClosed.removeAll();
+			}
+
+			while (head != tail) {
+
+				io_uring_cqe* cqe = handle->cqes + (head & handle->cqMask);
+				sl_uint64 userData = cqe->user_data;
+				sl_int32 res = cqe->res;
+				sl_uint32 flags = cqe->flags;
+				head++;
+				__atomic_store_n(handle->cqHead, head, __ATOMIC_RELEASE);
+
+				void* ptr = (void*)(sl_size)(userData & ~((sl_uint64)IO_URING_TAG_MASK));
+				sl_uint64 idPoll = userData >> 2;
+
+				switch (userData & IO_URING_TAG_MASK) {
+					case IO_URING_TAG_WAKE:
+						{
+							sl_uint64 value;
+							while (::read(handle->fdWake, &value, sizeof(value)) > 0) {
+							}
+							if (!(flags & IORING_CQE_F_MORE)) {
+								_AsyncIoUring_addPoll(handle, handle->fdWake, POLLIN, IO_URING_TAG_WAKE, sl_true);
+							}
+						}
+						break;
+					case IO_URING_TAG_POLL:
+						{
+							Ref<AsyncIoInstance> instance;
+							if (!(handle->polls.get(idPoll, &instance))) {
+								break;
+							}
+							if (instance.isNull() || instance->isClosing()) {
+								break;
+							}
+							if (!(flags & IORING_CQE_F_MORE)) {
+								// multi-shot poll is terminated by kernel
+								_AsyncIoUring_addPoll(handle, (int)(instance->getHandle()), _AsyncIoUring_getPollEvents(instance->getMode()), userData, sl_true);
+							}
+							if (res < 0 || !m_flagRunning) {
+								break;
+							}
+							AsyncIoInstance::EventDesc desc;
+							desc.flagIn = (res & (POLLIN | POLLPRI)) != 0;
+							desc.flagOut = (res & POLLOUT) != 0;
+							desc.flagError = (res & (POLLERR | POLLHUP | POLLRDHUP)) != 0;
+							desc.pOperation = sl_null;
+							instance->onEvent(&desc);
+						}
+						break;
+					case IO_URING_TAG_OPERATION:
+						{
+							AsyncIoOperation* operation = (AsyncIoOperation*)ptr;
+							handle->nOperationsPending--;
+							Ref<AsyncIoInstance> instance = operation->instance;
+							operation->instance.setNull();
+							operation->result = res;
+							if (instance.isNull() || instance->isClosing() || !m_flagRunning) {
+								break;
+							}
+							AsyncIoInstance::EventDesc desc;
+							desc.pOperation = operation;
+							if (operation->type == AsyncIoOperationType::Poll) {
+								desc.flagIn = res > 0 && (res & (POLLIN | POLLPRI)) != 0;
+								desc.flagOut = res > 0 && (res & POLLOUT) != 0;
+								desc.flagError = res < 0 || (res & (POLLERR | POLLHUP | POLLRDHUP)) != 0;
+							} else {
+								desc.flagIn = operation->type == AsyncIoOperationType::Read || operation->type == AsyncIoOperationType::Receive;
+								desc.flagOut = !(desc.flagIn);
+								desc.flagError = res < 0;
+							}
+							instance->onEvent(&desc);
+						}
+						break;
+					default:
+						break;
+				}
+			}
+
+			if (m_flagRunning) {
+				_stepEnd();
+			}
+		}
+	}
+
+	void AsyncIoLoop::__wake_IoUring(void* _handle)
+	{
+		_AsyncIoUringHandle* handle = (_AsyncIoUringHandle*)_handle;
+		sl_uint64 value = 1;
+		ssize_t n = ::write(handle->fdWake, &value, sizeof(value));
+		SLIB_UNUSED(n);
+	}
+
+	sl_bool AsyncIoLoop::__attachInstance_IoUring(void* _handle, AsyncIoInstance* instance, AsyncIoMode mode)
+	{
+		_AsyncIoUringHandle* handle = (_AsyncIoUringHandle*)_handle;
+		instance->setMode(mode);
+		sl_uint32 events = _AsyncIoUring_getPollEvents(mode);
+		if (!events) {
+			// completion based instance
+			return sl_true;
+		}
+		// attaching is requested from any thread, so the poll is registered by a task on the loop thread
+		Ref<AsyncIoInstance> ref = instance;
+		return addTask([handle, ref, events]() {
+			if (ref->isOpened() && !(ref->isClosing())) {
+				sl_uint64 idPoll = ++(handle->lastPollId);
+				if (_AsyncIoUring_addPoll(handle, (int)(ref->getHandle()), events, (idPoll << 2) | IO_URING_TAG_POLL, sl_true)) {
+					handle->polls.put(idPoll, ref);
+					handle->pollIds.put(ref.get(), idPoll);
+				}
+			}
+		});
+	}
+
+	void AsyncIoLoop::__detachInstance_IoUring(void* _handle, AsyncIoInstance* instance)
+	{
+		_AsyncIoUringHandle* handle = (_AsyncIoUringHandle*)_handle;
+		sl_uint64 idPoll;
+		if (handle->pollIds.remove(instance, &idPoll)) {
+			handle->polls.remove(idPoll);
+			io_uring_sqe* sqe = _AsyncIoUring_getSqe(handle);
+			if (sqe) {
+				sqe->opcode = IORING_OP_POLL_REMOVE;
+				sqe->fd = -1;
+				sqe->addr = (idPoll << 2) | IO_URING_TAG_POLL;
+				sqe->user_data = IO_URING_TAG_INTERNAL;
+			}
+		}
+		io_uring_sqe* sqe = _AsyncIoUring_getSqe(handle);
+		if (sqe) {
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->fd = (int)(instance->getHandle());
+			sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+			sqe->user_data = IO_URING_TAG_INTERNAL;
+		}
+		// should be submitted before the descriptor is closed
+		_AsyncIoUring_enter(handle, 0);
+	}
+
+	sl_bool AsyncIoLoop::__submitOperation_IoUring(void* _handle, AsyncIoInstance* instance, AsyncIoOperation* operation)
+	{
+		_AsyncIoUringHandle* handle = (_AsyncIoUringHandle*)_handle;
+		io_uring_sqe* sqe = _AsyncIoUring_getSqe(handle);
+		if (!sqe) {
+			return sl_false;
+		}
+		sqe->fd = (int)(instance->getHandle());
+		switch (operation->type) {
+			case AsyncIoOperationType::Read:
+				sqe->opcode = IORING_OP_READ;
+				sqe->addr = (sl_uint64)(sl_size)(operation->data);
+				sqe->len = operation->size;
+				sqe->off = operation->offset;
+				break;
+			case AsyncIoOperationType::Write:
+				sqe->opcode = IORING_OP_WRITE;
+				sqe->addr = (sl_uint64)(sl_size)(operation->data);
+				sqe->len = operation->size;
+				sqe->off = operation->offset;
+				break;
+			case AsyncIoOperationType::Receive:
+				sqe->opcode = IORING_OP_RECV;
+				sqe->addr = (sl_uint64)(sl_size)(operation->data);
+				sqe->len = operation->size;
+				break;
+			case AsyncIoOperationType::Send:
+				sqe->opcode = IORING_OP_SEND;
+				sqe->addr = (sl_uint64)(sl_size)(operation->data);
+				sqe->len = operation->size;
+				sqe->msg_flags = MSG_NOSIGNAL;
+				break;
+			case AsyncIoOperationType::Poll:
+				sqe->opcode = IORING_OP_POLL_ADD;
+				sqe->poll32_events = _AsyncIoUring_getPollEvents(operation->pollMode);
+				break;
+		}
+		sqe->user_data = (sl_uint64)(sl_size)operation | IO_URING_TAG_OPERATION;
+		operation->instance = instance;
+		operation->result = 0;
+		handle->nOperationsPending++;
+		return sl_true;
+	}
+
+
+	class _IoUringAsyncFileStreamInstance : public AsyncStreamInstance
+	{
+	public:
+		Ref<File> m_file;
+		Ref<AsyncStreamRequest> m_requestOperating;
+		sl_uint64 m_offset;
+		AsyncIoOperation m_operation;
+
+	public:
+		_IoUringAsyncFileStreamInstance()
+		{
+			m_offset = 0;
+		}
+
+		~_IoUringAsyncFileStreamInstance()
+		{
+			close();
+		}
+
+	public:
+		static Ref<_IoUringAsyncFileStreamInstance> open(const String& path, FileMode mode)
+		{
+			Ref<File> file = File::open(path, mode);
+			if (file.isNotNull()) {
+				Ref<_IoUringAsyncFileStreamInstance> ret = new _IoUringAsyncFileStreamInstance;
+				if (ret.isNotNull()) {
+					ret->m_file = file;
+					ret->setHandle(file->getHandle());
+					if (mode == FileMode::Append) {
+						ret->m_offset = file->getSize();
+					}
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+
+		void close()
+		{
+			setHandle(SLIB_FILE_INVALID_HANDLE);
+			m_file.setNull();
+		}
+
+		void onOrder()
+		{
+			if (m_operation.isPending()) {
+				return;
+			}
+			Ref<AsyncIoLoop> loop = getLoop();
+			if (loop.isNull()) {
+				return;
+			}
+			Ref<AsyncStreamRequest> req;
+			if (popReadRequest(req)) {
+				m_operation.type = AsyncIoOperationType::Read;
+			} else if (popWriteRequest(req)) {
+				m_operation.type = AsyncIoOperationType::Write;
+			} else {
+				return;
+			}
+			if (req.isNull()) {
+				return;
+			}
+			m_operation.data = req->data;
+			m_operation.size = req->size;
+			m_operation.offset = m_offset;
+			m_requestOperating = req;
+			if (!(loop->submitOperation(this, &m_operation))) {
+				m_requestOperating.setNull();
+				_runCallback(req.get(), 0, sl_true);
+			}
+		}
+
+		void onEvent(EventDesc* pev)
+		{
+			if (pev->pOperation != &m_operation) {
+				return;
+			}
+			Ref<AsyncStreamRequest> req = m_requestOperating;
+			m_requestOperating.setNull();
+			sl_int32 n = m_operation.result;
+			if (n > 0) {
+				m_offset += n;
+			}
+			if (req.isNotNull()) {
+				if (n > 0) {
+					_runCallback(req.get(), n, sl_false);
+				} else {
+					_runCallback(req.get(), 0, sl_true);
+				}
+			}
+			onOrder();
+		}
+
+		void _runCallback(AsyncStreamRequest* req, sl_uint32 size, sl_bool flagError)
+		{
+			Ref<AsyncIoObject> object = getObject();
+			if (object.isNotNull()) {
+				req->runCallback(static_cast<AsyncStream*>(object.get()), size, flagError);
+			}
+		}
+
+		sl_bool isSeekable()
+		{
+			return sl_true;
+		}
+
+		sl_bool seek(sl_uint64 pos)
+		{
+			m_offset = pos;
+			return sl_true;
+		}
+
+		sl_uint64 getSize()
+		{
+			return File::getSize(getHandle());
+		}
+
+	};
+
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop)
+	{
+		if (loop.isNotNull() && loop->isUsingIoUring()) {
+			Ref<_IoUringAsyncFileStreamInstance> ret = _IoUringAsyncFileStreamInstance::open(path, mode);
+			if (ret.isNotNull()) {
+				return AsyncStream::create(ret.get(), AsyncIoMode::None, loop);
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode)
+	{
+		return AsyncFile::openIoUring(path, mode, AsyncIoLoop::getDefault());
+	}
+
+}
+
+#endif
@@ -86,6 +86,7 @@ namespace slib
 						desc.flagIn = sl_false;
 						desc.flagOut = sl_false;
 						desc.flagError = sl_false;
+						desc.pOperation = sl_null;
 						int re = ev.filter;
 						if (re == EVFILT_READ) {
 							desc.flagIn = sl_true;
@@ -0,0 +1,592 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/core/file_btree.h"
+
+#include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/hash.h"
+#include "../../../inc/slib/core/scoped.h"
+
+/*
+	Header (page 0)
+
+	0: "SLBTREE" + version
+	8: pageSize (32 bits)
+	12: keySize (32 bits)
+	16: valueSize (32 bits)
+	24: number of pages (64 bits)
+	32: root page (64 bits)
+	40: first free page (64 bits)
+
+	Write-ahead log (`path.wal`)
+
+	0: magic (32 bits), pageSize (32 bits), number of records (64 bits)
+	16: records: page number (64 bits) + page data
+	trailer: checksum of the above (64 bits), commit magic (32 bits), 0 (32 bits)
+*/
+
+#define _FILE_BTREE_SIGNATURE "SLBTREE\x01"
+#define _FILE_BTREE_HEADER_SIZE 48
+#define _FILE_BTREE_MIN_PAGE_SIZE 64
+#define _FILE_BTREE_MAX_PAGE_SIZE 0x1000000
+#define _FILE_BTREE_MIN_CACHED_PAGES 8
+#define _FILE_BTREE_LOG_MAGIC 0x4C57424C
+#define _FILE_BTREE_LOG_COMMIT 0x54494D43
+
+namespace slib
+{
+
+	class _FileBTreePage
+	{
+	public:
+		sl_uint64 number;
+		sl_uint8* data;
+		sl_bool flagDirty;
+		_FileBTreePage* prev;
+		_FileBTreePage* next;
+
+	public:
+		static _FileBTreePage* create(sl_uint64 number, sl_uint32 size)
+		{
+			_FileBTreePage* page = (_FileBTreePage*)(Base::createMemory(sizeof(_FileBTreePage) + size));
+			if (page) {
+				page->number = number;
+				page->data = (sl_uint8*)(page + 1);
+				page->flagDirty = sl_false;
+				page->prev = sl_null;
+				page->next = sl_null;
+			}
+			return page;
+		}
+
+		static void free(_FileBTreePage* page)
+		{
+			Base::freeMemory(page);
+		}
+
+	};
+
+	FileBTreeParam::FileBTreeParam()
+	{
+		pageSize = 4096;
+		cachedPagesCount = 1024;
+		maximumDirtyPagesCount = 4096;
+		flagWriteAheadLog = sl_true;
+	}
+
+	FileBTreeParam::~FileBTreeParam()
+	{
+	}
+
+
+	FileBTreePager::FileBTreePager()
+	{
+		m_pageSize = 0;
+		m_nCachedPagesMax = 0;
+		m_nDirtyPagesMax = 0;
+		m_keySize = 0;
+		m_valueSize = 0;
+
+		m_nPages = 0;
+		m_pageRoot = 0;
+		m_pageFree = 0;
+		m_flagHeaderModified = sl_false;
+		m_nPagesInFile = 0;
+
+		m_pageCleanFirst = sl_null;
+		m_pageCleanLast = sl_null;
+		m_nCleanPages = 0;
+		m_pageDirtyFirst = sl_null;
+		m_pageDirtyLast = sl_null;
+		m_nDirtyPages = 0;
+	}
+
+	FileBTreePager::~FileBTreePager()
+	{
+		_freeCache();
+	}
+
+	sl_bool FileBTreePager::open(const FileBTreeParam& param, sl_uint32 keySize, sl_uint32 valueSize)
+	{
+		close();
+
+		sl_uint32 pageSize = param.pageSize;
+		if (pageSize < _FILE_BTREE_MIN_PAGE_SIZE || pageSize > _FILE_BTREE_MAX_PAGE_SIZE) {
+			return sl_false;
+		}
+		Ref<File> file = File::open(param.path, FileMode::RandomAccess);
+		if (file.isNull()) {
+			return sl_false;
+		}
+		if (!(file->lock())) {
+			return sl_false;
+		}
+		m_file = file;
+		m_pageSize = pageSize;
+		m_nCachedPagesMax = param.cachedPagesCount;
+		if (m_nCachedPagesMax < _FILE_BTREE_MIN_CACHED_PAGES) {
+			m_nCachedPagesMax = _FILE_BTREE_MIN_CACHED_PAGES;
+		}
+		m_nDirtyPagesMax = param.maximumDirtyPagesCount;
+		m_keySize = keySize;
+		m_valueSize = valueSize;
+
+		String pathLog = param.path + ".wal";
+		if (param.flagWriteAheadLog || File::exists(pathLog)) {
+			m_fileLog = File::open(pathLog, FileMode::RandomAccess);
+			if (m_fileLog.isNull() || !(_recoverLog())) {
+				close();
+				return sl_false;
+			}
+			if (!(param.flagWriteAheadLog)) {
+				m_fileLog.setNull();
+				File::deleteFile(pathLog);
+			}
+		}
+
+		sl_uint64 size = file->getSize();
+		if (size) {
+			sl_uint8 header[_FILE_BTREE_HEADER_SIZE];
+			if (!(file->seek(0, SeekPosition::Begin)) || file->readFully(header, _FILE_BTREE_HEADER_SIZE) != _FILE_BTREE_HEADER_SIZE) {
+				close();
+				return sl_false;
+			}
+			if (!(Base::equalsMemory(header, _FILE_BTREE_SIGNATURE, 8)) || MIO::readUint32LE(header + 8) != pageSize || MIO::readUint32LE(header + 12) != keySize || MIO::readUint32LE(header + 16) != valueSize) {
+				close();
+				return sl_false;
+			}
+			m_nPages = MIO::readUint64LE(header + 24);
+			m_pageRoot = MIO::readUint64LE(header + 32);
+			m_pageFree = MIO::readUint64LE(header + 40);
+			m_nPagesInFile = (size + pageSize - 1) / pageSize;
+			if (m_nPages < 1 || m_pageRoot >= m_nPages || m_pageFree >= m_nPages) {
+				close();
+				return sl_false;
+			}
+			m_flagHeaderModified = sl_false;
+		} else {
+			m_nPages = 1;
+			m_pageRoot = 0;
+			m_pageFree = 0;
+			m_nPagesInFile = 0;
+			m_flagHeaderModified = sl_true;
+		}
+		return sl_true;
+	}
+
+	void FileBTreePager::close()
+	{
+		_freeCache();
+		m_file.setNull();
+		m_fileLog.setNull();
+		m_nPages = 0;
+		m_pageRoot = 0;
+		m_pageFree = 0;
+		m_flagHeaderModified = sl_false;
+		m_nPagesInFile = 0;
+	}
+
+	sl_bool FileBTreePager::isOpened() const
+	{
+		return m_file.isNotNull();
+	}
+
+	sl_uint32 FileBTreePager::getPageSize() const
+	{
+		return m_pageSize;
+	}
+
+	sl_uint64 FileBTreePager::getRootPage() const
+	{
+		return m_pageRoot;
+	}
+
+	void FileBTreePager::setRootPage(sl_uint64 page)
+	{
+		m_pageRoot = page;
+		m_flagHeaderModified = sl_true;
+	}
+
+	sl_uint64 FileBTreePager::allocatePage()
+	{
+		if (m_file.isNull()) {
+			return 0;
+		}
+		sl_uint64 number;
+		if (m_pageFree) {
+			number = m_pageFree;
+			sl_uint8* data = writePage(number);
+			if (!data) {
+				return 0;
+			}
+			m_pageFree = MIO::readUint64LE(data);
+			Base::zeroMemory(data, m_pageSize);
+		} else {
+			number = m_nPages;
+			m_nPages++;
+			sl_uint8* data = writePage(number);
+			if (!data) {
+				m_nPages--;
+				return 0;
+			}
+		}
+		m_flagHeaderModified = sl_true;
+		return number;
+	}
+
+	sl_bool FileBTreePager::freePage(sl_uint64 number)
+	{
+		sl_uint8* data = writePage(number);
+		if (!data) {
+			return sl_false;
+		}
+		MIO::writeUint64LE(data, m_pageFree);
+		m_pageFree = number;
+		m_flagHeaderModified = sl_true;
+		return sl_true;
+	}
+
+	const sl_uint8* FileBTreePager::readPage(sl_uint64 number)
+	{
+		if (number == 0 || number >= m_nPages) {
+			return sl_null;
+		}
+		_FileBTreePage* page = _getPage(number, sl_true);
+		if (page) {
+			return page->data;
+		}
+		return sl_null;
+	}
+
+	sl_uint8* FileBTreePager::writePage(sl_uint64 number)
+	{
+		if (number == 0 || number >= m_nPages) {
+			return sl_null;
+		}
+		_FileBTreePage* page = _getPage(number, sl_true);
+		if (page) {
+			if (!(page->flagDirty)) {
+				_unlinkPage(page, m_pageCleanFirst, m_pageCleanLast);
+				m_nCleanPages--;
+				_linkPage(page, m_pageDirtyFirst, m_pageDirtyLast);
+				page->flagDirty = sl_true;
+				m_nDirtyPages++;
+			}
+			return page->data;
+		}
+		return sl_null;
+	}
+
+	sl_bool FileBTreePager::flush()
+	{
+		File* file = m_file.get();
+		if (!file) {
+			return sl_false;
+		}
+		if (!m_pageDirtyFirst && !m_flagHeaderModified) {
+			return sl_true;
+		}
+		if (m_fileLog.isNotNull()) {
+			if (!(_writeLog())) {
+				return sl_false;
+			}
+		}
+		_FileBTreePage* page = m_pageDirtyFirst;
+		while (page) {
+			if (!(file->seek(page->number * m_pageSize, SeekPosition::Begin))) {
+				return sl_false;
+			}
+			if (file->writeFully(page->data, m_pageSize) != (sl_reg)m_pageSize) {
+				return sl_false;
+			}
+			page = page->next;
+		}
+		{
+			SLIB_SCOPED_BUFFER(sl_uint8, 4096, header, m_pageSize);
+			if (!header) {
+				return sl_false;
+			}
+			_writeHeader(header);
+			if (!(file->seek(0, SeekPosition::Begin))) {
+				return sl_false;
+			}
+			if (file->writeFully(header, m_pageSize) != (sl_reg)m_pageSize) {
+				return sl_false;
+			}
+		}
+		if (!(file->flush())) {
+			return sl_false;
+		}
+		if (m_fileLog.isNotNull()) {
+			m_fileLog->setSize(0);
+		}
+		m_nPagesInFile = m_nPages;
+		m_flagHeaderModified = sl_false;
+		// the flushed pages become the most recently used clean pages
+		page = m_pageDirtyLast;
+		while (page) {
+			_FileBTreePage* prev = page->prev;
+			page->flagDirty = sl_false;
+			_unlinkPage(page, m_pageDirtyFirst, m_pageDirtyLast);
+			_linkPage(page, m_pageCleanFirst, m_pageCleanLast);
+			m_nCleanPages++;
+			page = prev;
+		}
+		m_nDirtyPages = 0;
+		_shrinkCache();
+		return sl_true;
+	}
+
+	sl_uint32 FileBTreePager::getDirtyPagesCount() const
+	{
+		return m_nDirtyPages;
+	}
+
+	sl_bool FileBTreePager::checkDirtyPages()
+	{
+		if (m_nDirtyPagesMax && m_nDirtyPages > m_nDirtyPagesMax) {
+			return flush();
+		}
+		return sl_true;
+	}
+
+	_FileBTreePage* FileBTreePager::_getPage(sl_uint64 number, sl_bool flagLoad)
+	{
+		_FileBTreePage* page;
+		if (m_mapPages.get(number, &page)) {
+			if (!(page->flagDirty) && page != m_pageCleanFirst) {
+				_unlinkPage(page, m_pageCleanFirst, m_pageCleanLast);
+				_linkPage(page, m_pageCleanFirst, m_pageCleanLast);
+			}
+			return page;
+		}
+		page = _FileBTreePage::create(number, m_pageSize);
+		if (!page) {
+			return sl_null;
+		}
+		if (flagLoad && number < m_nPagesInFile) {
+			File* file = m_file.get();
+			if (!(file->seek(number * m_pageSize, SeekPosition::Begin))) {
+				_FileBTreePage::free(page);
+				return sl_null;
+			}
+			sl_reg n = file->readFully(page->data, m_pageSize);
+			if (n < 0) {
+				_FileBTreePage::free(page);
+				return sl_null;
+			}
+			if ((sl_uint32)n < m_pageSize) {
+				Base::zeroMemory(page->data + n, m_pageSize - (sl_uint32)n);
+			}
+		} else {
+			Base::zeroMemory(page->data, m_pageSize);
+		}
+		if (!(m_mapPages.put(number, page))) {
+			_FileBTreePage::free(page);
+			return sl_null;
+		}
+		_linkPage(page, m_pageCleanFirst, m_pageCleanLast);
+		m_nCleanPages++;
+		_shrinkCache();
+		return page;
+	}
+
+	void FileBTreePager::_linkPage(_FileBTreePage* page, _FileBTreePage*& head, _FileBTreePage*& tail)
+	{
+		page->prev = sl_null;
+		page->next = head;
+		if (head) {
+			head->prev = page;
+		} else {
+			tail = page;
+		}
+		head = page;
+	}
+
+	void FileBTreePager::_unlinkPage(_FileBTreePage* page, _FileBTreePage*& head, _FileBTreePage*& tail)
+	{
+		if (page->prev) {
+			page->prev->next = page->next;
+		} else {
+			head = page->next;
+		}
+		if (page->next) {
+			page->next->prev = page->prev;
+		} else {
+			tail = page->prev;
+		}
+		page->prev = sl_null;
+		page->next = sl_null;
+	}
+
+	void FileBTreePager::_shrinkCache()
+	{
+		while (m_nCleanPages > m_nCachedPagesMax) {
+			_FileBTreePage* page = m_pageCleanLast;
+			_unlinkPage(page, m_pageCleanFirst, m_pageCleanLast);
+			m_nCleanPages--;
+			m_mapPages.remove(page->number);
+			_FileBTreePage::free(page);
+		}
+	}
+
+	sl_bool FileBTreePager::_writeLog()
+	{
+		File* file = m_fileLog.get();
+		if (!(file->seek(0, SeekPosition::Begin))) {
+			return sl_false;
+		}
+		sl_uint64 nRecords = 1;
+		_FileBTreePage* page = m_pageDirtyFirst;
+		while (page) {
+			nRecords++;
+			page = page->next;
+		}
+		sl_uint8 buf[16];
+		MIO::writeUint32LE(buf, _FILE_BTREE_LOG_MAGIC);
+		MIO::writeUint32LE(buf + 4, m_pageSize);
+		MIO::writeUint64LE(buf + 8, nRecords);
+		if (file->writeFully(buf, 16) != 16) {
+			return sl_false;
+		}
+		sl_uint64 checksum = HashBytes64(buf, 16);
+		SLIB_SCOPED_BUFFER(sl_uint8, 4096, header, m_pageSize);
+		if (!header) {
+			return sl_false;
+		}
+		_writeHeader(header);
+		sl_uint64 number = 0;
+		const sl_uint8* data = header;
+		page = m_pageDirtyFirst;
+		for (;;) {
+			MIO::writeUint64LE(buf, number);
+			if (file->writeFully(buf, 8) != 8) {
+				return sl_false;
+			}
+			if (file->writeFully(data, m_pageSize) != (sl_reg)m_pageSize) {
+				return sl_false;
+			}
+			checksum = HashBytes64(buf, 8, checksum);
+			checksum = HashBytes64(data, m_pageSize, checksum);
+			if (!page) {
+				break;
+			}
+			number = page->number;
+			data = page->data;
+			page = page->next;
+		}
+		MIO::writeUint64LE(buf, checksum);
+		MIO::writeUint32LE(buf + 8, _FILE_BTREE_LOG_COMMIT);
+		MIO::writeUint32LE(buf + 12, 0);
+		if (file->writeFully(buf, 16) != 16) {
+			return sl_false;
+		}
+		return file->flush();
+	}
+
+	sl_bool FileBTreePager::_recoverLog()
+	{
+		File* log = m_fileLog.get();
+		File* file = m_file.get();
+		sl_uint64 size = log->getSize();
+		if (!size) {
+			return sl_true;
+		}
+		// verifies the log, and applies it only if it was completely written
+		sl_bool flagValid = sl_false;
+		sl_uint8 buf[16];
+		sl_uint64 nRecords = 0;
+		if (log->seek(0, SeekPosition::Begin) && log->readFully(buf, 16) == 16) {
+			nRecords = MIO::readUint64LE(buf + 8);
+			if (MIO::readUint32LE(buf) == _FILE_BTREE_LOG_MAGIC && MIO::readUint32LE(buf + 4) == m_pageSize && nRecords && nRecords <= (size - 16) / (m_pageSize + 8)) {
+				flagValid = sl_true;
+			}
+		}
+		if (!flagValid) {
+			return log->setSize(0);
+		}
+		Memory mem = Memory::create(m_pageSize);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		sl_uint8* data = (sl_uint8*)(mem.getData());
+		for (int iPass = 0; iPass < 2; iPass++) {
+			sl_uint64 checksum = HashBytes64(buf, 16);
+			if (!(log->seek(16, SeekPosition::Begin))) {
+				return sl_false;
+			}
+			for (sl_uint64 i = 0; i < nRecords; i++) {
+				sl_uint8 bufNumber[8];
+				if (log->readFully(bufNumber, 8) != 8 || log->readFully(data, m_pageSize) != (sl_reg)m_pageSize) {
+					return sl_false;
+				}
+				if (iPass) {
+					sl_uint64 number = MIO::readUint64LE(bufNumber);
+					if (!(file->seek(number * m_pageSize, SeekPosition::Begin))) {
+						return sl_false;
+					}
+					if (file->writeFully(data, m_pageSize) != (sl_reg)m_pageSize) {
+						return sl_false;
+					}
+				} else {
+					checksum = HashBytes64(bufNumber, 8, checksum);
+					checksum = HashBytes64(data, m_pageSize, checksum);
+				}
+			}
+			if (!iPass) {
+				sl_uint8 trailer[16];
+				if (log->readFully(trailer, 16) != 16 || MIO::readUint64LE(trailer) != checksum || MIO::readUint32LE(trailer + 8) != _FILE_BTREE_LOG_COMMIT) {
+					// the crash happened before the commit
+					return log->setSize(0);
+				}
+			}
+		}
+		if (!(file->flush())) {
+			return sl_false;
+		}
+		return log->setSize(0);
+	}
+
+	void FileBTreePager::_writeHeader(sl_uint8* buf)
+	{
+		Base::zeroMemory(buf, m_pageSize);
+		Base::copyMemory(buf, _FILE_BTREE_SIGNATURE, 8);
+		MIO::writeUint32LE(buf + 8, m_pageSize);
+		MIO::writeUint32LE(buf + 12, m_keySize);
+		MIO::writeUint32LE(buf + 16, m_valueSize);
+		MIO::writeUint64LE(buf + 24, m_nPages);
+		MIO::writeUint64LE(buf + 32, m_pageRoot);
+		MIO::writeUint64LE(buf + 40, m_pageFree);
+	}
+
+	void FileBTreePager::_freeCache()
+	{
+		_FileBTreePage* page = m_pageCleanFirst;
+		while (page) {
+			_FileBTreePage* next = page->next;
+			_FileBTreePage::free(page);
+			page = next;
+		}
+		page = m_pageDirtyFirst;
+		while (page) {
+			_FileBTreePage* next = page->next;
+			_FileBTreePage::free(page);
+			page = next;
+		}
+		m_pageCleanFirst = sl_null;
+		m_pageCleanLast = sl_null;
+		m_nCleanPages = 0;
+		m_pageDirtyFirst = sl_null;
+		m_pageDirtyLast = sl_null;
+		m_nDirtyPages = 0;
+		m_mapPages.removeAll();
+	}
+
+}
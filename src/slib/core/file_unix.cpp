@@ -179,6 +179,15 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool File::flush()
+	{
+		if (isOpened()) {
+			int fd = (int)m_file;
+			return 0 == ::fsync(fd);
+		}
+		return sl_false;
+	}
+
 	sl_int32 File::read32(void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -177,6 +177,17 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool File::flush()
+	{
+		HANDLE handle = (HANDLE)m_file;
+		if (handle != (HANDLE)SLIB_FILE_INVALID_HANDLE) {
+			if (::FlushFileBuffers(handle)) {
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
 	sl_int32 File::read32(void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -10,19 +10,130 @@
 
 #include "../../../inc/slib/core/hash.h"
 
+#include "../../../inc/slib/core/base.h"
+#include "../../../inc/slib/core/math.h"
+
+#if defined(SLIB_COMPILER_IS_VC) && defined(SLIB_ARCH_IS_X64)
+#include <intrin.h>
+#endif
+
 namespace slib
 {
-	// based on adler32
-	sl_uint32 HashBytes(const void* _buf, sl_size n)
-	{
-#define MOD_ADLER 65521
-		sl_uint8* buf = (sl_uint8*)_buf;
-		sl_uint32 a = 1, b = 0;
-		for (sl_size i = 0; i < n; i++) {
-			a = (a + buf[i]) % MOD_ADLER;
-			b = (b + a) % MOD_ADLER;
+
+	// based on wyhash (public domain, Wang Yi)
+	
+	SLIB_INLINE static void _Hash_mum(sl_uint64* a, sl_uint64* b)
+	{
+#if defined(SLIB_COMPILER_IS_GCC) && defined(__SIZEOF_INT128__)
+		unsigned __int128 r = *a;
+		r *= *b;
+		*a = (sl_uint64)r;
+		*b = (sl_uint64)(r >> 64);
+#elif defined(SLIB_COMPILER_IS_VC) && defined(SLIB_ARCH_IS_X64)
+		*a = _umul128(*a, *b, b);
+#else
+		sl_uint64 ha = *a >> 32, hb = *b >> 32, la = (sl_uint32)*a, lb = (sl_uint32)*b;
+		sl_uint64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+		sl_uint64 t = rl + (rm0 << 32);
+		sl_uint64 c = t < rl;
+		sl_uint64 lo = t + (rm1 << 32);
+		c += lo < t;
+		sl_uint64 hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+		*a = lo;
+		*b = hi;
+#endif
+	}
+	
+	SLIB_INLINE static sl_uint64 _Hash_mix(sl_uint64 a, sl_uint64 b)
+	{
+		_Hash_mum(&a, &b);
+		return a ^ b;
+	}
+	
+	SLIB_INLINE static sl_uint64 _Hash_read8(const sl_uint8* p)
+	{
+		sl_uint64 v;
+		Base::copyMemory(&v, p, 8);
+		return v;
+	}
+	
+	SLIB_INLINE static sl_uint64 _Hash_read4(const sl_uint8* p)
+	{
+		sl_uint32 v;
+		Base::copyMemory(&v, p, 4);
+		return v;
+	}
+	
+	SLIB_INLINE static sl_uint64 _Hash_read3(const sl_uint8* p, sl_size k)
+	{
+		return (((sl_uint64)(p[0])) << 16) | (((sl_uint64)(p[k >> 1])) << 8) | p[k - 1];
+	}
+
+	sl_uint64 HashBytes64(const void* buf, sl_size len, sl_uint64 seed)
+	{
+		static const sl_uint64 secret[4] = {SLIB_UINT64(0x2d358dccaa6c78a5), SLIB_UINT64(0x8bb84b93962eacc9), SLIB_UINT64(0x4b33a62ed433d4a3), SLIB_UINT64(0x4d5a2da51de1aa47)};
+		const sl_uint8* p = (const sl_uint8*)buf;
+		seed ^= _Hash_mix(seed ^ secret[0], secret[1]);
+		sl_uint64 a, b;
+		if (len <= 16) {
+			if (len >= 4) {
+				a = (_Hash_read4(p) << 32) | _Hash_read4(p + ((len >> 3) << 2));
+				b = (_Hash_read4(p + len - 4) << 32) | _Hash_read4(p + len - 4 - ((len >> 3) << 2));
+			} else if (len > 0) {
+				a = _Hash_read3(p, len);
+				b = 0;
+			} else {
+				a = b = 0;
+			}
+		} else {
+			sl_size i = len;
+			if (i >= 48) {
+				sl_uint64 see1 = seed, see2 = seed;
+				do {
+					seed = _Hash_mix(_Hash_read8(p) ^ secret[1], _Hash_read8(p + 8) ^ seed);
+					see1 = _Hash_mix(_Hash_read8(p + 16) ^ secret[2], _Hash_read8(p + 24) ^ see1);
+					see2 = _Hash_mix(_Hash_read8(p + 32) ^ secret[3], _Hash_read8(p + 40) ^ see2);
+					p += 48;
+					i -= 48;
+				} while (i >= 48);
+				seed ^= see1 ^ see2;
+			}
+			while (i > 16) {
+				seed = _Hash_mix(_Hash_read8(p) ^ secret[1], _Hash_read8(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+			a = _Hash_read8(p + i - 16);
+			b = _Hash_read8(p + i - 8);
 		}
-		return Rehash((b << 16) | a);
+		a ^= secret[1];
+		b ^= seed;
+		_Hash_mum(&a, &b);
+		return _Hash_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+	}
+	
+	static sl_uint64 _Hash_generateSeed()
+	{
+#if defined(SLIB_HASH_DISABLE_RANDOM_SEED)
+		return 0;
+#else
+		sl_uint64 seed;
+		Math::randomMemory(&seed, sizeof(seed));
+		return seed;
+#endif
+	}
+	
+	sl_uint64 GetHashSeed()
+	{
+		// thread-safe initialization (C++11)
+		static sl_uint64 seed = _Hash_generateSeed();
+		return seed;
+	}
+
+	sl_uint32 HashBytes(const void* buf, sl_size n)
+	{
+		sl_uint64 h = HashBytes64(buf, n, GetHashSeed());
+		return (sl_uint32)(h ^ (h >> 32));
 	}
 
 }
@@ -16,6 +16,11 @@
 
 #include "../../../inc/slib/core/file.h"
 #include "../../../inc/slib/core/log.h"
+#include "../../../inc/slib/core/math.h"
+
+#if defined(SLIB_ARCH_IS_X64)
+#include <emmintrin.h>
+#endif
 
 namespace slib
 {
@@ -281,47 +286,76 @@ namespace slib
 		sl_bool flagError = sl_false;
 		String errorMessage;
 		
-		ST strNull;
-		ST strTrue;
-		ST strFalse;
-		
-	public:
-		_Json_Parser();
-		
 	public:
 		void escapeSpaceAndComments();
 		
+		sl_bool parseString(ST& _out);
+		
 		Json parseJson();
 
 		static Json parseJson(const CT* buf, sl_size len, JsonParseParam& param);
 		
 	};
 
-	template <>
-	_Json_Parser<String, sl_char8>::_Json_Parser()
-	{
-		SLIB_STATIC_STRING(_null, "null");
-		strNull = _null;
-		SLIB_STATIC_STRING(_true, "true");
-		strTrue = _true;
-		SLIB_STATIC_STRING(_false, "false");
-		strFalse = _false;
+	// returns the offset of the first quote or backslash character, or `len` if none is found
+	static sl_size _Json_findStringEnd(const sl_char8* buf, sl_size len, sl_char8 quote)
+	{
+		sl_size i = 0;
+#if defined(SLIB_ARCH_IS_X64)
+		__m128i vQuote = _mm_set1_epi8(quote);
+		__m128i vBackslash = _mm_set1_epi8('\\');
+		while (i + 16 <= len) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(buf + i));
+			int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, vQuote), _mm_cmpeq_epi8(v, vBackslash)));
+			if (mask) {
+				return i + Math::getLeastSignificantBits((sl_uint32)mask);
+			}
+			i += 16;
+		}
+#endif
+		for (; i < len; i++) {
+			sl_char8 ch = buf[i];
+			if (ch == quote || ch == '\\') {
+				return i;
+			}
+		}
+		return len;
 	}
 
-	template <>
-	_Json_Parser<String16, sl_char16>::_Json_Parser()
+	static sl_size _Json_findStringEnd(const sl_char16* buf, sl_size len, sl_char16 quote)
 	{
-		SLIB_STATIC_STRING16_BY_ARRAY(_null, 'n', 'u', 'l', 'l');
-		strNull = _null;
-		SLIB_STATIC_STRING16_BY_ARRAY(_true, 't', 'r', 'u', 'e');
-		strTrue = _true;
-		SLIB_STATIC_STRING16_BY_ARRAY(_false, 'f', 'a', 'l', 's', 'e');
-		strFalse = _false;
+		for (sl_size i = 0; i < len; i++) {
+			sl_char16 ch = buf[i];
+			if (ch == quote || ch == '\\') {
+				return i;
+			}
+		}
+		return len;
 	}
 
 	template <class ST, class CT>
 	void _Json_Parser<ST, CT>::escapeSpaceAndComments()
 	{
+		while (pos < len) {
+			CT ch = buf[pos];
+			if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+				pos++;
+			} else {
+				break;
+			}
+		}
+		if (pos == len) {
+			return;
+		}
+		if (!flagSupportComments) {
+			if (!(SLIB_CHAR_IS_WHITE_SPACE(buf[pos]))) {
+				return;
+			}
+		} else {
+			if (buf[pos] != '/' && !(SLIB_CHAR_IS_WHITE_SPACE(buf[pos]))) {
+				return;
+			}
+		}
 		sl_bool flagLineComment = sl_false;
 		sl_bool flagBlockComment = sl_false;
 		while (pos < len) {
@@ -361,6 +395,24 @@ namespace slib
 		}
 	}
 
+	template <class ST, class CT>
+	sl_bool _Json_Parser<ST, CT>::parseString(ST& _out)
+	{
+		CT quote = buf[pos];
+		sl_size n = _Json_findStringEnd(buf + pos + 1, len - pos - 1, quote);
+		if (pos + 1 + n < len && buf[pos + 1 + n] == quote) {
+			// no escape sequence: build the string directly from the source buffer
+			_out = ST(buf + pos + 1, n);
+			pos += n + 2;
+			return sl_true;
+		}
+		sl_size m = 0;
+		sl_bool f = sl_false;
+		_out = ParseUtil::parseBackslashEscapes(buf + pos, len - pos, &m, &f);
+		pos += m;
+		return !f;
+	}
+
 	template <class ST, class CT>
 	Json _Json_Parser<ST, CT>::parseJson()
 	{
@@ -373,11 +425,8 @@ namespace slib
 		
 		// string
 		if (first == '"' || first == '\'') {
-			sl_size m = 0;
-			sl_bool f = sl_false;
-			ST str = ParseUtil::parseBackslashEscapes(buf + pos, len - pos, &m, &f);
-			pos += m;
-			if (f) {
+			ST str;
+			if (!(parseString(str))) {
 				flagError = sl_true;
 				errorMessage = "String: Missing character  \" or ' ";
 				return sl_null;
@@ -482,11 +531,7 @@ namespace slib
 					pos++;
 					return map;
 				} else if (ch == '"' || ch == '\'') {
-					sl_size m = 0;
-					sl_bool f = sl_false;
-					key = ParseUtil::parseBackslashEscapes(buf + pos, len - pos, &m, &f);
-					pos += m;
-					if (f) {
+					if (!(parseString(key))) {
 						flagError = sl_true;
 						errorMessage = "Object Item Name: Missing terminating character \" or ' ";
 						return sl_null;
@@ -557,18 +602,19 @@ namespace slib
 				errorMessage = "Invalid token";
 				return sl_null;
 			}
-			ST str(buf + s, pos - s);
-			if (str == strNull) {
+			sl_size n = pos - s;
+			const CT* token = buf + s;
+			if (n == 4 && token[0] == 'n' && token[1] == 'u' && token[2] == 'l' && token[3] == 'l') {
 				return sl_null;
 			}
-			if (str == strTrue) {
+			if (n == 4 && token[0] == 't' && token[1] == 'r' && token[2] == 'u' && token[3] == 'e') {
 				return Variant::fromBoolean(sl_true);
 			}
-			if (str == strFalse) {
+			if (n == 5 && token[0] == 'f' && token[1] == 'a' && token[2] == 'l' && token[3] == 's' && token[4] == 'e') {
 				return Variant::fromBoolean(sl_false);
 			}
 			sl_int64 vi64;
-			if (str.parseInt64(10, &vi64)) {
+			if (ST::parseInt64(10, &vi64, token, 0, n) == (sl_reg)n) {
 				if (vi64 >= SLIB_INT64(-0x80000000) && vi64 < SLIB_INT64(0x7fffffff)) {
 					return (sl_int32)vi64;
 				} else {
@@ -576,7 +622,7 @@ namespace slib
 				}
 			}
 			double vf;
-			if (str.parseDouble(&vf)) {
+			if (ST::parseDouble(&vf, token, 0, n) == (sl_reg)n) {
 				return vf;
 			}
 		}
@@ -684,22 +730,38 @@ namespace slib
 
 	Json Json::parseJsonUtf8(const Memory& mem, JsonParseParam& param)
 	{
-		return parseJson((sl_char8*)(mem.getData()), mem.getSize(), param);
+		const sl_char8* sz = (const sl_char8*)(mem.getData());
+		sl_size len = mem.getSize();
+		// skip UTF-8 BOM
+		if (len >= 3 && (sl_uint8)(sz[0]) == 0xEF && (sl_uint8)(sz[1]) == 0xBB && (sl_uint8)(sz[2]) == 0xBF) {
+			sz += 3;
+			len -= 3;
+		}
+		return parseJson(sz, len, param);
 	}
 
 	Json Json::parseJsonUtf8(const Memory& mem)
 	{
-		return parseJson((sl_char8*)(mem.getData()), mem.getSize());
+		JsonParseParam param;
+		return parseJsonUtf8(mem, param);
 	}
 
 	Json Json::parseJson16Utf8(const Memory& mem, JsonParseParam& param)
 	{
-		return parseJson(String16((sl_char8*)(mem.getData()), mem.getSize()), param);
+		const sl_char8* sz = (const sl_char8*)(mem.getData());
+		sl_size len = mem.getSize();
+		// skip UTF-8 BOM
+		if (len >= 3 && (sl_uint8)(sz[0]) == 0xEF && (sl_uint8)(sz[1]) == 0xBB && (sl_uint8)(sz[2]) == 0xBF) {
+			sz += 3;
+			len -= 3;
+		}
+		return parseJson16(String16(sz, len), param);
 	}
 
 	Json Json::parseJson16Utf8(const Memory& mem)
 	{
-		return parseJson(String16((sl_char8*)(mem.getData()), mem.getSize()));
+		JsonParseParam param;
+		return parseJson16Utf8(mem, param);
 	}
 
 
@@ -13,6 +13,8 @@
 #include "../../../inc/slib/core/file.h"
 #include "../../../inc/slib/core/variant.h"
 #include "../../../inc/slib/core/safe_static.h"
+#include "../../../inc/slib/core/thread.h"
+#include "../../../inc/slib/core/event.h"
 
 #if defined(SLIB_PLATFORM_IS_ANDROID)
 #include <android/log.h>
@@ -22,6 +24,9 @@
 #include <dlog.h>
 #endif
 
+// milliseconds, keeps the flushing thread from spinning
+#define _FILE_LOGGER_MIN_FLUSH_INTERVAL 10
+
 namespace slib
 {
 
@@ -59,29 +64,270 @@ namespace slib
 		return String::format("%s [%s] %s", Time::now(), tag, content);
 	}
 
+	FileLoggerParam::FileLoggerParam()
+	{
+		flagAsync = sl_false;
+		bufferSize = 0x100000; // 1MB
+		flushInterval = 1000;
+		
+		maximumFileSize = 0;
+		rotationInterval = 0;
+		maximumBackupsCount = 5;
+	}
+	
+	FileLoggerParam::~FileLoggerParam()
+	{
+	}
+	
 	FileLogger::FileLogger()
 	{
+		FileLoggerParam param;
+		_init(param);
 	}
 
 	FileLogger::FileLogger(const String& fileName)
 	{
-		setFileName(fileName);
+		FileLoggerParam param;
+		param.fileName = fileName;
+		_init(param);
+	}
+	
+	FileLogger::FileLogger(const FileLoggerParam& param)
+	{
+		_init(param);
 	}
 
 	FileLogger::~FileLogger()
 	{
+		if (m_thread.isNotNull()) {
+			m_thread->finish();
+			m_eventFlush->set();
+			m_thread->join();
+			m_thread.setNull();
+		}
+		flush();
+	}
+	
+	void FileLogger::_init(const FileLoggerParam& param)
+	{
+		setFileName(param.fileName);
+		
+		m_flagAsync = sl_false;
+		m_flushInterval = param.flushInterval;
+		if (m_flushInterval < _FILE_LOGGER_MIN_FLUSH_INTERVAL) {
+			m_flushInterval = _FILE_LOGGER_MIN_FLUSH_INTERVAL;
+		}
+		m_maximumFileSize = param.maximumFileSize;
+		m_rotationInterval = param.rotationInterval;
+		m_maximumBackupsCount = param.maximumBackupsCount;
+		
+		m_sizeFile = 0;
+		
+		m_posBufferRead = 0;
+		m_posBufferWrite = 0;
+		m_nLinesDropped = 0;
+		m_nLinesDroppedNotReported = 0;
+		
+		if (param.flagAsync && param.bufferSize > 0) {
+			m_buffer = Memory::create(param.bufferSize);
+			m_eventFlush = Event::create();
+			if (m_buffer.isNotNull() && m_eventFlush.isNotNull()) {
+				m_flagAsync = sl_true;
+				m_thread = Thread::start(SLIB_FUNCTION_CLASS(FileLogger, _runFlush, this));
+				if (m_thread.isNull()) {
+					m_flagAsync = sl_false;
+				}
+			}
+		}
 	}
 
 	void FileLogger::log(const String& tag, const String& content)
 	{
-		String fileName = getFileName();
-		if (fileName.isEmpty()) {
+		if (getFileName().isEmpty()) {
 			return;
 		}
 		String s = _Log_getLineString(tag, content) + "\r\n";
 		if (s.getLength() > 0) {
-			ObjectLocker lock(this);
-			File::appendAllTextUTF8(fileName, s);
+			_writeLine(s);
+		}
+	}
+	
+	void FileLogger::flush()
+	{
+		if (m_flagAsync) {
+			MutexLocker lock(&m_lockFile);
+			_flushBuffer();
+		}
+	}
+	
+	sl_bool FileLogger::isAsync()
+	{
+		return m_flagAsync;
+	}
+	
+	sl_uint64 FileLogger::getDroppedLinesCount()
+	{
+		SpinLocker lock(&m_lockBuffer);
+		return m_nLinesDropped;
+	}
+	
+	void FileLogger::_writeLine(const String& line)
+	{
+		const sl_uint8* data = (const sl_uint8*)(line.getData());
+		sl_size n = line.getLength();
+		if (m_flagAsync) {
+			sl_size size = m_buffer.getSize();
+			sl_uint8* buf = (sl_uint8*)(m_buffer.getData());
+			sl_bool flagWake = sl_false;
+			{
+				SpinLocker lock(&m_lockBuffer);
+				sl_size nUsed = (sl_size)(m_posBufferWrite - m_posBufferRead);
+				if (nUsed + n > size) {
+					m_nLinesDropped++;
+					m_nLinesDroppedNotReported++;
+					return;
+				}
+				sl_size offset = (sl_size)(m_posBufferWrite % size);
+				sl_size n1 = size - offset;
+				if (n1 >= n) {
+					Base::copyMemory(buf + offset, data, n);
+				} else {
+					Base::copyMemory(buf + offset, data, n1);
+					Base::copyMemory(buf, data + n1, n - n1);
+				}
+				m_posBufferWrite += n;
+				// wake the flushing thread when the buffer becomes half full
+				flagWake = nUsed * 2 < size && (nUsed + n) * 2 >= size;
+			}
+			if (flagWake) {
+				m_eventFlush->set();
+			}
+		} else {
+			MutexLocker lock(&m_lockFile);
+			if (_prepareFile(n)) {
+				_writeFile(data, n);
+			}
+			// synchronous mode opens, appends and closes the file for each line
+			m_file.setNull();
+		}
+	}
+	
+	sl_bool FileLogger::_prepareFile(sl_size sizeWrite)
+	{
+		if (!(_openFile())) {
+			return sl_false;
+		}
+		if (m_sizeFile > 0) {
+			sl_bool flagRotate = sl_false;
+			if (m_maximumFileSize > 0 && m_sizeFile + sizeWrite > m_maximumFileSize) {
+				flagRotate = sl_true;
+			}
+			if (m_rotationInterval > 0 && Time::now().getSecondsCount() - m_timeOpened.getSecondsCount() >= (sl_int64)m_rotationInterval) {
+				flagRotate = sl_true;
+			}
+			if (flagRotate) {
+				_rotate();
+			}
+		}
+		return m_file.isNotNull();
+	}
+	
+	void FileLogger::_writeFile(const void* data, sl_size size)
+	{
+		sl_reg n = m_file->write(data, size);
+		if (n > 0) {
+			m_sizeFile += n;
+		}
+	}
+	
+	sl_bool FileLogger::_openFile()
+	{
+		String fileName = getFileName();
+		if (fileName.isEmpty()) {
+			m_file.setNull();
+			return sl_false;
+		}
+		if (m_file.isNotNull() && m_fileNameOpened == fileName) {
+			return sl_true;
+		}
+		m_file.setNull();
+		Ref<File> file = File::openForAppend(fileName);
+		if (file.isNull()) {
+			return sl_false;
+		}
+		m_file = file;
+		m_sizeFile = file->getSize();
+		if (m_fileNameOpened != fileName) {
+			// reopening the same file (synchronous mode) keeps the rotation period
+			m_fileNameOpened = fileName;
+			m_timeOpened = Time::now();
+		}
+		return sl_true;
+	}
+	
+	void FileLogger::_rotate()
+	{
+		m_file.setNull();
+		String fileName = m_fileNameOpened;
+		if (m_maximumBackupsCount > 0) {
+			File::deleteFile(String::format("%s.%d", fileName, m_maximumBackupsCount));
+			for (sl_uint32 i = m_maximumBackupsCount - 1; i >= 1; i--) {
+				String path = String::format("%s.%d", fileName, i);
+				if (File::exists(path)) {
+					File::rename(path, String::format("%s.%d", fileName, i + 1));
+				}
+			}
+			File::rename(fileName, fileName + ".1");
+		} else {
+			File::deleteFile(fileName);
+		}
+		m_file = File::openForAppend(fileName);
+		m_sizeFile = 0;
+		m_timeOpened = Time::now();
+	}
+	
+	void FileLogger::_flushBuffer()
+	{
+		sl_uint64 posRead, posWrite, nDropped;
+		{
+			SpinLocker lock(&m_lockBuffer);
+			posRead = m_posBufferRead;
+			posWrite = m_posBufferWrite;
+			nDropped = m_nLinesDroppedNotReported;
+			m_nLinesDroppedNotReported = 0;
+		}
+		sl_size n = (sl_size)(posWrite - posRead);
+		if (n > 0) {
+			// producers never overwrite the region between `posRead` and `posWrite` until `m_posBufferRead` is advanced
+			if (_prepareFile(n)) {
+				sl_size size = m_buffer.getSize();
+				sl_uint8* buf = (sl_uint8*)(m_buffer.getData());
+				sl_size offset = (sl_size)(posRead % size);
+				sl_size n1 = size - offset;
+				if (n1 >= n) {
+					_writeFile(buf + offset, n);
+				} else {
+					_writeFile(buf + offset, n1);
+					_writeFile(buf, n - n1);
+				}
+			}
+			SpinLocker lock(&m_lockBuffer);
+			m_posBufferRead = posWrite;
+		}
+		if (nDropped > 0) {
+			String s = _Log_getLineString("FileLogger", String::format("%d lines were dropped because the log buffer was full", nDropped)) + "\r\n";
+			if (_prepareFile(s.getLength())) {
+				_writeFile(s.getData(), s.getLength());
+			}
+		}
+	}
+	
+	void FileLogger::_runFlush()
+	{
+		while (Thread::isNotStoppingCurrent()) {
+			m_eventFlush->wait(m_flushInterval);
+			MutexLocker lock(&m_lockFile);
+			_flushBuffer();
 		}
 	}
 	
@@ -216,6 +462,11 @@ namespace slib
 		return new FileLogger(fileName);
 	}
 
+	Ref<Logger> Logger::createFileLogger(const FileLoggerParam& param)
+	{
+		return new FileLogger(param);
+	}
+
 	void Logger::logGlobal(const String& tag, const String& content)
 	{
 		Ref<LoggerSet> log = global();
@@ -21,6 +21,10 @@
 #include "float.h"
 #endif
 
+#if defined(SLIB_COMPILER_IS_VC)
+#include <intrin.h>
+#endif
+
 namespace slib
 {
 
@@ -460,22 +464,40 @@ namespace slib
 
 	sl_uint32 Math::getMostSignificantBits(sl_uint32 n)
 	{
+		if (n == 0) {
+			return 0;
+		}
+#if defined(SLIB_COMPILER_IS_GCC)
+		return 32 - (sl_uint32)(__builtin_clz(n));
+#elif defined(SLIB_COMPILER_IS_VC)
+		unsigned long index;
+		_BitScanReverse(&index, n);
+		return (sl_uint32)index + 1;
+#else
 		sl_uint32 ret = 0;
 		while (n) {
 			ret++;
 			n >>= 1;
 		}
 		return ret;
+#endif
 	}
 
 	sl_uint32 Math::getMostSignificantBits(sl_uint64 n)
 	{
+		if (n == 0) {
+			return 0;
+		}
+#if defined(SLIB_COMPILER_IS_GCC)
+		return 64 - (sl_uint32)(__builtin_clzll(n));
+#else
 		sl_uint32 ret = 0;
 		while (n) {
 			ret++;
 			n >>= 1;
 		}
 		return ret;
+#endif
 	}
 
 	sl_uint32 Math::getLeastSignificantBits(sl_uint32 n)
@@ -483,12 +505,20 @@ namespace slib
 		if (n == 0) {
 			return 0;
 		}
+#if defined(SLIB_COMPILER_IS_GCC)
+		return (sl_uint32)(__builtin_ctz(n));
+#elif defined(SLIB_COMPILER_IS_VC)
+		unsigned long index;
+		_BitScanForward(&index, n);
+		return (sl_uint32)index;
+#else
 		sl_uint32 ret = 0;
 		while ((n & 1) == 0) {
 			ret++;
 			n >>= 1;
 		}
 		return ret;
+#endif
 	}
 
 	sl_uint32 Math::getLeastSignificantBits(sl_uint64 n)
@@ -496,12 +526,16 @@ namespace slib
 		if (n == 0) {
 			return 0;
 		}
+#if defined(SLIB_COMPILER_IS_GCC)
+		return (sl_uint32)(__builtin_ctzll(n));
+#else
 		sl_uint32 ret = 0;
 		while ((n & 1) == 0) {
 			ret++;
 			n >>= 1;
 		}
 		return ret;
+#endif
 	}
 
 }
@@ -0,0 +1,1159 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/core/msgpack.h"
+
+#include "../../../inc/slib/core/mio.h"
+
+namespace slib
+{
+
+	struct _MsgPack_Header
+	{
+		MsgPackType type;
+		sl_bool flagSigned;
+		sl_int8 extType;
+		sl_uint32 sizeHeader;
+		sl_uint64 value;
+	};
+
+	SLIB_INLINE static sl_uint64 _MsgPack_readUint(const sl_uint8* p, sl_uint32 size)
+	{
+		switch (size) {
+			case 1:
+				return p[0];
+			case 2:
+				return MIO::readUint16BE(p);
+			case 4:
+				return MIO::readUint32BE(p);
+			case 8:
+				return MIO::readUint64BE(p);
+		}
+		return 0;
+	}
+
+	static sl_bool _MsgPack_parseHeader(const sl_uint8* p, sl_size n, _MsgPack_Header& h)
+	{
+		if (!n) {
+			return sl_false;
+		}
+		sl_uint8 c = p[0];
+		h.flagSigned = sl_false;
+		h.extType = 0;
+		h.sizeHeader = 1;
+		if (c < 0x80) {
+			h.type = MsgPackType::Integer;
+			h.value = c;
+			return sl_true;
+		}
+		if (c < 0x90) {
+			h.type = MsgPackType::Map;
+			h.value = c & 15;
+		} else if (c < 0xa0) {
+			h.type = MsgPackType::Array;
+			h.value = c & 15;
+		} else if (c < 0xc0) {
+			h.type = MsgPackType::String;
+			h.value = c & 31;
+		} else if (c >= 0xe0) {
+			h.type = MsgPackType::Integer;
+			h.flagSigned = sl_true;
+			h.value = (sl_uint64)(sl_int64)(sl_int8)c;
+			return sl_true;
+		} else {
+			// size of the length or the value following the first byte
+			sl_uint32 sizeValue = 0;
+			switch (c) {
+				case 0xc0:
+					h.type = MsgPackType::Nil;
+					h.value = 0;
+					return sl_true;
+				case 0xc2:
+				case 0xc3:
+					h.type = MsgPackType::Boolean;
+					h.value = c & 1;
+					return sl_true;
+				case 0xc4:
+				case 0xc5:
+				case 0xc6:
+					h.type = MsgPackType::Binary;
+					sizeValue = 1 << (c - 0xc4);
+					break;
+				case 0xc7:
+				case 0xc8:
+				case 0xc9:
+					h.type = MsgPackType::Extension;
+					sizeValue = 1 << (c - 0xc7);
+					break;
+				case 0xca:
+					h.type = MsgPackType::Float;
+					sizeValue = 4;
+					break;
+				case 0xcb:
+					h.type = MsgPackType::Double;
+					sizeValue = 8;
+					break;
+				case 0xcc:
+				case 0xcd:
+				case 0xce:
+				case 0xcf:
+					h.type = MsgPackType::Integer;
+					sizeValue = 1 << (c - 0xcc);
+					break;
+				case 0xd0:
+				case 0xd1:
+				case 0xd2:
+				case 0xd3:
+					h.type = MsgPackType::Integer;
+					h.flagSigned = sl_true;
+					sizeValue = 1 << (c - 0xd0);
+					break;
+				case 0xd4:
+				case 0xd5:
+				case 0xd6:
+				case 0xd7:
+				case 0xd8:
+					// fixext
+					if (n < 2) {
+						return sl_false;
+					}
+					h.type = MsgPackType::Extension;
+					h.extType = (sl_int8)(p[1]);
+					h.sizeHeader = 2;
+					h.value = 1 << (c - 0xd4);
+					return h.value <= n - 2;
+				case 0xd9:
+				case 0xda:
+				case 0xdb:
+					h.type = MsgPackType::String;
+					sizeValue = 1 << (c - 0xd9);
+					break;
+				case 0xdc:
+				case 0xdd:
+					h.type = MsgPackType::Array;
+					sizeValue = 2 << (c - 0xdc);
+					break;
+				case 0xde:
+				case 0xdf:
+					h.type = MsgPackType::Map;
+					sizeValue = 2 << (c - 0xde);
+					break;
+				default:
+					// 0xc1 is never used
+					return sl_false;
+			}
+			if (n <= sizeValue) {
+				return sl_false;
+			}
+			h.value = _MsgPack_readUint(p + 1, sizeValue);
+			h.sizeHeader = 1 + sizeValue;
+			if (h.type == MsgPackType::Extension) {
+				if (n <= h.sizeHeader) {
+					return sl_false;
+				}
+				h.extType = (sl_int8)(p[h.sizeHeader]);
+				h.sizeHeader++;
+			} else if (h.flagSigned) {
+				switch (sizeValue) {
+					case 1:
+						h.value = (sl_uint64)(sl_int64)(sl_int8)(h.value);
+						break;
+					case 2:
+						h.value = (sl_uint64)(sl_int64)(sl_int16)(h.value);
+						break;
+					case 4:
+						h.value = (sl_uint64)(sl_int64)(sl_int32)(h.value);
+						break;
+				}
+			}
+		}
+		sl_size sizeRemain = n - h.sizeHeader;
+		switch (h.type) {
+			case MsgPackType::String:
+			case MsgPackType::Binary:
+			case MsgPackType::Extension:
+				return h.value <= sizeRemain;
+			case MsgPackType::Array:
+				// every element takes one byte at least
+				return h.value <= sizeRemain;
+			case MsgPackType::Map:
+				return (h.value << 1) <= sizeRemain;
+			default:
+				break;
+		}
+		return sl_true;
+	}
+
+	static sl_size _MsgPack_getEncodedSize(const sl_uint8* p, sl_size n)
+	{
+		sl_size size = n;
+		sl_uint64 nPending = 1;
+		while (nPending) {
+			_MsgPack_Header h;
+			if (!(_MsgPack_parseHeader(p, n, h))) {
+				return 0;
+			}
+			nPending--;
+			sl_size sizeItem = h.sizeHeader;
+			switch (h.type) {
+				case MsgPackType::String:
+				case MsgPackType::Binary:
+				case MsgPackType::Extension:
+					sizeItem += (sl_size)(h.value);
+					break;
+				case MsgPackType::Array:
+					nPending += h.value;
+					break;
+				case MsgPackType::Map:
+					nPending += h.value << 1;
+					break;
+				default:
+					break;
+			}
+			p += sizeItem;
+			n -= sizeItem;
+		}
+		return size - n;
+	}
+
+	SLIB_INLINE static Time _MsgPack_decodeTime(const sl_uint8* p, sl_uint32 size)
+	{
+		sl_int64 seconds;
+		sl_uint32 nanoseconds;
+		if (size == 4) {
+			seconds = MIO::readUint32BE(p);
+			nanoseconds = 0;
+		} else if (size == 8) {
+			sl_uint64 v = MIO::readUint64BE(p);
+			seconds = (sl_int64)(v & SLIB_UINT64(0x3ffffffff));
+			nanoseconds = (sl_uint32)(v >> 34);
+		} else {
+			nanoseconds = MIO::readUint32BE(p);
+			seconds = MIO::readInt64BE(p + 4);
+		}
+		return seconds * 1000000 + nanoseconds / 1000;
+	}
+
+
+	// converts the value at `p`, and advances `p` and `n` past the value
+	static sl_bool _MsgPack_toVariant(const sl_uint8*& p, sl_size& n, const Memory& mem, sl_uint32 depth, Variant& _out)
+	{
+		_MsgPack_Header h;
+		if (!(_MsgPack_parseHeader(p, n, h))) {
+			return sl_false;
+		}
+		const sl_uint8* start = p;
+		const sl_uint8* payload = p + h.sizeHeader;
+		p = payload;
+		n -= h.sizeHeader;
+		switch (h.type) {
+			case MsgPackType::Nil:
+				_out.setNull();
+				return sl_true;
+			case MsgPackType::Boolean:
+				_out = (sl_bool)(h.value != 0);
+				return sl_true;
+			case MsgPackType::Integer:
+				if (h.flagSigned) {
+					sl_int64 v = (sl_int64)(h.value);
+					if (v >= SLIB_INT64(-2147483648)) {
+						_out = (sl_int32)v;
+					} else {
+						_out = v;
+					}
+				} else {
+					if (h.value <= 0x7fffffff) {
+						_out = (sl_int32)(h.value);
+					} else if (h.value <= SLIB_UINT64(0x7fffffffffffffff)) {
+						_out = (sl_int64)(h.value);
+					} else {
+						_out = h.value;
+					}
+				}
+				return sl_true;
+			case MsgPackType::Float:
+				_out = MIO::readFloatBE(start + 1);
+				return sl_true;
+			case MsgPackType::Double:
+				_out = MIO::readDoubleBE(start + 1);
+				return sl_true;
+			case MsgPackType::String:
+			case MsgPackType::Binary:
+			case MsgPackType::Extension:
+				{
+					sl_size size = (sl_size)(h.value);
+					p += size;
+					n -= size;
+					if (h.type == MsgPackType::String) {
+						_out = String((const sl_char8*)payload, (sl_reg)size);
+					} else if (h.type == MsgPackType::Binary) {
+						if (mem.isNotNull()) {
+							_out = mem.sub(payload - (const sl_uint8*)(mem.getData()), size);
+						} else {
+							_out = Memory::create(payload, size);
+						}
+					} else if (h.extType == SLIB_MSGPACK_EXT_TIMESTAMP && (size == 4 || size == 8 || size == 12)) {
+						_out = _MsgPack_decodeTime(payload, (sl_uint32)size);
+					} else {
+						_out.setNull();
+					}
+					return sl_true;
+				}
+			case MsgPackType::Array:
+				{
+					if (depth >= SLIB_MSGPACK_MAX_DEPTH) {
+						return sl_false;
+					}
+					VariantList list = VariantList::create();
+					if (list.isNull()) {
+						return sl_false;
+					}
+					sl_uint32 count = (sl_uint32)(h.value);
+					for (sl_uint32 i = 0; i < count; i++) {
+						Variant item;
+						if (!(_MsgPack_toVariant(p, n, mem, depth + 1, item))) {
+							return sl_false;
+						}
+						list.add_NoLock(item);
+					}
+					_out = list;
+					return sl_true;
+				}
+			case MsgPackType::Map:
+				{
+					if (depth >= SLIB_MSGPACK_MAX_DEPTH) {
+						return sl_false;
+					}
+					VariantMap map = VariantMap::createHash();
+					if (map.isNull()) {
+						return sl_false;
+					}
+					sl_uint32 count = (sl_uint32)(h.value);
+					for (sl_uint32 i = 0; i < count; i++) {
+						Variant key;
+						if (!(_MsgPack_toVariant(p, n, mem, depth + 1, key))) {
+							return sl_false;
+						}
+						Variant value;
+						if (!(_MsgPack_toVariant(p, n, mem, depth + 1, value))) {
+							return sl_false;
+						}
+						map.put_NoLock(key.getString(), value);
+					}
+					_out = map;
+					return sl_true;
+				}
+			default:
+				return sl_false;
+		}
+	}
+
+
+	MsgPackWriter::MsgPackWriter(IWriter* writer)
+	{
+		m_writer = writer;
+		m_sizeBuffer = 0;
+		m_flagError = sl_false;
+	}
+
+	MsgPackWriter::~MsgPackWriter()
+	{
+		flush();
+	}
+
+	sl_bool MsgPackWriter::writeNil()
+	{
+		sl_uint8 c = 0xc0;
+		return _write(&c, 1);
+	}
+
+	sl_bool MsgPackWriter::writeBoolean(sl_bool value)
+	{
+		sl_uint8 c = value ? 0xc3 : 0xc2;
+		return _write(&c, 1);
+	}
+
+	sl_bool MsgPackWriter::writeInt64(sl_int64 value)
+	{
+		if (value >= 0) {
+			return writeUint64(value);
+		}
+		if (value >= -32) {
+			sl_uint8 c = (sl_uint8)value;
+			return _write(&c, 1);
+		}
+		if (value >= -128) {
+			return _writeHeader(0xd0, (sl_uint64)value, 1);
+		}
+		if (value >= -32768) {
+			return _writeHeader(0xd1, (sl_uint64)value, 2);
+		}
+		if (value >= SLIB_INT64(-2147483648)) {
+			return _writeHeader(0xd2, (sl_uint64)value, 4);
+		}
+		return _writeHeader(0xd3, (sl_uint64)value, 8);
+	}
+
+	sl_bool MsgPackWriter::writeUint64(sl_uint64 value)
+	{
+		if (value < 0x80) {
+			sl_uint8 c = (sl_uint8)value;
+			return _write(&c, 1);
+		}
+		if (value <= 0xff) {
+			return _writeHeader(0xcc, value, 1);
+		}
+		if (value <= 0xffff) {
+			return _writeHeader(0xcd, value, 2);
+		}
+		if (value <= 0xffffffff) {
+			return _writeHeader(0xce, value, 4);
+		}
+		return _writeHeader(0xcf, value, 8);
+	}
+
+	sl_bool MsgPackWriter::writeFloat(float value)
+	{
+		sl_uint8 buf[5];
+		buf[0] = 0xca;
+		MIO::writeFloatBE(buf + 1, value);
+		return _write(buf, 5);
+	}
+
+	sl_bool MsgPackWriter::writeDouble(double value)
+	{
+		sl_uint8 buf[9];
+		buf[0] = 0xcb;
+		MIO::writeDoubleBE(buf + 1, value);
+		return _write(buf, 9);
+	}
+
+	sl_bool MsgPackWriter::writeString(const sl_char8* str, sl_size len)
+	{
+		sl_bool flagSuccess;
+		if (len < 32) {
+			sl_uint8 c = (sl_uint8)(0xa0 | len);
+			flagSuccess = _write(&c, 1);
+		} else if (len <= 0xff) {
+			flagSuccess = _writeHeader(0xd9, len, 1);
+		} else if (len <= 0xffff) {
+			flagSuccess = _writeHeader(0xda, len, 2);
+		} else if ((sl_uint64)len <= 0xffffffff) {
+			flagSuccess = _writeHeader(0xdb, len, 4);
+		} else {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		if (flagSuccess) {
+			return _write(str, len);
+		}
+		return sl_false;
+	}
+
+	sl_bool MsgPackWriter::writeString(const String& str)
+	{
+		return writeString(str.getData(), str.getLength());
+	}
+
+	sl_bool MsgPackWriter::writeBinary(const void* data, sl_size size)
+	{
+		sl_bool flagSuccess;
+		if (size <= 0xff) {
+			flagSuccess = _writeHeader(0xc4, size, 1);
+		} else if (size <= 0xffff) {
+			flagSuccess = _writeHeader(0xc5, size, 2);
+		} else if ((sl_uint64)size <= 0xffffffff) {
+			flagSuccess = _writeHeader(0xc6, size, 4);
+		} else {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		if (flagSuccess) {
+			return _write(data, size);
+		}
+		return sl_false;
+	}
+
+	sl_bool MsgPackWriter::writeArrayHeader(sl_uint32 count)
+	{
+		if (count < 16) {
+			sl_uint8 c = (sl_uint8)(0x90 | count);
+			return _write(&c, 1);
+		}
+		if (count <= 0xffff) {
+			return _writeHeader(0xdc, count, 2);
+		}
+		return _writeHeader(0xdd, count, 4);
+	}
+
+	sl_bool MsgPackWriter::writeMapHeader(sl_uint32 count)
+	{
+		if (count < 16) {
+			sl_uint8 c = (sl_uint8)(0x80 | count);
+			return _write(&c, 1);
+		}
+		if (count <= 0xffff) {
+			return _writeHeader(0xde, count, 2);
+		}
+		return _writeHeader(0xdf, count, 4);
+	}
+
+	sl_bool MsgPackWriter::writeExtension(sl_int8 type, const void* data, sl_uint32 size)
+	{
+		sl_uint8 buf[6];
+		sl_uint32 sizeHeader;
+		switch (size) {
+			case 1:
+				buf[0] = 0xd4;
+				sizeHeader = 1;
+				break;
+			case 2:
+				buf[0] = 0xd5;
+				sizeHeader = 1;
+				break;
+			case 4:
+				buf[0] = 0xd6;
+				sizeHeader = 1;
+				break;
+			case 8:
+				buf[0] = 0xd7;
+				sizeHeader = 1;
+				break;
+			case 16:
+				buf[0] = 0xd8;
+				sizeHeader = 1;
+				break;
+			default:
+				if (size <= 0xff) {
+					buf[0] = 0xc7;
+					buf[1] = (sl_uint8)size;
+					sizeHeader = 2;
+				} else if (size <= 0xffff) {
+					buf[0] = 0xc8;
+					MIO::writeUint16BE(buf + 1, (sl_uint16)size);
+					sizeHeader = 3;
+				} else {
+					buf[0] = 0xc9;
+					MIO::writeUint32BE(buf + 1, size);
+					sizeHeader = 5;
+				}
+				break;
+		}
+		buf[sizeHeader] = (sl_uint8)type;
+		if (_write(buf, sizeHeader + 1)) {
+			return _write(data, size);
+		}
+		return sl_false;
+	}
+
+	sl_bool MsgPackWriter::writeTime(const Time& time)
+	{
+		sl_int64 t = time.toInt();
+		sl_int64 seconds = t / 1000000;
+		sl_int64 microseconds = t % 1000000;
+		if (microseconds < 0) {
+			microseconds += 1000000;
+			seconds--;
+		}
+		sl_uint32 nanoseconds = (sl_uint32)(microseconds * 1000);
+		sl_uint8 buf[12];
+		if (!(seconds >> 34)) {
+			if (!nanoseconds && !(seconds >> 32)) {
+				MIO::writeUint32BE(buf, (sl_uint32)seconds);
+				return writeExtension(SLIB_MSGPACK_EXT_TIMESTAMP, buf, 4);
+			}
+			MIO::writeUint64BE(buf, ((sl_uint64)nanoseconds << 34) | (sl_uint64)seconds);
+			return writeExtension(SLIB_MSGPACK_EXT_TIMESTAMP, buf, 8);
+		}
+		MIO::writeUint32BE(buf, nanoseconds);
+		MIO::writeInt64BE(buf + 4, seconds);
+		return writeExtension(SLIB_MSGPACK_EXT_TIMESTAMP, buf, 12);
+	}
+
+	sl_bool MsgPackWriter::writeVariant(const Variant& value)
+	{
+		return _writeVariant(value, 0);
+	}
+
+	sl_bool MsgPackWriter::flush()
+	{
+		if (m_flagError) {
+			return sl_false;
+		}
+		if (m_sizeBuffer) {
+			if (!m_writer || m_writer->writeFully(m_buffer, m_sizeBuffer) != (sl_reg)m_sizeBuffer) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			m_sizeBuffer = 0;
+		}
+		return sl_true;
+	}
+
+	sl_bool MsgPackWriter::isError() const
+	{
+		return m_flagError;
+	}
+
+	sl_bool MsgPackWriter::_write(const void* data, sl_size size)
+	{
+		if (m_flagError) {
+			return sl_false;
+		}
+		if (size <= SLIB_MSGPACK_WRITER_BUFFER_SIZE - m_sizeBuffer) {
+			Base::copyMemory(m_buffer + m_sizeBuffer, data, size);
+			m_sizeBuffer += (sl_uint32)size;
+			return sl_true;
+		}
+		if (!(flush())) {
+			return sl_false;
+		}
+		if (size <= SLIB_MSGPACK_WRITER_BUFFER_SIZE) {
+			Base::copyMemory(m_buffer, data, size);
+			m_sizeBuffer = (sl_uint32)size;
+			return sl_true;
+		}
+		if (m_writer->writeFully(data, size) != (sl_reg)size) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		return sl_true;
+	}
+
+	sl_bool MsgPackWriter::_writeHeader(sl_uint8 type, sl_uint64 value, sl_uint32 sizeValue)
+	{
+		sl_uint8 buf[9];
+		buf[0] = type;
+		switch (sizeValue) {
+			case 1:
+				buf[1] = (sl_uint8)value;
+				break;
+			case 2:
+				MIO::writeUint16BE(buf + 1, (sl_uint16)value);
+				break;
+			case 4:
+				MIO::writeUint32BE(buf + 1, (sl_uint32)value);
+				break;
+			default:
+				MIO::writeUint64BE(buf + 1, value);
+				break;
+		}
+		return _write(buf, 1 + sizeValue);
+	}
+
+	sl_bool MsgPackWriter::_writeVariantList(const List<Variant>& list, sl_uint32 depth)
+	{
+		ListLocker<Variant> l(list);
+		if ((sl_uint64)(l.count) > 0xffffffff) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		if (!(writeArrayHeader((sl_uint32)(l.count)))) {
+			return sl_false;
+		}
+		for (sl_size i = 0; i < l.count; i++) {
+			if (!(_writeVariant(l.data[i], depth))) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool MsgPackWriter::_writeVariantMap(const Map<String, Variant>& map, sl_uint32 depth)
+	{
+		IMap<String, Variant>* p = map.ref._ptr;
+		if (!p) {
+			return writeMapHeader(0);
+		}
+		ObjectLocker lock(p);
+		sl_size n = p->getCount();
+		if ((sl_uint64)n > 0xffffffff) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		if (!(writeMapHeader((sl_uint32)n))) {
+			return sl_false;
+		}
+		Iterator< Pair<String, Variant> > iterator(p->toIterator());
+		Pair<String, Variant> pair;
+		sl_size i = 0;
+		while (i < n && iterator.next(&pair)) {
+			if (!(writeString(pair.key))) {
+				return sl_false;
+			}
+			if (!(_writeVariant(pair.value, depth))) {
+				return sl_false;
+			}
+			i++;
+		}
+		if (i != n) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		return sl_true;
+	}
+
+	sl_bool MsgPackWriter::_writeVariantMapList(const List< Map<String, Variant> >& list, sl_uint32 depth)
+	{
+		ListLocker< Map<String, Variant> > l(list);
+		if ((sl_uint64)(l.count) > 0xffffffff) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		if (!(writeArrayHeader((sl_uint32)(l.count)))) {
+			return sl_false;
+		}
+		for (sl_size i = 0; i < l.count; i++) {
+			if (!(_writeVariantMap(l.data[i], depth))) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool MsgPackWriter::_writeVariant(const Variant& value, sl_uint32 depth)
+	{
+		switch (value._type) {
+			case VariantType::Null:
+			case VariantType::Pointer:
+				return writeNil();
+			case VariantType::Int32:
+			case VariantType::Int64:
+				return writeInt64(value.getInt64());
+			case VariantType::Uint32:
+			case VariantType::Uint64:
+				return writeUint64(value.getUint64());
+			case VariantType::Float:
+				return writeFloat(value.getFloat());
+			case VariantType::Double:
+				return writeDouble(value.getDouble());
+			case VariantType::Boolean:
+				return writeBoolean(value.getBoolean());
+			case VariantType::String8:
+			case VariantType::String16:
+			case VariantType::Sz8:
+			case VariantType::Sz16:
+				return writeString(value.getString());
+			case VariantType::Time:
+				return writeTime(value.getTime());
+			case VariantType::Object:
+			case VariantType::Weak:
+				{
+					Ref<Referable> obj(value.getObject());
+					if (obj.isNotNull()) {
+						if (depth >= SLIB_MSGPACK_MAX_DEPTH) {
+							m_flagError = sl_true;
+							return sl_false;
+						}
+						if (CList<Variant>* p1 = CastInstance< CList<Variant> >(obj._ptr)) {
+							return _writeVariantList(p1, depth + 1);
+						} else if (IMap<String, Variant>* p2 = CastInstance< IMap<String, Variant> >(obj._ptr)) {
+							return _writeVariantMap(p2, depth + 1);
+						} else if (CList< Map<String, Variant> >* p3 = CastInstance< CList< Map<String, Variant> > >(obj._ptr)) {
+							return _writeVariantMapList(p3, depth + 1);
+						} else if (CMemory* p4 = CastInstance<CMemory>(obj._ptr)) {
+							return writeBinary(p4->getData(), p4->getCount());
+						}
+					}
+				}
+				return writeNil();
+			default:
+				return writeNil();
+		}
+	}
+
+
+	MsgPackReader::MsgPackReader()
+	{
+		_parse(sl_null, 0);
+	}
+
+	MsgPackReader::MsgPackReader(const void* data, sl_size size)
+	{
+		_parse((const sl_uint8*)data, size);
+	}
+
+	MsgPackReader::MsgPackReader(const Memory& mem) : m_mem(mem)
+	{
+		_parse((const sl_uint8*)(mem.getData()), mem.getSize());
+	}
+
+	MsgPackReader::MsgPackReader(const MsgPackReader& other) : m_data(other.m_data), m_size(other.m_size), m_mem(other.m_mem), m_type(other.m_type), m_flagSigned(other.m_flagSigned), m_extType(other.m_extType), m_sizeHeader(other.m_sizeHeader), m_value(other.m_value)
+	{
+	}
+
+	MsgPackReader::~MsgPackReader()
+	{
+	}
+
+	MsgPackReader& MsgPackReader::operator=(const MsgPackReader& other)
+	{
+		m_data = other.m_data;
+		m_size = other.m_size;
+		m_mem = other.m_mem;
+		m_type = other.m_type;
+		m_flagSigned = other.m_flagSigned;
+		m_extType = other.m_extType;
+		m_sizeHeader = other.m_sizeHeader;
+		m_value = other.m_value;
+		return *this;
+	}
+
+	sl_bool MsgPackReader::isValid() const
+	{
+		return m_type != MsgPackType::Invalid;
+	}
+
+	MsgPackType MsgPackReader::getType() const
+	{
+		return m_type;
+	}
+
+	sl_bool MsgPackReader::isNil() const
+	{
+		return m_type == MsgPackType::Nil;
+	}
+
+	sl_bool MsgPackReader::isBoolean() const
+	{
+		return m_type == MsgPackType::Boolean;
+	}
+
+	sl_bool MsgPackReader::isInteger() const
+	{
+		return m_type == MsgPackType::Integer;
+	}
+
+	sl_bool MsgPackReader::isNumber() const
+	{
+		return m_type == MsgPackType::Integer || m_type == MsgPackType::Float || m_type == MsgPackType::Double;
+	}
+
+	sl_bool MsgPackReader::isString() const
+	{
+		return m_type == MsgPackType::String;
+	}
+
+	sl_bool MsgPackReader::isBinary() const
+	{
+		return m_type == MsgPackType::Binary;
+	}
+
+	sl_bool MsgPackReader::isArray() const
+	{
+		return m_type == MsgPackType::Array;
+	}
+
+	sl_bool MsgPackReader::isMap() const
+	{
+		return m_type == MsgPackType::Map;
+	}
+
+	sl_bool MsgPackReader::isExtension() const
+	{
+		return m_type == MsgPackType::Extension;
+	}
+
+	sl_bool MsgPackReader::isTime() const
+	{
+		return m_type == MsgPackType::Extension && m_extType == SLIB_MSGPACK_EXT_TIMESTAMP && (m_value == 4 || m_value == 8 || m_value == 12);
+	}
+
+	sl_size MsgPackReader::getEncodedSize() const
+	{
+		if (m_type == MsgPackType::Invalid) {
+			return 0;
+		}
+		return _MsgPack_getEncodedSize(m_data, m_size);
+	}
+
+	sl_bool MsgPackReader::getBoolean(sl_bool def) const
+	{
+		if (m_type == MsgPackType::Boolean || m_type == MsgPackType::Integer) {
+			return m_value != 0;
+		}
+		return def;
+	}
+
+	sl_int64 MsgPackReader::getInt64(sl_int64 def) const
+	{
+		switch (m_type) {
+			case MsgPackType::Integer:
+				return (sl_int64)m_value;
+			case MsgPackType::Float:
+			case MsgPackType::Double:
+				return (sl_int64)(getDouble());
+			default:
+				return def;
+		}
+	}
+
+	sl_uint64 MsgPackReader::getUint64(sl_uint64 def) const
+	{
+		switch (m_type) {
+			case MsgPackType::Integer:
+				return m_value;
+			case MsgPackType::Float:
+			case MsgPackType::Double:
+				return (sl_uint64)(getDouble());
+			default:
+				return def;
+		}
+	}
+
+	double MsgPackReader::getDouble(double def) const
+	{
+		switch (m_type) {
+			case MsgPackType::Integer:
+				if (m_flagSigned) {
+					return (double)((sl_int64)m_value);
+				} else {
+					return (double)m_value;
+				}
+			case MsgPackType::Float:
+				return MIO::readFloatBE(m_data + 1);
+			case MsgPackType::Double:
+				return MIO::readDoubleBE(m_data + 1);
+			default:
+				return def;
+		}
+	}
+
+	Time MsgPackReader::getTime(const Time& def) const
+	{
+		if (isTime()) {
+			return _MsgPack_decodeTime(m_data + m_sizeHeader, (sl_uint32)m_value);
+		}
+		return def;
+	}
+
+	const sl_char8* MsgPackReader::getStringData(sl_size* outLength) const
+	{
+		if (m_type == MsgPackType::String) {
+			if (outLength) {
+				*outLength = (sl_size)m_value;
+			}
+			return (const sl_char8*)(m_data + m_sizeHeader);
+		}
+		if (outLength) {
+			*outLength = 0;
+		}
+		return sl_null;
+	}
+
+	String MsgPackReader::getString(const String& def) const
+	{
+		if (m_type == MsgPackType::String) {
+			return String((const sl_char8*)(m_data + m_sizeHeader), (sl_reg)m_value);
+		}
+		return def;
+	}
+
+	sl_bool MsgPackReader::equalsString(const sl_char8* str, sl_size len) const
+	{
+		if (m_type == MsgPackType::String && m_value == len) {
+			return Base::compareMemory(m_data + m_sizeHeader, (const sl_uint8*)str, len) == 0;
+		}
+		return sl_false;
+	}
+
+	const void* MsgPackReader::getBinaryData(sl_size* outSize) const
+	{
+		if (m_type == MsgPackType::Binary || m_type == MsgPackType::Extension) {
+			if (outSize) {
+				*outSize = (sl_size)m_value;
+			}
+			return m_data + m_sizeHeader;
+		}
+		if (outSize) {
+			*outSize = 0;
+		}
+		return sl_null;
+	}
+
+	Memory MsgPackReader::getBinary() const
+	{
+		sl_size size;
+		const sl_uint8* data = (const sl_uint8*)(getBinaryData(&size));
+		if (!data) {
+			return sl_null;
+		}
+		if (m_mem.isNotNull()) {
+			return m_mem.sub(data - (const sl_uint8*)(m_mem.getData()), size);
+		}
+		return Memory::create(data, size);
+	}
+
+	sl_int8 MsgPackReader::getExtensionType() const
+	{
+		return m_extType;
+	}
+
+	sl_uint32 MsgPackReader::getCount() const
+	{
+		if (m_type == MsgPackType::Array || m_type == MsgPackType::Map) {
+			return (sl_uint32)m_value;
+		}
+		return 0;
+	}
+
+	MsgPackReader MsgPackReader::getFirstChild() const
+	{
+		if ((m_type == MsgPackType::Array || m_type == MsgPackType::Map) && m_value) {
+			return _getReader(m_data + m_sizeHeader, m_size - m_sizeHeader);
+		}
+		return MsgPackReader();
+	}
+
+	MsgPackReader MsgPackReader::getNext() const
+	{
+		sl_size size = getEncodedSize();
+		if (size) {
+			return _getReader(m_data + size, m_size - size);
+		}
+		return MsgPackReader();
+	}
+
+	MsgPackReader MsgPackReader::getElement(sl_uint32 index) const
+	{
+		if (m_type != MsgPackType::Array || index >= m_value) {
+			return MsgPackReader();
+		}
+		const sl_uint8* p = m_data + m_sizeHeader;
+		sl_size n = m_size - m_sizeHeader;
+		for (sl_uint32 i = 0; i < index; i++) {
+			sl_size size = _MsgPack_getEncodedSize(p, n);
+			if (!size) {
+				return MsgPackReader();
+			}
+			p += size;
+			n -= size;
+		}
+		return _getReader(p, n);
+	}
+
+	MsgPackReader MsgPackReader::getItem(const sl_char8* key, sl_size len) const
+	{
+		if (m_type != MsgPackType::Map) {
+			return MsgPackReader();
+		}
+		const sl_uint8* p = m_data + m_sizeHeader;
+		sl_size n = m_size - m_sizeHeader;
+		sl_uint32 count = (sl_uint32)m_value;
+		for (sl_uint32 i = 0; i < count; i++) {
+			_MsgPack_Header h;
+			if (!(_MsgPack_parseHeader(p, n, h))) {
+				break;
+			}
+			sl_size size;
+			if (h.type == MsgPackType::String) {
+				size = h.sizeHeader + (sl_size)(h.value);
+				if (h.value == len && Base::compareMemory(p + h.sizeHeader, (const sl_uint8*)key, len) == 0) {
+					return _getReader(p + size, n - size);
+				}
+			} else {
+				size = _MsgPack_getEncodedSize(p, n);
+				if (!size) {
+					break;
+				}
+			}
+			p += size;
+			n -= size;
+			size = _MsgPack_getEncodedSize(p, n);
+			if (!size) {
+				break;
+			}
+			p += size;
+			n -= size;
+		}
+		return MsgPackReader();
+	}
+
+	MsgPackReader MsgPackReader::getItem(const String& key) const
+	{
+		return getItem(key.getData(), key.getLength());
+	}
+
+	Variant MsgPackReader::toVariant() const
+	{
+		Variant ret;
+		if (m_type != MsgPackType::Invalid) {
+			const sl_uint8* p = m_data;
+			sl_size n = m_size;
+			if (!(_MsgPack_toVariant(p, n, m_mem, 0, ret))) {
+				ret.setNull();
+			}
+		}
+		return ret;
+	}
+
+	Json MsgPackReader::toJson() const
+	{
+		return toVariant();
+	}
+
+	void MsgPackReader::_parse(const sl_uint8* data, sl_size size)
+	{
+		m_data = data;
+		m_size = size;
+		_MsgPack_Header h;
+		if (data && _MsgPack_parseHeader(data, size, h)) {
+			m_type = h.type;
+			m_flagSigned = h.flagSigned;
+			m_extType = h.extType;
+			m_sizeHeader = h.sizeHeader;
+			m_value = h.value;
+		} else {
+			m_type = MsgPackType::Invalid;
+			m_flagSigned = sl_false;
+			m_extType = 0;
+			m_sizeHeader = 0;
+			m_value = 0;
+		}
+	}
+
+	MsgPackReader MsgPackReader::_getReader(const sl_uint8* data, sl_size size) const
+	{
+		MsgPackReader ret;
+		ret.m_mem = m_mem;
+		ret._parse(data, size);
+		return ret;
+	}
+
+
+	Memory MsgPack::serialize(const Variant& value)
+	{
+		MemoryWriter writer;
+		if (serialize(&writer, value)) {
+			return writer.getData();
+		}
+		return sl_null;
+	}
+
+	sl_bool MsgPack::serialize(IWriter* writer, const Variant& value)
+	{
+		MsgPackWriter packer(writer);
+		if (packer.writeVariant(value)) {
+			return packer.flush();
+		}
+		return sl_false;
+	}
+
+	Variant MsgPack::deserialize(const void* data, sl_size size)
+	{
+		return MsgPackReader(data, size).toVariant();
+	}
+
+	Variant MsgPack::deserialize(const Memory& mem)
+	{
+		return MsgPackReader(mem).toVariant();
+	}
+
+}
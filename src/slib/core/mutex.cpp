@@ -13,12 +13,19 @@
 
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
 #include <windows.h>
+#elif defined(SLIB_PLATFORM_IS_LINUX)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #elif defined(SLIB_PLATFORM_IS_UNIX)
 #include <pthread.h>
 #include <time.h>
 #include <sys/time.h>
 #endif
 
+// count of the polls before a contended lock sleeps on the futex
+#define MUTEX_SPIN_COUNT 100
+
 namespace slib
 {
 
@@ -37,73 +44,218 @@ namespace slib
 		_free();
 	}
 
+#if defined(SLIB_PLATFORM_IS_LINUX)
+
+	/*
+		Recursive lock on a futex word, based on "Futexes Are Tricky" (Ulrich Drepper).
+		No memory is allocated, and the kernel is entered only when the lock is contended.
+	*/
+
+	// the address is unique for each running thread
+	static SLIB_THREAD char _gt_mutexThreadMarker = 0;
+
+	SLIB_INLINE static sl_size _Mutex_getCurrentThread()
+	{
+		return (sl_size)(&_gt_mutexThreadMarker);
+	}
+
+	static void _Mutex_wait(sl_int32* state)
+	{
+		::syscall(SYS_futex, state, FUTEX_WAIT_PRIVATE, 2, sl_null, sl_null, 0);
+	}
+
+	static void _Mutex_wake(sl_int32* state)
+	{
+		::syscall(SYS_futex, state, FUTEX_WAKE_PRIVATE, 1, sl_null, sl_null, 0);
+	}
+
+	SLIB_INLINE static sl_bool _Mutex_tryAcquire(sl_int32* state)
+	{
+		sl_int32 c = 0;
+		return __atomic_compare_exchange_n(state, &c, 1, sl_false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+	}
+
+	static void _Mutex_acquireContended(sl_int32* state)
+	{
+		for (sl_uint32 i = 0; i < MUTEX_SPIN_COUNT; i++) {
+			if (!(__atomic_load_n(state, __ATOMIC_RELAXED))) {
+				if (_Mutex_tryAcquire(state)) {
+					return;
+				}
+			}
+		}
+		// mark as contended, so that the owner wakes a waiter on unlocking
+		while (__atomic_exchange_n(state, 2, __ATOMIC_ACQUIRE)) {
+			_Mutex_wait(state);
+		}
+	}
+
 	void Mutex::_init()
+	{
+		m_state = 0;
+		m_countRecursion = 0;
+		m_owner = 0;
+	}
+
+	void Mutex::_free()
+	{
+	}
+
+	void Mutex::lock() const
+	{
+		sl_size thread = _Mutex_getCurrentThread();
+		// only the owner can find itself here
+		if (__atomic_load_n(&m_owner, __ATOMIC_RELAXED) == thread) {
+			m_countRecursion++;
+			return;
+		}
+		if (!(_Mutex_tryAcquire(&m_state))) {
+			_Mutex_acquireContended(&m_state);
+		}
+		__atomic_store_n(&m_owner, thread, __ATOMIC_RELAXED);
+		m_countRecursion = 1;
+	}
+
+	sl_bool Mutex::tryLock() const
+	{
+		sl_size thread = _Mutex_getCurrentThread();
+		if (__atomic_load_n(&m_owner, __ATOMIC_RELAXED) == thread) {
+			m_countRecursion++;
+			return sl_true;
+		}
+		if (_Mutex_tryAcquire(&m_state)) {
+			__atomic_store_n(&m_owner, thread, __ATOMIC_RELAXED);
+			m_countRecursion = 1;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	void Mutex::unlock() const
+	{
+		if (__atomic_load_n(&m_owner, __ATOMIC_RELAXED) != _Mutex_getCurrentThread()) {
+			return;
+		}
+		m_countRecursion--;
+		if (m_countRecursion) {
+			return;
+		}
+		__atomic_store_n(&m_owner, 0, __ATOMIC_RELAXED);
+		if (__atomic_exchange_n(&m_state, 0, __ATOMIC_RELEASE) == 2) {
+			_Mutex_wake(&m_state);
+		}
+	}
+
+#else
+
+	static void* _Mutex_create()
 	{
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		m_pObject = Base::createMemory(sizeof(CRITICAL_SECTION));
+		void* p = Base::createMemory(sizeof(CRITICAL_SECTION));
+		if (p) {
 #	if defined(SLIB_PLATFORM_IS_DESKTOP)
-		InitializeCriticalSection((PCRITICAL_SECTION)m_pObject);
+			InitializeCriticalSection((PCRITICAL_SECTION)p);
 #	elif defined(SLIB_PLATFORM_IS_MOBILE)
-		InitializeCriticalSectionEx((PCRITICAL_SECTION)m_pObject, NULL, NULL);
+			InitializeCriticalSectionEx((PCRITICAL_SECTION)p, NULL, NULL);
 #	endif
+		}
+		return p;
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		m_pObject = Base::createMemory(sizeof(pthread_mutex_t));
-		pthread_mutexattr_t attr;
-		pthread_mutexattr_init(&attr);
-		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-		pthread_mutex_init((pthread_mutex_t*)(m_pObject), &attr);
-		pthread_mutexattr_destroy(&attr);
+		void* p = Base::createMemory(sizeof(pthread_mutex_t));
+		if (p) {
+			pthread_mutexattr_t attr;
+			pthread_mutexattr_init(&attr);
+			pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+			pthread_mutex_init((pthread_mutex_t*)p, &attr);
+			pthread_mutexattr_destroy(&attr);
+		}
+		return p;
 #endif
 	}
 
-	void Mutex::_free()
+	static void _Mutex_destroy(void* p)
 	{
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		DeleteCriticalSection((PCRITICAL_SECTION)m_pObject);
-		Base::freeMemory(m_pObject);
-		m_pObject = sl_null;
+		DeleteCriticalSection((PCRITICAL_SECTION)p);
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		pthread_mutex_destroy((pthread_mutex_t*)(m_pObject));
-		Base::freeMemory(m_pObject);
+		pthread_mutex_destroy((pthread_mutex_t*)p);
 #endif
+		Base::freeMemory(p);
+	}
+
+	void Mutex::_init()
+	{
+		m_pObject = sl_null;
+	}
+
+	void Mutex::_free()
+	{
+		if (m_pObject) {
+			_Mutex_destroy(m_pObject);
+			m_pObject = sl_null;
+		}
+	}
+
+	void* Mutex::_getObject() const
+	{
+		void* p = m_pObject;
+		if (p) {
+			return p;
+		}
+		p = _Mutex_create();
+		if (!p) {
+			return sl_null;
+		}
+		if (Base::interlockedCompareExchangePtr(&m_pObject, p, sl_null)) {
+			return p;
+		}
+		// created by another thread
+		_Mutex_destroy(p);
+		return m_pObject;
 	}
 
 	void Mutex::lock() const
 	{
-		if (!m_pObject) {
+		void* p = _getObject();
+		if (!p) {
 			return;
 		}
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		EnterCriticalSection((PCRITICAL_SECTION)m_pObject);
+		EnterCriticalSection((PCRITICAL_SECTION)p);
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		pthread_mutex_lock((pthread_mutex_t*)(m_pObject));
+		pthread_mutex_lock((pthread_mutex_t*)p);
 #endif
 	}
 
 	sl_bool Mutex::tryLock() const
 	{
-		if (!m_pObject) {
+		void* p = _getObject();
+		if (!p) {
 			return sl_false;
 		}
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		return TryEnterCriticalSection((PCRITICAL_SECTION)m_pObject) != 0;
+		return TryEnterCriticalSection((PCRITICAL_SECTION)p) != 0;
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		return pthread_mutex_trylock((pthread_mutex_t*)(m_pObject)) == 0;
+		return pthread_mutex_trylock((pthread_mutex_t*)p) == 0;
 #endif
 	}
 
 	void Mutex::unlock() const
 	{
-		if (!m_pObject) {
+		// never locked when the native mutex is not created
+		void* p = m_pObject;
+		if (!p) {
 			return;
 		}
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		LeaveCriticalSection((PCRITICAL_SECTION)m_pObject);
+		LeaveCriticalSection((PCRITICAL_SECTION)p);
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		pthread_mutex_unlock((pthread_mutex_t*)(m_pObject));
+		pthread_mutex_unlock((pthread_mutex_t*)p);
 #endif
 	}
 
+#endif
+
 	Mutex& Mutex::operator=(const Mutex& other)
 	{
 		return *this;
@@ -10,6 +10,8 @@
 
 #include "../../../inc/slib/core/ref.h"
 
+#include "../../../inc/slib/core/system.h"
+
 #define _SIGNATURE 0x15181289
 
 namespace slib
@@ -23,6 +25,88 @@ namespace slib
 
 	const _Ref_Const _Ref_Null = {0, 0};
 
+
+	// hazard slot of a thread, occupying a cache line
+	struct _Ref_HazardRecord
+	{
+		void* hazard;
+		_Ref_HazardRecord* next;
+		sl_int32 flagActive;
+	};
+
+	// records are reused by the following threads, and never freed
+	static _Ref_HazardRecord* _g_ref_hazardRecords = sl_null;
+
+	static SLIB_THREAD _Ref_HazardRecord* _gt_ref_hazardRecord = sl_null;
+
+	class _Ref_HazardReleaser
+	{
+	public:
+		~_Ref_HazardReleaser()
+		{
+			_Ref_HazardRecord* record = _gt_ref_hazardRecord;
+			if (record) {
+				_gt_ref_hazardRecord = sl_null;
+				_Ref_releasePtr(&(record->hazard));
+				Base::interlockedCompareExchange32(&(record->flagActive), 0, 1);
+			}
+		}
+	};
+
+	static _Ref_HazardRecord* _Ref_acquireHazardRecord()
+	{
+		_Ref_HazardRecord* record = (_Ref_HazardRecord*)(_Ref_loadPtr((void* const*)(&_g_ref_hazardRecords)));
+		while (record) {
+			if (!(record->flagActive)) {
+				if (Base::interlockedCompareExchange32(&(record->flagActive), 1, 0)) {
+					return record;
+				}
+			}
+			record = record->next;
+		}
+		sl_uint8* mem = (sl_uint8*)(Base::createMemory(sizeof(_Ref_HazardRecord) + 128));
+		if (!mem) {
+			SLIB_ABORT("Failed to allocate the hazard record");
+			return sl_null;
+		}
+		// occupies a cache line alone
+		record = (_Ref_HazardRecord*)(mem + 64 - (((sl_size)mem) & 63));
+		record->hazard = sl_null;
+		record->flagActive = 1;
+		_Ref_HazardRecord* head;
+		do {
+			head = (_Ref_HazardRecord*)(_Ref_loadPtr((void* const*)(&_g_ref_hazardRecords)));
+			record->next = head;
+		} while (!(Base::interlockedCompareExchangePtr((void**)(&_g_ref_hazardRecords), record, head)));
+		return record;
+	}
+
+	void** _Ref_getHazardSlot()
+	{
+		_Ref_HazardRecord* record = _gt_ref_hazardRecord;
+		if (!record) {
+			// returns the record on the exit of the thread
+			static SLIB_THREAD _Ref_HazardReleaser releaser;
+			SLIB_UNUSED(releaser)
+			record = _Ref_acquireHazardRecord();
+			_gt_ref_hazardRecord = record;
+		}
+		return &(record->hazard);
+	}
+
+	void _Ref_waitHazard(const void* object)
+	{
+		sl_uint32 count = 0;
+		_Ref_HazardRecord* record = (_Ref_HazardRecord*)(_Ref_loadPtr((void* const*)(&_g_ref_hazardRecords)));
+		while (record) {
+			while (_Ref_loadPtr(&(record->hazard)) == object) {
+				System::yield(count);
+				count++;
+			}
+			record = record->next;
+		}
+	}
+
 	Referable::Referable()
 	{
 #ifdef SLIB_DEBUG_REFERENCE
@@ -48,48 +132,11 @@ namespace slib
 		_clearWeak();
 	}
 
-	sl_reg Referable::increaseReference()
-	{
-		if (m_nRefCount >= 0) {
-#ifdef SLIB_DEBUG_REFERENCE
-			_checkValid();
-#endif
-			return Base::interlockedIncrement(&m_nRefCount);
-		}
-		return 1;
-	}
-
-	sl_reg Referable::decreaseReference()
-	{
-		if (m_nRefCount > 0) {
-#ifdef SLIB_DEBUG_REFERENCE
-			_checkValid();
-#endif
-			sl_reg nRef = Base::interlockedDecrement(&m_nRefCount);
-			if (nRef == 0) {
-				_free();
-			}
-			return nRef;
-		}
-		return 1;
-	}
-	
 	sl_reg Referable::getReferenceCount()
 	{
 		return m_nRefCount;
 	}
 
-	sl_reg Referable::decreaseReferenceNoFree()
-	{
-		if (m_nRefCount > 0) {
-#ifdef SLIB_DEBUG_REFERENCE
-			_checkValid();
-#endif
-			return Base::interlockedDecrement(&m_nRefCount);
-		}
-		return 1;
-	}
-
 	void Referable::makeNeverFree()
 	{
 		m_nRefCount = -1;
@@ -173,23 +220,38 @@ namespace slib
 	Ref<Referable> CWeakRef::lock()
 	{
 		Ref<Referable> ret;
-		SpinLocker lock(&m_lock);
-		Referable* obj = m_object;
-		if (obj) {
-			sl_reg n = obj->increaseReference();
-			if (n > 1) {
-				ret = obj;
+		if (m_object) {
+			void** slot = _Ref_getHazardSlot();
+			Referable* obj = (Referable*)(_Ref_protectPtr(slot, (void* const*)(&m_object)));
+			if (obj) {
+				// the count is increased only while it is not zero: the object being freed is never revived or touched
+				for (;;) {
+					sl_reg n = *((volatile sl_reg*)(&(obj->m_nRefCount)));
+					if (n < 0) {
+						// never freed
+						ret = obj;
+						break;
+					}
+					if (!n) {
+						break;
+					}
+					if (Base::interlockedCompareExchange(&(obj->m_nRefCount), n + 1, n)) {
+						ret = obj;
+						obj->decreaseReferenceNoFree();
+						break;
+					}
+				}
+				_Ref_releasePtr(slot);
 			}
-			obj->decreaseReferenceNoFree();
 		}
 		return ret;
 	}
 
 	void CWeakRef::release()
 	{
-		{
-			SpinLocker lock(&m_lock);
-			m_object = sl_null;
+		Referable* obj = (Referable*)(_Ref_exchangePtr((void**)(&m_object), sl_null));
+		if (obj) {
+			_Ref_waitHazard(obj);
 		}
 		decreaseReference();
 	}
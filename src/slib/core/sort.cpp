@@ -0,0 +1,131 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/core/sort.h"
+
+#include "../../../inc/slib/core/thread_pool.h"
+#include "../../../inc/slib/core/event.h"
+#include "../../../inc/slib/core/system.h"
+#include "../../../inc/slib/core/safe_static.h"
+
+// minimum count of the elements sorted by a thread
+#define _PARALLEL_SORT_MIN_PART 8192
+
+namespace slib
+{
+
+	SLIB_SAFE_STATIC_GETTER(Ref<ThreadPool>, _ParallelSort_getDefaultPool, ThreadPool::create(0, System::getProcessorsCount()))
+
+	class _ParallelSortTasks : public Referable
+	{
+	public:
+		void (*callback)(void* context, sl_uint32 index);
+		void* context;
+		sl_int32 nTasks;
+		sl_int32 indexNext;
+		sl_int32 nCompleted;
+		Ref<Event> eventCompleted;
+
+	public:
+		// the workers and the calling thread take the tasks in turn
+		void run()
+		{
+			for (;;) {
+				sl_int32 index = Base::interlockedIncrement32(&indexNext) - 1;
+				if (index >= nTasks) {
+					return;
+				}
+				callback(context, index);
+				if (Base::interlockedIncrement32(&nCompleted) == nTasks) {
+					eventCompleted->set();
+				}
+			}
+		}
+
+	};
+
+	sl_uint32 ParallelSort::getThreadsCount(sl_size size, ThreadPool* pool)
+	{
+		sl_uint32 n;
+		if (pool) {
+			// the calling thread also runs the tasks
+			n = pool->getMaximumThreadsCount() + 1;
+		} else {
+			n = System::getProcessorsCount();
+		}
+		sl_size nMax = size / _PARALLEL_SORT_MIN_PART;
+		if (n > nMax) {
+			n = (sl_uint32)nMax;
+		}
+		if (n < 1) {
+			n = 1;
+		}
+		return n;
+	}
+
+	void ParallelSort::runTasks(ThreadPool* pool, sl_uint32 nTasks, void (*callback)(void* context, sl_uint32 index), void* context)
+	{
+		if (!nTasks) {
+			return;
+		}
+		sl_uint32 i;
+		Ref<ThreadPool> poolDefault;
+		if (!pool && nTasks > 1) {
+			Ref<ThreadPool>* p = _ParallelSort_getDefaultPool();
+			if (p) {
+				poolDefault = *p;
+				pool = poolDefault.get();
+			}
+		}
+		if (!pool || nTasks == 1) {
+			for (i = 0; i < nTasks; i++) {
+				callback(context, i);
+			}
+			return;
+		}
+		Ref<_ParallelSortTasks> tasks = new _ParallelSortTasks;
+		if (tasks.isNull()) {
+			for (i = 0; i < nTasks; i++) {
+				callback(context, i);
+			}
+			return;
+		}
+		tasks->callback = callback;
+		tasks->context = context;
+		tasks->nTasks = nTasks;
+		tasks->indexNext = 0;
+		tasks->nCompleted = 0;
+		tasks->eventCompleted = Event::create(sl_false);
+		if (tasks->eventCompleted.isNull()) {
+			for (i = 0; i < nTasks; i++) {
+				callback(context, i);
+			}
+			return;
+		}
+		sl_uint32 nWorkers = pool->getMaximumThreadsCount();
+		if (nWorkers > nTasks - 1) {
+			nWorkers = nTasks - 1;
+		}
+		for (i = 0; i < nWorkers; i++) {
+			// the remaining tasks are run by the calling thread when the pool is busy
+			if (!(pool->addTask([tasks]() {
+				tasks->run();
+			}))) {
+				break;
+			}
+		}
+		tasks->run();
+		// the workers may still hold `tasks` after this call, but they don't touch `context` any more
+		if (tasks->nCompleted != (sl_int32)nTasks) {
+			tasks->eventCompleted->wait();
+		}
+	}
+
+}
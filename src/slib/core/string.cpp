@@ -1593,15 +1593,35 @@ namespace slib
 	}
 
 
-	template <class CT>
-	SLIB_INLINE sl_uint32 _String_calcHash(const CT* buf, sl_size len)
+	SLIB_INLINE static sl_uint32 _String_calcHash(const sl_char8* buf, sl_size len)
 	{
-		sl_uint32 hash = 0;
-		for (sl_size i = 0; i < len; i++) {
-			sl_uint32 ch = buf[i];
-			hash = hash * 31 + ch;
+		return HashBytes(buf, len);
+	}
+
+	static sl_uint32 _String_calcHash(const sl_char16* buf, sl_size len)
+	{
+		sl_size i;
+		for (i = 0; i < len; i++) {
+			if ((sl_uint16)(buf[i]) > 0xFF) {
+				return HashBytes(buf, len << 1);
+			}
+		}
+		// the code units are narrowed to be hashed as `String` does, so the same content has the same hash code in both types
+		sl_uint8 bufStack[256];
+		sl_uint8* narrow = bufStack;
+		if (len > sizeof(bufStack)) {
+			narrow = (sl_uint8*)(Base::createMemory(len));
+			if (!narrow) {
+				return HashBytes(buf, len << 1);
+			}
+		}
+		for (i = 0; i < len; i++) {
+			narrow[i] = (sl_uint8)(buf[i]);
+		}
+		sl_uint32 hash = HashBytes(narrow, len);
+		if (narrow != bufStack) {
+			Base::freeMemory(narrow);
 		}
-		hash = Rehash(hash);
 		return hash;
 	}
 
@@ -10,20 +10,175 @@
 
 #include "../../../inc/slib/core/thread_pool.h"
 
+#include "../../../inc/slib/core/system.h"
+#include "../../../inc/slib/core/spin_lock.h"
+
+#if defined(SLIB_PLATFORM_IS_WIN32)
+#include <windows.h>
+#elif defined(SLIB_PLATFORM_IS_LINUX)
+#include <sched.h>
+#endif
+
+// milliseconds for the workers over the minimum count to wait new tasks before exiting
+#define THREAD_POOL_IDLE_TIMEOUT 5000
+
 namespace slib
 {
 
+	// the counters shared by the workers are accessed atomically
+	SLIB_INLINE static sl_int32 _ThreadPool_load(const sl_int32* p)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		return *((const volatile sl_int32*)p);
+#else
+		return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	SLIB_INLINE static void _ThreadPool_store(sl_int32* p, sl_int32 value)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		_InterlockedExchange((long*)p, (long)value);
+#else
+		__atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+#endif
+	}
+
+	class _ThreadPoolWorker
+	{
+	public:
+		ThreadPool* pool;
+		sl_uint32 index;
+
+		Ref<Thread> thread;
+		Ref<Event> eventWake;
+
+		SpinLock lockTasks;
+		CLinkedList< Function<void()> > tasks;
+		sl_int32 nTasks;
+
+		// accepts the tasks only when active
+		sl_bool flagActive;
+		sl_int32 flagParked;
+
+	public:
+		_ThreadPoolWorker()
+		{
+			pool = sl_null;
+			index = 0;
+			nTasks = 0;
+			flagActive = sl_false;
+			flagParked = 0;
+		}
+
+	public:
+		sl_bool push(const Function<void()>& task)
+		{
+			SpinLocker lock(&lockTasks);
+			if (!flagActive) {
+				return sl_false;
+			}
+			if (tasks.pushBack_NoLock(task)) {
+				Base::interlockedIncrement32(&nTasks);
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+		// the owner takes the oldest task too, so the tasks added to a worker are run in the order of adding
+		sl_bool pop(Function<void()>& task)
+		{
+			if (!(_ThreadPool_load(&nTasks))) {
+				return sl_false;
+			}
+			SpinLocker lock(&lockTasks);
+			if (tasks.popFront_NoLock(&task)) {
+				Base::interlockedDecrement32(&nTasks);
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+		// the thieves take the oldest task
+		sl_bool steal(Function<void()>& task)
+		{
+			if (!(_ThreadPool_load(&nTasks))) {
+				return sl_false;
+			}
+			if (!(lockTasks.tryLock())) {
+				return sl_false;
+			}
+			sl_bool flagSuccess = sl_false;
+			if (tasks.popFront_NoLock(&task)) {
+				Base::interlockedDecrement32(&nTasks);
+				flagSuccess = sl_true;
+			}
+			lockTasks.unlock();
+			return flagSuccess;
+		}
+
+		sl_bool wake()
+		{
+			if (Base::interlockedCompareExchange32(&flagParked, 0, 1)) {
+				Base::interlockedDecrement32(&(pool->m_nWorkersParked));
+				eventWake->set();
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+	};
+
+	SLIB_THREAD _ThreadPoolWorker* _gt_threadPoolWorkerCurrent = sl_null;
+
+	static void _ThreadPool_setAffinity(sl_uint32 index)
+	{
+		sl_uint32 nProcessors = System::getProcessorsCount();
+		if (nProcessors < 2) {
+			return;
+		}
+		index = index % nProcessors;
+#if defined(SLIB_PLATFORM_IS_WIN32)
+		if (index < sizeof(DWORD_PTR) * 8) {
+			::SetThreadAffinityMask(::GetCurrentThread(), ((DWORD_PTR)1) << index);
+		}
+#elif defined(SLIB_PLATFORM_IS_LINUX)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(index, &set);
+		::sched_setaffinity(0, sizeof(set), &set);
+#endif
+	}
+
+
 	SLIB_DEFINE_OBJECT(ThreadPool, Dispatcher)
 
 	ThreadPool::ThreadPool()
 	{
 		setThreadStackSize(SLIB_THREAD_DEFAULT_STACK_SIZE);
+		setCpuAffinity(sl_false);
+
+		m_workers = sl_null;
+		m_nWorkerSlots = 0;
+		m_nWorkersActive = 0;
+		m_nWorkersParked = 0;
+		m_nTasks = 0;
+		m_indexWorkerNext = 0;
+		m_indexWorkerTimeWaiting = 0;
+		m_timeNextTask = 0;
+
 		m_flagRunning = sl_true;
 	}
 
 	ThreadPool::~ThreadPool()
 	{
 		release();
+		if (m_workers) {
+			for (sl_uint32 i = 0; i < m_nWorkerSlots; i++) {
+				delete m_workers[i];
+			}
+			delete[] m_workers;
+		}
 	}
 
 	Ref<ThreadPool> ThreadPool::create(sl_uint32 minThreads, sl_uint32 maxThreads)
@@ -43,15 +198,32 @@ namespace slib
 			return;
 		}
 		m_flagRunning = sl_false;
-		
-		ListElements< Ref<Thread> > threads(m_threadWorkers);
-		sl_size i;
-		for (i = 0; i < threads.count; i++) {
-			threads[i]->finish();
+
+		if (!m_workers) {
+			return;
 		}
-		for (i = 0; i < threads.count; i++) {
-			threads[i]->finishAndWait();
+
+		sl_uint32 i;
+		sl_uint32 n = m_nWorkerSlots;
+		for (i = 0; i < n; i++) {
+			_ThreadPoolWorker* worker = m_workers[i];
+			Ref<Thread> thread = worker->thread;
+			if (thread.isNotNull()) {
+				thread->finish();
+				worker->eventWake->set();
+			}
+		}
+		lock.unlock();
+		for (i = 0; i < n; i++) {
+			_ThreadPoolWorker* worker = m_workers[i];
+			Ref<Thread> thread = worker->thread;
+			if (thread.isNotNull()) {
+				thread->finishAndWait();
+			}
 		}
+
+		MutexLocker lockTime(&m_lockTimeTasks);
+		m_timeTasks.removeAll();
 	}
 
 	sl_bool ThreadPool::isRunning()
@@ -61,7 +233,7 @@ namespace slib
 
 	sl_uint32 ThreadPool::getThreadsCount()
 	{
-		return (sl_uint32)(m_threadWorkers.getCount());
+		return (sl_uint32)(_ThreadPool_load(&m_nWorkersActive));
 	}
 
 	sl_bool ThreadPool::addTask(const Function<void()>& task)
@@ -69,59 +241,314 @@ namespace slib
 		if (task.isNull()) {
 			return sl_false;
 		}
-		ObjectLocker lock(this);
 		if (!m_flagRunning) {
 			return sl_false;
 		}
-		// add task
-		if (!(m_tasks.push(task))) {
-			return sl_false;
+		if (!m_workers) {
+			ObjectLocker lock(this);
+			if (!m_workers) {
+				if (!(_initWorkers())) {
+					return sl_false;
+				}
+			}
 		}
+		if (_pushTask(task)) {
+			return sl_true;
+		}
+		return _startWorker(task);
+	}
 
-		// wake a sleeping worker
+	sl_bool ThreadPool::dispatch(const Function<void()>& callback, sl_uint64 delay_ms)
+	{
+		if (delay_ms == 0) {
+			return addTask(callback);
+		}
+		if (callback.isNull()) {
+			return sl_false;
+		}
+		if (!m_flagRunning) {
+			return sl_false;
+		}
 		{
-			ListElements< Ref<Thread> > threads(m_threadWorkers);
-			for (sl_size i = 0; i < threads.count; i++) {
-				if (threads[i]->isWaiting()) {
-					threads[i]->wake();
-					return sl_true;
+			MutexLocker lock(&m_lockTimeTasks);
+			TimeTask tt;
+			tt.time = m_timeCounter.getElapsedMilliseconds() + delay_ms;
+			tt.task = callback;
+			if (!(m_timeTasks.put(tt.time, tt, MapPutMode::AddAlways))) {
+				return sl_false;
+			}
+			if (m_timeTasks.getCount() == 1 || tt.time < m_timeNextTask) {
+				m_timeNextTask = tt.time;
+			}
+		}
+		// the worker waiting for the time tasks should update its timeout
+		sl_int32 indexTimeWaiting = _ThreadPool_load(&m_indexWorkerTimeWaiting);
+		if (indexTimeWaiting) {
+			_ThreadPoolWorker* worker = m_workers[indexTimeWaiting - 1];
+			if (!(worker->wake())) {
+				// not parked yet, but its timeout may be computed before this task: the pending event ends the next wait at once
+				worker->eventWake->set();
+			}
+		} else if (_ThreadPool_load(&m_nWorkersParked) > 0) {
+			_wakeParkedWorker();
+		} else if (_ThreadPool_load(&m_nWorkersActive) == 0) {
+			if (!m_workers) {
+				ObjectLocker lock(this);
+				if (!m_workers) {
+					if (!(_initWorkers())) {
+						return sl_false;
+					}
 				}
 			}
+			_startWorker(sl_null);
 		}
+		return sl_true;
+	}
 
-		// increase workers
-		{
-			sl_size nThreads = m_threadWorkers.getCount();
-			if (nThreads == 0 || (nThreads < getMaximumThreadsCount())) {
-				Ref<Thread> worker = Thread::start(SLIB_FUNCTION_CLASS(ThreadPool, onRunWorker, this), getThreadStackSize());
-				if (worker.isNotNull()) {
-					m_threadWorkers.add_NoLock(worker);
+	sl_bool ThreadPool::_initWorkers()
+	{
+		sl_uint32 n = getMaximumThreadsCount();
+		if (n == 0) {
+			n = 1;
+		}
+		_ThreadPoolWorker** workers = new _ThreadPoolWorker*[n];
+		if (!workers) {
+			return sl_false;
+		}
+		for (sl_uint32 i = 0; i < n; i++) {
+			_ThreadPoolWorker* worker = new _ThreadPoolWorker;
+			if (worker) {
+				worker->eventWake = Event::create();
+				if (worker->eventWake.isNotNull()) {
+					worker->pool = this;
+					worker->index = i;
+					workers[i] = worker;
+					continue;
 				}
+				delete worker;
+			}
+			for (sl_uint32 k = 0; k < i; k++) {
+				delete workers[k];
 			}
+			delete[] workers;
+			return sl_false;
 		}
+		m_nWorkerSlots = n;
+		m_workers = workers;
 		return sl_true;
 	}
 
-	sl_bool ThreadPool::dispatch(const Function<void()>& callback, sl_uint64 delay_ms)
+	sl_bool ThreadPool::_pushTask(const Function<void()>& task)
 	{
-		return addTask(callback);
+		_ThreadPoolWorker* target = sl_null;
+		_ThreadPoolWorker* current = _gt_threadPoolWorkerCurrent;
+		if (current && current->pool == this && current->push(task)) {
+			target = current;
+		} else {
+			sl_uint32 n = m_nWorkerSlots;
+			sl_uint32 start = m_indexWorkerNext++;
+			for (sl_uint32 i = 0; i < n; i++) {
+				_ThreadPoolWorker* worker = m_workers[(start + i) % n];
+				if (worker->flagActive && worker->push(task)) {
+					target = worker;
+					break;
+				}
+			}
+			if (!target) {
+				return sl_false;
+			}
+		}
+		Base::interlockedIncrement32(&m_nTasks);
+		sl_uint32 nWorkersActive = (sl_uint32)(_ThreadPool_load(&m_nWorkersActive));
+		if (_ThreadPool_load(&(target->flagParked))) {
+			target->wake();
+		} else if (_ThreadPool_load(&m_nWorkersParked) > 0) {
+			_wakeParkedWorker();
+		} else if (nWorkersActive < m_nWorkerSlots && nWorkersActive < getMaximumThreadsCount()) {
+			// every worker is busy: adds a worker to steal the tasks
+			_startWorker(sl_null);
+		}
+		return sl_true;
 	}
 
-	void ThreadPool::onRunWorker()
+	sl_bool ThreadPool::_startWorker(const Function<void()>& task)
 	{
+		ObjectLocker lock(this);
+		if (!m_flagRunning) {
+			return sl_false;
+		}
+		sl_uint32 nMax = getMaximumThreadsCount();
+		if (nMax == 0) {
+			nMax = 1;
+		}
+		sl_int32 nWorkersActive = _ThreadPool_load(&m_nWorkersActive);
+		if (nWorkersActive > 0 && (sl_uint32)nWorkersActive >= nMax) {
+			if (task.isNotNull()) {
+				return _pushTask(task);
+			}
+			return sl_false;
+		}
+		for (sl_uint32 i = 0; i < m_nWorkerSlots; i++) {
+			_ThreadPoolWorker* worker = m_workers[i];
+			if (!(worker->flagActive)) {
+				worker->flagActive = sl_true;
+				if (task.isNotNull()) {
+					worker->push(task);
+					Base::interlockedIncrement32(&m_nTasks);
+				}
+				Base::interlockedIncrement32(&m_nWorkersActive);
+				worker->thread = Thread::create([this, worker]() {
+					onRunWorker(worker);
+				});
+				if (worker->thread.isNotNull() && worker->thread->start(getThreadStackSize())) {
+					return sl_true;
+				}
+				worker->thread.setNull();
+				Base::interlockedDecrement32(&m_nWorkersActive);
+				Function<void()> t;
+				SpinLocker lockTasks(&(worker->lockTasks));
+				worker->flagActive = sl_false;
+				while (worker->tasks.popFront_NoLock(&t)) {
+					Base::interlockedDecrement32(&(worker->nTasks));
+					Base::interlockedDecrement32(&m_nTasks);
+				}
+				return sl_false;
+			}
+		}
+		if (task.isNotNull()) {
+			return _pushTask(task);
+		}
+		return sl_false;
+	}
+
+	void ThreadPool::_wakeParkedWorker()
+	{
+		sl_uint32 n = m_nWorkerSlots;
+		for (sl_uint32 i = 0; i < n; i++) {
+			_ThreadPoolWorker* worker = m_workers[i];
+			if (_ThreadPool_load(&(worker->flagParked))) {
+				worker->wake();
+				return;
+			}
+		}
+	}
+
+	sl_bool ThreadPool::_popTask(_ThreadPoolWorker* worker, Function<void()>& task)
+	{
+		if (worker->pop(task)) {
+			Base::interlockedDecrement32(&m_nTasks);
+			return sl_true;
+		}
+		if (_ThreadPool_load(&m_nTasks) > 0) {
+			sl_uint32 n = m_nWorkerSlots;
+			for (sl_uint32 i = 1; i < n; i++) {
+				_ThreadPoolWorker* other = m_workers[(worker->index + i) % n];
+				if (other->steal(task)) {
+					Base::interlockedDecrement32(&m_nTasks);
+					return sl_true;
+				}
+			}
+		}
+		return sl_false;
+	}
+
+	sl_int32 ThreadPool::_processTimeTasks(_ThreadPoolWorker* worker)
+	{
+		MutexLocker lock(&m_lockTimeTasks);
+		if (m_timeTasks.getCount() == 0) {
+			m_timeNextTask = 0;
+			return -1;
+		}
+		sl_uint64 rel = m_timeCounter.getElapsedMilliseconds();
+		sl_int32 timeout = -1;
+		TreePosition pos;
+		TimeTask timeTask;
+		sl_uint64 t;
+		while (m_timeTasks.getFirstPosition(pos, &t, &timeTask)) {
+			if (rel >= t) {
+				if (worker->push(timeTask.task)) {
+					Base::interlockedIncrement32(&m_nTasks);
+				}
+				m_timeTasks.removeAt(pos);
+			} else {
+				m_timeNextTask = t;
+				timeout = (sl_int32)(t - rel);
+				break;
+			}
+		}
+		return timeout;
+	}
+
+	void ThreadPool::onRunWorker(_ThreadPoolWorker* worker)
+	{
+		_gt_threadPoolWorkerCurrent = worker;
+		if (isCpuAffinity()) {
+			_ThreadPool_setAffinity(worker->index);
+		}
+
 		while (m_flagRunning && Thread::isNotStoppingCurrent()) {
+
+			// the time tasks are due while all the workers are busy
+			if (m_timeTasks.getCount() > 0 && m_timeCounter.getElapsedMilliseconds() >= m_timeNextTask) {
+				_processTimeTasks(worker);
+			}
+
 			Function<void()> task;
-			if (m_tasks.pop(&task)) {
+			if (_popTask(worker, task)) {
 				task();
-			} else {
+				continue;
+			}
+
+			// only one worker waits for the time tasks
+			sl_int32 timeout = THREAD_POOL_IDLE_TIMEOUT;
+			sl_bool flagTimeWaiting = Base::interlockedCompareExchange32(&m_indexWorkerTimeWaiting, worker->index + 1, 0);
+			if (flagTimeWaiting) {
+				sl_int32 t = _processTimeTasks(worker);
+				if (_ThreadPool_load(&(worker->nTasks))) {
+					_ThreadPool_store(&m_indexWorkerTimeWaiting, 0);
+					continue;
+				}
+				if (t >= 0) {
+					timeout = t;
+				}
+			}
+			if ((sl_uint32)(_ThreadPool_load(&m_nWorkersActive)) <= getMinimumThreadsCount() && !flagTimeWaiting) {
+				timeout = -1;
+			}
+
+			// park
+			Base::interlockedIncrement32(&m_nWorkersParked);
+			Base::interlockedCompareExchange32(&(worker->flagParked), 1, 0);
+			if (_ThreadPool_load(&m_nTasks) > 0 || !m_flagRunning) {
+				if (Base::interlockedCompareExchange32(&(worker->flagParked), 0, 1)) {
+					Base::interlockedDecrement32(&m_nWorkersParked);
+				}
+				if (flagTimeWaiting) {
+					_ThreadPool_store(&m_indexWorkerTimeWaiting, 0);
+				}
+				continue;
+			}
+			sl_bool flagWoken = worker->eventWake->wait(timeout);
+			if (Base::interlockedCompareExchange32(&(worker->flagParked), 0, 1)) {
+				Base::interlockedDecrement32(&m_nWorkersParked);
+			}
+			if (flagTimeWaiting) {
+				_ThreadPool_store(&m_indexWorkerTimeWaiting, 0);
+			}
+
+			if (!flagWoken && _ThreadPool_load(&m_nTasks) == 0 && timeout == THREAD_POOL_IDLE_TIMEOUT) {
 				ObjectLocker lock(this);
-				sl_size nThreads = m_threadWorkers.getCount();
-				if (nThreads > getMinimumThreadsCount()) {
-					m_threadWorkers.removeValue_NoLock(Thread::getCurrent());
-					return;
-				} else {
-					lock.unlock();
-					Thread::sleep(5000);
+				if (!m_flagRunning) {
+					break;
+				}
+				if ((sl_uint32)(_ThreadPool_load(&m_nWorkersActive)) > getMinimumThreadsCount()) {
+					SpinLocker lockTasks(&(worker->lockTasks));
+					if (worker->tasks.isEmpty()) {
+						// the slot can be reused by a new worker from now
+						worker->flagActive = sl_false;
+						Base::interlockedDecrement32(&m_nWorkersActive);
+						return;
+					}
 				}
 			}
 		}
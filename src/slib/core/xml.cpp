@@ -1394,6 +1394,8 @@ namespace slib
 		sl_size lineNumber;
 		sl_size columnNumber;
 		sl_size posForLineColumn;
+		// offset of `buf` in the whole source, used for the positions of the nodes
+		sl_size offsetSource;
 		
 		Ref<XmlDocument> document;
 		Ptr<IXmlParseListener> listener;
@@ -1427,12 +1429,20 @@ namespace slib
 		
 		void parseAttribute(String& name, String& value);
 		
+		void parseStartTag(XmlNodeGroup* parent, String& defNamespace, Map<String, String>& namespaces, CList<String>& listPrefixMappings, Ref<XmlElement>& element, sl_size& posNameStart, sl_size& lenName, sl_bool& flagEmptyTag);
+		
+		void endElement(XmlElement* element, CList<String>& listPrefixMappings);
+		
 		void parseElement(XmlNodeGroup* parent, const String& defNamespace, const Map<String, String>& namespaces);
 		
 		void parseText(XmlNodeGroup* parent);
 		
 		void parseNodes(XmlNodeGroup* parent, const String& defNamespace, const Map<String, String>& namespaces);
 		
+		void startDocument();
+		
+		void endDocument();
+		
 		void parseXml();
 		
 		static Ref<XmlDocument> parseXml(const String& sourceFilePath, const CT* buf, sl_size len, XmlParseParam& param);
@@ -1499,6 +1509,7 @@ namespace slib
 	SLIB_STATIC_STRING(_g_xml_error_msg_element_attr_duplicate, "Attribute name is already specified")
 	SLIB_STATIC_STRING(_g_xml_error_msg_content_include_lt, "Content must not include less-than(<) character")
 	SLIB_STATIC_STRING(_g_xml_error_msg_document_not_wellformed, "Document must be well-formed")
+	SLIB_STATIC_STRING(_g_xml_error_msg_file_open, "Failed to open the file")
 
 #define CALL_LISTENER(NAME, NODE, ...) \
 	{ \
@@ -1534,6 +1545,7 @@ namespace slib
 		lineNumber = 1;
 		columnNumber = 1;
 		posForLineColumn = 0;
+		offsetSource = 0;
 
 		buf = sl_null;
 		len = 0;
@@ -1608,7 +1620,7 @@ namespace slib
 	template <class ST, class CT, class BT>
 	void _Xml_Parser<ST, CT, BT>::escapeEntity(BT* sb)
 	{
-		if (pos < len - 2 && buf[pos] == 'l' && buf[pos+1] == 't' && buf[pos+2] == ';') {
+		if (pos + 2 < len && buf[pos] == 'l' && buf[pos+1] == 't' && buf[pos+2] == ';') {
 			static CT sc = '<';
 			if (sb) {
 				if (!(sb->addStatic(&sc, 1))) {
@@ -1616,7 +1628,7 @@ namespace slib
 				}
 			}
 			pos += 3;
-		} else if (pos < len - 2 && buf[pos] == 'g' && buf[pos+1] == 't' && buf[pos+2] == ';') {
+		} else if (pos + 2 < len && buf[pos] == 'g' && buf[pos+1] == 't' && buf[pos+2] == ';') {
 			static CT sc = '>';
 			if (sb) {
 				if (!(sb->addStatic(&sc, 1))) {
@@ -1624,7 +1636,7 @@ namespace slib
 				}
 			}
 			pos += 3;
-		} else if (pos < len - 3 && buf[pos] == 'a' && buf[pos+1] == 'm' && buf[pos+2] == 'p' && buf[pos+3] == ';') {
+		} else if (pos + 3 < len && buf[pos] == 'a' && buf[pos+1] == 'm' && buf[pos+2] == 'p' && buf[pos+3] == ';') {
 			static CT sc = '&';
 			if (sb) {
 				if (!(sb->addStatic(&sc, 1))) {
@@ -1632,7 +1644,7 @@ namespace slib
 				}
 			}
 			pos += 4;
-		} else if (pos < len - 4 && buf[pos] == 'a' && buf[pos+1] == 'p' && buf[pos+2] == 'o' && buf[pos+3] == 's' && buf[pos+4] == ';') {
+		} else if (pos + 4 < len && buf[pos] == 'a' && buf[pos+1] == 'p' && buf[pos+2] == 'o' && buf[pos+3] == 's' && buf[pos+4] == ';') {
 			static CT sc = '\'';
 			if (sb) {
 				if (!(sb->addStatic(&sc, 1))) {
@@ -1640,7 +1652,7 @@ namespace slib
 				}
 			}
 			pos += 5;
-		} else if (pos < len - 4 && buf[pos] == 'q' && buf[pos+1] == 'u' && buf[pos+2] == 'o' && buf[pos+3] == 't' && buf[pos+4] == ';') {
+		} else if (pos + 4 < len && buf[pos] == 'q' && buf[pos+1] == 'u' && buf[pos+2] == 'o' && buf[pos+3] == 't' && buf[pos+4] == ';') {
 			static CT sc = '\"';
 			if (sb) {
 				if (!(sb->addStatic(&sc, 1))) {
@@ -1648,15 +1660,15 @@ namespace slib
 				}
 			}
 			pos += 5;
-		} else if (pos < len - 2 && buf[pos] == '#'){
+		} else if (pos + 2 < len && buf[pos] == '#'){
 			pos++;
 			sl_uint32 n;
 			sl_reg parseRes;
 			if (buf[pos] == 'x') {
 				pos++;
-				parseRes = ST::parseUint32(16, &n, buf, pos, len - pos);
+				parseRes = ST::parseUint32(16, &n, buf, pos, len);
 			} else {
-				parseRes = ST::parseUint32(10, &n, buf, pos, len - pos);
+				parseRes = ST::parseUint32(10, &n, buf, pos, len);
 			}
 			if (parseRes == SLIB_PARSE_ERROR) {
 				REPORT_ERROR(_g_xml_error_msg_invalid_escape)
@@ -1959,28 +1971,26 @@ namespace slib
 	}
 
 	template <class ST, class CT, class BT>
-	void _Xml_Parser<ST, CT, BT>::parseElement(XmlNodeGroup* parent, const String& _defNamespace, const Map<String, String>& _namespaces)
+	void _Xml_Parser<ST, CT, BT>::parseStartTag(XmlNodeGroup* parent, String& defNamespace, Map<String, String>& namespaces, CList<String>& listPrefixMappings, Ref<XmlElement>& element, sl_size& posNameStart, sl_size& lenName, sl_bool& flagEmptyTag)
 	{
-		String defNamespace = _defNamespace;
-		Map<String, String> namespaces = _namespaces;
+		Map<String, String> _namespaces = namespaces;
 		
 		calcLineNumber();
 		sl_size startLine = lineNumber;
 		sl_size startColumn = columnNumber;
-		sl_size posNameStart = pos;
+		posNameStart = pos;
 		String name;
 		parseName(name);
 		if (flagError) {
 			return;
 		}
-		sl_size lenName = pos - posNameStart;
+		lenName = pos - posNameStart;
 		
-		Ref<XmlElement> element = new XmlElement;
+		element = new XmlElement;
 		if (element.isNull()) {
 			REPORT_ERROR(_g_xml_error_msg_memory_lack)
 		}
 		
-		CList<String> listPrefixMappings;
 		sl_size indexAttr = 0;
 		
 		while (pos < len) {
@@ -2062,7 +2072,7 @@ namespace slib
 		if (pos >= len) {
 			REPORT_ERROR(_g_xml_error_msg_element_tag_not_end)
 		}
-		sl_bool flagEmptyTag = sl_false;
+		flagEmptyTag = sl_false;
 		if (buf[pos] == '/') {
 			if (pos < len - 1 && buf[pos+1] == '>') {
 				flagEmptyTag = sl_true;
@@ -2075,10 +2085,10 @@ namespace slib
 		}
 		
 		element->setSourceFilePath(sourceFilePath);
-		element->setStartPositionInSource(posNameStart);
+		element->setStartPositionInSource(offsetSource + posNameStart);
 		element->setLineNumberInSource(startLine);
 		element->setColumnNumberInSource(startColumn);
-		element->setEndPositionInSource(pos);
+		element->setEndPositionInSource(offsetSource + pos);
 
 		String prefix, uri, localName;
 		processPrefix(name, defNamespace, namespaces, prefix, uri, localName);
@@ -2092,6 +2102,34 @@ namespace slib
 			}
 		}
 		CALL_LISTENER(onStartElement, element.get(), element.get())
+	}
+
+	template <class ST, class CT, class BT>
+	void _Xml_Parser<ST, CT, BT>::endElement(XmlElement* element, CList<String>& listPrefixMappings)
+	{
+		element->setEndPositionInSource(offsetSource + pos);
+		CALL_LISTENER(onEndElement, element, element);
+		if (param.flagProcessNamespaces) {
+			ListLocker<String> prefixes(listPrefixMappings);
+			for (sl_size i = 0; i < prefixes.count; i++) {
+				CALL_LISTENER(onEndPrefixMapping, element, prefixes[i]);
+			}
+		}
+	}
+
+	template <class ST, class CT, class BT>
+	void _Xml_Parser<ST, CT, BT>::parseElement(XmlNodeGroup* parent, const String& _defNamespace, const Map<String, String>& _namespaces)
+	{
+		String defNamespace = _defNamespace;
+		Map<String, String> namespaces = _namespaces;
+		CList<String> listPrefixMappings;
+		Ref<XmlElement> element;
+		sl_size posNameStart, lenName;
+		sl_bool flagEmptyTag;
+		parseStartTag(parent, defNamespace, namespaces, listPrefixMappings, element, posNameStart, lenName, flagEmptyTag);
+		if (flagError) {
+			return;
+		}
 		if (!flagEmptyTag) {
 			parseNodes(parent ? element.get() : sl_null, defNamespace, namespaces);
 			if (flagError) {
@@ -2125,14 +2163,7 @@ namespace slib
 			}
 			pos++;
 		}
-		element->setEndPositionInSource(pos);
-		CALL_LISTENER(onEndElement, element.get(), element.get());
-		if (param.flagProcessNamespaces) {
-			ListLocker<String> prefixes(listPrefixMappings);
-			for (sl_size i = 0; i < prefixes.count; i++) {
-				CALL_LISTENER(onEndPrefixMapping, element.get(), prefixes[i]);
-			}
-		}
+		endElement(element.get(), listPrefixMappings);
 	}
 
 	template <class ST, class CT, class BT>
@@ -2273,9 +2304,24 @@ namespace slib
 	}
 
 	template <class ST, class CT, class BT>
-	void _Xml_Parser<ST, CT, BT>::parseXml()
+	void _Xml_Parser<ST, CT, BT>::startDocument()
 	{
 		CALL_LISTENER(onStartDocument, document.get(), document.get())
+	}
+
+	template <class ST, class CT, class BT>
+	void _Xml_Parser<ST, CT, BT>::endDocument()
+	{
+		CALL_LISTENER(onEndDocument, document.get(), document.get())
+	}
+
+	template <class ST, class CT, class BT>
+	void _Xml_Parser<ST, CT, BT>::parseXml()
+	{
+		startDocument();
+		if (flagError) {
+			return;
+		}
 		parseNodes(document.get(), String::null(), Map<String, String>::null());
 		if (flagError) {
 			return;
@@ -2288,7 +2334,7 @@ namespace slib
 				REPORT_ERROR(_g_xml_error_msg_document_not_wellformed);
 			}
 		}
-		CALL_LISTENER(onEndDocument, document.get(), document.get())
+		endDocument();
 	}
 
 	template <class ST, class CT, class BT>
@@ -2393,6 +2439,577 @@ namespace slib
 		return _Xml_Parser<String16, sl_char16, StringBuffer16>::parseXml(filePath, xml.getData(), xml.getLength(), param);
 	}
 
+	sl_bool Xml::parseXmlStream(IReader* reader, XmlParseParam& param)
+	{
+		param.flagError = sl_false;
+		Ref<XmlStreamParser> parser = XmlStreamParser::create(param);
+		if (parser.isNull()) {
+			param.flagError = sl_true;
+			param.errorMessage = _g_xml_error_msg_memory_lack;
+			return sl_false;
+		}
+		if (parser->feedFromReader(reader) && parser->end()) {
+			return sl_true;
+		}
+		const XmlParseParam& result = parser->getParam();
+		param.flagError = sl_true;
+		param.errorPosition = result.errorPosition;
+		param.errorLine = result.errorLine;
+		param.errorColumn = result.errorColumn;
+		param.errorMessage = result.errorMessage;
+		return sl_false;
+	}
+
+	sl_bool Xml::parseXmlStreamFromFile(const String& filePath, XmlParseParam& param)
+	{
+		Ref<File> file = File::openForRead(filePath);
+		if (file.isNull()) {
+			param.flagError = sl_true;
+			param.errorPosition = 0;
+			param.errorLine = 0;
+			param.errorColumn = 0;
+			param.errorMessage = _g_xml_error_msg_file_open;
+			return sl_false;
+		}
+		return parseXmlStream(file.get(), param);
+	}
+
+/************************************************
+				XmlStreamParser
+************************************************/
+
+#define _XML_STREAM_READ_SIZE 65536
+
+	SLIB_DEFINE_OBJECT(XmlStreamParser, Object)
+
+	XmlStreamParser::XmlStreamParser()
+	{
+	}
+
+	XmlStreamParser::~XmlStreamParser()
+	{
+	}
+
+	sl_bool XmlStreamParser::isError() const
+	{
+		return m_param.flagError;
+	}
+
+	const XmlParseParam& XmlStreamParser::getParam() const
+	{
+		return m_param;
+	}
+
+	class _Xml_StreamElement : public Referable
+	{
+	public:
+		Ref<XmlElement> element;
+		String defNamespace;
+		Map<String, String> namespaces;
+		CList<String> listPrefixMappings;
+	};
+
+	// 1: matched, 0: not matched, -1: more data is needed
+	static sl_int32 _Xml_StreamParser_matchPrefix(const sl_char8* data, sl_size size, const char* prefix, sl_size len)
+	{
+		sl_size n = size < len ? size : len;
+		if (!(Base::equalsMemory(data, prefix, n))) {
+			return 0;
+		}
+		return n == len ? 1 : -1;
+	}
+
+	// returns the index of `pattern` in [start, size), or SLIB_SIZE_MAX if not found
+	static sl_size _Xml_StreamParser_find(const sl_char8* data, sl_size start, sl_size size, const char* pattern, sl_size len)
+	{
+		while (start + len <= size) {
+			const sl_char8* p = (const sl_char8*)(Base::findMemory(data + start, pattern[0], size - start - len + 1));
+			if (!p) {
+				break;
+			}
+			start = p - data;
+			if (Base::equalsMemory(p + 1, pattern + 1, len - 1)) {
+				return start;
+			}
+			start++;
+		}
+		return SLIB_SIZE_MAX;
+	}
+
+	class _Xml_StreamParser : public XmlStreamParser
+	{
+	public:
+		_Xml_Parser<String, sl_char8, StringBuffer> m_parser;
+
+		sl_char8* m_buf;
+		sl_size m_sizeBuf;
+		sl_size m_capacity;
+		// position in the whole source of `m_buf` (or the chunk parsed in place)
+		sl_size m_offset;
+		// bytes at the start of `m_buf` which are already searched for the end of the unfinished markup
+		sl_size m_sizeSearched;
+
+		CList< Ref<_Xml_StreamElement> > m_elements;
+		sl_uint32 m_nRootElements;
+		sl_bool m_flagRootText;
+
+		sl_bool m_flagStarted;
+		sl_bool m_flagEnded;
+
+	public:
+		_Xml_StreamParser()
+		{
+			m_buf = sl_null;
+			m_sizeBuf = 0;
+			m_capacity = 0;
+			m_offset = 0;
+			m_sizeSearched = 0;
+			m_nRootElements = 0;
+			m_flagRootText = sl_false;
+			m_flagStarted = sl_false;
+			m_flagEnded = sl_false;
+		}
+
+		~_Xml_StreamParser()
+		{
+			if (m_buf) {
+				Base::freeMemory(m_buf);
+			}
+		}
+
+	public:
+		void init(const XmlParseParam& param)
+		{
+			m_param = param;
+			m_param.flagError = sl_false;
+			m_parser.param = param;
+			m_parser.listener = param.listener;
+			m_parser.control.characterSize = 1;
+		}
+
+		// override
+		sl_bool feed(const void* _data, sl_size size)
+		{
+			if (!(_begin())) {
+				return sl_false;
+			}
+			const sl_char8* data = (const sl_char8*)_data;
+			if (m_sizeBuf) {
+				if (!(_reserve(m_sizeBuf + size))) {
+					return sl_false;
+				}
+				Base::copyMemory(m_buf + m_sizeBuf, data, size);
+				m_sizeBuf += size;
+				return _processBuffer(sl_false);
+			}
+			// parses in place, and keeps only the unfinished markup
+			sl_size n = _process(data, size, sl_false, 0);
+			if (m_parser.flagError) {
+				return _reportError();
+			}
+			m_offset += n;
+			if (n < size) {
+				if (!(_reserve(size - n))) {
+					return sl_false;
+				}
+				Base::copyMemory(m_buf, data + n, size - n);
+				m_sizeBuf = size - n;
+				m_sizeSearched = m_sizeBuf;
+			}
+			return sl_true;
+		}
+
+		// override
+		sl_bool feedFromReader(IReader* reader)
+		{
+			if (!(_begin())) {
+				return sl_false;
+			}
+			for (;;) {
+				if (!(_reserve(m_sizeBuf + _XML_STREAM_READ_SIZE))) {
+					return sl_false;
+				}
+				sl_reg n = reader->read(m_buf + m_sizeBuf, m_capacity - m_sizeBuf);
+				if (n <= 0) {
+					break;
+				}
+				m_sizeBuf += n;
+				if (!(_processBuffer(sl_false))) {
+					return sl_false;
+				}
+			}
+			return sl_true;
+		}
+
+		// override
+		sl_bool end()
+		{
+			if (!(_begin())) {
+				return sl_false;
+			}
+			m_flagEnded = sl_true;
+			if (!(_processBuffer(sl_true))) {
+				return sl_false;
+			}
+			if (m_elements.getCount()) {
+				return _setError(_g_xml_error_msg_element_tag_not_matching_end_tag, 0);
+			}
+			if (m_param.flagCheckWellFormed) {
+				if (m_nRootElements != 1 || m_flagRootText) {
+					return _setError(_g_xml_error_msg_document_not_wellformed, 0);
+				}
+			}
+			m_parser.endDocument();
+			if (m_parser.flagError) {
+				return _reportError();
+			}
+			if (m_buf) {
+				Base::freeMemory(m_buf);
+				m_buf = sl_null;
+				m_capacity = 0;
+			}
+			return sl_true;
+		}
+
+	public:
+		sl_bool _begin()
+		{
+			if (m_param.flagError) {
+				return sl_false;
+			}
+			if (m_flagEnded) {
+				return sl_false;
+			}
+			if (!m_flagStarted) {
+				m_flagStarted = sl_true;
+				m_parser.startDocument();
+				if (m_parser.flagError) {
+					return _reportError();
+				}
+			}
+			return sl_true;
+		}
+
+		sl_bool _reserve(sl_size size)
+		{
+			if (size <= m_capacity) {
+				return sl_true;
+			}
+			sl_size capacity = m_capacity ? m_capacity : _XML_STREAM_READ_SIZE;
+			while (capacity < size) {
+				capacity <<= 1;
+			}
+			sl_char8* buf = (sl_char8*)(Base::reallocMemory(m_buf, capacity));
+			if (!buf) {
+				return _setError(_g_xml_error_msg_memory_lack, 0);
+			}
+			m_buf = buf;
+			m_capacity = capacity;
+			return sl_true;
+		}
+
+		sl_bool _processBuffer(sl_bool flagEnd)
+		{
+			sl_size n = _process(m_buf, m_sizeBuf, flagEnd, m_sizeSearched);
+			if (m_parser.flagError) {
+				return _reportError();
+			}
+			if (n) {
+				m_sizeBuf -= n;
+				// copies forward, so overlapping is safe
+				Base::copyMemory(m_buf, m_buf + n, m_sizeBuf);
+				m_offset += n;
+			}
+			m_sizeSearched = m_sizeBuf;
+			return sl_true;
+		}
+
+		sl_bool _setError(const String& message, sl_size pos)
+		{
+			m_parser.flagError = sl_true;
+			m_parser.errorMessage = message;
+			m_parser.pos = pos;
+			if (pos < m_parser.posForLineColumn) {
+				m_parser.posForLineColumn = pos;
+			}
+			return _reportError();
+		}
+
+		sl_bool _reportError()
+		{
+			if (!(m_param.flagError)) {
+				if (m_parser.buf && m_parser.pos > m_parser.posForLineColumn && m_parser.pos <= m_parser.len) {
+					m_parser.calcLineNumber();
+				}
+				m_param.flagError = sl_true;
+				m_param.errorPosition = m_offset + m_parser.pos;
+				m_param.errorLine = m_parser.lineNumber;
+				m_param.errorColumn = m_parser.columnNumber;
+				m_param.errorMessage = m_parser.errorMessage;
+				if (m_param.flagLogError) {
+					LogError("Xml", m_param.getErrorText());
+				}
+			}
+			return sl_false;
+		}
+
+		// returns the size of the parsed data. `posSearched`: the terminator of the first markup is not found before this position
+		sl_size _process(const sl_char8* data, sl_size size, sl_bool flagEnd, sl_size posSearched)
+		{
+			_Xml_Parser<String, sl_char8, StringBuffer>& parser = m_parser;
+			parser.buf = data;
+			parser.len = size;
+			parser.offsetSource = m_offset;
+			parser.control.source.sz8 = (sl_char8*)data;
+			parser.control.source.len = size;
+			sl_size pos = 0;
+			if (!m_offset) {
+				// byte order mark
+				sl_int32 m = _Xml_StreamParser_matchPrefix(data, size, "\xEF\xBB\xBF", 3);
+				if (m < 0 && !flagEnd) {
+					return 0;
+				}
+				if (m > 0) {
+					pos = 3;
+				}
+			}
+			while (pos < size) {
+				sl_size start = pos;
+				sl_size end;
+				sl_size posSearch = posSearched > start + 2 ? posSearched - 2 : start;
+				parser.posForLineColumn = start;
+				parser.len = size;
+				if (data[start] != '<') {
+					const sl_char8* p = (const sl_char8*)(Base::findMemory(data + posSearch, '<', size - posSearch));
+					if (p) {
+						end = p - data;
+					} else {
+						if (!flagEnd) {
+							break;
+						}
+						end = size;
+					}
+					if (!m_flagRootText && !(m_elements.getCount())) {
+						for (sl_size i = start; i < end; i++) {
+							if (!(SLIB_CHAR_IS_WHITE_SPACE(data[i]))) {
+								m_flagRootText = sl_true;
+								break;
+							}
+						}
+					}
+					parser.pos = start;
+					parser.len = end;
+					parser.parseText(sl_null);
+				} else {
+					sl_int32 m;
+					sl_size index;
+					if (start + 1 >= size) {
+						if (!flagEnd) {
+							break;
+						}
+						_setError(_g_xml_error_msg_invalid_markup, start);
+						return start;
+					}
+					sl_char8 ch = data[start + 1];
+					if (ch == '!') {
+						if ((m = _Xml_StreamParser_matchPrefix(data + start, size - start, "<!--", 4)) != 0) {
+							if (m < 0) {
+								if (!flagEnd) {
+									break;
+								}
+								_setError(_g_xml_error_msg_invalid_markup, start);
+								return start;
+							}
+							if (posSearch < start + 4) {
+								posSearch = start + 4;
+							}
+							index = _Xml_StreamParser_find(data, posSearch, size, "--", 2);
+							if (index != SLIB_SIZE_MAX && index + 2 < size) {
+								end = index + 3;
+							} else {
+								if (!flagEnd) {
+									break;
+								}
+								end = size;
+							}
+							parser.pos = start + 4;
+							parser.len = end;
+							parser.parseComment(sl_null);
+						} else if ((m = _Xml_StreamParser_matchPrefix(data + start, size - start, "<![CDATA[", 9)) != 0) {
+							if (m < 0) {
+								if (!flagEnd) {
+									break;
+								}
+								_setError(_g_xml_error_msg_invalid_markup, start);
+								return start;
+							}
+							if (posSearch < start + 9) {
+								posSearch = start + 9;
+							}
+							index = _Xml_StreamParser_find(data, posSearch, size, "]]>", 3);
+							if (index != SLIB_SIZE_MAX) {
+								end = index + 3;
+							} else {
+								if (!flagEnd) {
+									break;
+								}
+								end = size;
+							}
+							parser.pos = start + 9;
+							parser.len = end;
+							parser.parseCDATA(sl_null);
+						} else {
+							_setError(_g_xml_error_msg_invalid_markup, start);
+							return start;
+						}
+					} else if (ch == '?') {
+						if (posSearch < start + 2) {
+							posSearch = start + 2;
+						}
+						index = _Xml_StreamParser_find(data, posSearch, size, "?>", 2);
+						if (index != SLIB_SIZE_MAX) {
+							end = index + 2;
+						} else {
+							if (!flagEnd) {
+								break;
+							}
+							end = size;
+						}
+						parser.pos = start + 2;
+						parser.len = end;
+						parser.parsePI(sl_null);
+					} else if (ch == '/') {
+						if (posSearch < start + 2) {
+							posSearch = start + 2;
+						}
+						const sl_char8* p = (const sl_char8*)(Base::findMemory(data + posSearch, '>', size - posSearch));
+						if (p) {
+							end = p - data + 1;
+						} else {
+							if (!flagEnd) {
+								break;
+							}
+							_setError(_g_xml_error_msg_element_tag_not_end, size);
+							return start;
+						}
+						_processEndTag(data, start, end);
+					} else {
+						// finds `>` out of the quoted attribute values
+						sl_char8 chQuot = 0;
+						end = 0;
+						for (sl_size i = start + 1; i < size; i++) {
+							sl_char8 c = data[i];
+							if (chQuot) {
+								if (c == chQuot) {
+									chQuot = 0;
+								}
+							} else if (c == '\"' || c == '\'') {
+								chQuot = c;
+							} else if (c == '>') {
+								end = i + 1;
+								break;
+							}
+						}
+						if (!end) {
+							if (!flagEnd) {
+								break;
+							}
+							end = size;
+						}
+						parser.pos = start + 1;
+						parser.len = end;
+						_processStartTag();
+					}
+				}
+				if (parser.flagError) {
+					return start;
+				}
+				if (parser.pos != end) {
+					// the position is not changeable in the stream
+					parser.pos = end;
+				}
+				parser.len = size;
+				parser.calcLineNumber();
+				pos = end;
+				posSearched = 0;
+			}
+			return pos;
+		}
+
+		void _processStartTag()
+		{
+			String defNamespace;
+			Map<String, String> namespaces;
+			sl_size nElements = m_elements.getCount();
+			if (nElements) {
+				_Xml_StreamElement* parent = m_elements.getData()[nElements - 1].get();
+				defNamespace = parent->defNamespace;
+				namespaces = parent->namespaces;
+			}
+			Ref<_Xml_StreamElement> item = new _Xml_StreamElement;
+			if (item.isNull()) {
+				_setError(_g_xml_error_msg_memory_lack, m_parser.pos);
+				return;
+			}
+			sl_size posNameStart, lenName;
+			sl_bool flagEmptyTag;
+			m_parser.parseStartTag(sl_null, defNamespace, namespaces, item->listPrefixMappings, item->element, posNameStart, lenName, flagEmptyTag);
+			if (m_parser.flagError) {
+				return;
+			}
+			if (!nElements) {
+				m_nRootElements++;
+			}
+			if (flagEmptyTag) {
+				m_parser.endElement(item->element.get(), item->listPrefixMappings);
+			} else {
+				item->defNamespace = defNamespace;
+				item->namespaces = namespaces;
+				if (!(m_elements.add_NoLock(item))) {
+					_setError(_g_xml_error_msg_memory_lack, m_parser.pos);
+				}
+			}
+		}
+
+		void _processEndTag(const sl_char8* data, sl_size start, sl_size end)
+		{
+			sl_size nElements = m_elements.getCount();
+			if (!nElements) {
+				_setError(_g_xml_error_msg_element_tag_not_matching_end_tag, start);
+				return;
+			}
+			Ref<_Xml_StreamElement> item = m_elements.getData()[nElements - 1];
+			String name = item->element->getName();
+			sl_size lenName = name.getLength();
+			sl_size pos = start + 2;
+			if (pos + lenName >= end || !(Base::equalsMemory(data + pos, name.getData(), lenName))) {
+				_setError(_g_xml_error_msg_element_tag_not_matching_end_tag, pos);
+				return;
+			}
+			pos += lenName;
+			while (pos < end - 1 && SLIB_CHAR_IS_WHITE_SPACE(data[pos])) {
+				pos++;
+			}
+			if (pos != end - 1) {
+				_setError(_g_xml_error_msg_name_invalid_char, pos);
+				return;
+			}
+			m_parser.pos = end;
+			m_elements.popBack_NoLock();
+			m_parser.endElement(item->element.get(), item->listPrefixMappings);
+		}
+
+	};
+
+	Ref<XmlStreamParser> XmlStreamParser::create(const XmlParseParam& param)
+	{
+		Ref<_Xml_StreamParser> ret = new _Xml_StreamParser;
+		if (ret.isNotNull()) {
+			ret->init(param);
+		}
+		return ret;
+	}
+
 /************************************************
 				Xml Utilities
 ************************************************/
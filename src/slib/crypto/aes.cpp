@@ -17,13 +17,30 @@
 	AES - Advanced Encryption Standard
 
 	http://csrc.nist.gov/publications/fips/fips197/fips-197.pdf
+
+	AES-NI: https://software.intel.com/sites/default/files/article/165683/aes-wp-2012-09-22-v01.pdf
 */
 
+#if (defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)) && (defined(SLIB_COMPILER_IS_GCC) || defined(SLIB_COMPILER_IS_VC))
+#	define _SLIB_AES_NI
+#	include <wmmintrin.h>
+#	include <tmmintrin.h>
+#	if defined(SLIB_COMPILER_IS_VC)
+#		include <intrin.h>
+#		define _SLIB_AES_NI_FUNCTION
+#	else
+#		include <cpuid.h>
+#		define _SLIB_AES_NI_FUNCTION __attribute__((target("aes,ssse3")))
+#	endif
+#endif
+
 namespace slib
 {
 
 	AES::AES()
 	{
+		m_nCountRounds = 0;
+		m_flagHardware = isHardwareAccelerated();
 	}
 
 	AES::~AES()
@@ -35,6 +52,42 @@ namespace slib
 		return 16;
 	}
 
+	static sl_bool _AES_checkNI()
+	{
+#if defined(_SLIB_AES_NI)
+		// AES: ECX bit 25, SSSE3: ECX bit 9
+#	if defined(SLIB_COMPILER_IS_VC)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & 0x02000200) == 0x02000200;
+#	else
+		unsigned int a, b, c, d;
+		if (__get_cpuid(1, &a, &b, &c, &d)) {
+			return (c & 0x02000200) == 0x02000200;
+		}
+		return sl_false;
+#	endif
+#else
+		return sl_false;
+#endif
+	}
+
+	sl_bool AES::isHardwareAccelerated()
+	{
+		static sl_bool flag = _AES_checkNI();
+		return flag;
+	}
+
+	sl_bool AES::isUsingHardware() const
+	{
+		return m_flagHardware;
+	}
+
+	void AES::setUsingHardware(sl_bool flag)
+	{
+		m_flagHardware = flag && isHardwareAccelerated();
+	}
+
 #define _BYTE(x) ((sl_uint8)(x))
 
 	// S-Box: substitution values for the byte xy
@@ -353,9 +406,169 @@ static const sl_uint32 _AES_RT3[256] = { RT };
 			W += 4;
 		}
 		Base::copyMemory(W, WE, 32);
+
+		if (isHardwareAccelerated()) {
+			j = (nRounds + 1) << 2;
+			for (i = 0; i < j; i++) {
+				MIO::writeUint32BE(m_roundKeyEncBytes + (i << 2), m_roundKeyEnc[i]);
+				MIO::writeUint32BE(m_roundKeyDecBytes + (i << 2), m_roundKeyDec[i]);
+			}
+		}
 		return sl_true;
 	}
 
+#if defined(_SLIB_AES_NI)
+/*
+	The inverse round keys (`m_roundKeyDec`) are already in the form of the Equivalent Inverse Cipher,
+	so both key schedules are used by AESENC and AESDEC as they are.
+	Several blocks are processed together, to hide the latency of the instructions.
+*/
+#define _AES_NI_PIPELINE 8
+
+	_SLIB_AES_NI_FUNCTION static void _AES_NI_encrypt(const sl_uint8* K, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst)
+	{
+		__m128i S = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src), _mm_loadu_si128((const __m128i*)K));
+		for (sl_uint32 r = 1; r < nRounds; r++) {
+			S = _mm_aesenc_si128(S, _mm_loadu_si128((const __m128i*)(K + (r << 4))));
+		}
+		_mm_storeu_si128((__m128i*)dst, _mm_aesenclast_si128(S, _mm_loadu_si128((const __m128i*)(K + (nRounds << 4)))));
+	}
+
+	_SLIB_AES_NI_FUNCTION static void _AES_NI_decrypt(const sl_uint8* K, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst)
+	{
+		__m128i S = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src), _mm_loadu_si128((const __m128i*)K));
+		for (sl_uint32 r = 1; r < nRounds; r++) {
+			S = _mm_aesdec_si128(S, _mm_loadu_si128((const __m128i*)(K + (r << 4))));
+		}
+		_mm_storeu_si128((__m128i*)dst, _mm_aesdeclast_si128(S, _mm_loadu_si128((const __m128i*)(K + (nRounds << 4)))));
+	}
+
+	_SLIB_AES_NI_FUNCTION static void _AES_NI_encryptBlocks(const sl_uint8* K, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		__m128i W[15];
+		__m128i S[_AES_NI_PIPELINE];
+		sl_uint32 i, r;
+		for (r = 0; r <= nRounds; r++) {
+			W[r] = _mm_loadu_si128((const __m128i*)(K + (r << 4)));
+		}
+		while (nBlocks >= _AES_NI_PIPELINE) {
+			for (i = 0; i < _AES_NI_PIPELINE; i++) {
+				S[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src + i), W[0]);
+			}
+			for (r = 1; r < nRounds; r++) {
+				for (i = 0; i < _AES_NI_PIPELINE; i++) {
+					S[i] = _mm_aesenc_si128(S[i], W[r]);
+				}
+			}
+			for (i = 0; i < _AES_NI_PIPELINE; i++) {
+				_mm_storeu_si128((__m128i*)dst + i, _mm_aesenclast_si128(S[i], W[nRounds]));
+			}
+			src += _AES_NI_PIPELINE << 4;
+			dst += _AES_NI_PIPELINE << 4;
+			nBlocks -= _AES_NI_PIPELINE;
+		}
+		while (nBlocks > 0) {
+			S[0] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src), W[0]);
+			for (r = 1; r < nRounds; r++) {
+				S[0] = _mm_aesenc_si128(S[0], W[r]);
+			}
+			_mm_storeu_si128((__m128i*)dst, _mm_aesenclast_si128(S[0], W[nRounds]));
+			src += 16;
+			dst += 16;
+			nBlocks--;
+		}
+	}
+
+	_SLIB_AES_NI_FUNCTION static void _AES_NI_decryptBlocks(const sl_uint8* K, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		__m128i W[15];
+		__m128i S[_AES_NI_PIPELINE];
+		sl_uint32 i, r;
+		for (r = 0; r <= nRounds; r++) {
+			W[r] = _mm_loadu_si128((const __m128i*)(K + (r << 4)));
+		}
+		while (nBlocks >= _AES_NI_PIPELINE) {
+			for (i = 0; i < _AES_NI_PIPELINE; i++) {
+				S[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src + i), W[0]);
+			}
+			for (r = 1; r < nRounds; r++) {
+				for (i = 0; i < _AES_NI_PIPELINE; i++) {
+					S[i] = _mm_aesdec_si128(S[i], W[r]);
+				}
+			}
+			for (i = 0; i < _AES_NI_PIPELINE; i++) {
+				_mm_storeu_si128((__m128i*)dst + i, _mm_aesdeclast_si128(S[i], W[nRounds]));
+			}
+			src += _AES_NI_PIPELINE << 4;
+			dst += _AES_NI_PIPELINE << 4;
+			nBlocks -= _AES_NI_PIPELINE;
+		}
+		while (nBlocks > 0) {
+			S[0] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src), W[0]);
+			for (r = 1; r < nRounds; r++) {
+				S[0] = _mm_aesdec_si128(S[0], W[r]);
+			}
+			_mm_storeu_si128((__m128i*)dst, _mm_aesdeclast_si128(S[0], W[nRounds]));
+			src += 16;
+			dst += 16;
+			nBlocks--;
+		}
+	}
+
+#define _AES_NI_COUNTER_BLOCK(S) \
+	S = _mm_xor_si128(_mm_shuffle_epi8(_mm_set_epi64x((sl_int64)high, (sl_int64)low), maskSwap), W[0]); \
+	if (flagIncrease32) { \
+		low = (low & SLIB_UINT64(0xFFFFFFFF00000000)) | (sl_uint32)(low + 1); \
+	} else { \
+		low++; \
+		if (!low) { \
+			high++; \
+		} \
+	}
+
+	// `high`, `low`: the counter as big-endian integers
+	_SLIB_AES_NI_FUNCTION static void _AES_NI_encryptCTR(const sl_uint8* K, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks, sl_uint64& _high, sl_uint64& _low, sl_bool flagIncrease32)
+	{
+		__m128i W[15];
+		__m128i S[_AES_NI_PIPELINE];
+		__m128i maskSwap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		sl_uint64 high = _high;
+		sl_uint64 low = _low;
+		sl_uint32 i, r;
+		for (r = 0; r <= nRounds; r++) {
+			W[r] = _mm_loadu_si128((const __m128i*)(K + (r << 4)));
+		}
+		while (nBlocks >= _AES_NI_PIPELINE) {
+			for (i = 0; i < _AES_NI_PIPELINE; i++) {
+				_AES_NI_COUNTER_BLOCK(S[i])
+			}
+			for (r = 1; r < nRounds; r++) {
+				for (i = 0; i < _AES_NI_PIPELINE; i++) {
+					S[i] = _mm_aesenc_si128(S[i], W[r]);
+				}
+			}
+			for (i = 0; i < _AES_NI_PIPELINE; i++) {
+				_mm_storeu_si128((__m128i*)dst + i, _mm_xor_si128(_mm_aesenclast_si128(S[i], W[nRounds]), _mm_loadu_si128((const __m128i*)src + i)));
+			}
+			src += _AES_NI_PIPELINE << 4;
+			dst += _AES_NI_PIPELINE << 4;
+			nBlocks -= _AES_NI_PIPELINE;
+		}
+		while (nBlocks > 0) {
+			_AES_NI_COUNTER_BLOCK(S[0])
+			for (r = 1; r < nRounds; r++) {
+				S[0] = _mm_aesenc_si128(S[0], W[r]);
+			}
+			_mm_storeu_si128((__m128i*)dst, _mm_xor_si128(_mm_aesenclast_si128(S[0], W[nRounds]), _mm_loadu_si128((const __m128i*)src)));
+			src += 16;
+			dst += 16;
+			nBlocks--;
+		}
+		_high = high;
+		_low = low;
+	}
+#endif
+
 /*
 	Encryption Rounds
 
@@ -437,6 +650,13 @@ Roundn (Last):
 		const sl_uint8* IN = (const sl_uint8*)_src;
 		sl_uint8* OUT = (sl_uint8*)_dst;
 
+#if defined(_SLIB_AES_NI)
+		if (m_flagHardware) {
+			_AES_NI_encrypt(m_roundKeyEncBytes, m_nCountRounds, IN, OUT);
+			return;
+		}
+#endif
+
 		sl_uint32 d0 = MIO::readUint32BE(IN);
 		sl_uint32 d1 = MIO::readUint32BE(IN + 4);
 		sl_uint32 d2 = MIO::readUint32BE(IN + 8);
@@ -532,6 +752,13 @@ Roundn (Last):
 	{
 		const sl_uint8* IN = (const sl_uint8*)_src;
 		sl_uint8* OUT = (sl_uint8*)_dst;
+
+#if defined(_SLIB_AES_NI)
+		if (m_flagHardware) {
+			_AES_NI_decrypt(m_roundKeyDecBytes, m_nCountRounds, IN, OUT);
+			return;
+		}
+#endif
 		
 		sl_uint32 d0 = MIO::readUint32BE(IN);
 		sl_uint32 d1 = MIO::readUint32BE(IN + 4);
@@ -546,6 +773,81 @@ Roundn (Last):
 		MIO::writeUint32BE(OUT + 12, d3);
 	}
 
+	sl_size AES::encryptBlocks(const void* _src, void* _dst, sl_size size) const
+	{
+		if (size & 15) {
+			return 0;
+		}
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		sl_size n = size >> 4;
+#if defined(_SLIB_AES_NI)
+		if (m_flagHardware) {
+			_AES_NI_encryptBlocks(m_roundKeyEncBytes, m_nCountRounds, src, dst, n);
+			return size;
+		}
+#endif
+		for (sl_size i = 0; i < n; i++) {
+			encryptBlock(src, dst);
+			src += 16;
+			dst += 16;
+		}
+		return size;
+	}
+
+	sl_size AES::decryptBlocks(const void* _src, void* _dst, sl_size size) const
+	{
+		if (size & 15) {
+			return 0;
+		}
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		sl_size n = size >> 4;
+#if defined(_SLIB_AES_NI)
+		if (m_flagHardware) {
+			_AES_NI_decryptBlocks(m_roundKeyDecBytes, m_nCountRounds, src, dst, n);
+			return size;
+		}
+#endif
+		for (sl_size i = 0; i < n; i++) {
+			decryptBlock(src, dst);
+			src += 16;
+			dst += 16;
+		}
+		return size;
+	}
+
+	void AES::encrypt_CTR_Blocks(const void* _src, void* _dst, sl_size nBlocks, void* _counter, sl_bool flagIncrease32) const
+	{
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		sl_uint8* counter = (sl_uint8*)_counter;
+#if defined(_SLIB_AES_NI)
+		if (m_flagHardware) {
+			sl_uint64 high = MIO::readUint64BE(counter);
+			sl_uint64 low = MIO::readUint64BE(counter + 8);
+			_AES_NI_encryptCTR(m_roundKeyEncBytes, m_nCountRounds, src, dst, nBlocks, high, low, flagIncrease32);
+			MIO::writeUint64BE(counter, high);
+			MIO::writeUint64BE(counter + 8, low);
+			return;
+		}
+#endif
+		sl_uint8 mask[16];
+		for (sl_size k = 0; k < nBlocks; k++) {
+			encryptBlock(counter, mask);
+			for (sl_uint32 i = 0; i < 16; i++) {
+				dst[i] = src[i] ^ mask[i];
+			}
+			src += 16;
+			dst += 16;
+			if (flagIncrease32) {
+				MIO::writeUint32BE(counter + 12, MIO::readUint32BE(counter + 12) + 1);
+			} else {
+				MIO::increaseBE(counter, 16);
+			}
+		}
+	}
+
 	void AES::setKey_SHA256(const String& key)
 	{
 		char sig[32];
@@ -291,6 +291,29 @@ namespace slib
 		Counter Mode (CTR)
 ***************************************/
 
+	// encrypts `n` whole blocks, and advances the counter by `n`
+	template <class BlockCipher>
+	static void _BlockCipher_CTR_encryptBlocks(const BlockCipher* crypto, const sl_uint8* input, sl_uint8* output, sl_size n, sl_uint8* counter)
+	{
+		sl_uint8 mask[SLIB_CRYPTO_BLOCK_CIPHER_BLOCK_MAX_LEN];
+		sl_uint32 sizeBlock = crypto->getBlockSize();
+		for (sl_size k = 0; k < n; k++) {
+			crypto->encryptBlock(counter, mask);
+			for (sl_uint32 i = 0; i < sizeBlock; i++) {
+				output[i] = input[i] ^ mask[i];
+			}
+			input += sizeBlock;
+			output += sizeBlock;
+			MIO::increaseBE(counter, sizeBlock);
+		}
+	}
+
+	// AES pipelines several counter blocks
+	static void _BlockCipher_CTR_encryptBlocks(const AES* crypto, const sl_uint8* input, sl_uint8* output, sl_size n, sl_uint8* counter)
+	{
+		crypto->encrypt_CTR_Blocks(input, output, n, counter);
+	}
+
 	template <class BlockCipher>
 	sl_size BlockCipher_CTR<BlockCipher>::encrypt(const BlockCipher* crypto, const void* _input, sl_size _size, void* _output, void* _counter, sl_uint32 offset)
 	{
@@ -328,15 +351,19 @@ namespace slib
 				return size;
 			}
 		}
-		while (size > 0) {
-			crypto->encryptBlock(counter, mask);
-			n = SLIB_MIN(sizeBlock, size);
-			for (i = 0; i < n; i++) {
-				output[i] = input[i] ^ mask[i];
-			}
+		n = size / sizeBlock;
+		if (n) {
+			_BlockCipher_CTR_encryptBlocks(crypto, input, output, n, counter);
+			n *= sizeBlock;
 			size -= n;
 			input += n;
 			output += n;
+		}
+		if (size > 0) {
+			crypto->encryptBlock(counter, mask);
+			for (i = 0; i < size; i++) {
+				output[i] = input[i] ^ mask[i];
+			}
 			MIO::increaseBE(counter, sizeBlock);
 		}
 		return _size;
@@ -369,11 +396,13 @@ namespace slib
 	}
 
 
-#define DEFINE_BLOCKCIPHER(CLASS) \
+#define DEFINE_BLOCKCIPHER_BLOCKS(CLASS) \
 	sl_size CLASS::encryptBlocks(const void* src, void* dst, sl_size size) const \
 	{ return BlockCipher_Blocks<CLASS>::encryptBlocks(this, src, dst, size); } \
 	sl_size CLASS::decryptBlocks(const void* src, void* dst, sl_size size) const \
-	{ return BlockCipher_Blocks<CLASS>::decryptBlocks(this, src, dst, size); } \
+	{ return BlockCipher_Blocks<CLASS>::decryptBlocks(this, src, dst, size); }
+
+#define DEFINE_BLOCKCIPHER_MODES(CLASS) \
 	sl_size CLASS::encrypt_ECB_PKCS7Padding(const void* src, sl_size size, void* dst) const \
 	{ return BlockCipher_ECB<CLASS, BlockCipherPadding_PKCS7>::encrypt(this, src, size, dst); } \
 	sl_size CLASS::decrypt_ECB_PKCS7Padding(const void* src, sl_size size, void* dst) const \
@@ -401,7 +430,12 @@ namespace slib
 	sl_size CLASS::encrypt_CTR(const void* iv, sl_uint64 pos, const void* input, sl_size size, void* output) const \
 	{ return BlockCipher_CTR<CLASS>::encrypt(this, iv, pos, input, size, output); }
 
-	DEFINE_BLOCKCIPHER(AES);
+#define DEFINE_BLOCKCIPHER(CLASS) \
+	DEFINE_BLOCKCIPHER_BLOCKS(CLASS) \
+	DEFINE_BLOCKCIPHER_MODES(CLASS)
+
+	// AES implements `encryptBlocks` and `decryptBlocks` by itself, to use the pipelined AES-NI instructions
+	DEFINE_BLOCKCIPHER_MODES(AES);
 	DEFINE_BLOCKCIPHER(Blowfish);
 
 }
@@ -11,10 +11,195 @@
 #include "../../../inc/slib/crypto/gcm.h"
 
 #include "../../../inc/slib/crypto/aes.h"
+#include "../../../inc/slib/core/mio.h"
+
+/*
+	Carry-less multiplication for GHASH
+
+	https://software.intel.com/sites/default/files/managed/72/cc/clmul-wp-rev-2.02-2014-04-20.pdf
+*/
+
+#if (defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)) && (defined(SLIB_COMPILER_IS_GCC) || defined(SLIB_COMPILER_IS_VC))
+#	define _SLIB_GCM_CLMUL
+#	include <wmmintrin.h>
+#	include <tmmintrin.h>
+#	if defined(SLIB_COMPILER_IS_VC)
+#		include <intrin.h>
+#		define _SLIB_GCM_CLMUL_FUNCTION
+#	else
+#		include <cpuid.h>
+#		define _SLIB_GCM_CLMUL_FUNCTION __attribute__((target("pclmul,ssse3")))
+#	endif
+#endif
+
+// size of the data encrypted and hashed at once
+#define _SLIB_GCM_BATCH_SIZE 2048
 
 namespace slib
 {
 
+	static sl_bool _GCM_checkCLMUL()
+	{
+#if defined(_SLIB_GCM_CLMUL)
+		// PCLMULQDQ: ECX bit 1, SSSE3: ECX bit 9
+#	if defined(SLIB_COMPILER_IS_VC)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & 0x202) == 0x202;
+#	else
+		unsigned int a, b, c, d;
+		if (__get_cpuid(1, &a, &b, &c, &d)) {
+			return (c & 0x202) == 0x202;
+		}
+		return sl_false;
+#	endif
+#else
+		return sl_false;
+#endif
+	}
+
+	static sl_bool _GCM_isSupportedCLMUL()
+	{
+		static sl_bool flag = _GCM_checkCLMUL();
+		return flag;
+	}
+
+#if defined(_SLIB_GCM_CLMUL)
+/*
+	The blocks are loaded in the byte-reversed order, so that the bit 0 of the first byte becomes the most significant bit.
+	The products of the reflected operands are shifted left by 1 bit before the reduction.
+*/
+
+	_SLIB_GCM_CLMUL_FUNCTION static __m128i _GCM_CLMUL_load(const void* p)
+	{
+		return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p), _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+	}
+
+	_SLIB_GCM_CLMUL_FUNCTION static void _GCM_CLMUL_store(void* p, __m128i v)
+	{
+		_mm_storeu_si128((__m128i*)p, _mm_shuffle_epi8(v, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)));
+	}
+
+	_SLIB_GCM_CLMUL_FUNCTION static __m128i _GCM_CLMUL_fromUint128(const Uint128& v)
+	{
+		return _mm_set_epi64x((sl_int64)(v.high), (sl_int64)(v.low));
+	}
+
+	_SLIB_GCM_CLMUL_FUNCTION static void _GCM_CLMUL_toUint128(__m128i v, Uint128& o)
+	{
+		sl_uint64 t[2];
+		_mm_storeu_si128((__m128i*)t, v);
+		o.low = t[0];
+		o.high = t[1];
+	}
+
+	// accumulates the 256-bit product (a * b) into (lo, hi)
+	_SLIB_GCM_CLMUL_FUNCTION static void _GCM_CLMUL_multiply(__m128i a, __m128i b, __m128i& lo, __m128i& hi)
+	{
+		__m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+		__m128i t1 = _mm_clmulepi64_si128(a, b, 0x11);
+		__m128i t2 = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+		lo = _mm_xor_si128(lo, _mm_xor_si128(t0, _mm_slli_si128(t2, 8)));
+		hi = _mm_xor_si128(hi, _mm_xor_si128(t1, _mm_srli_si128(t2, 8)));
+	}
+
+	// reduces the 256-bit product modulo x^128 + x^7 + x^2 + x + 1
+	_SLIB_GCM_CLMUL_FUNCTION static __m128i _GCM_CLMUL_reduce(__m128i lo, __m128i hi)
+	{
+		__m128i t1, t2, t3, t4, t5;
+
+		// shift left by 1 bit
+		t1 = _mm_srli_epi32(lo, 31);
+		t2 = _mm_srli_epi32(hi, 31);
+		lo = _mm_slli_epi32(lo, 1);
+		hi = _mm_slli_epi32(hi, 1);
+		t3 = _mm_srli_si128(t1, 12);
+		t2 = _mm_slli_si128(t2, 4);
+		t1 = _mm_slli_si128(t1, 4);
+		lo = _mm_or_si128(lo, t1);
+		hi = _mm_or_si128(hi, t2);
+		hi = _mm_or_si128(hi, t3);
+
+		// first phase
+		t1 = _mm_slli_epi32(lo, 31);
+		t2 = _mm_slli_epi32(lo, 30);
+		t3 = _mm_slli_epi32(lo, 25);
+		t1 = _mm_xor_si128(t1, t2);
+		t1 = _mm_xor_si128(t1, t3);
+		t2 = _mm_srli_si128(t1, 4);
+		t1 = _mm_slli_si128(t1, 12);
+		lo = _mm_xor_si128(lo, t1);
+
+		// second phase
+		t3 = _mm_srli_epi32(lo, 1);
+		t4 = _mm_srli_epi32(lo, 2);
+		t5 = _mm_srli_epi32(lo, 7);
+		t3 = _mm_xor_si128(t3, t4);
+		t3 = _mm_xor_si128(t3, t5);
+		t3 = _mm_xor_si128(t3, t2);
+		lo = _mm_xor_si128(lo, t3);
+		return _mm_xor_si128(hi, lo);
+	}
+
+	_SLIB_GCM_CLMUL_FUNCTION static __m128i _GCM_CLMUL_multiplyReduce(__m128i a, __m128i b)
+	{
+		__m128i lo = _mm_setzero_si128();
+		__m128i hi = _mm_setzero_si128();
+		_GCM_CLMUL_multiply(a, b, lo, hi);
+		return _GCM_CLMUL_reduce(lo, hi);
+	}
+
+	_SLIB_GCM_CLMUL_FUNCTION static void _GCM_CLMUL_generatePowers(const Uint128& H, Uint128* HP)
+	{
+		__m128i h1 = _GCM_CLMUL_fromUint128(H);
+		__m128i h2 = _GCM_CLMUL_multiplyReduce(h1, h1);
+		__m128i h3 = _GCM_CLMUL_multiplyReduce(h2, h1);
+		__m128i h4 = _GCM_CLMUL_multiplyReduce(h3, h1);
+		_GCM_CLMUL_toUint128(h1, HP[0]);
+		_GCM_CLMUL_toUint128(h2, HP[1]);
+		_GCM_CLMUL_toUint128(h3, HP[2]);
+		_GCM_CLMUL_toUint128(h4, HP[3]);
+	}
+
+	_SLIB_GCM_CLMUL_FUNCTION static void _GCM_CLMUL_multiplyH(const Uint128* HP, const void* X, void* O)
+	{
+		_GCM_CLMUL_store(O, _GCM_CLMUL_multiplyReduce(_GCM_CLMUL_load(X), _GCM_CLMUL_fromUint128(HP[0])));
+	}
+
+	// X = (...((X ^ D0) * H ^ D1) * H ...) * H, four blocks are aggregated by the powers of H before the reduction
+	_SLIB_GCM_CLMUL_FUNCTION static void _GCM_CLMUL_multiplyData(const Uint128* HP, void* X, const sl_uint8* D, sl_size lenD)
+	{
+		__m128i h1 = _GCM_CLMUL_fromUint128(HP[0]);
+		__m128i h2 = _GCM_CLMUL_fromUint128(HP[1]);
+		__m128i h3 = _GCM_CLMUL_fromUint128(HP[2]);
+		__m128i h4 = _GCM_CLMUL_fromUint128(HP[3]);
+		__m128i x = _GCM_CLMUL_load(X);
+		__m128i lo, hi;
+		while (lenD >= 64) {
+			lo = _mm_setzero_si128();
+			hi = _mm_setzero_si128();
+			_GCM_CLMUL_multiply(_mm_xor_si128(x, _GCM_CLMUL_load(D)), h4, lo, hi);
+			_GCM_CLMUL_multiply(_GCM_CLMUL_load(D + 16), h3, lo, hi);
+			_GCM_CLMUL_multiply(_GCM_CLMUL_load(D + 32), h2, lo, hi);
+			_GCM_CLMUL_multiply(_GCM_CLMUL_load(D + 48), h1, lo, hi);
+			x = _GCM_CLMUL_reduce(lo, hi);
+			D += 64;
+			lenD -= 64;
+		}
+		while (lenD >= 16) {
+			x = _GCM_CLMUL_multiplyReduce(_mm_xor_si128(x, _GCM_CLMUL_load(D)), h1);
+			D += 16;
+			lenD -= 16;
+		}
+		if (lenD) {
+			sl_uint8 last[16] = { 0 };
+			Base::copyMemory(last, D, lenD);
+			x = _GCM_CLMUL_multiplyReduce(_mm_xor_si128(x, _GCM_CLMUL_load(last)), h1);
+		}
+		_GCM_CLMUL_store(X, x);
+	}
+#endif
+
 	void GCM_Table::generateTable(const void* _H)
 	{
 		sl_uint32 i, j;
@@ -50,6 +235,13 @@ namespace slib
 			}
 			i <<= 1;
 		}
+
+		flagCLMUL = _GCM_isSupportedCLMUL();
+#if defined(_SLIB_GCM_CLMUL)
+		if (flagCLMUL) {
+			_GCM_CLMUL_generatePowers(M[8], HP);
+		}
+#endif
 	}
 
 	static const sl_uint64 _GCM_R[16] =
@@ -74,6 +266,12 @@ namespace slib
 
 	void GCM_Table::multiplyH(const void* _X, void* _O) const
 	{
+#if defined(_SLIB_GCM_CLMUL)
+		if (flagCLMUL) {
+			_GCM_CLMUL_multiplyH(HP, _X, _O);
+			return;
+		}
+#endif
 		const sl_uint8* X = (const sl_uint8*)_X;
 		sl_uint8* O = (sl_uint8*)_O;
 		Uint128 Z;
@@ -119,6 +317,13 @@ namespace slib
 		const sl_uint8* D = (const sl_uint8*)_D;
 		sl_size i, k, n;
 
+#if defined(_SLIB_GCM_CLMUL)
+		if (flagCLMUL) {
+			_GCM_CLMUL_multiplyData(HP, X, D, lenD);
+			return;
+		}
+#endif
+
 		n = lenD >> 4;
 		for (i = 0; i < n; i++) {
 			for (k = 0; k < 16; k++) {
@@ -247,6 +452,33 @@ namespace slib
 	}
 
 
+	// encrypts `n` whole blocks by the counters following `CIV`, and advances `CIV` by `n`
+	template <class BlockCipher>
+	static void _GCM_encryptCounterBlocks(const BlockCipher* cipher, sl_uint8* CIV, const sl_uint8* src, sl_uint8* dst, sl_size n)
+	{
+		sl_uint8 GCTR[16];
+		for (sl_size k = 0; k < n; k++) {
+			MIO::writeUint32BE(CIV + 12, MIO::readUint32BE(CIV + 12) + 1);
+			cipher->encryptBlock(CIV, GCTR);
+			for (sl_uint32 i = 0; i < 16; i++) {
+				dst[i] = src[i] ^ GCTR[i];
+			}
+			src += 16;
+			dst += 16;
+		}
+	}
+
+	// AES pipelines several counter blocks
+	static void _GCM_encryptCounterBlocks(const AES* cipher, sl_uint8* CIV, const sl_uint8* src, sl_uint8* dst, sl_size n)
+	{
+		sl_uint8 counter[16];
+		sl_uint32 low = MIO::readUint32BE(CIV + 12);
+		Base::copyMemory(counter, CIV, 12);
+		MIO::writeUint32BE(counter + 12, low + 1);
+		cipher->encrypt_CTR_Blocks(src, dst, n, counter, sl_true);
+		MIO::writeUint32BE(CIV + 12, low + (sl_uint32)n);
+	}
+
 	template <class BlockCipher>
 	GCM<BlockCipher>::GCM()
 	{
@@ -312,25 +544,21 @@ namespace slib
 	template <class BlockCipher>
 	void GCM<BlockCipher>::encrypt(const void* src, void *dst, sl_size len)
 	{
-		sl_uint8 GCTR[16];
-		sl_size i, k, n;
 		const sl_uint8* P = (const sl_uint8*)src;
 		sl_uint8* C = (sl_uint8*)dst;
-		
-		for (i = 0; i < len; i += 16) {
-			increaseCIV();
-			m_cipher->encryptBlock(CIV, GCTR);
-			n = len - i;
-			if (n > 16) {
-				n = 16;
+		while (len >= 16) {
+			sl_size n = len & (~((sl_size)15));
+			if (n > _SLIB_GCM_BATCH_SIZE) {
+				n = _SLIB_GCM_BATCH_SIZE;
 			}
-			for (k = 0; k < n; k++) {
-				*C = *P ^ GCTR[k];
-				GHASH_X[k] ^= *C;
-				C++;
-				P++;
-			}
-			multiplyH(GHASH_X, GHASH_X);
+			_GCM_encryptCounterBlocks(m_cipher, CIV, P, C, n >> 4);
+			multiplyData(GHASH_X, C, n);
+			P += n;
+			C += n;
+			len -= n;
+		}
+		if (len) {
+			encryptBlock(P, C, (sl_uint32)len);
 		}
 	}
 
@@ -355,25 +583,22 @@ namespace slib
 	template <class BlockCipher>
 	void GCM<BlockCipher>::decrypt(const void* src, void *dst, sl_size len)
 	{
-		sl_uint8 GCTR[16];
-		sl_size i, k, n;
 		const sl_uint8* C = (const sl_uint8*)src;
 		sl_uint8* P = (sl_uint8*)dst;
-		
-		for (i = 0; i < len; i += 16) {
-			increaseCIV();
-			m_cipher->encryptBlock(CIV, GCTR);
-			n = len - i;
-			if (n > 16) {
-				n = 16;
-			}
-			for (k = 0; k < n; k++) {
-				GHASH_X[k] ^= *C;
-				*P = *C ^ GCTR[k];
-				C++;
-				P++;
+		while (len >= 16) {
+			sl_size n = len & (~((sl_size)15));
+			if (n > _SLIB_GCM_BATCH_SIZE) {
+				n = _SLIB_GCM_BATCH_SIZE;
 			}
-			multiplyH(GHASH_X, GHASH_X);
+			// GHASH is calculated before the output is written, because the decryption can be in-place
+			multiplyData(GHASH_X, C, n);
+			_GCM_encryptCounterBlocks(m_cipher, CIV, C, P, n >> 4);
+			C += n;
+			P += n;
+			len -= n;
+		}
+		if (len) {
+			decryptBlock(C, P, (sl_uint32)len);
 		}
 	}
 
@@ -18,6 +18,22 @@
 namespace slib
 {
 
+	static Ref<BigIntMontgomery> _rsa_get_montgomery(AtomicRef<BigIntMontgomery>& cache, const BigInt& M)
+	{
+		Ref<BigIntMontgomery> context = cache;
+		if (context.isNotNull()) {
+			if (context->getModulus().compare(M) == 0) {
+				return context;
+			}
+		}
+		context = BigIntMontgomery::create(M);
+		if (context.isNotNull()) {
+			cache = context;
+		}
+		return context;
+	}
+
+
 	RSAPublicKey::RSAPublicKey()
 	{
 	}
@@ -31,6 +47,11 @@ namespace slib
 		return (sl_uint32)(N.getMostSignificantBytes());
 	}
 
+	Ref<BigIntMontgomery> RSAPublicKey::getMontgomeryN() const
+	{
+		return _rsa_get_montgomery(m_montN, N);
+	}
+
 
 	RSAPrivateKey::RSAPrivateKey()
 	{
@@ -45,6 +66,21 @@ namespace slib
 		return (sl_uint32)(N.getMostSignificantBytes());
 	}
 
+	Ref<BigIntMontgomery> RSAPrivateKey::getMontgomeryN() const
+	{
+		return _rsa_get_montgomery(m_montN, N);
+	}
+
+	Ref<BigIntMontgomery> RSAPrivateKey::getMontgomeryP() const
+	{
+		return _rsa_get_montgomery(m_montP, P);
+	}
+
+	Ref<BigIntMontgomery> RSAPrivateKey::getMontgomeryQ() const
+	{
+		return _rsa_get_montgomery(m_montQ, Q);
+	}
+
 
 	sl_bool RSA::executePublic(const RSAPublicKey& key, const void* src, void* dst)
 	{
@@ -53,7 +89,11 @@ namespace slib
 		if (T >= key.N) {
 			return sl_false;
 		}
-		T = T.pow_montgomery(key.E, key.N);
+		Ref<BigIntMontgomery> montN = key.getMontgomeryN();
+		if (montN.isNull()) {
+			return sl_false;
+		}
+		T = montN->pow(T, key.E);
 		if (T.isNotNull()) {
 			if (T.getBytesBE(dst, n)) {
 				return sl_true;
@@ -70,10 +110,19 @@ namespace slib
 			return sl_false;
 		}
 		if (key.flagUseOnlyD) {
-			T = T.pow_montgomery(key.D, key.N);
+			Ref<BigIntMontgomery> montN = key.getMontgomeryN();
+			if (montN.isNull()) {
+				return sl_false;
+			}
+			T = montN->pow(T, key.D);
 		} else {
-			BigInt TP = T.pow_montgomery(key.DP, key.P);
-			BigInt TQ = T.pow_montgomery(key.DQ, key.Q);
+			Ref<BigIntMontgomery> montP = key.getMontgomeryP();
+			Ref<BigIntMontgomery> montQ = key.getMontgomeryQ();
+			if (montP.isNull() || montQ.isNull()) {
+				return sl_false;
+			}
+			BigInt TP = montP->pow(T, key.DP);
+			BigInt TQ = montQ->pow(T, key.DQ);
 			T = ((TP - TQ) * key.IQ) % key.P;
 			T = TQ + T * key.Q;
 		}
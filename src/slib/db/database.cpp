@@ -10,6 +10,8 @@
 
 #include "../../../inc/slib/db/database.h"
 
+#include "../../../inc/slib/core/thread.h"
+
 namespace slib
 {
 
@@ -112,4 +114,106 @@ namespace slib
 		return sl_null;
 	}
 
+
+	class _DatabasePoolThreadHandler : public Referable
+	{
+	public:
+		WeakRef<DatabasePool> pool;
+		sl_uint64 threadId;
+
+	public:
+		~_DatabasePoolThreadHandler()
+		{
+			Ref<DatabasePool> _pool = pool;
+			if (_pool.isNotNull()) {
+				_pool->_removeDatabase(threadId);
+			}
+		}
+
+	};
+
+	// releases the connections of the thread on its exit, for any thread (not only `Thread`)
+	class _DatabasePoolThreadReleaser
+	{
+	public:
+		List< Ref<_DatabasePoolThreadHandler> > handlers;
+
+	};
+
+	SLIB_DEFINE_OBJECT(DatabasePool, Object)
+
+	DatabasePool::DatabasePool()
+	{
+	}
+
+	DatabasePool::~DatabasePool()
+	{
+	}
+
+	Ref<DatabasePool> DatabasePool::create(const Function<Ref<Database>()>& connector)
+	{
+		if (connector.isNull()) {
+			return sl_null;
+		}
+		Ref<DatabasePool> ret = new DatabasePool;
+		if (ret.isNotNull()) {
+			ret->m_connector = connector;
+		}
+		return ret;
+	}
+
+	Ref<Database> DatabasePool::getDatabase()
+	{
+		sl_uint64 threadId = Thread::getCurrentThreadUniqueId();
+		Ref<Database> db;
+		if (m_databases.get(threadId, &db)) {
+			return db;
+		}
+		db = m_connector();
+		if (db.isNull()) {
+			return sl_null;
+		}
+		m_databases.put(threadId, db);
+		static SLIB_THREAD _DatabasePoolThreadReleaser releaser;
+		List< Ref<_DatabasePoolThreadHandler> > handlers;
+		sl_bool flagFound = sl_false;
+		ListElements< Ref<_DatabasePoolThreadHandler> > handlersOld(releaser.handlers);
+		for (sl_size i = 0; i < handlersOld.count; i++) {
+			Ref<DatabasePool> pool = handlersOld[i]->pool;
+			// the handlers of the released pools are dropped
+			if (pool.isNotNull()) {
+				if (pool == this) {
+					// registered before `clear()`
+					flagFound = sl_true;
+				}
+				handlers.add_NoLock(handlersOld[i]);
+			}
+		}
+		if (!flagFound) {
+			Ref<_DatabasePoolThreadHandler> handler = new _DatabasePoolThreadHandler;
+			if (handler.isNotNull()) {
+				handler->pool = this;
+				handler->threadId = threadId;
+				handlers.add_NoLock(handler);
+			}
+		}
+		releaser.handlers = handlers;
+		return db;
+	}
+
+	sl_size DatabasePool::getDatabasesCount()
+	{
+		return m_databases.getCount();
+	}
+
+	void DatabasePool::clear()
+	{
+		m_databases.removeAll();
+	}
+
+	void DatabasePool::_removeDatabase(sl_uint64 threadId)
+	{
+		m_databases.remove(threadId);
+	}
+
 }
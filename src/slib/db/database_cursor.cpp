@@ -10,9 +10,239 @@
 
 #include "../../../inc/slib/db/database.h"
 
+#include <initializer_list>
+
 namespace slib
 {
 
+	DatabaseBatch::DatabaseBatch()
+	{
+		m_columns = sl_null;
+		m_nColumns = 0;
+		m_maxRows = 0;
+		m_nRows = 0;
+	}
+
+	DatabaseBatch::~DatabaseBatch()
+	{
+		_free();
+	}
+
+	sl_bool DatabaseBatch::setColumns(const DatabaseColumnType* types, sl_uint32 nColumns, sl_uint32 maxRows)
+	{
+		_free();
+		if (!nColumns || !maxRows) {
+			return sl_false;
+		}
+		DatabaseBatchColumn* columns = new DatabaseBatchColumn[nColumns];
+		if (!columns) {
+			return sl_false;
+		}
+		Base::zeroMemory(columns, sizeof(DatabaseBatchColumn) * nColumns);
+		m_columns = columns;
+		m_nColumns = nColumns;
+		for (sl_uint32 i = 0; i < nColumns; i++) {
+			DatabaseBatchColumn& column = columns[i];
+			column.type = types[i];
+			column.nulls = (sl_uint8*)(Base::createMemory(maxRows));
+			if (!(column.nulls)) {
+				_free();
+				return sl_false;
+			}
+			if (column.type == DatabaseColumnType::String || column.type == DatabaseColumnType::Blob) {
+				column.offsets = (sl_size*)(Base::createMemory(sizeof(sl_size) * (maxRows + 1)));
+				if (!(column.offsets)) {
+					_free();
+					return sl_false;
+				}
+				column.offsets[0] = 0;
+			} else {
+				column.valuesInt64 = (sl_int64*)(Base::createMemory(sizeof(sl_int64) * maxRows));
+				if (!(column.valuesInt64)) {
+					_free();
+					return sl_false;
+				}
+			}
+		}
+		m_maxRows = maxRows;
+		return sl_true;
+	}
+
+	sl_bool DatabaseBatch::setColumns(const std::initializer_list<DatabaseColumnType>& types, sl_uint32 maxRows)
+	{
+		return setColumns(types.begin(), (sl_uint32)(types.size()), maxRows);
+	}
+
+	sl_uint32 DatabaseBatch::getColumnsCount() const
+	{
+		return m_nColumns;
+	}
+
+	DatabaseColumnType DatabaseBatch::getColumnType(sl_uint32 column) const
+	{
+		return m_columns[column].type;
+	}
+
+	const DatabaseBatchColumn* DatabaseBatch::getColumn(sl_uint32 column) const
+	{
+		if (column < m_nColumns) {
+			return m_columns + column;
+		}
+		return sl_null;
+	}
+
+	sl_uint32 DatabaseBatch::getMaxRowsCount() const
+	{
+		return m_maxRows;
+	}
+
+	sl_uint32 DatabaseBatch::getRowsCount() const
+	{
+		return m_nRows;
+	}
+
+	sl_bool DatabaseBatch::isNull(sl_uint32 column, sl_uint32 row) const
+	{
+		return m_columns[column].nulls[row] != 0;
+	}
+
+	const sl_int64* DatabaseBatch::getInt64Values(sl_uint32 column) const
+	{
+		return m_columns[column].valuesInt64;
+	}
+
+	const double* DatabaseBatch::getDoubleValues(sl_uint32 column) const
+	{
+		return m_columns[column].valuesDouble;
+	}
+
+	const sl_uint8* DatabaseBatch::getData(sl_uint32 column, sl_uint32 row, sl_size* outSize) const
+	{
+		DatabaseBatchColumn& c = m_columns[column];
+		sl_size offset = c.offsets[row];
+		if (outSize) {
+			*outSize = c.offsets[row + 1] - offset;
+		}
+		return c.arena + offset;
+	}
+
+	sl_size DatabaseBatch::getDataSize(sl_uint32 column, sl_uint32 row) const
+	{
+		DatabaseBatchColumn& c = m_columns[column];
+		return c.offsets[row + 1] - c.offsets[row];
+	}
+
+	String DatabaseBatch::getString(sl_uint32 column, sl_uint32 row) const
+	{
+		DatabaseBatchColumn& c = m_columns[column];
+		if (c.nulls[row]) {
+			return sl_null;
+		}
+		sl_size offset = c.offsets[row];
+		return String::fromUtf8(c.arena + offset, c.offsets[row + 1] - offset);
+	}
+
+	Memory DatabaseBatch::getBlob(sl_uint32 column, sl_uint32 row) const
+	{
+		DatabaseBatchColumn& c = m_columns[column];
+		if (c.nulls[row]) {
+			return sl_null;
+		}
+		sl_size offset = c.offsets[row];
+		return Memory::create(c.arena + offset, c.offsets[row + 1] - offset);
+	}
+
+	void DatabaseBatch::setRowsCount(sl_uint32 count)
+	{
+		m_nRows = count;
+	}
+
+	void DatabaseBatch::setNull(sl_uint32 column, sl_uint32 row)
+	{
+		DatabaseBatchColumn& c = m_columns[column];
+		c.nulls[row] = 1;
+		if (c.offsets) {
+			if (!row) {
+				c.sizeArena = 0;
+			}
+			c.offsets[row + 1] = c.sizeArena;
+		} else {
+			c.valuesInt64[row] = 0;
+		}
+	}
+
+	void DatabaseBatch::setInt64(sl_uint32 column, sl_uint32 row, sl_int64 value)
+	{
+		DatabaseBatchColumn& c = m_columns[column];
+		c.nulls[row] = 0;
+		c.valuesInt64[row] = value;
+	}
+
+	void DatabaseBatch::setDouble(sl_uint32 column, sl_uint32 row, double value)
+	{
+		DatabaseBatchColumn& c = m_columns[column];
+		c.nulls[row] = 0;
+		c.valuesDouble[row] = value;
+	}
+
+	sl_bool DatabaseBatch::setData(sl_uint32 column, sl_uint32 row, const void* data, sl_size size)
+	{
+		DatabaseBatchColumn& c = m_columns[column];
+		if (!row) {
+			c.sizeArena = 0;
+		}
+		sl_size sizeNew = c.sizeArena + size;
+		if (sizeNew > c.capacityArena) {
+			sl_size capacity = c.capacityArena * 2;
+			if (capacity < sizeNew) {
+				capacity = sizeNew;
+			}
+			if (capacity < 1024) {
+				capacity = 1024;
+			}
+			sl_uint8* arena = (sl_uint8*)(Base::reallocMemory(c.arena, capacity));
+			if (!arena) {
+				setNull(column, row);
+				return sl_false;
+			}
+			c.arena = arena;
+			c.capacityArena = capacity;
+		}
+		Base::copyMemory(c.arena + c.sizeArena, data, size);
+		c.sizeArena = sizeNew;
+		c.offsets[row + 1] = sizeNew;
+		c.nulls[row] = 0;
+		return sl_true;
+	}
+
+	void DatabaseBatch::_free()
+	{
+		DatabaseBatchColumn* columns = m_columns;
+		if (columns) {
+			for (sl_uint32 i = 0; i < m_nColumns; i++) {
+				DatabaseBatchColumn& c = columns[i];
+				if (c.valuesInt64) {
+					Base::freeMemory(c.valuesInt64);
+				}
+				if (c.offsets) {
+					Base::freeMemory(c.offsets);
+				}
+				if (c.arena) {
+					Base::freeMemory(c.arena);
+				}
+				if (c.nulls) {
+					Base::freeMemory(c.nulls);
+				}
+			}
+			delete[] columns;
+			m_columns = sl_null;
+		}
+		m_nColumns = 0;
+		m_maxRows = 0;
+		m_nRows = 0;
+	}
+
+
 	SLIB_DEFINE_OBJECT(DatabaseCursor, Object)
 
 	DatabaseCursor::DatabaseCursor()
@@ -172,4 +402,109 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_uint32 DatabaseCursor::fetchBatch(DatabaseBatch& batch)
+	{
+		sl_uint32 nColumns = batch.getColumnsCount();
+		if (nColumns > getColumnsCount()) {
+			nColumns = getColumnsCount();
+		}
+		sl_uint32 maxRows = batch.getMaxRowsCount();
+		sl_uint32 nRows = 0;
+		while (nRows < maxRows && moveNext()) {
+			for (sl_uint32 i = 0; i < nColumns; i++) {
+				setBatchValue(batch, i, nRows);
+			}
+			nRows++;
+		}
+		batch.setRowsCount(nRows);
+		return nRows;
+	}
+
+	void DatabaseCursor::setBatchValue(DatabaseBatch& batch, sl_uint32 index, sl_uint32 row)
+	{
+		switch (batch.getColumnType(index)) {
+		case DatabaseColumnType::Int64:
+			batch.setInt64(index, row, getInt64(index));
+			break;
+		case DatabaseColumnType::Double:
+			batch.setDouble(index, row, getDouble(index));
+			break;
+		case DatabaseColumnType::String:
+			{
+				String s = getString(index);
+				if (s.isNull()) {
+					batch.setNull(index, row);
+				} else {
+					batch.setData(index, row, s.getData(), s.getLength());
+				}
+			}
+			break;
+		case DatabaseColumnType::Blob:
+			{
+				Memory m = getBlob(index);
+				if (m.isNull()) {
+					batch.setNull(index, row);
+				} else {
+					batch.setData(index, row, m.getData(), m.getSize());
+				}
+			}
+			break;
+		}
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, sl_int64& _out)
+	{
+		_out = getInt64(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, sl_uint64& _out)
+	{
+		_out = getUint64(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, sl_int32& _out)
+	{
+		_out = getInt32(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, sl_uint32& _out)
+	{
+		_out = getUint32(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, float& _out)
+	{
+		_out = getFloat(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, double& _out)
+	{
+		_out = getDouble(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, sl_bool& _out)
+	{
+		_out = getInt64(index) != 0;
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, String& _out)
+	{
+		_out = getString(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, Time& _out)
+	{
+		_out = getTime(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, Memory& _out)
+	{
+		_out = getBlob(index);
+	}
+
+	void DatabaseCursor::readValue(sl_uint32 index, Variant& _out)
+	{
+		_out = getValue(index);
+	}
+
 }
@@ -310,6 +310,36 @@ namespace slib
 				}
 				return sl_false;
 			}
+
+			// override
+			void setBatchValue(DatabaseBatch& batch, sl_uint32 index, sl_uint32 row)
+			{
+				const sl_char8* data = m_row[index];
+				if (!data) {
+					batch.setNull(index, row);
+					return;
+				}
+				sl_size len = (sl_size)(m_lengths[index]);
+				switch (batch.getColumnType(index)) {
+				case DatabaseColumnType::Int64:
+					{
+						sl_int64 value = 0;
+						String::parseInt64(10, &value, data, 0, len);
+						batch.setInt64(index, row, value);
+					}
+					break;
+				case DatabaseColumnType::Double:
+					{
+						double value = 0;
+						String::parseDouble(&value, data, 0, len);
+						batch.setDouble(index, row, value);
+					}
+					break;
+				default:
+					batch.setData(index, row, data, len);
+					break;
+				}
+			}
 		};
 
 		// override
@@ -13,10 +13,25 @@
 #include "../../../inc/slib/db/sqlite.h"
 
 #include "../../../inc/slib/core/file.h"
+#include "../../../inc/slib/core/linked_list.h"
+#include "../../../inc/slib/core/spin_lock.h"
 
 namespace slib
 {	
 
+	SQLiteParam::SQLiteParam()
+	{
+		flagCreate = sl_false;
+		flagWAL = sl_false;
+		busyTimeout = 0;
+		statementCacheSize = 32;
+	}
+
+	SQLiteParam::~SQLiteParam()
+	{
+	}
+
+
 	SLIB_DEFINE_OBJECT(SQLiteDatabase, Database)
 
 	SQLiteDatabase::SQLiteDatabase()
@@ -27,35 +42,66 @@ namespace slib
 	{
 	}
 
+	struct _Sqlite3CachedStatement
+	{
+		String sql;
+		sqlite3_stmt* statement;
+	};
+
 	class _Sqlite3Database : public SQLiteDatabase
 	{
 	public:
 		sqlite3* m_db;
 
+		// idle prepared statements, the most recently used at the front
+		CLinkedList<_Sqlite3CachedStatement> m_listCachedStatements;
+		HashMap< String, Link<_Sqlite3CachedStatement>* > m_mapCachedStatements;
+		sl_uint32 m_sizeStatementCache;
+		SpinLock m_lockStatementCache;
+
 		_Sqlite3Database()
 		{
 			m_db = sl_null;
+			m_sizeStatementCache = 0;
 		}
 
 		~_Sqlite3Database()
 		{
+			_Sqlite3CachedStatement item;
+			while (m_listCachedStatements.popFront_NoLock(&item)) {
+				::sqlite3_finalize(item.statement);
+			}
 			::sqlite3_close(m_db);
 		}
 
-		static Ref<_Sqlite3Database> connect(const String& filePath)
+		static Ref<_Sqlite3Database> connect(const SQLiteParam& param)
 		{
 			Ref<_Sqlite3Database> ret;
 			sqlite3* db = sl_null;
-			if (File::exists(filePath)) {
-				sl_int32 iResult = ::sqlite3_open(filePath.getData(), &db);
+			String filePath = param.path;
+			if (param.flagCreate || File::exists(filePath)) {
+				int flags = SQLITE_OPEN_READWRITE;
+				if (param.flagCreate) {
+					flags |= SQLITE_OPEN_CREATE;
+				}
+				sl_int32 iResult = ::sqlite3_open_v2(filePath.getData(), &db, flags, sl_null);
 				if (SQLITE_OK == iResult) {
-					ret = new _Sqlite3Database();
-					if (ret.isNotNull()) {
-						ret->m_db = db;
-						return ret;
+					if (param.busyTimeout) {
+						::sqlite3_busy_timeout(db, (int)(param.busyTimeout));
+					}
+					if (param.flagWAL) {
+						iResult = ::sqlite3_exec(db, "PRAGMA journal_mode=WAL", 0, 0, sl_null);
+					}
+					if (SQLITE_OK == iResult) {
+						ret = new _Sqlite3Database();
+						if (ret.isNotNull()) {
+							ret->m_db = db;
+							ret->m_sizeStatementCache = param.statementCacheSize;
+							return ret;
+						}
 					}
-					::sqlite3_close(db);
 				}
+				::sqlite3_close(db);
 			}
 			return ret;
 		}
@@ -88,6 +134,7 @@ namespace slib
 		public:
 			Ref<DatabaseStatement> m_statementObj;
 			sqlite3_stmt* m_statement;
+			sl_bool m_flagEnd;
 
 			CList<String> m_listColumnNames;
 			sl_uint32 m_nColumnNames;
@@ -99,6 +146,7 @@ namespace slib
 				m_db = db;
 				m_statementObj = statementObj;
 				m_statement = statement;
+				m_flagEnd = sl_false;
 
 				sl_int32 cols = ::sqlite3_column_count(statement);
 				for (sl_int32 i = 0; i < cols; i++) {
@@ -344,13 +392,63 @@ namespace slib
 			// override
 			sl_bool moveNext()
 			{
+				// stepping again after the end restarts the statement
+				if (m_flagEnd) {
+					return sl_false;
+				}
 				sl_int32 nRet = ::sqlite3_step(m_statement);
 				if (nRet == SQLITE_ROW) {
 					return sl_true;
 				}
+				m_flagEnd = sl_true;
 				return sl_false;
 			}
 
+			// override
+			void setBatchValue(DatabaseBatch& batch, sl_uint32 index, sl_uint32 row)
+			{
+				int type = ::sqlite3_column_type(m_statement, index);
+				if (type == SQLITE_NULL) {
+					batch.setNull(index, row);
+					return;
+				}
+				switch (batch.getColumnType(index)) {
+				case DatabaseColumnType::Int64:
+					if (type == SQLITE_TEXT) {
+						sl_int64 value = 0;
+						String::parseInt64(10, &value, (const sl_char8*)(sqlite3_column_text(m_statement, index)), 0, sqlite3_column_bytes(m_statement, index));
+						batch.setInt64(index, row, value);
+					} else {
+						batch.setInt64(index, row, sqlite3_column_int64(m_statement, index));
+					}
+					break;
+				case DatabaseColumnType::Double:
+					if (type == SQLITE_TEXT) {
+						double value = 0;
+						String::parseDouble(&value, (const sl_char8*)(sqlite3_column_text(m_statement, index)), 0, sqlite3_column_bytes(m_statement, index));
+						batch.setDouble(index, row, value);
+					} else {
+						batch.setDouble(index, row, sqlite3_column_double(m_statement, index));
+					}
+					break;
+				case DatabaseColumnType::String:
+					{
+						// converts the numbers into the text in the buffer of the statement
+						const void* buf = sqlite3_column_text(m_statement, index);
+						int n = sqlite3_column_bytes(m_statement, index);
+						batch.setData(index, row, buf, n);
+					}
+					break;
+				case DatabaseColumnType::Blob:
+					{
+						const void* buf = sqlite3_column_blob(m_statement, index);
+						int n = sqlite3_column_bytes(m_statement, index);
+						batch.setData(index, row, buf, n);
+					}
+					break;
+				}
+			}
+
 		};
 
 		class _DatabaseStatement : public DatabaseStatement
@@ -358,18 +456,21 @@ namespace slib
 		public:
 			sqlite3* m_sqlite;
 			sqlite3_stmt* m_statement;
+			String m_sql;
 			Array<Variant> m_boundParams;
 
-			_DatabaseStatement(_Sqlite3Database* db, sqlite3_stmt* statement)
+			_DatabaseStatement(_Sqlite3Database* db, sqlite3_stmt* statement, const String& sql)
 			{
 				m_db = db;
 				m_sqlite = db->m_db;
 				m_statement = statement;
+				m_sql = sql;
 			}
 
 			~_DatabaseStatement()
 			{
-				::sqlite3_finalize(m_statement);
+				// the cursors hold this object, so the statement is not in use here
+				((_Sqlite3Database*)(m_db.get()))->_releaseStatement(m_sql, m_statement);
 			}
 
 			sl_bool _execute(const Variant* _params, sl_uint32 nParams)
@@ -394,34 +495,34 @@ namespace slib
 							Variant& var = (params.getData())[i];
 							switch (var.getType()) {
 							case VariantType::Null:
-								iRet = ::sqlite3_bind_null(m_statement, i);
+								iRet = ::sqlite3_bind_null(m_statement, i + 1);
 								break;
 							case VariantType::Boolean:
 							case VariantType::Int32:
-								iRet = ::sqlite3_bind_int(m_statement, i, var.getInt32());
+								iRet = ::sqlite3_bind_int(m_statement, i + 1, var.getInt32());
 								break;
 							case VariantType::Uint32:
 							case VariantType::Int64:
 							case VariantType::Uint64:
-								iRet = ::sqlite3_bind_int64(m_statement, i, var.getInt64());
+								iRet = ::sqlite3_bind_int64(m_statement, i + 1, var.getInt64());
 								break;
 							case VariantType::Float:
 							case VariantType::Double:
-								iRet = ::sqlite3_bind_double(m_statement, i, var.getDouble());
+								iRet = ::sqlite3_bind_double(m_statement, i + 1, var.getDouble());
 								break;
 							default:
 								if (var.isMemory()) {
 									Memory mem = var.getMemory();
 									sl_size size = mem.getSize();
 									if (size > 0x7fffffff) {
-										iRet = ::sqlite3_bind_blob64(m_statement, i, mem.getData(), size, SQLITE_STATIC);
+										iRet = ::sqlite3_bind_blob64(m_statement, i + 1, mem.getData(), size, SQLITE_STATIC);
 									} else {
-										iRet = ::sqlite3_bind_blob(m_statement, i, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
+										iRet = ::sqlite3_bind_blob(m_statement, i + 1, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
 									}
 								} else {
 									String str = var.getString();
 									var = str;
-									iRet = ::sqlite3_bind_text(m_statement, i, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
+									iRet = ::sqlite3_bind_text(m_statement, i + 1, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
 								}
 							}
 							if (iRet != SQLITE_OK) {
@@ -469,19 +570,64 @@ namespace slib
 		// override
 		Ref<DatabaseStatement> prepareStatement(const String& sql)
 		{
-			ObjectLocker lock(this);
 			Ref<DatabaseStatement> ret;
-			sqlite3_stmt* statement = sl_null;
-			if (SQLITE_OK == ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
-				ret = new _DatabaseStatement(this, statement);
-				if (ret.isNotNull()) {
+			sqlite3_stmt* statement = _getCachedStatement(sql);
+			if (!statement) {
+				ObjectLocker lock(this);
+				if (SQLITE_OK != ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
 					return ret;
 				}
-				::sqlite3_finalize(statement);
 			}
+			ret = new _DatabaseStatement(this, statement, sql);
+			if (ret.isNotNull()) {
+				return ret;
+			}
+			::sqlite3_finalize(statement);
 			return ret;
 		}
 
+		// takes the idle statement out of the cache, so that it is used by one object at a time
+		sqlite3_stmt* _getCachedStatement(const String& sql)
+		{
+			SpinLocker lock(&m_lockStatementCache);
+			Link<_Sqlite3CachedStatement>* link;
+			if (m_mapCachedStatements.remove_NoLock(sql, &link)) {
+				sqlite3_stmt* statement = link->value.statement;
+				m_listCachedStatements.removeItem_NoLock(link);
+				return statement;
+			}
+			return sl_null;
+		}
+
+		void _releaseStatement(const String& sql, sqlite3_stmt* statement)
+		{
+			::sqlite3_reset(statement);
+			::sqlite3_clear_bindings(statement);
+			sqlite3_stmt* statementEvicted = statement;
+			{
+				SpinLocker lock(&m_lockStatementCache);
+				if (m_sizeStatementCache && !(m_mapCachedStatements.contains_NoLock(sql))) {
+					_Sqlite3CachedStatement item;
+					item.sql = sql;
+					item.statement = statement;
+					Link<_Sqlite3CachedStatement>* link = m_listCachedStatements.pushFront_NoLock(item);
+					if (link) {
+						m_mapCachedStatements.put_NoLock(sql, link);
+						statementEvicted = sl_null;
+						if (m_listCachedStatements.getCount() > m_sizeStatementCache) {
+							// evicts the least recently used
+							m_listCachedStatements.popBack_NoLock(&item);
+							m_mapCachedStatements.remove_NoLock(item.sql);
+							statementEvicted = item.statement;
+						}
+					}
+				}
+			}
+			if (statementEvicted) {
+				::sqlite3_finalize(statementEvicted);
+			}
+		}
+
 		// override
 		String getErrorMessage()
 		{
@@ -491,7 +637,23 @@ namespace slib
 
 	Ref<SQLiteDatabase> SQLiteDatabase::connect(const String& path)
 	{
-		return _Sqlite3Database::connect(path);
+		SQLiteParam param;
+		param.path = path;
+		return _Sqlite3Database::connect(param);
+	}
+
+	Ref<SQLiteDatabase> SQLiteDatabase::connect(const SQLiteParam& param)
+	{
+		return _Sqlite3Database::connect(param);
+	}
+
+	Ref<DatabasePool> SQLiteDatabase::createPool(const SQLiteParam& _param)
+	{
+		SQLiteParam param = _param;
+		param.flagWAL = sl_true;
+		return DatabasePool::create([param]() {
+			return Ref<Database>(_Sqlite3Database::connect(param));
+		});
 	}
 
 }
@@ -2003,164 +2003,324 @@ namespace slib
 	}
 
 /*
-	Montgomery multiplication: A = A * B * R^-1 mod M
+	Montgomery arithmetic on 64-bit limbs
 */
-	static sl_bool _cbigint_mont_mul(CBigInt& A, const CBigInt& B, const CBigInt& M, sl_uint32 MI)
+
+#define CBIGINT_KARATSUBA_THRESHOLD 40
+
+	// returns the low limb of (a * b + r + c), and the high limb in c
+	SLIB_INLINE static sl_uint64 _cbigint_mac64(sl_uint64 a, sl_uint64 b, sl_uint64 r, sl_uint64& c)
 	{
-		sl_size nM = M.length;
-		sl_size nB = Math::min(nM, B.length);
-		
-		sl_size nOut = nM * 2 + 1;
-		SLIB_SCOPED_BUFFER(sl_uint32, STACK_BUFFER_SIZE, out, nOut);
-		if (!out) {
-			return sl_false;
+#if defined(SLIB_COMPILER_IS_GCC) && defined(__SIZEOF_INT128__)
+		unsigned __int128 t = ((unsigned __int128)a) * b + r + c;
+		c = (sl_uint64)(t >> 64);
+		return (sl_uint64)t;
+#else
+		sl_uint64 h, l;
+		Math::mul64(a, b, h, l);
+		l += r;
+		h += l < r;
+		l += c;
+		h += l < c;
+		c = h;
+		return l;
+#endif
+	}
+
+	// r[0..n) += a[0..n) * b, returns carry
+	SLIB_INLINE static sl_uint64 _cbigint_mul64_add(sl_uint64* r, const sl_uint64* a, sl_size n, sl_uint64 b)
+	{
+		sl_uint64 c = 0;
+		for (sl_size i = 0; i < n; i++) {
+			r[i] = _cbigint_mac64(a[i], b, r[i], c);
 		}
-		Base::zeroMemory(out, nOut * 4);
-		for (sl_size i = 0; i < nM; i++) {
-			// T = (T + cB*B + cM*M) / 2^(32*nM)
-			sl_uint32 cB = i < A.length ? A.elements[i] : 0;
-			sl_uint32 cM = (out[0] + cB * B.elements[0]) * MI;
-			_cbigint_muladd_uint32(out, out, nOut, B.elements, nB, cB, 0);
-			_cbigint_muladd_uint32(out, out, nOut, M.elements, nM, cM, 0);
-			*out = cB;
-			nOut--;
-			out++;
-		}
-		if (!A.setValueFromElements(out, nM + 1)) {
-			return sl_false;
+		return c;
+	}
+
+	// r[0..n) = a[0..n) + b[0..n), returns carry
+	static sl_uint64 _cbigint_add64(sl_uint64* r, const sl_uint64* a, const sl_uint64* b, sl_size n)
+	{
+		sl_uint64 c = 0;
+		for (sl_size i = 0; i < n; i++) {
+			sl_uint64 s = a[i] + c;
+			c = s < c;
+			sl_uint64 t = s + b[i];
+			c += t < s;
+			r[i] = t;
 		}
-		if (A.compareAbs(M) >= 0) {
-			if (!A.subAbs(A, M)) {
-				return sl_false;
-			}
+		return c;
+	}
+
+	// r[0..n) = a[0..n) - b[0..n), returns borrow
+	static sl_uint64 _cbigint_sub64(sl_uint64* r, const sl_uint64* a, const sl_uint64* b, sl_size n)
+	{
+		sl_uint64 c = 0;
+		for (sl_size i = 0; i < n; i++) {
+			sl_uint64 s = a[i] - b[i];
+			sl_uint64 c1 = s > a[i];
+			r[i] = s - c;
+			c = c1 | (r[i] > s);
 		}
-		return sl_true;
+		return c;
 	}
 
-/*
-	Montgomery reduction: A = A * R^-1 mod M
-*/
-	SLIB_INLINE static sl_bool _cbigint_mont_reduction(CBigInt& A, const CBigInt& M, sl_uint32 MI)
+	// r[0..n) += v, returns carry
+	static sl_uint64 _cbigint_inc64(sl_uint64* r, sl_size n, sl_uint64 v)
 	{
-		CBIGINT_UINT32(o, 1);
-		return _cbigint_mont_mul(A, o, M, MI);
+		for (sl_size i = 0; i < n && v; i++) {
+			sl_uint64 s = r[i] + v;
+			v = s < v;
+			r[i] = s;
+		}
+		return v;
 	}
 
-	sl_bool CBigInt::pow_montgomery(const CBigInt& A, const CBigInt& _E, const CBigInt& _M)
+	static sl_int32 _cbigint_compare64(const sl_uint64* a, const sl_uint64* b, sl_size n)
 	{
-		CBigInt M;
-		M.copyFrom(_M);
-		if (!M.compact()) {
-			return sl_false;
+		for (sl_size i = n; i > 0; i--) {
+			if (a[i - 1] != b[i - 1]) {
+				return a[i - 1] > b[i - 1] ? 1 : -1;
+			}
 		}
-		sl_size nM = M.getMostSignificantElements();
-		if (nM == 0) {
-			return sl_false;
+		return 0;
+	}
+
+	// r[0..na+nb) = a[0..na) * b[0..nb)
+	static void _cbigint_mul64_basic(sl_uint64* r, const sl_uint64* a, sl_size na, const sl_uint64* b, sl_size nb)
+	{
+		Base::zeroMemory(r, na * 8);
+		for (sl_size j = 0; j < nb; j++) {
+			r[j + na] = _cbigint_mul64_add(r + j, a, na, b[j]);
 		}
-		if (M.sign < 0) {
-			return sl_false;
+	}
+
+	// r[0..2n) = a[0..n)^2
+	static void _cbigint_sqr64_basic(sl_uint64* r, const sl_uint64* a, sl_size n)
+	{
+		sl_size n2 = n << 1;
+		Base::zeroMemory(r, n * 8);
+		r[n2 - 1] = 0;
+		// cross products
+		for (sl_size i = 0; i + 1 < n; i++) {
+			r[i + n] = _cbigint_mul64_add(r + i + i + 1, a + i + 1, n - i - 1, a[i]);
 		}
-		const CBigInt* pE;
-		CBigInt __E;
-		if (&_E == this) {
-			pE = &__E;
-			if (!__E.copyFrom(_E)) {
-				return sl_false;
-			}
-		} else {
-			pE = &_E;
+		// double
+		sl_uint64 c = 0;
+		for (sl_size i = 0; i < n2; i++) {
+			sl_uint64 t = r[i];
+			r[i] = (t << 1) | c;
+			c = t >> 63;
 		}
-		const CBigInt& E = *pE;
-		sl_size nE = E.getMostSignificantElements();
-		if (nE == 0) {
-			if (!setValue((sl_uint32)1)) {
-				return sl_false;
+		// diagonal
+		c = 0;
+		for (sl_size i = 0; i < n; i++) {
+			sl_uint64 h = 0;
+			sl_uint64 l = _cbigint_mac64(a[i], a[i], 0, h);
+			sl_uint64 s = r[i << 1] + l;
+			sl_uint64 c1 = s < l;
+			s += c;
+			c1 += s < c;
+			r[i << 1] = s;
+			s = r[(i << 1) + 1] + h;
+			sl_uint64 c2 = s < h;
+			s += c1;
+			c2 += s < c1;
+			r[(i << 1) + 1] = s;
+			c = c2;
+		}
+	}
+
+	// limbs of the work area used by the karatsuba functions
+	static sl_size _cbigint_karatsuba_work_size(sl_size n)
+	{
+		sl_size size = 0;
+		while (n >= CBIGINT_KARATSUBA_THRESHOLD) {
+			n -= n >> 1;
+			size += 6 * n + 2;
+		}
+		return size;
+	}
+
+	/*
+		r = a0*b0 + (a0*b0 + a1*b1 - (a0-a1)*(b0-b1)) * X + a1*b1 * X^2
+		r[0..2n) = a[0..n) * b[0..n)
+	*/
+	static void _cbigint_mul64_karatsuba(sl_uint64* r, const sl_uint64* a, const sl_uint64* b, sl_size n, sl_uint64* work)
+	{
+		if (n < CBIGINT_KARATSUBA_THRESHOLD) {
+			_cbigint_mul64_basic(r, a, n, b, n);
+			return;
+		}
+		sl_size nl = n >> 1;
+		sl_size nh = n - nl;
+		sl_uint64* da = work;
+		sl_uint64* db = da + nh;
+		sl_uint64* z1 = db + nh;
+		sl_uint64* t = z1 + (nh << 1);
+		sl_uint64* workNext = t + (nh << 1) + 2;
+
+		// |a1 - a0|, |b1 - b0|, low parts are extended to nh limbs
+		sl_bool flagNegative = sl_false;
+		for (int k = 0; k < 2; k++) {
+			const sl_uint64* x = k ? b : a;
+			sl_uint64* d = k ? db : da;
+			d[nh - 1] = 0;
+			Base::copyMemory(d, x, nl * 8);
+			if (_cbigint_compare64(x + nl, d, nh) >= 0) {
+				_cbigint_sub64(d, x + nl, d, nh);
+			} else {
+				_cbigint_sub64(d, d, x + nl, nh);
+				flagNegative = !flagNegative;
 			}
-			sign = 1;
-			return sl_true;
 		}
-		if (E.sign < 0) {
-			return sl_false;
+
+		_cbigint_mul64_karatsuba(r, a, b, nl, workNext);
+		_cbigint_mul64_karatsuba(r + (nl << 1), a + nl, b + nl, nh, workNext);
+		_cbigint_mul64_karatsuba(z1, da, db, nh, workNext);
+
+		// t = a0*b0 + a1*b1 -+ z1
+		sl_size nt = (nh << 1) + 1;
+		Base::copyMemory(t, r, (nl << 1) * 8);
+		Base::zeroMemory(t + (nl << 1), (nt - (nl << 1)) * 8);
+		t[nh << 1] = _cbigint_add64(t, t, r + (nl << 1), nh << 1);
+		if (flagNegative) {
+			t[nh << 1] += _cbigint_add64(t, t, z1, nh << 1);
+		} else {
+			t[nh << 1] -= _cbigint_sub64(t, t, z1, nh << 1);
 		}
-		sl_size nA = A.getMostSignificantElements();
-		if (nA == 0) {
-			setZero();
-			return sl_true;
+		sl_size nr = (n << 1) - nl;
+		_cbigint_inc64(r + nl + nt, nr - nt, _cbigint_add64(r + nl, r + nl, t, nt));
+	}
+
+	// r[0..2n) = a[0..n)^2
+	static void _cbigint_sqr64_karatsuba(sl_uint64* r, const sl_uint64* a, sl_size n, sl_uint64* work)
+	{
+		if (n < CBIGINT_KARATSUBA_THRESHOLD) {
+			_cbigint_sqr64_basic(r, a, n);
+			return;
 		}
+		sl_size nl = n >> 1;
+		sl_size nh = n - nl;
+		sl_uint64* da = work;
+		sl_uint64* z1 = da + (nh << 1);
+		sl_uint64* t = z1 + (nh << 1);
+		sl_uint64* workNext = t + (nh << 1) + 2;
 
-		// MI = -(M0^-1) mod (2^32)
-		sl_uint32 MI;
-		// initialize montgomery
-		{
-			sl_uint32 M0 = M.elements[0];
-			sl_uint32 K = M0;
-			K += ((M0 + 2) & 4) << 1;
-			for (sl_uint32 i = 32; i >= 8; i /= 2) {
-				K *= (2 - (M0 * K));
-			}
-			MI = 0 - K;
+		da[nh - 1] = 0;
+		Base::copyMemory(da, a, nl * 8);
+		if (_cbigint_compare64(a + nl, da, nh) >= 0) {
+			_cbigint_sub64(da, a + nl, da, nh);
+		} else {
+			_cbigint_sub64(da, da, a + nl, nh);
 		}
 
-		// pre-compute R^2 mod M
-		// R = 2^(nM*32)
-		CBigInt R2;
-		{
-			if (!R2.setValue((sl_uint32)1)) {
-				return sl_false;
-			}
-			if (!R2.shiftLeft(nM * 64)) {
-				return sl_false;
-			}
-			if (!CBigInt::divAbs(R2, M, sl_null, &R2)) {
-				return sl_false;
-			}
+		_cbigint_sqr64_karatsuba(r, a, nl, workNext);
+		_cbigint_sqr64_karatsuba(r + (nl << 1), a + nl, nh, workNext);
+		_cbigint_sqr64_karatsuba(z1, da, nh, workNext);
+
+		// t = a0^2 + a1^2 - (a1-a0)^2
+		sl_size nt = (nh << 1) + 1;
+		Base::copyMemory(t, r, (nl << 1) * 8);
+		Base::zeroMemory(t + (nl << 1), (nt - (nl << 1)) * 8);
+		t[nh << 1] = _cbigint_add64(t, t, r + (nl << 1), nh << 1);
+		t[nh << 1] -= _cbigint_sub64(t, t, z1, nh << 1);
+		sl_size nr = (n << 1) - nl;
+		_cbigint_inc64(r + nl + nt, nr - nt, _cbigint_add64(r + nl, r + nl, t, nt));
+	}
+
+	/*
+		Montgomery reduction: r = t * R^-1 mod M, R = 2^(64*n)
+			t[0..2n) < M*R, and `t` is destroyed
+	*/
+	static void _cbigint_mont64_reduce(sl_uint64* r, sl_uint64* t, const sl_uint64* M, sl_size n, sl_uint64 MI)
+	{
+		sl_uint64 carry = 0;
+		for (sl_size i = 0; i < n; i++) {
+			sl_uint64 c = _cbigint_mul64_add(t + i, M, n, t[i] * MI);
+			sl_uint64 s = t[i + n] + c;
+			sl_uint64 c1 = s < c;
+			s += carry;
+			c1 += s < carry;
+			t[i + n] = s;
+			carry = c1;
+		}
+		if (carry || _cbigint_compare64(t + n, M, n) >= 0) {
+			_cbigint_sub64(r, t + n, M, n);
+		} else {
+			Base::copyMemory(r, t + n, n * 8);
 		}
+	}
 
-		sl_bool flagNegative = A.sign < 0;
-		// T = A * R^2 * R^-1 mod M = A * R mod M
-		CBigInt T;
-		if (!CBigInt::divAbs(A, M, sl_null, &T)) {
+	// r = a * b * R^-1 mod M, `t` has 2n limbs
+	SLIB_INLINE static void _cbigint_mont64_mul(sl_uint64* r, const sl_uint64* a, const sl_uint64* b, const sl_uint64* M, sl_size n, sl_uint64 MI, sl_uint64* t, sl_uint64* work)
+	{
+		_cbigint_mul64_karatsuba(t, a, b, n, work);
+		_cbigint_mont64_reduce(r, t, M, n, MI);
+	}
+
+	// r = a * a * R^-1 mod M, `t` has 2n limbs
+	SLIB_INLINE static void _cbigint_mont64_sqr(sl_uint64* r, const sl_uint64* a, const sl_uint64* M, sl_size n, sl_uint64 MI, sl_uint64* t, sl_uint64* work)
+	{
+		_cbigint_sqr64_karatsuba(t, a, n, work);
+		_cbigint_mont64_reduce(r, t, M, n, MI);
+	}
+
+	// out[0..n) = |A|, returns false when |A| doesn't fit
+	static sl_bool _cbigint_get_limbs64(sl_uint64* out, sl_size n, const CBigInt& A)
+	{
+		sl_size nA = A.getMostSignificantElements();
+		if (nA > (n << 1)) {
 			return sl_false;
 		}
-		if (!_cbigint_mont_mul(T, R2, M, MI)) {
-			return sl_false;
+		Base::zeroMemory(out, n * 8);
+		for (sl_size i = 0; i < nA; i++) {
+			out[i >> 1] |= ((sl_uint64)(A.elements[i])) << ((i & 1) << 5);
 		}
+		return sl_true;
+	}
 
-		// C = R^2 * R^-1 mod M = R mod M
-		if (!copyFrom(R2)) {
+	static sl_bool _cbigint_set_limbs64(CBigInt& A, const sl_uint64* v, sl_size n)
+	{
+		SLIB_SCOPED_BUFFER(sl_uint32, STACK_BUFFER_SIZE, e, n << 1);
+		if (!e) {
 			return sl_false;
 		}
-		if (!_cbigint_mont_reduction(*this, M, MI)) {
+		for (sl_size i = 0; i < n; i++) {
+			e[i << 1] = (sl_uint32)(v[i]);
+			e[(i << 1) + 1] = (sl_uint32)(v[i] >> 32);
+		}
+		if (!A.setValueFromElements(e, n << 1)) {
 			return sl_false;
 		}
+		A.sign = 1;
+		return sl_true;
+	}
 
-		sl_size nbE = E.getMostSignificantBits();
-		for (sl_size ib = 0; ib < nbE; ib++) {
-			sl_size ke = ib >> 5;
-			sl_uint32 kb = (sl_uint32)(ib & 31);
-			if (((E.elements[ke]) >> kb) & 1) {
-				// C = C * T * R^-1 mod M
-				if (!_cbigint_mont_mul(*this, T, M, MI)) {
-					return sl_false;
-				}
-			}
-			// T = T * T * R^-1 mod M
-			if (!_cbigint_mont_mul(T, T, M, MI)) {
-				return sl_false;
-			}
+	// window size of the sliding window exponentiation by the bits of the exponent
+	static sl_uint32 _cbigint_mont64_window(sl_size nbE)
+	{
+		if (nbE > 671) {
+			return 6;
 		}
-		if (!_cbigint_mont_reduction(*this, M, MI)) {
-			return sl_false;
+		if (nbE > 239) {
+			return 5;
 		}
-		if (flagNegative && (E.elements[0] & 1) != 0) {
-			sign = -1;
-			if (!add(M)) {
-				return sl_false;
-			}
-		} else {
-			sign = 1;
+		if (nbE > 79) {
+			return 4;
 		}
-		return sl_true;
+		if (nbE > 23) {
+			return 3;
+		}
+		return 1;
+	}
+
+	sl_bool CBigInt::pow_montgomery(const CBigInt& A, const CBigInt& E, const CBigInt& M)
+	{
+		BigIntMontgomery context;
+		if (!context.initialize(M)) {
+			return sl_false;
+		}
+		return context.pow(*this, A, E);
 	}
 
 	sl_bool CBigInt::pow_montgomery(const CBigInt& E, const CBigInt& M)
@@ -4778,4 +4938,239 @@ namespace slib
 		return BigInt::shiftRight(a, n);
 	}
 
+
+/*
+	BigIntMontgomery
+*/
+
+	SLIB_DEFINE_ROOT_OBJECT(BigIntMontgomery)
+
+	BigIntMontgomery::BigIntMontgomery()
+	{
+		m_M = sl_null;
+		m_R2 = sl_null;
+		m_n = 0;
+		m_MI = 0;
+	}
+
+	BigIntMontgomery::~BigIntMontgomery()
+	{
+		_free();
+	}
+
+	Ref<BigIntMontgomery> BigIntMontgomery::create(const BigInt& M)
+	{
+		CBigInt* m = M.ref._ptr;
+		if (m) {
+			Ref<BigIntMontgomery> ret = new BigIntMontgomery;
+			if (ret.isNotNull()) {
+				if (ret->initialize(*m)) {
+					return ret;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	sl_bool BigIntMontgomery::initialize(const CBigInt& M)
+	{
+		_free();
+		if (M.sign < 0) {
+			return sl_false;
+		}
+		sl_size nbM = M.getMostSignificantBits();
+		if (nbM == 0) {
+			return sl_false;
+		}
+		if (!(M.elements[0] & 1)) {
+			return sl_false;
+		}
+		sl_size n = (nbM + 63) >> 6;
+		CBigInt* modulus = M.duplicateCompact();
+		if (!modulus) {
+			return sl_false;
+		}
+		m_modulus = modulus;
+		sl_uint64* mem = (sl_uint64*)(Base::createMemory(n * 16));
+		if (!mem) {
+			_free();
+			return sl_false;
+		}
+		m_M = mem;
+		m_R2 = mem + n;
+		_cbigint_get_limbs64(m_M, n, M);
+
+		// MI = -(M0^-1) mod (2^64), each iteration doubles the correct bits from 5 bits
+		sl_uint64 M0 = m_M[0];
+		sl_uint64 K = (M0 * 3) ^ 2;
+		for (sl_uint32 i = 0; i < 4; i++) {
+			K *= 2 - M0 * K;
+		}
+		m_MI = 0 - K;
+
+		// R^2 mod M
+		CBigInt R2;
+		if (!R2.setValue((sl_uint32)1)) {
+			_free();
+			return sl_false;
+		}
+		if (!R2.shiftLeft(n * 128)) {
+			_free();
+			return sl_false;
+		}
+		if (!CBigInt::divAbs(R2, M, sl_null, &R2)) {
+			_free();
+			return sl_false;
+		}
+		_cbigint_get_limbs64(m_R2, n, R2);
+		m_n = n;
+		return sl_true;
+	}
+
+	sl_bool BigIntMontgomery::isInitialized() const
+	{
+		return m_n != 0;
+	}
+
+	BigInt BigIntMontgomery::getModulus() const
+	{
+		return m_modulus;
+	}
+
+	sl_bool BigIntMontgomery::pow(CBigInt& C, const CBigInt& A, const CBigInt& E) const
+	{
+		sl_size n = m_n;
+		if (n == 0) {
+			return sl_false;
+		}
+		if (E.sign < 0) {
+			return sl_false;
+		}
+		sl_size nbE = E.getMostSignificantBits();
+		if (nbE == 0) {
+			if (!C.setValue((sl_uint32)1)) {
+				return sl_false;
+			}
+			C.sign = 1;
+			return sl_true;
+		}
+		if (A.isZero()) {
+			C.setZero();
+			return sl_true;
+		}
+		const sl_uint64* M = m_M;
+		sl_uint64 MI = m_MI;
+
+		sl_uint32 nWindow = _cbigint_mont64_window(nbE);
+		// odd powers: A, A^3, A^5, ..., A^(2^nWindow-1)
+		sl_size nTable = ((sl_size)1) << (nWindow - 1);
+		sl_size nBuf = n * (nTable + 3) + _cbigint_karatsuba_work_size(n);
+		SLIB_SCOPED_BUFFER(sl_uint64, 1024, buf, nBuf);
+		if (!buf) {
+			return sl_false;
+		}
+		sl_uint64* table = buf;
+		sl_uint64* X = table + n * nTable;
+		sl_uint64* T = X + n;
+		sl_uint64* work = T + (n << 1);
+
+		// table[0] = A * R mod M
+		if (A.compareAbs(*(m_modulus.ref._ptr)) >= 0) {
+			CBigInt a;
+			if (!CBigInt::divAbs(A, *(m_modulus.ref._ptr), sl_null, &a)) {
+				return sl_false;
+			}
+			_cbigint_get_limbs64(X, n, a);
+		} else {
+			_cbigint_get_limbs64(X, n, A);
+		}
+		_cbigint_mont64_mul(table, X, m_R2, M, n, MI, T, work);
+		if (nTable > 1) {
+			_cbigint_mont64_sqr(X, table, M, n, MI, T, work);
+			for (sl_size i = 1; i < nTable; i++) {
+				_cbigint_mont64_mul(table + i * n, table + (i - 1) * n, X, M, n, MI, T, work);
+			}
+		}
+
+		// sliding window from the most significant bit
+		sl_bool flagStarted = sl_false;
+		sl_size ib = nbE;
+		while (ib > 0) {
+			sl_size k = ib - 1;
+			if (!(E.getBit(k))) {
+				if (flagStarted) {
+					_cbigint_mont64_sqr(X, X, M, n, MI, T, work);
+				}
+				ib = k;
+				continue;
+			}
+			// window [kb, k] ending with the set bit
+			sl_size kb = k + 1 > nWindow ? k + 1 - nWindow : 0;
+			while (!(E.getBit(kb))) {
+				kb++;
+			}
+			sl_size index = 0;
+			for (sl_size m = k + 1; m > kb; m--) {
+				index = (index << 1) | (E.getBit(m - 1) ? 1 : 0);
+			}
+			const sl_uint64* P = table + (index >> 1) * n;
+			if (flagStarted) {
+				for (sl_size m = kb; m <= k; m++) {
+					_cbigint_mont64_sqr(X, X, M, n, MI, T, work);
+				}
+				_cbigint_mont64_mul(X, X, P, M, n, MI, T, work);
+			} else {
+				Base::copyMemory(X, P, n * 8);
+				flagStarted = sl_true;
+			}
+			ib = kb;
+		}
+
+		// C = X * R^-1 mod M
+		Base::copyMemory(T, X, n * 8);
+		Base::zeroMemory(T + n, n * 8);
+		_cbigint_mont64_reduce(X, T, M, n, MI);
+
+		if (A.sign < 0 && E.getBit(0)) {
+			sl_size i = 0;
+			while (i < n && !(X[i])) {
+				i++;
+			}
+			if (i < n) {
+				_cbigint_sub64(X, M, X, n);
+			}
+		}
+		return _cbigint_set_limbs64(C, X, n);
+	}
+
+	BigInt BigIntMontgomery::pow(const BigInt& A, const BigInt& E) const
+	{
+		CBigInt* a = A.ref._ptr;
+		CBigInt* e = E.ref._ptr;
+		if (!e || e->isZero()) {
+			return BigInt::fromInt32(1);
+		}
+		if (a) {
+			CBigInt* r = new CBigInt;
+			if (r) {
+				if (pow(*r, *a, *e)) {
+					return r;
+				}
+				delete r;
+			}
+		}
+		return sl_null;
+	}
+
+	void BigIntMontgomery::_free()
+	{
+		if (m_M) {
+			Base::freeMemory(m_M);
+			m_M = sl_null;
+		}
+		m_R2 = sl_null;
+		m_n = 0;
+		m_modulus.setNull();
+	}
+
 }
@@ -0,0 +1,793 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/network/http2.h"
+
+#include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/memory.h"
+#include "../../../inc/slib/core/safe_static.h"
+
+namespace slib
+{
+
+/***********************************************************************
+						Http2FrameHeader
+***********************************************************************/
+
+	sl_uint32 Http2FrameHeader::getLength() const
+	{
+		return ((sl_uint32)(_length[0]) << 16) | ((sl_uint32)(_length[1]) << 8) | ((sl_uint32)(_length[2]));
+	}
+
+	void Http2FrameHeader::setLength(sl_uint32 length)
+	{
+		_length[0] = (sl_uint8)(length >> 16);
+		_length[1] = (sl_uint8)(length >> 8);
+		_length[2] = (sl_uint8)(length);
+	}
+
+	Http2FrameType Http2FrameHeader::getType() const
+	{
+		return (Http2FrameType)(_type);
+	}
+
+	void Http2FrameHeader::setType(Http2FrameType type)
+	{
+		_type = (sl_uint8)type;
+	}
+
+	sl_uint8 Http2FrameHeader::getFlags() const
+	{
+		return _flags;
+	}
+
+	void Http2FrameHeader::setFlags(sl_uint8 flags)
+	{
+		_flags = flags;
+	}
+
+	sl_bool Http2FrameHeader::isFlag(sl_uint8 flag) const
+	{
+		return (_flags & flag) != 0;
+	}
+
+	sl_uint32 Http2FrameHeader::getStreamId() const
+	{
+		return MIO::readUint32BE(_streamId) & 0x7fffffff;
+	}
+
+	void Http2FrameHeader::setStreamId(sl_uint32 streamId)
+	{
+		MIO::writeUint32BE(_streamId, streamId & 0x7fffffff);
+	}
+
+	const sl_uint8* Http2FrameHeader::getPayload() const
+	{
+		return (const sl_uint8*)this + SLIB_HTTP2_FRAME_HEADER_SIZE;
+	}
+
+	sl_uint8* Http2FrameHeader::getPayload()
+	{
+		return (sl_uint8*)this + SLIB_HTTP2_FRAME_HEADER_SIZE;
+	}
+
+
+/***********************************************************************
+							HPackHeader
+***********************************************************************/
+
+	HPackHeader::HPackHeader()
+	{
+	}
+
+	HPackHeader::HPackHeader(const String& _name, const String& _value) : name(_name), value(_value)
+	{
+	}
+
+	HPackHeader::~HPackHeader()
+	{
+	}
+
+	sl_uint32 HPackHeader::getEntrySize() const
+	{
+		return (sl_uint32)(name.getLength() + value.getLength()) + SLIB_HPACK_ENTRY_OVERHEAD;
+	}
+
+
+/***********************************************************************
+						HPackDynamicTable
+***********************************************************************/
+
+	HPackDynamicTable::HPackDynamicTable()
+	{
+		m_entries = sl_null;
+		m_capacity = 0;
+		m_first = 0;
+		m_count = 0;
+		m_size = 0;
+		m_maxSize = SLIB_HPACK_DEFAULT_TABLE_SIZE;
+	}
+
+	HPackDynamicTable::~HPackDynamicTable()
+	{
+		if (m_entries) {
+			delete[] m_entries;
+		}
+	}
+
+	sl_uint32 HPackDynamicTable::getCount() const
+	{
+		return m_count;
+	}
+
+	sl_uint32 HPackDynamicTable::getSize() const
+	{
+		return m_size;
+	}
+
+	sl_uint32 HPackDynamicTable::getMaxSize() const
+	{
+		return m_maxSize;
+	}
+
+	void HPackDynamicTable::setMaxSize(sl_uint32 size)
+	{
+		m_maxSize = size;
+		_evict(size);
+	}
+
+	const HPackHeader* HPackDynamicTable::getEntry(sl_uint32 index) const
+	{
+		if (index < m_count) {
+			return m_entries + ((m_first + index) & (m_capacity - 1));
+		}
+		return sl_null;
+	}
+
+	void HPackDynamicTable::add(const String& name, const String& value)
+	{
+		sl_uint32 size = (sl_uint32)(name.getLength() + value.getLength()) + SLIB_HPACK_ENTRY_OVERHEAD;
+		if (size > m_maxSize) {
+			clear();
+			return;
+		}
+		_evict(m_maxSize - size);
+		if (m_count >= m_capacity) {
+			// the capacity is kept as a power of 2
+			sl_uint32 capacity = m_capacity ? m_capacity << 1 : 16;
+			HPackHeader* entries = new HPackHeader[capacity];
+			if (!entries) {
+				return;
+			}
+			for (sl_uint32 i = 0; i < m_count; i++) {
+				entries[i] = m_entries[(m_first + i) & (m_capacity - 1)];
+			}
+			if (m_entries) {
+				delete[] m_entries;
+			}
+			m_entries = entries;
+			m_capacity = capacity;
+			m_first = 0;
+		}
+		m_first = (m_first - 1) & (m_capacity - 1);
+		HPackHeader& entry = m_entries[m_first];
+		entry.name = name;
+		entry.value = value;
+		m_count++;
+		m_size += size;
+	}
+
+	sl_int32 HPackDynamicTable::find(const String& name, const String& value, sl_bool& outFlagValueMatched) const
+	{
+		sl_int32 indexName = -1;
+		sl_size lenName = name.getLength();
+		sl_size lenValue = value.getLength();
+		for (sl_uint32 i = 0; i < m_count; i++) {
+			HPackHeader& entry = m_entries[(m_first + i) & (m_capacity - 1)];
+			if (entry.name.getLength() == lenName && Base::equalsMemory(entry.name.getData(), name.getData(), lenName)) {
+				if (entry.value.getLength() == lenValue && Base::equalsMemory(entry.value.getData(), value.getData(), lenValue)) {
+					outFlagValueMatched = sl_true;
+					return i;
+				}
+				if (indexName < 0) {
+					indexName = i;
+				}
+			}
+		}
+		outFlagValueMatched = sl_false;
+		return indexName;
+	}
+
+	void HPackDynamicTable::clear()
+	{
+		for (sl_uint32 i = 0; i < m_count; i++) {
+			HPackHeader& entry = m_entries[(m_first + i) & (m_capacity - 1)];
+			entry.name.setNull();
+			entry.value.setNull();
+		}
+		m_first = 0;
+		m_count = 0;
+		m_size = 0;
+	}
+
+	void HPackDynamicTable::_evict(sl_uint32 sizeLimit)
+	{
+		while (m_count > 0 && m_size > sizeLimit) {
+			HPackHeader& entry = m_entries[(m_first + m_count - 1) & (m_capacity - 1)];
+			m_size -= entry.getEntrySize();
+			entry.name.setNull();
+			entry.value.setNull();
+			m_count--;
+		}
+	}
+
+
+/***********************************************************************
+								HPack
+***********************************************************************/
+
+	static const char* _g_hpack_static_table[SLIB_HPACK_STATIC_TABLE_SIZE][2] = {
+		{":authority", ""},
+		{":method", "GET"},
+		{":method", "POST"},
+		{":path", "/"},
+		{":path", "/index.html"},
+		{":scheme", "http"},
+		{":scheme", "https"},
+		{":status", "200"},
+		{":status", "204"},
+		{":status", "206"},
+		{":status", "304"},
+		{":status", "400"},
+		{":status", "404"},
+		{":status", "500"},
+		{"accept-charset", ""},
+		{"accept-encoding", "gzip, deflate"},
+		{"accept-language", ""},
+		{"accept-ranges", ""},
+		{"accept", ""},
+		{"access-control-allow-origin", ""},
+		{"age", ""},
+		{"allow", ""},
+		{"authorization", ""},
+		{"cache-control", ""},
+		{"content-disposition", ""},
+		{"content-encoding", ""},
+		{"content-language", ""},
+		{"content-length", ""},
+		{"content-location", ""},
+		{"content-range", ""},
+		{"content-type", ""},
+		{"cookie", ""},
+		{"date", ""},
+		{"etag", ""},
+		{"expect", ""},
+		{"expires", ""},
+		{"from", ""},
+		{"host", ""},
+		{"if-match", ""},
+		{"if-modified-since", ""},
+		{"if-none-match", ""},
+		{"if-range", ""},
+		{"if-unmodified-since", ""},
+		{"last-modified", ""},
+		{"link", ""},
+		{"location", ""},
+		{"max-forwards", ""},
+		{"proxy-authenticate", ""},
+		{"proxy-authorization", ""},
+		{"range", ""},
+		{"referer", ""},
+		{"refresh", ""},
+		{"retry-after", ""},
+		{"server", ""},
+		{"set-cookie", ""},
+		{"strict-transport-security", ""},
+		{"transfer-encoding", ""},
+		{"user-agent", ""},
+		{"vary", ""},
+		{"via", ""},
+		{"www-authenticate", ""}
+	};
+
+	class _HPackStaticTable
+	{
+	public:
+		HPackHeader entries[SLIB_HPACK_STATIC_TABLE_SIZE];
+
+	public:
+		_HPackStaticTable()
+		{
+			for (sl_uint32 i = 0; i < SLIB_HPACK_STATIC_TABLE_SIZE; i++) {
+				entries[i].name = _g_hpack_static_table[i][0];
+				entries[i].value = _g_hpack_static_table[i][1];
+			}
+		}
+
+	};
+
+	SLIB_SAFE_STATIC_GETTER(_HPackStaticTable, _HPack_getStaticTable)
+
+	// codes of the octets, from RFC 7541 Appendix B
+	static const sl_uint32 _g_hpack_huffman_codes[256] = {
+		0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+		0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+		0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+		0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+		0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+		0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+		0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+		0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+		0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+		0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+		0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+		0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+		0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+		0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+		0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+		0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+		0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+		0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+		0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+		0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+		0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+		0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+		0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+		0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+		0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+		0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+		0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+		0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+		0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+		0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+		0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+		0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee
+	};
+
+	static const sl_uint8 _g_hpack_huffman_lengths[256] = {
+		13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+		28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+		6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+		5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+		13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+		15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+		6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+		20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+		24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+		22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+		21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+		26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+		19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+		20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+		26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26
+	};
+
+	// the code is canonical: number of the codes for each length (including EOS)
+	static const sl_uint16 _g_hpack_huffman_counts[31] = {
+		0, 0, 0, 0, 0, 10, 26, 32, 6, 0, 5, 3, 2, 6, 2, 3,
+		0, 0, 0, 3, 8, 13, 26, 29, 12, 4, 15, 19, 29, 0, 4
+	};
+
+	// symbols ordered by the code
+	static const sl_uint16 _g_hpack_huffman_symbols[257] = {
+		48, 49, 50, 97, 99, 101, 105, 111, 115, 116, 32, 37, 45, 46, 47, 51,
+		52, 53, 54, 55, 56, 57, 61, 65, 95, 98, 100, 102, 103, 104, 108, 109,
+		110, 112, 114, 117, 58, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76,
+		77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 89, 106, 107, 113, 118,
+		119, 120, 121, 122, 38, 42, 44, 59, 88, 90, 33, 34, 40, 41, 63, 39,
+		43, 124, 35, 62, 0, 36, 64, 91, 93, 126, 94, 125, 60, 96, 123, 92,
+		195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161, 167, 172, 176, 177,
+		179, 209, 216, 217, 227, 229, 230, 129, 132, 133, 134, 136, 146, 154, 156, 160,
+		163, 164, 169, 170, 173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232,
+		233, 1, 135, 137, 138, 139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157,
+		158, 165, 166, 168, 174, 175, 180, 182, 183, 188, 191, 197, 231, 239, 9, 142,
+		144, 145, 148, 159, 171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193,
+		200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211,
+		212, 214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254,
+		2, 3, 4, 5, 6, 7, 8, 11, 12, 14, 15, 16, 17, 18, 19, 20,
+		21, 23, 24, 25, 26, 27, 28, 29, 30, 31, 127, 220, 249, 10, 13, 22,
+		256
+	};
+
+	const HPackHeader* HPack::getStaticEntry(sl_uint32 index)
+	{
+		if (index == 0 || index > SLIB_HPACK_STATIC_TABLE_SIZE) {
+			return sl_null;
+		}
+		_HPackStaticTable* table = _HPack_getStaticTable();
+		if (!table) {
+			return sl_null;
+		}
+		return table->entries + (index - 1);
+	}
+
+	sl_uint32 HPack::findStaticEntry(const String& name, const String& value, sl_bool& outFlagValueMatched)
+	{
+		outFlagValueMatched = sl_false;
+		_HPackStaticTable* table = _HPack_getStaticTable();
+		if (!table) {
+			return 0;
+		}
+		sl_size lenName = name.getLength();
+		sl_size lenValue = value.getLength();
+		sl_uint32 indexName = 0;
+		for (sl_uint32 i = 0; i < SLIB_HPACK_STATIC_TABLE_SIZE; i++) {
+			HPackHeader& entry = table->entries[i];
+			if (entry.name.getLength() == lenName && Base::equalsMemory(entry.name.getData(), name.getData(), lenName)) {
+				if (entry.value.getLength() == lenValue && Base::equalsMemory(entry.value.getData(), value.getData(), lenValue)) {
+					outFlagValueMatched = sl_true;
+					return i + 1;
+				}
+				if (!indexName) {
+					indexName = i + 1;
+				}
+			} else if (indexName) {
+				// the entries having same name are adjacent
+				break;
+			}
+		}
+		return indexName;
+	}
+
+	sl_size HPack::getHuffmanEncodedLength(const void* _data, sl_size size)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		sl_size nBits = 0;
+		for (sl_size i = 0; i < size; i++) {
+			nBits += _g_hpack_huffman_lengths[data[i]];
+		}
+		return (nBits + 7) >> 3;
+	}
+
+	void HPack::encodeHuffman(const void* _data, sl_size size, sl_uint8* output)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		sl_uint64 bits = 0;
+		sl_uint32 nBits = 0;
+		for (sl_size i = 0; i < size; i++) {
+			sl_uint8 ch = data[i];
+			sl_uint32 len = _g_hpack_huffman_lengths[ch];
+			bits = (bits << len) | _g_hpack_huffman_codes[ch];
+			nBits += len;
+			while (nBits >= 8) {
+				nBits -= 8;
+				*(output++) = (sl_uint8)(bits >> nBits);
+			}
+		}
+		if (nBits) {
+			// padded with the most significant bits of EOS
+			*output = (sl_uint8)((bits << (8 - nBits)) | (0xff >> nBits));
+		}
+	}
+
+	sl_bool HPack::decodeHuffman(const void* _data, sl_size size, String& output)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		// the shortest code has 5 bits
+		sl_size sizeMax = (size << 3) / 5;
+		String ret = String::allocate(sizeMax);
+		if (sizeMax && ret.isNull()) {
+			return sl_false;
+		}
+		sl_char8* out = ret.getData();
+		sl_size lenOutput = 0;
+		// decoding the canonical code, starting at the first code of each length
+		sl_uint32 code = 0;
+		sl_uint32 first = 0;
+		sl_uint32 index = 0;
+		sl_uint32 len = 0;
+		// bits of the incomplete code, to validate the padding
+		sl_uint32 bitsPending = 0;
+		for (sl_size i = 0; i < size; i++) {
+			sl_uint32 byte = data[i];
+			for (sl_uint32 k = 0; k < 8; k++) {
+				sl_uint32 bit = (byte >> (7 - k)) & 1;
+				code |= bit;
+				bitsPending = (bitsPending << 1) | bit;
+				len++;
+				sl_uint32 count = _g_hpack_huffman_counts[len];
+				if (code < first + count) {
+					sl_uint32 symbol = _g_hpack_huffman_symbols[index + code - first];
+					if (symbol == 256) {
+						// EOS in the string is an error
+						return sl_false;
+					}
+					out[lenOutput++] = (sl_char8)symbol;
+					code = 0;
+					first = 0;
+					index = 0;
+					len = 0;
+					bitsPending = 0;
+				} else {
+					if (len >= 30) {
+						return sl_false;
+					}
+					index += count;
+					first = (first + count) << 1;
+					code <<= 1;
+				}
+			}
+		}
+		// the padding must be shorter than 8 bits, and consists of the most significant bits of EOS (all ones)
+		if (len > 7 || bitsPending != ((1u << len) - 1)) {
+			return sl_false;
+		}
+		if (lenOutput < sizeMax) {
+			output = ret.substring(0, lenOutput);
+		} else {
+			output = ret;
+		}
+		return sl_true;
+	}
+
+
+/***********************************************************************
+							HPackDecoder
+***********************************************************************/
+
+	static sl_bool _HPack_decodeInteger(const sl_uint8* data, sl_size size, sl_size& pos, sl_uint32 nPrefixBits, sl_uint32& value)
+	{
+		if (pos >= size) {
+			return sl_false;
+		}
+		sl_uint32 max = (1 << nPrefixBits) - 1;
+		sl_uint32 v = data[pos++] & max;
+		if (v < max) {
+			value = v;
+			return sl_true;
+		}
+		sl_uint64 n = v;
+		sl_uint32 shift = 0;
+		for (;;) {
+			if (pos >= size || shift > 28) {
+				return sl_false;
+			}
+			sl_uint8 b = data[pos++];
+			n += (sl_uint64)(b & 0x7f) << shift;
+			if (n > 0xffffffff) {
+				return sl_false;
+			}
+			if (!(b & 0x80)) {
+				break;
+			}
+			shift += 7;
+		}
+		value = (sl_uint32)n;
+		return sl_true;
+	}
+
+	static sl_bool _HPack_decodeString(const sl_uint8* data, sl_size size, sl_size& pos, String& value)
+	{
+		if (pos >= size) {
+			return sl_false;
+		}
+		sl_bool flagHuffman = (data[pos] & 0x80) != 0;
+		sl_uint32 len;
+		if (!(_HPack_decodeInteger(data, size, pos, 7, len))) {
+			return sl_false;
+		}
+		if (len > size - pos) {
+			return sl_false;
+		}
+		if (flagHuffman) {
+			if (!(HPack::decodeHuffman(data + pos, len, value))) {
+				return sl_false;
+			}
+		} else {
+			value = String((const sl_char8*)(data + pos), len);
+		}
+		pos += len;
+		return sl_true;
+	}
+
+	HPackDecoder::HPackDecoder()
+	{
+		m_maxTableSize = SLIB_HPACK_DEFAULT_TABLE_SIZE;
+		m_maxHeaderListSize = 0;
+	}
+
+	HPackDecoder::~HPackDecoder()
+	{
+	}
+
+	void HPackDecoder::setMaxTableSize(sl_uint32 size)
+	{
+		m_maxTableSize = size;
+		if (m_table.getMaxSize() > size) {
+			m_table.setMaxSize(size);
+		}
+	}
+
+	void HPackDecoder::setMaxHeaderListSize(sl_size size)
+	{
+		m_maxHeaderListSize = size;
+	}
+
+	sl_bool HPackDecoder::decode(const void* _data, sl_size size, List<HPackHeader>& outHeaders)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		sl_size pos = 0;
+		sl_size sizeList = 0;
+		while (pos < size) {
+			sl_uint8 b = data[pos];
+			HPackHeader header;
+			if (b & 0x80) {
+				// indexed header field
+				sl_uint32 index;
+				if (!(_HPack_decodeInteger(data, size, pos, 7, index))) {
+					return sl_false;
+				}
+				const HPackHeader* entry;
+				if (index <= SLIB_HPACK_STATIC_TABLE_SIZE) {
+					entry = HPack::getStaticEntry(index);
+				} else {
+					entry = m_table.getEntry(index - SLIB_HPACK_STATIC_TABLE_SIZE - 1);
+				}
+				if (!entry) {
+					return sl_false;
+				}
+				header = *entry;
+			} else if ((b & 0xe0) == 0x20) {
+				// dynamic table size update
+				sl_uint32 sizeTable;
+				if (!(_HPack_decodeInteger(data, size, pos, 5, sizeTable))) {
+					return sl_false;
+				}
+				if (sizeTable > m_maxTableSize) {
+					return sl_false;
+				}
+				m_table.setMaxSize(sizeTable);
+				continue;
+			} else {
+				// literal header field, with incremental indexing (6-bit prefix) or without indexing (4-bit prefix)
+				sl_bool flagIndexing = (b & 0x40) != 0;
+				sl_uint32 indexName;
+				if (!(_HPack_decodeInteger(data, size, pos, flagIndexing ? 6 : 4, indexName))) {
+					return sl_false;
+				}
+				if (indexName) {
+					const HPackHeader* entry;
+					if (indexName <= SLIB_HPACK_STATIC_TABLE_SIZE) {
+						entry = HPack::getStaticEntry(indexName);
+					} else {
+						entry = m_table.getEntry(indexName - SLIB_HPACK_STATIC_TABLE_SIZE - 1);
+					}
+					if (!entry) {
+						return sl_false;
+					}
+					header.name = entry->name;
+				} else {
+					if (!(_HPack_decodeString(data, size, pos, header.name))) {
+						return sl_false;
+					}
+				}
+				if (!(_HPack_decodeString(data, size, pos, header.value))) {
+					return sl_false;
+				}
+				if (flagIndexing) {
+					m_table.add(header.name, header.value);
+				}
+			}
+			sizeList += header.getEntrySize();
+			if (m_maxHeaderListSize && sizeList > m_maxHeaderListSize) {
+				return sl_false;
+			}
+			if (!(outHeaders.add_NoLock(header))) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+
+/***********************************************************************
+							HPackEncoder
+***********************************************************************/
+
+	static void _HPack_encodeInteger(CList<sl_uint8>& output, sl_uint8 prefix, sl_uint32 nPrefixBits, sl_uint32 value)
+	{
+		sl_uint32 max = (1 << nPrefixBits) - 1;
+		if (value < max) {
+			output.add_NoLock((sl_uint8)(prefix | value));
+			return;
+		}
+		output.add_NoLock((sl_uint8)(prefix | max));
+		value -= max;
+		while (value >= 0x80) {
+			output.add_NoLock((sl_uint8)((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		output.add_NoLock((sl_uint8)value);
+	}
+
+	static void _HPack_encodeString(CList<sl_uint8>& output, const String& str)
+	{
+		const sl_char8* data = str.getData();
+		sl_size len = str.getLength();
+		sl_size lenHuffman = HPack::getHuffmanEncodedLength(data, len);
+		if (lenHuffman < len) {
+			_HPack_encodeInteger(output, 0x80, 7, (sl_uint32)lenHuffman);
+			sl_size n = output.getCount();
+			if (output.setCount_NoLock(n + lenHuffman)) {
+				HPack::encodeHuffman(data, len, output.getData() + n);
+			}
+		} else {
+			_HPack_encodeInteger(output, 0, 7, (sl_uint32)len);
+			output.addElements_NoLock((const sl_uint8*)data, len);
+		}
+	}
+
+	HPackEncoder::HPackEncoder()
+	{
+		m_maxTableSizeAllowed = SLIB_HPACK_DEFAULT_TABLE_SIZE;
+		m_flagTableSizeUpdate = sl_false;
+	}
+
+	HPackEncoder::~HPackEncoder()
+	{
+	}
+
+	void HPackEncoder::setMaxTableSize(sl_uint32 size)
+	{
+		if (size > SLIB_HPACK_DEFAULT_TABLE_SIZE) {
+			size = SLIB_HPACK_DEFAULT_TABLE_SIZE;
+		}
+		if (size != m_table.getMaxSize()) {
+			m_maxTableSizeAllowed = size;
+			m_flagTableSizeUpdate = sl_true;
+		}
+	}
+
+	void HPackEncoder::begin(CList<sl_uint8>& output)
+	{
+		if (m_flagTableSizeUpdate) {
+			m_flagTableSizeUpdate = sl_false;
+			m_table.setMaxSize(m_maxTableSizeAllowed);
+			_HPack_encodeInteger(output, 0x20, 5, m_maxTableSizeAllowed);
+		}
+	}
+
+	void HPackEncoder::encode(CList<sl_uint8>& output, const String& name, const String& value, sl_bool flagIndexing)
+	{
+		sl_bool flagValueMatched;
+		sl_uint32 indexName = HPack::findStaticEntry(name, value, flagValueMatched);
+		if (flagValueMatched) {
+			_HPack_encodeInteger(output, 0x80, 7, indexName);
+			return;
+		}
+		sl_bool flagDynamicValueMatched;
+		sl_int32 indexDynamic = m_table.find(name, value, flagDynamicValueMatched);
+		if (indexDynamic >= 0) {
+			if (flagDynamicValueMatched) {
+				_HPack_encodeInteger(output, 0x80, 7, SLIB_HPACK_STATIC_TABLE_SIZE + 1 + indexDynamic);
+				return;
+			}
+			if (!indexName) {
+				indexName = SLIB_HPACK_STATIC_TABLE_SIZE + 1 + indexDynamic;
+			}
+		}
+		if (flagIndexing && (sl_uint32)(name.getLength() + value.getLength()) + SLIB_HPACK_ENTRY_OVERHEAD <= m_table.getMaxSize()) {
+			_HPack_encodeInteger(output, 0x40, 6, indexName);
+			if (!indexName) {
+				_HPack_encodeString(output, name);
+			}
+			_HPack_encodeString(output, value);
+			m_table.add(name, value);
+		} else {
+			_HPack_encodeInteger(output, 0, 4, indexName);
+			if (!indexName) {
+				_HPack_encodeString(output, name);
+			}
+			_HPack_encodeString(output, value);
+		}
+	}
+
+}
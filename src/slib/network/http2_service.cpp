@@ -0,0 +1,1245 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "http2_service.h"
+
+#include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/content_type.h"
+
+// receive windows announced to the client
+#define HTTP2_STREAM_WINDOW_SIZE 0x100000
+#define HTTP2_CONNECTION_WINDOW_SIZE 0x400000
+// chunk size reading the response bodies
+#define HTTP2_SIZE_READ_BODY 0x10000
+// response bytes prepared in each stream before they are framed
+#define HTTP2_SIZE_STREAM_BUFFER 0x10000
+// bytes written to the output before waiting it to be drained, so that the streams are scheduled by their priorities
+#define HTTP2_SIZE_OUTPUT_BUDGET 0x40000
+
+namespace slib
+{
+
+/**********************************************
+			_Http2ServiceStream
+**********************************************/
+
+	_Http2ServiceStream::_Http2ServiceStream()
+	{
+		id = 0;
+
+		flagHeadersReceived = sl_false;
+		flagRemoteClosed = sl_false;
+		windowReceive = HTTP2_STREAM_WINDOW_SIZE;
+		sizeReceivedUnacked = 0;
+
+		flagResponding = sl_false;
+		flagLocalClosed = sl_false;
+		windowSend = SLIB_HTTP2_DEFAULT_WINDOW_SIZE;
+		sizeBodyRemaining = 0;
+		flagReadingBody = sl_false;
+		flagOutputEnded = sl_false;
+
+		dependency = 0;
+		weight = SLIB_HTTP2_DEFAULT_WEIGHT;
+		virtualTime = 0;
+	}
+
+	_Http2ServiceStream::~_Http2ServiceStream()
+	{
+	}
+
+	sl_bool _Http2ServiceStream::isSendable(sl_int64 windowConnection)
+	{
+		if (!flagResponding || flagLocalClosed) {
+			return sl_false;
+		}
+		if (dataResponse.getSize() > 0) {
+			return windowSend > 0 && windowConnection > 0;
+		}
+		// empty DATA frame carrying END_STREAM
+		return flagOutputEnded;
+	}
+
+
+/**********************************************
+			_Http2ServiceSession
+**********************************************/
+
+	_Http2ServiceSession::_Http2ServiceSession()
+	{
+		m_maxRequestHeadersSize = 0;
+		m_maxRequestBodySize = 0;
+		m_maxConcurrentStreams = 0;
+		m_flagProcessByThreads = sl_true;
+
+		m_sizePrefaceReceived = 0;
+		m_flagSettingsReceived = sl_false;
+		m_flagClosing = sl_false;
+
+		m_sizeFrameHeader = 0;
+		m_sizeFramePayload = 0;
+
+		m_streamHeaderBlock = 0;
+		m_flagHeaderBlockEndStream = sl_false;
+
+		m_lastStreamId = 0;
+
+		m_maxFrameSizeSend = SLIB_HTTP2_DEFAULT_MAX_FRAME_SIZE;
+		m_initialWindowSend = SLIB_HTTP2_DEFAULT_WINDOW_SIZE;
+
+		m_windowSend = SLIB_HTTP2_DEFAULT_WINDOW_SIZE;
+		m_windowReceive = SLIB_HTTP2_DEFAULT_WINDOW_SIZE;
+		m_sizeReceivedUnacked = 0;
+
+		m_virtualTime = 0;
+		m_sizeOutputPending = 0;
+		m_flagOutputWritten = sl_false;
+	}
+
+	_Http2ServiceSession::~_Http2ServiceSession()
+	{
+	}
+
+	Ref<_Http2ServiceSession> _Http2ServiceSession::create(HttpServiceConnection* connection, sl_uint32 sizePrefaceReceived)
+	{
+		Ref<HttpService> service = connection->getService();
+		if (service.isNull()) {
+			return sl_null;
+		}
+		Memory bufFramePayload = Memory::create(SLIB_HTTP2_DEFAULT_MAX_FRAME_SIZE);
+		if (bufFramePayload.isNull()) {
+			return sl_null;
+		}
+		Ref<_Http2ServiceSession> ret = new _Http2ServiceSession;
+		if (ret.isNotNull()) {
+			const HttpServiceParam& param = service->getParam();
+			ret->m_connection = connection;
+			ret->m_output = connection->m_output;
+			ret->m_ioLoop = connection->m_io->getIoLoop();
+			ret->m_maxRequestHeadersSize = (sl_uint32)(param.maxRequestHeadersSize);
+			ret->m_maxRequestBodySize = param.maxRequestBodySize;
+			ret->m_maxConcurrentStreams = param.http2MaxConcurrentStreams;
+			ret->m_flagProcessByThreads = param.flagProcessByThreads;
+			ret->m_sizePrefaceReceived = sizePrefaceReceived;
+			ret->m_bufFramePayload = bufFramePayload;
+			// a header block exceeding the limit fails the connection, because HPACK can't skip it
+			ret->m_decoder.setMaxHeaderListSize(ret->m_maxRequestHeadersSize);
+		}
+		return ret;
+	}
+
+	void _Http2ServiceSession::start()
+	{
+		ObjectLocker lock(this);
+		sl_uint8 settings[18];
+		MIO::writeUint16BE(settings, (sl_uint16)(Http2SettingId::MaxConcurrentStreams));
+		MIO::writeUint32BE(settings + 2, m_maxConcurrentStreams);
+		MIO::writeUint16BE(settings + 6, (sl_uint16)(Http2SettingId::InitialWindowSize));
+		MIO::writeUint32BE(settings + 8, HTTP2_STREAM_WINDOW_SIZE);
+		MIO::writeUint16BE(settings + 12, (sl_uint16)(Http2SettingId::MaxHeaderListSize));
+		MIO::writeUint32BE(settings + 14, m_maxRequestHeadersSize);
+		_writeFrame(Http2FrameType::Settings, 0, 0, settings, 18);
+		_writeWindowUpdate(0, HTTP2_CONNECTION_WINDOW_SIZE - SLIB_HTTP2_DEFAULT_WINDOW_SIZE);
+		m_windowReceive = HTTP2_CONNECTION_WINDOW_SIZE;
+		_flush();
+	}
+
+	void _Http2ServiceSession::startUpgrade(const Ref<HttpServiceContext>& context, const Memory& settings)
+	{
+		{
+			ObjectLocker lock(this);
+			start();
+			sl_uint32 sizeSettings = (sl_uint32)(settings.getSize());
+			if (sizeSettings % 6) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return;
+			}
+			if (!(_processSettings((sl_uint8*)(settings.getData()), sizeSettings))) {
+				return;
+			}
+			// the request of the upgrade is processed as the half-closed stream 1
+			Ref<_Http2ServiceStream> stream = new _Http2ServiceStream;
+			if (stream.isNull()) {
+				_goAway(Http2ErrorCode::InternalError);
+				return;
+			}
+			stream->id = 1;
+			stream->context = context;
+			stream->flagHeadersReceived = sl_true;
+			stream->flagRemoteClosed = sl_true;
+			stream->windowSend = m_initialWindowSend;
+			context->m_streamId = 1;
+			m_streams.add_NoLock(stream);
+			m_lastStreamId = 1;
+			m_contextsReady.add_NoLock(context);
+		}
+		_dispatch();
+	}
+
+	void _Http2ServiceSession::processInput(const void* data, sl_uint32 size)
+	{
+		{
+			ObjectLocker lock(this);
+			_processFrames((const sl_uint8*)data, size);
+			_send();
+			_flush();
+		}
+		_dispatch();
+	}
+
+	void _Http2ServiceSession::completeResponse(HttpServiceContext* context)
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosing) {
+			return;
+		}
+		Ref<_Http2ServiceStream> stream = _getStream(context->m_streamId);
+		if (stream.isNull() || stream->context.get() != context || stream->flagResponding) {
+			return;
+		}
+
+		sl_uint64 sizeBody = context->getResponseContentLength();
+		context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(sizeBody));
+		String oldResponseContentType = context->getResponseContentType();
+		if (oldResponseContentType.isEmpty()) {
+			context->setResponseContentType(ContentTypes::TextHtml_Utf8);
+		}
+
+		SLIB_STATIC_STRING(s_status, ":status")
+		SLIB_STATIC_STRING(s_connection, "connection")
+		SLIB_STATIC_STRING(s_keepAlive, "keep-alive")
+		SLIB_STATIC_STRING(s_proxyConnection, "proxy-connection")
+		SLIB_STATIC_STRING(s_transferEncoding, "transfer-encoding")
+		SLIB_STATIC_STRING(s_upgrade, "upgrade")
+		// the values changing for each response are not worth to be indexed
+		SLIB_STATIC_STRING(s_contentLength, "content-length")
+		SLIB_STATIC_STRING(s_contentRange, "content-range")
+		SLIB_STATIC_STRING(s_date, "date")
+		SLIB_STATIC_STRING(s_etag, "etag")
+		SLIB_STATIC_STRING(s_lastModified, "last-modified")
+		SLIB_STATIC_STRING(s_setCookie, "set-cookie")
+
+		CList<sl_uint8> block;
+		m_encoder.begin(block);
+		m_encoder.encode(block, s_status, String::fromUint32((sl_uint32)(context->getResponseCode())));
+		Iterator< Pair<String, String> > iterator = context->getResponseHeaders().toIterator();
+		Pair<String, String> pair;
+		while (iterator.next(&pair)) {
+			String name = pair.key.toLower();
+			if (name == s_connection || name == s_keepAlive || name == s_proxyConnection || name == s_transferEncoding || name == s_upgrade) {
+				continue;
+			}
+			sl_bool flagIndexing = !(name == s_contentLength || name == s_contentRange || name == s_date || name == s_etag || name == s_lastModified || name == s_setCookie);
+			m_encoder.encode(block, name, pair.value, flagIndexing);
+		}
+
+		stream->flagResponding = sl_true;
+		if (sizeBody == 0 || context->getMethod() == HttpMethod::HEAD) {
+			_sendHeaders(stream->id, block, sl_true);
+			context->clearOutput();
+			stream->flagLocalClosed = sl_true;
+			if (stream->flagRemoteClosed) {
+				_removeStream(stream.get());
+			} else {
+				_resetStream(stream->id, Http2ErrorCode::NoError);
+			}
+		} else {
+			_sendHeaders(stream->id, block, sl_false);
+			_fillStream(stream.get());
+			_send();
+		}
+		_flush();
+	}
+
+	void _Http2ServiceSession::onOutputComplete()
+	{
+		Ref<AsyncIoLoop> ioLoop = m_ioLoop;
+		if (ioLoop.isNotNull()) {
+			// the output is locked in this call
+			ioLoop->addTask(SLIB_FUNCTION_WEAKREF(_Http2ServiceSession, _onOutputDrained, this));
+		}
+	}
+
+	void _Http2ServiceSession::_processFrames(const sl_uint8* data, sl_uint32 size)
+	{
+		if (m_flagClosing) {
+			return;
+		}
+		if (m_sizePrefaceReceived < SLIB_HTTP2_CONNECTION_PREFACE_SIZE) {
+			sl_uint32 n = SLIB_HTTP2_CONNECTION_PREFACE_SIZE - m_sizePrefaceReceived;
+			if (n > size) {
+				n = size;
+			}
+			if (!(Base::equalsMemory(data, SLIB_HTTP2_CONNECTION_PREFACE + m_sizePrefaceReceived, n))) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return;
+			}
+			m_sizePrefaceReceived += n;
+			data += n;
+			size -= n;
+		}
+		sl_uint8* bufPayload = (sl_uint8*)(m_bufFramePayload.getData());
+		for (;;) {
+			if (m_sizeFrameHeader < SLIB_HTTP2_FRAME_HEADER_SIZE) {
+				if (!size) {
+					return;
+				}
+				if (!m_sizeFrameHeader && size >= SLIB_HTTP2_FRAME_HEADER_SIZE) {
+					// the whole frame is processed in the input without copying
+					const Http2FrameHeader* header = (const Http2FrameHeader*)data;
+					sl_uint32 len = header->getLength();
+					if (len > SLIB_HTTP2_DEFAULT_MAX_FRAME_SIZE) {
+						_goAway(Http2ErrorCode::FrameSizeError);
+						return;
+					}
+					if (size >= SLIB_HTTP2_FRAME_HEADER_SIZE + len) {
+						if (!(_processFrame(*header, data + SLIB_HTTP2_FRAME_HEADER_SIZE))) {
+							return;
+						}
+						data += SLIB_HTTP2_FRAME_HEADER_SIZE + len;
+						size -= SLIB_HTTP2_FRAME_HEADER_SIZE + len;
+						continue;
+					}
+				}
+				sl_uint32 n = SLIB_HTTP2_FRAME_HEADER_SIZE - m_sizeFrameHeader;
+				if (n > size) {
+					n = size;
+				}
+				Base::copyMemory(m_bufFrameHeader + m_sizeFrameHeader, data, n);
+				m_sizeFrameHeader += n;
+				data += n;
+				size -= n;
+				if (m_sizeFrameHeader < SLIB_HTTP2_FRAME_HEADER_SIZE) {
+					return;
+				}
+				if (((Http2FrameHeader*)m_bufFrameHeader)->getLength() > SLIB_HTTP2_DEFAULT_MAX_FRAME_SIZE) {
+					_goAway(Http2ErrorCode::FrameSizeError);
+					return;
+				}
+				m_sizeFramePayload = 0;
+			}
+			Http2FrameHeader header;
+			Base::copyMemory(&header, m_bufFrameHeader, SLIB_HTTP2_FRAME_HEADER_SIZE);
+			sl_uint32 len = header.getLength();
+			if (m_sizeFramePayload < len) {
+				if (!size) {
+					return;
+				}
+				sl_uint32 n = len - m_sizeFramePayload;
+				if (n > size) {
+					n = size;
+				}
+				Base::copyMemory(bufPayload + m_sizeFramePayload, data, n);
+				m_sizeFramePayload += n;
+				data += n;
+				size -= n;
+				if (m_sizeFramePayload < len) {
+					return;
+				}
+			}
+			m_sizeFrameHeader = 0;
+			if (!(_processFrame(header, bufPayload))) {
+				return;
+			}
+		}
+	}
+
+	sl_bool _Http2ServiceSession::_processFrame(const Http2FrameHeader& header, const sl_uint8* payload)
+	{
+		Http2FrameType type = header.getType();
+		sl_uint32 len = header.getLength();
+		sl_uint32 streamId = header.getStreamId();
+		if (!m_flagSettingsReceived) {
+			// the client preface ends with a SETTINGS frame
+			if (type != Http2FrameType::Settings || header.isFlag(SLIB_HTTP2_FLAG_ACK)) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			}
+		}
+		if (m_streamHeaderBlock) {
+			if (type != Http2FrameType::Continuation || streamId != m_streamHeaderBlock) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			}
+		}
+		switch (type) {
+			case Http2FrameType::Data:
+				return _processData(header, payload);
+			case Http2FrameType::Headers:
+				return _processHeaders(header, payload);
+			case Http2FrameType::Priority:
+				{
+					if (!streamId) {
+						_goAway(Http2ErrorCode::ProtocolError);
+						return sl_false;
+					}
+					if (len != 5) {
+						_resetStream(streamId, Http2ErrorCode::FrameSizeError);
+						return sl_true;
+					}
+					Ref<_Http2ServiceStream> stream = _getStream(streamId);
+					if (stream.isNotNull()) {
+						_setPriority(stream.get(), payload);
+					}
+					return sl_true;
+				}
+			case Http2FrameType::ResetStream:
+				{
+					if (!streamId || streamId > m_lastStreamId) {
+						_goAway(Http2ErrorCode::ProtocolError);
+						return sl_false;
+					}
+					if (len != 4) {
+						_goAway(Http2ErrorCode::FrameSizeError);
+						return sl_false;
+					}
+					Ref<_Http2ServiceStream> stream = _getStream(streamId);
+					if (stream.isNotNull()) {
+						_removeStream(stream.get());
+					}
+					return sl_true;
+				}
+			case Http2FrameType::Settings:
+				if (streamId) {
+					_goAway(Http2ErrorCode::ProtocolError);
+					return sl_false;
+				}
+				if (header.isFlag(SLIB_HTTP2_FLAG_ACK)) {
+					if (len) {
+						_goAway(Http2ErrorCode::FrameSizeError);
+						return sl_false;
+					}
+					return sl_true;
+				}
+				if (len % 6) {
+					_goAway(Http2ErrorCode::FrameSizeError);
+					return sl_false;
+				}
+				if (!(_processSettings(payload, len))) {
+					return sl_false;
+				}
+				m_flagSettingsReceived = sl_true;
+				_writeFrame(Http2FrameType::Settings, SLIB_HTTP2_FLAG_ACK, 0, sl_null, 0);
+				return sl_true;
+			case Http2FrameType::PushPromise:
+				// clients can't push
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			case Http2FrameType::Ping:
+				if (streamId) {
+					_goAway(Http2ErrorCode::ProtocolError);
+					return sl_false;
+				}
+				if (len != 8) {
+					_goAway(Http2ErrorCode::FrameSizeError);
+					return sl_false;
+				}
+				if (!(header.isFlag(SLIB_HTTP2_FLAG_ACK))) {
+					_writeFrame(Http2FrameType::Ping, SLIB_HTTP2_FLAG_ACK, 0, payload, 8);
+				}
+				return sl_true;
+			case Http2FrameType::GoAway:
+				if (streamId) {
+					_goAway(Http2ErrorCode::ProtocolError);
+					return sl_false;
+				}
+				// the client doesn't open new streams, and the connection is closed by the client after the responses
+				return sl_true;
+			case Http2FrameType::WindowUpdate:
+				if (len != 4) {
+					_goAway(Http2ErrorCode::FrameSizeError);
+					return sl_false;
+				}
+				return _processWindowUpdate(streamId, payload);
+			case Http2FrameType::Continuation:
+				if (!m_streamHeaderBlock) {
+					_goAway(Http2ErrorCode::ProtocolError);
+					return sl_false;
+				}
+				if (m_headerBlock.getCount() + len > m_maxRequestHeadersSize) {
+					_goAway(Http2ErrorCode::EnhanceYourCalm);
+					return sl_false;
+				}
+				m_headerBlock.addElements_NoLock(payload, len);
+				if (header.isFlag(SLIB_HTTP2_FLAG_END_HEADERS)) {
+					m_streamHeaderBlock = 0;
+					return _processHeaderBlock(streamId);
+				}
+				return sl_true;
+			default:
+				// unknown frames are ignored
+				return sl_true;
+		}
+	}
+
+	sl_bool _Http2ServiceSession::_processHeaders(const Http2FrameHeader& header, const sl_uint8* payload)
+	{
+		sl_uint32 streamId = header.getStreamId();
+		if (!streamId) {
+			_goAway(Http2ErrorCode::ProtocolError);
+			return sl_false;
+		}
+		sl_uint32 size = header.getLength();
+		if (header.isFlag(SLIB_HTTP2_FLAG_PADDED)) {
+			if (!size || payload[0] >= size) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			}
+			size -= 1 + payload[0];
+			payload++;
+		}
+		const sl_uint8* priority = sl_null;
+		if (header.isFlag(SLIB_HTTP2_FLAG_PRIORITY)) {
+			if (size < 5) {
+				_goAway(Http2ErrorCode::FrameSizeError);
+				return sl_false;
+			}
+			priority = payload;
+			payload += 5;
+			size -= 5;
+		}
+		Ref<_Http2ServiceStream> stream = _getStream(streamId);
+		if (stream.isNotNull()) {
+			// trailers
+			if (stream->flagRemoteClosed) {
+				_goAway(Http2ErrorCode::StreamClosed);
+				return sl_false;
+			}
+		} else {
+			if (!(streamId & 1)) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			}
+			if (streamId <= m_lastStreamId) {
+				_goAway(Http2ErrorCode::StreamClosed);
+				return sl_false;
+			}
+			stream = new _Http2ServiceStream;
+			if (stream.isNull()) {
+				_goAway(Http2ErrorCode::InternalError);
+				return sl_false;
+			}
+			stream->id = streamId;
+			stream->windowSend = m_initialWindowSend;
+			stream->virtualTime = m_virtualTime;
+			m_streams.add_NoLock(stream);
+			m_lastStreamId = streamId;
+		}
+		if (priority) {
+			_setPriority(stream.get(), priority);
+		}
+		if (size > m_maxRequestHeadersSize) {
+			_goAway(Http2ErrorCode::EnhanceYourCalm);
+			return sl_false;
+		}
+		m_flagHeaderBlockEndStream = header.isFlag(SLIB_HTTP2_FLAG_END_STREAM);
+		m_headerBlock.setCount_NoLock(0);
+		m_headerBlock.addElements_NoLock(payload, size);
+		if (header.isFlag(SLIB_HTTP2_FLAG_END_HEADERS)) {
+			return _processHeaderBlock(streamId);
+		}
+		m_streamHeaderBlock = streamId;
+		return sl_true;
+	}
+
+	sl_bool _Http2ServiceSession::_processHeaderBlock(sl_uint32 streamId)
+	{
+		// the block is always decoded to keep the dynamic table synchronized
+		List<HPackHeader> headers;
+		sl_bool flagDecoded = m_decoder.decode(m_headerBlock.getData(), m_headerBlock.getCount(), headers);
+		m_headerBlock.setCount_NoLock(0);
+		if (!flagDecoded) {
+			_goAway(Http2ErrorCode::CompressionError);
+			return sl_false;
+		}
+		Ref<_Http2ServiceStream> stream = _getStream(streamId);
+		if (stream.isNull()) {
+			return sl_true;
+		}
+		if (stream->flagHeadersReceived) {
+			// trailers are ignored, and they end the stream
+			if (!m_flagHeaderBlockEndStream) {
+				_resetStream(streamId, Http2ErrorCode::ProtocolError);
+				return sl_true;
+			}
+			_completeRequest(stream.get());
+			return sl_true;
+		}
+		stream->flagHeadersReceived = sl_true;
+		if (m_streams.getCount() > m_maxConcurrentStreams) {
+			_resetStream(streamId, Http2ErrorCode::RefusedStream);
+			return sl_true;
+		}
+		if (!(_buildRequest(stream.get(), headers))) {
+			_resetStream(streamId, Http2ErrorCode::ProtocolError);
+			return sl_true;
+		}
+		if (m_flagHeaderBlockEndStream) {
+			_completeRequest(stream.get());
+		}
+		return sl_true;
+	}
+
+	sl_bool _Http2ServiceSession::_processData(const Http2FrameHeader& header, const sl_uint8* payload)
+	{
+		sl_uint32 streamId = header.getStreamId();
+		if (!streamId) {
+			_goAway(Http2ErrorCode::ProtocolError);
+			return sl_false;
+		}
+		sl_uint32 len = header.getLength();
+		sl_uint32 size = len;
+		if (header.isFlag(SLIB_HTTP2_FLAG_PADDED)) {
+			if (!size || payload[0] >= size) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			}
+			size -= 1 + payload[0];
+			payload++;
+		}
+		// the whole payload including the padding is flow-controlled
+		if (len > m_windowReceive) {
+			_goAway(Http2ErrorCode::FlowControlError);
+			return sl_false;
+		}
+		m_windowReceive -= len;
+		m_sizeReceivedUnacked += len;
+		if (m_sizeReceivedUnacked >= HTTP2_CONNECTION_WINDOW_SIZE / 2) {
+			_writeWindowUpdate(0, m_sizeReceivedUnacked);
+			m_windowReceive += m_sizeReceivedUnacked;
+			m_sizeReceivedUnacked = 0;
+		}
+		Ref<_Http2ServiceStream> stream = _getStream(streamId);
+		if (stream.isNull()) {
+			if (streamId > m_lastStreamId) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			}
+			_resetStream(streamId, Http2ErrorCode::StreamClosed);
+			return sl_true;
+		}
+		if (stream->flagRemoteClosed) {
+			_resetStream(streamId, Http2ErrorCode::StreamClosed);
+			return sl_true;
+		}
+		if (len > stream->windowReceive) {
+			_resetStream(streamId, Http2ErrorCode::FlowControlError);
+			return sl_true;
+		}
+		stream->windowReceive -= len;
+		stream->sizeReceivedUnacked += len;
+		HttpServiceContext* context = stream->context.get();
+		if (size) {
+			if (context->m_requestBodyBuffer.getSize() + size > m_maxRequestBodySize) {
+				_sendStatus(stream.get(), HttpStatus::BadRequest);
+				return sl_true;
+			}
+			if (!(context->m_requestBodyBuffer.add(Memory::create(payload, size)))) {
+				_resetStream(streamId, Http2ErrorCode::InternalError);
+				return sl_true;
+			}
+		}
+		if (header.isFlag(SLIB_HTTP2_FLAG_END_STREAM)) {
+			_completeRequest(stream.get());
+		} else if (stream->sizeReceivedUnacked >= HTTP2_STREAM_WINDOW_SIZE / 2) {
+			_writeWindowUpdate(streamId, stream->sizeReceivedUnacked);
+			stream->windowReceive += stream->sizeReceivedUnacked;
+			stream->sizeReceivedUnacked = 0;
+		}
+		return sl_true;
+	}
+
+	sl_bool _Http2ServiceSession::_processSettings(const sl_uint8* payload, sl_uint32 size)
+	{
+		for (sl_uint32 i = 0; i + 6 <= size; i += 6) {
+			sl_uint16 id = MIO::readUint16BE(payload + i);
+			sl_uint32 value = MIO::readUint32BE(payload + i + 2);
+			switch ((Http2SettingId)id) {
+				case Http2SettingId::HeaderTableSize:
+					m_encoder.setMaxTableSize(value);
+					break;
+				case Http2SettingId::EnablePush:
+					if (value > 1) {
+						_goAway(Http2ErrorCode::ProtocolError);
+						return sl_false;
+					}
+					break;
+				case Http2SettingId::InitialWindowSize:
+					{
+						if (value > SLIB_HTTP2_MAX_WINDOW_SIZE) {
+							_goAway(Http2ErrorCode::FlowControlError);
+							return sl_false;
+						}
+						// the change applies to the windows of all open streams
+						sl_int64 delta = (sl_int64)value - m_initialWindowSend;
+						ListElements< Ref<_Http2ServiceStream> > streams(m_streams);
+						for (sl_size k = 0; k < streams.count; k++) {
+							_Http2ServiceStream* stream = streams[k].get();
+							stream->windowSend += delta;
+							if (stream->windowSend > SLIB_HTTP2_MAX_WINDOW_SIZE) {
+								_goAway(Http2ErrorCode::FlowControlError);
+								return sl_false;
+							}
+						}
+						m_initialWindowSend = value;
+						break;
+					}
+				case Http2SettingId::MaxFrameSize:
+					if (value < SLIB_HTTP2_DEFAULT_MAX_FRAME_SIZE || value > SLIB_HTTP2_MAX_FRAME_SIZE) {
+						_goAway(Http2ErrorCode::ProtocolError);
+						return sl_false;
+					}
+					m_maxFrameSizeSend = value;
+					break;
+				default:
+					break;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool _Http2ServiceSession::_processWindowUpdate(sl_uint32 streamId, const sl_uint8* payload)
+	{
+		sl_uint32 increment = MIO::readUint32BE(payload) & 0x7fffffff;
+		if (!streamId) {
+			if (!increment) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			}
+			if (m_windowSend + increment > SLIB_HTTP2_MAX_WINDOW_SIZE) {
+				_goAway(Http2ErrorCode::FlowControlError);
+				return sl_false;
+			}
+			m_windowSend += increment;
+			return sl_true;
+		}
+		Ref<_Http2ServiceStream> stream = _getStream(streamId);
+		if (stream.isNull()) {
+			if (streamId > m_lastStreamId) {
+				_goAway(Http2ErrorCode::ProtocolError);
+				return sl_false;
+			}
+			return sl_true;
+		}
+		if (!increment) {
+			_resetStream(streamId, Http2ErrorCode::ProtocolError);
+			return sl_true;
+		}
+		if (stream->windowSend + increment > SLIB_HTTP2_MAX_WINDOW_SIZE) {
+			_resetStream(streamId, Http2ErrorCode::FlowControlError);
+			return sl_true;
+		}
+		stream->windowSend += increment;
+		return sl_true;
+	}
+
+	void _Http2ServiceSession::_setPriority(_Http2ServiceStream* stream, const sl_uint8* data)
+	{
+		// the exclusive flag is ignored, and the dependency on itself is treated as no dependency
+		sl_uint32 dependency = MIO::readUint32BE(data) & 0x7fffffff;
+		if (dependency == stream->id) {
+			dependency = 0;
+		}
+		stream->dependency = dependency;
+		stream->weight = (sl_uint32)(data[4]) + 1;
+	}
+
+	sl_bool _Http2ServiceSession::_buildRequest(_Http2ServiceStream* stream, List<HPackHeader>& headers)
+	{
+		Ref<HttpServiceConnection> connection = m_connection;
+		if (connection.isNull()) {
+			return sl_false;
+		}
+
+		SLIB_STATIC_STRING(s_method, ":method")
+		SLIB_STATIC_STRING(s_path, ":path")
+		SLIB_STATIC_STRING(s_scheme, ":scheme")
+		SLIB_STATIC_STRING(s_authority, ":authority")
+		SLIB_STATIC_STRING(s_connection, "connection")
+		SLIB_STATIC_STRING(s_keepAlive, "keep-alive")
+		SLIB_STATIC_STRING(s_proxyConnection, "proxy-connection")
+		SLIB_STATIC_STRING(s_transferEncoding, "transfer-encoding")
+		SLIB_STATIC_STRING(s_upgrade, "upgrade")
+		SLIB_STATIC_STRING(s_te, "te")
+		SLIB_STATIC_STRING(s_trailers, "trailers")
+		SLIB_STATIC_STRING(s_host, "host")
+		SLIB_STATIC_STRING(s_cookie, "cookie")
+
+		String method, path, scheme, authority, cookie;
+		// the request is converted to the HTTP/1.x form, so it is parsed and accessed like the other requests
+		MemoryBuffer fields;
+		sl_bool flagRegular = sl_false;
+		ListElements<HPackHeader> list(headers);
+		for (sl_size i = 0; i < list.count; i++) {
+			String& name = list[i].name;
+			String& value = list[i].value;
+			const sl_char8* sz = name.getData();
+			sl_size len = name.getLength();
+			if (!len) {
+				return sl_false;
+			}
+			for (sl_size k = 0; k < len; k++) {
+				sl_char8 ch = sz[k];
+				if (ch <= ' ' || (ch >= 'A' && ch <= 'Z') || (ch == ':' && k) || ch == 0x7f) {
+					return sl_false;
+				}
+			}
+			const sl_char8* szValue = value.getData();
+			sl_size lenValue = value.getLength();
+			for (sl_size k = 0; k < lenValue; k++) {
+				sl_char8 ch = szValue[k];
+				if (ch == '\r' || ch == '\n' || ch == 0) {
+					return sl_false;
+				}
+			}
+			if (sz[0] == ':') {
+				// pseudo-header fields precede the regular fields
+				if (flagRegular) {
+					return sl_false;
+				}
+				String* field;
+				if (name == s_method) {
+					field = &method;
+				} else if (name == s_path) {
+					field = &path;
+				} else if (name == s_scheme) {
+					field = &scheme;
+				} else if (name == s_authority) {
+					field = &authority;
+				} else {
+					return sl_false;
+				}
+				if (field->isNotNull()) {
+					return sl_false;
+				}
+				*field = value;
+			} else {
+				flagRegular = sl_true;
+				if (name == s_connection || name == s_keepAlive || name == s_proxyConnection || name == s_transferEncoding || name == s_upgrade) {
+					return sl_false;
+				}
+				if (name == s_te && value != s_trailers) {
+					return sl_false;
+				}
+				if (name == s_cookie) {
+					// cookie-pairs may be split into the separate fields
+					if (cookie.isNull()) {
+						cookie = value;
+					} else {
+						cookie = cookie + "; " + value;
+					}
+					continue;
+				}
+				if (name == s_host && authority.isNotEmpty()) {
+					continue;
+				}
+				fields.addStatic(sz, len);
+				fields.addStatic(": ", 2);
+				fields.addStatic(szValue, lenValue);
+				fields.addStatic("\r\n", 2);
+			}
+		}
+		if (method.isEmpty()) {
+			return sl_false;
+		}
+		if (method == HttpMethods::toString(HttpMethod::CONNECT)) {
+			if (path.isNotNull() || scheme.isNotNull() || authority.isEmpty()) {
+				return sl_false;
+			}
+			path = authority;
+		} else {
+			if (path.isEmpty() || scheme.isEmpty()) {
+				return sl_false;
+			}
+		}
+		if (method.indexOf(' ') >= 0 || path.indexOf(' ') >= 0) {
+			return sl_false;
+		}
+
+		MemoryBuffer packet;
+		packet.addStatic(method.getData(), method.getLength());
+		packet.addStatic(" ", 1);
+		packet.addStatic(path.getData(), path.getLength());
+		packet.addStatic(" HTTP/2.0\r\n", 11);
+		if (authority.isNotEmpty()) {
+			packet.addStatic("host: ", 6);
+			packet.addStatic(authority.getData(), authority.getLength());
+			packet.addStatic("\r\n", 2);
+		}
+		packet.link(fields);
+		if (cookie.isNotNull()) {
+			packet.addStatic("cookie: ", 8);
+			packet.addStatic(cookie.getData(), cookie.getLength());
+			packet.addStatic("\r\n", 2);
+		}
+		packet.addStatic("\r\n", 2);
+		Memory header = packet.merge();
+		if (header.isNull()) {
+			return sl_false;
+		}
+
+		Ref<HttpServiceContext> context = HttpServiceContext::create(connection);
+		if (context.isNull()) {
+			return sl_false;
+		}
+		context->m_requestHeader = header;
+		sl_reg iRet = context->parseRequestPacket(header);
+		if (iRet != (sl_reg)(header.getSize())) {
+			return sl_false;
+		}
+		context->m_streamId = stream->id;
+		context->setProcessingByThread(m_flagProcessByThreads);
+		context->applyQueryToParameters();
+		stream->context = context;
+		return sl_true;
+	}
+
+	void _Http2ServiceSession::_completeRequest(_Http2ServiceStream* stream)
+	{
+		stream->flagRemoteClosed = sl_true;
+		HttpServiceContext* context = stream->context.get();
+		context->m_requestBody = context->m_requestBodyBuffer.merge();
+		context->m_requestContentLength = context->m_requestBodyBuffer.getSize();
+		if (context->m_requestContentLength > 0 && context->m_requestBody.isEmpty()) {
+			_resetStream(stream->id, Http2ErrorCode::InternalError);
+			return;
+		}
+		context->m_requestBodyBuffer.clear();
+		if (context->getMethod() == HttpMethod::POST) {
+			String reqContentType = context->getRequestContentTypeNoParams();
+			if (reqContentType == ContentTypes::WebForm) {
+				Memory body = context->getRequestBody();
+				context->applyPostParameters(body.getData(), body.getSize());
+			}
+		}
+		m_contextsReady.add_NoLock(stream->context);
+	}
+
+	void _Http2ServiceSession::_dispatch()
+	{
+		Ref<HttpServiceConnection> connection = m_connection;
+		if (connection.isNull()) {
+			return;
+		}
+		Ref<HttpService> service = connection->getService();
+		if (service.isNull()) {
+			return;
+		}
+		for (;;) {
+			Ref<HttpServiceContext> context;
+			{
+				ObjectLocker lock(this);
+				if (!(m_contextsReady.popFront_NoLock(&context))) {
+					return;
+				}
+			}
+			if (context->isProcessingByThread()) {
+				Ref<ThreadPool> threadPool = service->getThreadPool();
+				if (threadPool.isNotNull()) {
+					threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, connection.get(), context));
+				} else {
+					context->setResponseCode(HttpStatus::InternalServerError);
+					completeResponse(context.get());
+				}
+			} else {
+				connection->_processContext(context);
+			}
+		}
+	}
+
+	Ref<_Http2ServiceStream> _Http2ServiceSession::_getStream(sl_uint32 streamId)
+	{
+		ListElements< Ref<_Http2ServiceStream> > streams(m_streams);
+		for (sl_size i = 0; i < streams.count; i++) {
+			if (streams[i]->id == streamId) {
+				return streams[i];
+			}
+		}
+		return sl_null;
+	}
+
+	void _Http2ServiceSession::_removeStream(_Http2ServiceStream* stream)
+	{
+		stream->flagRemoteClosed = sl_true;
+		stream->flagLocalClosed = sl_true;
+		stream->body.setNull();
+		stream->dataResponse.clear_NoLock();
+		ListElements< Ref<_Http2ServiceStream> > streams(m_streams);
+		for (sl_size i = 0; i < streams.count; i++) {
+			if (streams[i].get() == stream) {
+				m_streams.removeAt_NoLock(i);
+				return;
+			}
+		}
+	}
+
+	void _Http2ServiceSession::_resetStream(sl_uint32 streamId, Http2ErrorCode code)
+	{
+		sl_uint8 payload[4];
+		MIO::writeUint32BE(payload, (sl_uint32)code);
+		_writeFrame(Http2FrameType::ResetStream, 0, streamId, payload, 4);
+		Ref<_Http2ServiceStream> stream = _getStream(streamId);
+		if (stream.isNotNull()) {
+			_removeStream(stream.get());
+		}
+	}
+
+	void _Http2ServiceSession::_sendStatus(_Http2ServiceStream* stream, HttpStatus status)
+	{
+		SLIB_STATIC_STRING(s_status, ":status")
+		SLIB_STATIC_STRING(s_contentLength, "content-length")
+		SLIB_STATIC_STRING(s_zero, "0")
+		CList<sl_uint8> block;
+		m_encoder.begin(block);
+		m_encoder.encode(block, s_status, String::fromUint32((sl_uint32)status));
+		m_encoder.encode(block, s_contentLength, s_zero, sl_false);
+		stream->flagResponding = sl_true;
+		_sendHeaders(stream->id, block, sl_true);
+		// the rest of the request is not needed
+		_resetStream(stream->id, Http2ErrorCode::NoError);
+	}
+
+	void _Http2ServiceSession::_sendHeaders(sl_uint32 streamId, CList<sl_uint8>& block, sl_bool flagEndStream)
+	{
+		sl_uint8* data = block.getData();
+		sl_uint32 size = (sl_uint32)(block.getCount());
+		sl_uint32 n = size;
+		if (n > m_maxFrameSizeSend) {
+			n = m_maxFrameSizeSend;
+		}
+		sl_uint8 flags = flagEndStream ? SLIB_HTTP2_FLAG_END_STREAM : 0;
+		if (n == size) {
+			flags |= SLIB_HTTP2_FLAG_END_HEADERS;
+		}
+		_writeFrame(Http2FrameType::Headers, flags, streamId, data, n);
+		data += n;
+		size -= n;
+		while (size > 0) {
+			n = size;
+			if (n > m_maxFrameSizeSend) {
+				n = m_maxFrameSizeSend;
+			}
+			_writeFrame(Http2FrameType::Continuation, n == size ? SLIB_HTTP2_FLAG_END_HEADERS : 0, streamId, data, n);
+			data += n;
+			size -= n;
+		}
+	}
+
+	void _Http2ServiceSession::_fillStream(_Http2ServiceStream* stream)
+	{
+		HttpServiceContext* context = stream->context.get();
+		while (!(stream->flagReadingBody) && !(stream->flagOutputEnded) && stream->dataResponse.getSize() < HTTP2_SIZE_STREAM_BUFFER) {
+			if (stream->body.isNotNull()) {
+				if (!(stream->sizeBodyRemaining)) {
+					stream->body.setNull();
+					continue;
+				}
+				sl_uint32 n = HTTP2_SIZE_READ_BODY;
+				if (n > stream->sizeBodyRemaining) {
+					n = (sl_uint32)(stream->sizeBodyRemaining);
+				}
+				Memory buf = Memory::create(n);
+				if (buf.isNull()) {
+					_resetStream(stream->id, Http2ErrorCode::InternalError);
+					return;
+				}
+				stream->flagReadingBody = sl_true;
+				Ref<_Http2ServiceStream> refStream = stream;
+				if (!(stream->body->read(buf.getData(), n, SLIB_BIND_WEAKREF(void(AsyncStreamResult*), _Http2ServiceSession, _onReadBody, this, refStream, buf)))) {
+					stream->flagReadingBody = sl_false;
+					_resetStream(stream->id, Http2ErrorCode::InternalError);
+				}
+				return;
+			}
+			Ref<AsyncOutputBufferElement> element;
+			if (!(context->m_bufferOutput.popElement(element))) {
+				stream->flagOutputEnded = sl_true;
+				return;
+			}
+			stream->dataResponse.link_NoLock(element->getHeader());
+			sl_uint64 sizeBody = element->getBodySize();
+			Ref<AsyncStream> body = element->getBody();
+			if (sizeBody && body.isNotNull()) {
+				stream->body = body;
+				stream->sizeBodyRemaining = sizeBody;
+			}
+		}
+	}
+
+	void _Http2ServiceSession::_onReadBody(const Ref<_Http2ServiceStream>& stream, const Memory& buf, AsyncStreamResult* result)
+	{
+		ObjectLocker lock(this);
+		stream->flagReadingBody = sl_false;
+		if (stream->flagLocalClosed || m_flagClosing) {
+			return;
+		}
+		if (result->flagError || !(result->size)) {
+			_resetStream(stream->id, Http2ErrorCode::InternalError);
+			_flush();
+			return;
+		}
+		sl_uint32 n = result->size;
+		if (n > stream->sizeBodyRemaining) {
+			n = (sl_uint32)(stream->sizeBodyRemaining);
+		}
+		stream->dataResponse.add_NoLock(buf.sub(0, n));
+		stream->sizeBodyRemaining -= n;
+		_fillStream(stream.get());
+		_send();
+		_flush();
+	}
+
+	Ref<_Http2ServiceStream> _Http2ServiceSession::_selectStream()
+	{
+		_Http2ServiceStream* ret = sl_null;
+		ListElements< Ref<_Http2ServiceStream> > streams(m_streams);
+		for (sl_size i = 0; i < streams.count; i++) {
+			_Http2ServiceStream* stream = streams[i].get();
+			if (!(stream->isSendable(m_windowSend))) {
+				continue;
+			}
+			if (stream->dependency) {
+				// the stream waits while its parent can be sent
+				Ref<_Http2ServiceStream> parent = _getStream(stream->dependency);
+				if (parent.isNotNull() && parent->isSendable(m_windowSend)) {
+					continue;
+				}
+			}
+			if (!ret || stream->virtualTime < ret->virtualTime) {
+				ret = stream;
+			}
+		}
+		return ret;
+	}
+
+	void _Http2ServiceSession::_send()
+	{
+		if (m_flagClosing) {
+			return;
+		}
+		while (m_sizeOutputPending < HTTP2_SIZE_OUTPUT_BUDGET) {
+			Ref<_Http2ServiceStream> stream = _selectStream();
+			if (stream.isNull()) {
+				return;
+			}
+			sl_uint64 sizeData = stream->dataResponse.getSize();
+			sl_uint32 n = m_maxFrameSizeSend;
+			if (n > stream->windowSend) {
+				n = (sl_uint32)(stream->windowSend);
+			}
+			if (n > m_windowSend) {
+				n = (sl_uint32)m_windowSend;
+			}
+			if (n > sizeData) {
+				n = (sl_uint32)sizeData;
+			}
+			sl_bool flagEndStream = n == sizeData && stream->flagOutputEnded;
+			Memory mem = Memory::create(SLIB_HTTP2_FRAME_HEADER_SIZE + n);
+			if (mem.isNull()) {
+				_goAway(Http2ErrorCode::InternalError);
+				return;
+			}
+			Http2FrameHeader* header = (Http2FrameHeader*)(mem.getData());
+			header->setLength(n);
+			header->setType(Http2FrameType::Data);
+			header->setFlags(flagEndStream ? SLIB_HTTP2_FLAG_END_STREAM : 0);
+			header->setStreamId(stream->id);
+			stream->dataResponse.pop_NoLock(header->getPayload(), n);
+			_writeOutput(mem);
+			stream->windowSend -= n;
+			m_windowSend -= n;
+			// weighted fair queuing: the virtual time of the stream advances inversely proportional to its weight
+			m_virtualTime = stream->virtualTime;
+			stream->virtualTime += ((sl_uint64)(n + 1) << 8) / stream->weight;
+			if (flagEndStream) {
+				stream->flagLocalClosed = sl_true;
+				if (stream->flagRemoteClosed) {
+					_removeStream(stream.get());
+				} else {
+					_resetStream(stream->id, Http2ErrorCode::NoError);
+				}
+			} else {
+				_fillStream(stream.get());
+			}
+		}
+	}
+
+	void _Http2ServiceSession::_writeOutput(const Memory& mem)
+	{
+		if (m_output->write(mem)) {
+			m_sizeOutputPending += (sl_uint32)(mem.getSize());
+			m_flagOutputWritten = sl_true;
+		}
+	}
+
+	void _Http2ServiceSession::_writeFrame(Http2FrameType type, sl_uint8 flags, sl_uint32 streamId, const void* payload, sl_uint32 size)
+	{
+		Memory mem = Memory::create(SLIB_HTTP2_FRAME_HEADER_SIZE + size);
+		if (mem.isNull()) {
+			return;
+		}
+		Http2FrameHeader* header = (Http2FrameHeader*)(mem.getData());
+		header->setLength(size);
+		header->setType(type);
+		header->setFlags(flags);
+		header->setStreamId(streamId);
+		if (size) {
+			Base::copyMemory(header->getPayload(), payload, size);
+		}
+		_writeOutput(mem);
+	}
+
+	void _Http2ServiceSession::_writeWindowUpdate(sl_uint32 streamId, sl_uint32 increment)
+	{
+		sl_uint8 payload[4];
+		MIO::writeUint32BE(payload, increment);
+		_writeFrame(Http2FrameType::WindowUpdate, 0, streamId, payload, 4);
+	}
+
+	void _Http2ServiceSession::_goAway(Http2ErrorCode code)
+	{
+		if (m_flagClosing) {
+			return;
+		}
+		sl_uint8 payload[8];
+		MIO::writeUint32BE(payload, m_lastStreamId);
+		MIO::writeUint32BE(payload + 4, (sl_uint32)code);
+		_writeFrame(Http2FrameType::GoAway, 0, 0, payload, 8);
+		// the connection is closed after GOAWAY is sent
+		m_flagClosing = sl_true;
+		m_flagOutputWritten = sl_true;
+		_flush();
+	}
+
+	void _Http2ServiceSession::_flush()
+	{
+		if (m_flagOutputWritten) {
+			m_flagOutputWritten = sl_false;
+			m_output->startWriting();
+		}
+	}
+
+	void _Http2ServiceSession::_onOutputDrained()
+	{
+		ObjectLocker lock(this);
+		m_sizeOutputPending = 0;
+		if (m_flagClosing) {
+			lock.unlock();
+			Ref<HttpServiceConnection> connection = m_connection;
+			if (connection.isNotNull()) {
+				connection->close();
+			}
+			return;
+		}
+		_send();
+		_flush();
+	}
+
+}
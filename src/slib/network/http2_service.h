@@ -0,0 +1,193 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_NETWORK_HTTP2_SERVICE
+#define CHECKHEADER_SLIB_NETWORK_HTTP2_SERVICE
+
+#include "../../../inc/slib/network/http_service.h"
+#include "../../../inc/slib/network/http2.h"
+
+namespace slib
+{
+
+	class _Http2ServiceStream : public Referable
+	{
+	public:
+		sl_uint32 id;
+		Ref<HttpServiceContext> context;
+
+		// request
+		sl_bool flagHeadersReceived;
+		// END_STREAM is received
+		sl_bool flagRemoteClosed;
+		sl_int64 windowReceive;
+		sl_uint32 sizeReceivedUnacked;
+
+		// response
+		// HEADERS of the response are sent
+		sl_bool flagResponding;
+		// END_STREAM or RST_STREAM is sent
+		sl_bool flagLocalClosed;
+		sl_int64 windowSend;
+		// response bytes which are ready to be framed
+		MemoryQueue dataResponse;
+		Ref<AsyncStream> body;
+		sl_uint64 sizeBodyRemaining;
+		sl_bool flagReadingBody;
+		// all output of the context is moved to `dataResponse`
+		sl_bool flagOutputEnded;
+
+		// priority
+		sl_uint32 dependency;
+		sl_uint32 weight;
+		// the streams having smaller virtual time are served first, and the time advances inversely proportional to the weight
+		sl_uint64 virtualTime;
+
+	public:
+		_Http2ServiceStream();
+
+		~_Http2ServiceStream();
+
+	public:
+		// true when a DATA frame can be sent now, `windowConnection` is the send window of the connection
+		sl_bool isSendable(sl_int64 windowConnection);
+
+	};
+
+	class _Http2ServiceSession : public Object
+	{
+	protected:
+		_Http2ServiceSession();
+
+		~_Http2ServiceSession();
+
+	public:
+		// `sizePrefaceReceived`: the count of the preface bytes already consumed by the connection
+		static Ref<_Http2ServiceSession> create(HttpServiceConnection* connection, sl_uint32 sizePrefaceReceived);
+
+	public:
+		// sends the server preface
+		void start();
+
+		// switched by `Upgrade: h2c`: `context` is the request of the stream 1, and `settings` is the payload of `HTTP2-Settings` header
+		void startUpgrade(const Ref<HttpServiceContext>& context, const Memory& settings);
+
+		void processInput(const void* data, sl_uint32 size);
+
+		void completeResponse(HttpServiceContext* context);
+
+		// called in the thread completing the output
+		void onOutputComplete();
+
+	protected:
+		void _processFrames(const sl_uint8* data, sl_uint32 size);
+
+		sl_bool _processFrame(const Http2FrameHeader& header, const sl_uint8* payload);
+
+		sl_bool _processHeaders(const Http2FrameHeader& header, const sl_uint8* payload);
+
+		sl_bool _processHeaderBlock(sl_uint32 streamId);
+
+		sl_bool _processData(const Http2FrameHeader& header, const sl_uint8* payload);
+
+		sl_bool _processSettings(const sl_uint8* payload, sl_uint32 size);
+
+		sl_bool _processWindowUpdate(sl_uint32 streamId, const sl_uint8* payload);
+
+		void _setPriority(_Http2ServiceStream* stream, const sl_uint8* data);
+
+		sl_bool _buildRequest(_Http2ServiceStream* stream, List<HPackHeader>& headers);
+
+		void _completeRequest(_Http2ServiceStream* stream);
+
+		void _dispatch();
+
+		Ref<_Http2ServiceStream> _getStream(sl_uint32 streamId);
+
+		void _removeStream(_Http2ServiceStream* stream);
+
+		// sends RST_STREAM and removes the stream
+		void _resetStream(sl_uint32 streamId, Http2ErrorCode code);
+
+		void _sendStatus(_Http2ServiceStream* stream, HttpStatus status);
+
+		void _sendHeaders(sl_uint32 streamId, CList<sl_uint8>& block, sl_bool flagEndStream);
+
+		void _fillStream(_Http2ServiceStream* stream);
+
+		void _onReadBody(const Ref<_Http2ServiceStream>& stream, const Memory& buf, AsyncStreamResult* result);
+
+		Ref<_Http2ServiceStream> _selectStream();
+
+		void _send();
+
+		void _writeOutput(const Memory& mem);
+
+		void _writeFrame(Http2FrameType type, sl_uint8 flags, sl_uint32 streamId, const void* payload, sl_uint32 size);
+
+		void _writeWindowUpdate(sl_uint32 streamId, sl_uint32 increment);
+
+		void _goAway(Http2ErrorCode code);
+
+		void _flush();
+
+		void _onOutputDrained();
+
+	protected:
+		WeakRef<HttpServiceConnection> m_connection;
+		Ref<AsyncOutput> m_output;
+		WeakRef<AsyncIoLoop> m_ioLoop;
+
+		sl_uint32 m_maxRequestHeadersSize;
+		sl_uint64 m_maxRequestBodySize;
+		sl_uint32 m_maxConcurrentStreams;
+		sl_bool m_flagProcessByThreads;
+
+		sl_uint32 m_sizePrefaceReceived;
+		sl_bool m_flagSettingsReceived;
+		sl_bool m_flagClosing;
+
+		// frame being received
+		sl_uint8 m_bufFrameHeader[SLIB_HTTP2_FRAME_HEADER_SIZE];
+		sl_uint32 m_sizeFrameHeader;
+		Memory m_bufFramePayload;
+		sl_uint32 m_sizeFramePayload;
+
+		// header block being received by HEADERS and CONTINUATION frames
+		sl_uint32 m_streamHeaderBlock;
+		sl_bool m_flagHeaderBlockEndStream;
+		CList<sl_uint8> m_headerBlock;
+
+		CList< Ref<_Http2ServiceStream> > m_streams;
+		sl_uint32 m_lastStreamId;
+		// requests to be processed after the input is parsed
+		CList< Ref<HttpServiceContext> > m_contextsReady;
+
+		HPackDecoder m_decoder;
+		HPackEncoder m_encoder;
+
+		// settings of the peer
+		sl_uint32 m_maxFrameSizeSend;
+		sl_int64 m_initialWindowSend;
+
+		sl_int64 m_windowSend;
+		sl_int64 m_windowReceive;
+		sl_uint32 m_sizeReceivedUnacked;
+
+		sl_uint64 m_virtualTime;
+		// bytes written to the output since it was drained last
+		sl_uint32 m_sizeOutputPending;
+		sl_bool m_flagOutputWritten;
+
+	};
+
+}
+
+#endif
@@ -148,6 +148,9 @@ namespace slib
 	DEFINE_HTTP_HEADER(AcceptEncoding, "Accept-Encoding")
 	DEFINE_HTTP_HEADER(TransferEncoding, "Transfer-Encoding")
 	DEFINE_HTTP_HEADER(ContentEncoding, "Content-Encoding")
+	DEFINE_HTTP_HEADER(Connection, "Connection")
+	DEFINE_HTTP_HEADER(Upgrade, "Upgrade")
+	DEFINE_HTTP_HEADER(HTTP2Settings, "HTTP2-Settings")
 
 	DEFINE_HTTP_HEADER(Range, "Range")
 	DEFINE_HTTP_HEADER(ContentRange, "Content-Range")
@@ -217,6 +220,73 @@ namespace slib
 		return posCurrent;
 	}
 
+	sl_reg HttpHeaders::parseHeaders(HttpHeaderSlice* slices, sl_uint32 maxCount, sl_uint32& outCount, const void* _data, sl_size size)
+	{
+		const sl_char8* data = (const sl_char8*)_data;
+		sl_size posCurrent = 0;
+		sl_uint32 count = 0;
+		
+		for (;;) {
+			sl_size posStart = posCurrent;
+			sl_size indexSplit = 0;
+			while (posCurrent < size) {
+				sl_char8 ch = data[posCurrent];
+				if (ch == '\r') {
+					break;
+				}
+				if (indexSplit == 0) {
+					if (ch == ':') {
+						indexSplit = posCurrent;
+					}
+				}
+				posCurrent++;
+			}
+			if (posCurrent >= size - 1) {
+				return 0;
+			}
+			if (data[posCurrent + 1] != '\n') {
+				return -1;
+			}
+			
+			if (posCurrent == posStart) {
+				posCurrent += 2;
+				break;
+			}
+			
+			if (count < maxCount) {
+				HttpHeaderSlice& slice = slices[count];
+				slice.name = (sl_uint32)posStart;
+				if (indexSplit != 0) {
+					slice.nameLength = (sl_uint32)(indexSplit - posStart);
+					sl_size startValue = indexSplit + 1;
+					sl_size endValue = posCurrent;
+					while (startValue < endValue) {
+						if (data[startValue] != ' ' && data[startValue] != '\t') {
+							break;
+						}
+						startValue++;
+					}
+					while (startValue < endValue) {
+						if (data[endValue - 1] != ' ' && data[endValue - 1] != '\t') {
+							break;
+						}
+						endValue--;
+					}
+					slice.value = (sl_uint32)startValue;
+					slice.valueLength = (sl_uint32)(endValue - startValue);
+				} else {
+					slice.nameLength = (sl_uint32)(posCurrent - posStart);
+					slice.value = (sl_uint32)posCurrent;
+					slice.valueLength = 0;
+				}
+			}
+			count++;
+			posCurrent += 2;
+		}
+		outCount = count;
+		return posCurrent;
+	}
+
 
 /***********************************************************************
 							HttpRequest
@@ -232,6 +302,11 @@ namespace slib
 		m_methodTextUpper = s2;
 		
 		m_requestHeaders.initHash(0, HashIgnoreCaseString(), EqualsIgnoreCaseString());
+		
+		m_requestHeaderSection = 0;
+		m_nRequestHeaderIndex = 0;
+		m_flagRequestHeaderIndex = sl_false;
+		m_flagRequestHeaderMapBuilt = sl_false;
 	}
 
 	HttpRequest::~HttpRequest()
@@ -297,51 +372,133 @@ namespace slib
 		m_requestVersion = version;
 	}
 
+	void HttpRequest::resetRequest()
+	{
+		SLIB_STATIC_STRING(s1, "HTTP/1.1");
+		m_requestVersion = s1;
+		m_method = HttpMethod::GET;
+		SLIB_STATIC_STRING(s2, "GET");
+		m_methodText = s2;
+		m_methodTextUpper = s2;
+		m_path.setNull();
+		m_query.setNull();
+		
+		m_requestHeaders.removeAll_NoLock();
+		m_requestHeaderPacket.setNull();
+		m_requestHeaderSection = 0;
+		m_nRequestHeaderIndex = 0;
+		m_flagRequestHeaderIndex = sl_false;
+		m_flagRequestHeaderMapBuilt = sl_false;
+		m_parameters.removeAll_NoLock();
+		m_queryParameters.removeAll_NoLock();
+		m_postParameters.removeAll_NoLock();
+		m_pathParameters.removeAll_NoLock();
+	}
+
 	const Map<String, String>& HttpRequest::getRequestHeaders() const
 	{
+		_buildRequestHeaders();
 		return m_requestHeaders;
 	}
 
 	String HttpRequest::getRequestHeader(String name) const
 	{
+		if (m_flagRequestHeaderIndex) {
+			sl_uint32 index;
+			if (_findRequestHeader(name, 0, index)) {
+				return _getIndexedRequestHeader(index);
+			}
+			return sl_null;
+		}
 		return m_requestHeaders.getValue_NoLock(name, String::null());
 	}
 
+	sl_bool HttpRequest::getRequestHeaderData(const String& name, StringData& outValue) const
+	{
+		String value;
+		if (m_flagRequestHeaderIndex) {
+			sl_uint32 index;
+			if (!(_findRequestHeader(name, 0, index))) {
+				return sl_false;
+			}
+			const HttpHeaderSlice& slice = m_requestHeaderIndex[index];
+			const sl_char8* sz = (const sl_char8*)(m_requestHeaderPacket.getData()) + m_requestHeaderSection + slice.value;
+			if (!(Base::findMemory((const void*)sz, '%', slice.valueLength))) {
+				outValue.sz8 = sz;
+				outValue.len = slice.valueLength;
+				outValue.refer = m_requestHeaderPacket.ref;
+				outValue.str8.setNull();
+				return sl_true;
+			}
+			value = _getIndexedRequestHeader(index);
+		} else {
+			if (!(m_requestHeaders.get_NoLock(name, &value))) {
+				return sl_false;
+			}
+		}
+		outValue.sz8 = value.getData();
+		outValue.len = value.getLength();
+		outValue.refer.setNull();
+		outValue.str8 = value;
+		return sl_true;
+	}
+
 	List<String> HttpRequest::getRequestHeaderValues(String name) const
 	{
+		if (m_flagRequestHeaderIndex) {
+			List<String> ret;
+			sl_uint32 index = 0;
+			while (_findRequestHeader(name, index, index)) {
+				ret.add_NoLock(_getIndexedRequestHeader(index));
+				index++;
+			}
+			return ret;
+		}
 		return m_requestHeaders.getValues_NoLock(name);
 	}
 
 	void HttpRequest::setRequestHeader(String name, String value)
 	{
+		_detachRequestHeaderIndex();
 		m_requestHeaders.put_NoLock(name, value);
 	}
 
 	void HttpRequest::addRequestHeader(String name, String value)
 	{
+		_detachRequestHeaderIndex();
 		m_requestHeaders.put_NoLock(name, value, MapPutMode::AddAlways);
 	}
 
 	sl_bool HttpRequest::containsRequestHeader(String name) const
 	{
+		if (m_flagRequestHeaderIndex) {
+			sl_uint32 index;
+			return _findRequestHeader(name, 0, index);
+		}
 		return m_requestHeaders.contains_NoLock(name);
 	}
 
 	void HttpRequest::removeRequestHeader(String name)
 	{
+		_detachRequestHeaderIndex();
 		m_requestHeaders.removeItems_NoLock(name);
 	}
 
 	void HttpRequest::clearRequestHeaders()
 	{
+		m_flagRequestHeaderIndex = sl_false;
+		m_flagRequestHeaderMapBuilt = sl_false;
 		m_requestHeaders.removeAll_NoLock();
 	}
 
 	sl_uint64 HttpRequest::getRequestContentLengthHeader() const
 	{
-		String headerContentLength = getRequestHeader(HttpHeaders::ContentLength);
-		if (headerContentLength.isNotEmpty()) {
-			return headerContentLength.parseUint64();
+		StringData value;
+		if (getRequestHeaderData(HttpHeaders::ContentLength, value)) {
+			sl_uint64 n;
+			if (value.len > 0 && String::parseUint64(10, &n, value.sz8, 0, value.len) == (sl_reg)(value.len)) {
+				return n;
+			}
 		}
 		return 0;
 	}
@@ -510,6 +667,22 @@ namespace slib
 		return m_postParameters.contains_NoLock(name);
 	}
 
+	const Map<String, String>& HttpRequest::getPathParameters() const
+	{
+		return m_pathParameters;
+	}
+
+	String HttpRequest::getPathParameter(const String& name) const
+	{
+		return m_pathParameters.getValue_NoLock(name, String::null());
+	}
+
+	void HttpRequest::setPathParameter(const String& name, const String& value)
+	{
+		m_pathParameters.put_NoLock(name, value);
+		m_parameters.put_NoLock(name, value);
+	}
+
 	void HttpRequest::applyPostParameters(const void* data, sl_size size)
 	{
 		Map<String, String> params = parseParameters(data, size);
@@ -591,6 +764,7 @@ namespace slib
 		msg.addStatic(strVersion.getData(), strVersion.getLength());
 		msg.addStatic("\r\n", 2);
 
+		_buildRequestHeaders();
 		Iterator< Pair<String, String> > iterator = m_requestHeaders.toIterator();
 		Pair<String, String> pair;
 		while (iterator.next(&pair)) {
@@ -607,7 +781,25 @@ namespace slib
 
 	sl_reg HttpRequest::parseRequestPacket(const void* packet, sl_size size)
 	{
-		const sl_char8* data = (const sl_char8*)packet;
+		return parseRequestPacket(Memory::create(packet, size));
+	}
+
+	static sl_bool _HttpRequest_equalsIgnoreCase(const sl_char8* s1, const sl_char8* s2, sl_size len)
+	{
+		for (sl_size i = 0; i < len; i++) {
+			sl_char8 c1 = s1[i];
+			sl_char8 c2 = s2[i];
+			if (c1 != c2 && SLIB_CHAR_UPPER_TO_LOWER(c1) != SLIB_CHAR_UPPER_TO_LOWER(c2)) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_reg HttpRequest::parseRequestPacket(const Memory& packet)
+	{
+		const sl_char8* data = (const sl_char8*)(packet.getData());
+		sl_size size = packet.getSize();
 		sl_size posCurrent = 0;
 		sl_size posStart = 0;
 		// method
@@ -624,7 +816,23 @@ namespace slib
 		if (posCurrent == size) {
 			return 0;
 		}
-		setMethod(String::fromUtf8(data + posStart, posCurrent - posStart));
+		{
+			// the known methods are resolved to the static strings
+			static const HttpMethod methods[] = {HttpMethod::GET, HttpMethod::POST, HttpMethod::HEAD, HttpMethod::PUT, HttpMethod::DELETE, HttpMethod::OPTIONS, HttpMethod::CONNECT, HttpMethod::TRACE};
+			sl_size len = posCurrent - posStart;
+			sl_bool flagKnown = sl_false;
+			for (sl_size i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+				String name = HttpMethods::toString(methods[i]);
+				if (name.getLength() == len && Base::equalsMemory(name.getData(), data + posStart, len)) {
+					setMethod(methods[i]);
+					flagKnown = sl_true;
+					break;
+				}
+			}
+			if (!flagKnown) {
+				setMethod(String::fromUtf8(data + posStart, len));
+			}
+		}
 		posCurrent++;
 
 		// uri
@@ -670,15 +878,86 @@ namespace slib
 		if (data[posCurrent + 1] != '\n') {
 			return -1;
 		}
-		setRequestVersion(String::fromUtf8(data + posStart, posCurrent - posStart));
+		{
+			SLIB_STATIC_STRING(s1, "HTTP/1.1");
+			SLIB_STATIC_STRING(s2, "HTTP/1.0");
+			sl_size len = posCurrent - posStart;
+			if (len == 8 && Base::equalsMemory(s1.getData(), data + posStart, 8)) {
+				setRequestVersion(s1);
+			} else if (len == 8 && Base::equalsMemory(s2.getData(), data + posStart, 8)) {
+				setRequestVersion(s2);
+			} else {
+				setRequestVersion(String::fromUtf8(data + posStart, len));
+			}
+		}
 		posCurrent += 2;
 
-		sl_reg iRet = HttpHeaders::parseHeaders(m_requestHeaders, data + posCurrent, size - posCurrent);
-		if (iRet > 0) {
-			return posCurrent + iRet;
-		} else {
+		_detachRequestHeaderIndex();
+		sl_uint32 nHeaders = 0;
+		sl_reg iRet = HttpHeaders::parseHeaders(m_requestHeaderIndex, SLIB_HTTP_HEADER_INDEX_SIZE, nHeaders, data + posCurrent, size - posCurrent);
+		if (iRet <= 0) {
 			return iRet;
 		}
+		if (nHeaders <= SLIB_HTTP_HEADER_INDEX_SIZE && m_requestHeaders.isEmpty()) {
+			m_requestHeaderPacket = packet;
+			m_requestHeaderSection = (sl_uint32)posCurrent;
+			m_nRequestHeaderIndex = nHeaders;
+			m_flagRequestHeaderIndex = sl_true;
+		} else {
+			HttpHeaders::parseHeaders(m_requestHeaders, data + posCurrent, size - posCurrent);
+		}
+		return posCurrent + iRet;
+	}
+
+	void HttpRequest::_buildRequestHeaders() const
+	{
+		if (!m_flagRequestHeaderIndex) {
+			return;
+		}
+		// the index stays valid while the map is built, so the readers using the index are not affected
+		SpinLocker lock(&m_lockRequestHeaderMap);
+		if (m_flagRequestHeaderMapBuilt) {
+			return;
+		}
+		const sl_char8* section = (const sl_char8*)(m_requestHeaderPacket.getData()) + m_requestHeaderSection;
+		for (sl_uint32 i = 0; i < m_nRequestHeaderIndex; i++) {
+			const HttpHeaderSlice& slice = m_requestHeaderIndex[i];
+			m_requestHeaders.put_NoLock(String::fromUtf8(section + slice.name, slice.nameLength), _getIndexedRequestHeader(i), MapPutMode::AddAlways);
+		}
+		m_flagRequestHeaderMapBuilt = sl_true;
+	}
+
+	void HttpRequest::_detachRequestHeaderIndex()
+	{
+		_buildRequestHeaders();
+		m_flagRequestHeaderIndex = sl_false;
+		m_flagRequestHeaderMapBuilt = sl_false;
+	}
+
+	sl_bool HttpRequest::_findRequestHeader(const String& name, sl_uint32 start, sl_uint32& outIndex) const
+	{
+		const sl_char8* sz = name.getData();
+		sl_size len = name.getLength();
+		const sl_char8* section = (const sl_char8*)(m_requestHeaderPacket.getData()) + m_requestHeaderSection;
+		for (sl_uint32 i = start; i < m_nRequestHeaderIndex; i++) {
+			const HttpHeaderSlice& slice = m_requestHeaderIndex[i];
+			if (slice.nameLength == len && _HttpRequest_equalsIgnoreCase(section + slice.name, sz, len)) {
+				outIndex = i;
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	String HttpRequest::_getIndexedRequestHeader(sl_uint32 index) const
+	{
+		const HttpHeaderSlice& slice = m_requestHeaderIndex[index];
+		const sl_char8* sz = (const sl_char8*)(m_requestHeaderPacket.getData()) + m_requestHeaderSection + slice.value;
+		String value = String::fromUtf8(sz, slice.valueLength);
+		if (Base::findMemory((const void*)sz, '%', slice.valueLength)) {
+			return Url::decodeUriComponentByUTF8(value);
+		}
+		return value;
 	}
 
 
@@ -732,6 +1011,17 @@ namespace slib
 		m_responseVersion = version;
 	}
 
+	void HttpResponse::resetResponse()
+	{
+		SLIB_STATIC_STRING(s1, "HTTP/1.1");
+		m_responseVersion = s1;
+		m_responseCode = HttpStatus::OK;
+		SLIB_STATIC_STRING(s2, "OK");
+		m_responseMessage = s2;
+		
+		m_responseHeaders.removeAll_NoLock();
+	}
+
 	const Map<String, String>& HttpResponse::getResponseHeaders() const
 	{
 		return m_responseHeaders;
@@ -1070,7 +1360,8 @@ namespace slib
 			posBody = 3;
 			flagFound = sl_true;
 		}
-		if (size > 3) {
+		// the data following the header may contain the header of the next request
+		if (!flagFound && size > 3) {
 			for (sl_size i = 0; i <= size - 4; i++) {
 				if (buf[i] == '\r' && buf[i + 1] == '\n' && buf[i + 2] == '\r' && buf[i + 3] == '\n') {
 					posBody = 4 + i;
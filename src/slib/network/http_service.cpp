@@ -14,8 +14,12 @@
 #include "../../../inc/slib/core/asset.h"
 #include "../../../inc/slib/core/file.h"
 #include "../../../inc/slib/core/log.h"
+#include "../../../inc/slib/core/system.h"
 #include "../../../inc/slib/core/json.h"
 #include "../../../inc/slib/core/content_type.h"
+#include "../../../inc/slib/core/base64.h"
+
+#include "http2_service.h"
 
 #define SERVICE_TAG "HTTP SERVICE"
 
@@ -32,6 +36,7 @@ namespace slib
 	{
 		m_requestContentLength = 0;
 		m_flagAsynchronousResponse = sl_false;
+		m_streamId = 0;
 
 		setClosingConnection(sl_false);
 		setProcessingByThread(sl_true);
@@ -70,7 +75,7 @@ namespace slib
 
 	Variant HttpServiceContext::getRequestBodyAsJson() const
 	{
-		return Json::parseJson16Utf8(m_requestBody);
+		return Json::parseJsonUtf8(m_requestBody);
 	}
 
 	sl_uint64 HttpServiceContext::getResponseContentLength() const
@@ -103,6 +108,10 @@ namespace slib
 
 	Ref<AsyncIoLoop> HttpServiceContext::getAsyncIoLoop()
 	{
+		Ref<AsyncStream> io = getIO();
+		if (io.isNotNull()) {
+			return io->getIoLoop();
+		}
 		Ref<HttpService> service = getService();
 		if (service.isNotNull()) {
 			return service->getAsyncIoLoop();
@@ -149,6 +158,29 @@ namespace slib
 		}
 	}
 
+	sl_uint32 HttpServiceContext::getStreamId() const
+	{
+		return m_streamId;
+	}
+
+	void HttpServiceContext::_reset()
+	{
+		resetRequest();
+		resetResponse();
+		clearOutput();
+		
+		m_requestHeaderReader.clear();
+		m_requestHeader.setNull();
+		m_requestContentLength = 0;
+		m_requestBodyBuffer.clear();
+		m_requestBody.setNull();
+		m_flagAsynchronousResponse = sl_false;
+		m_streamId = 0;
+		
+		setClosingConnection(sl_false);
+		setProcessingByThread(sl_true);
+	}
+
 /******************************************************
 			HttpServiceConnection
 ******************************************************/
@@ -159,6 +191,8 @@ namespace slib
 	{
 		m_flagClosed = sl_true;
 		m_flagReading = sl_false;
+		m_flagProcessingInline = sl_false;
+		m_flagCompletedInline = sl_false;
 	}
 
 	HttpServiceConnection::~HttpServiceConnection()
@@ -213,6 +247,21 @@ namespace slib
 		m_contextCurrent.setNull();
 		if (data && size > 0) {
 			_processInput(data, size);
+			return;
+		}
+		Memory pending;
+		{
+			ObjectLocker lock(this);
+			if (m_flagProcessingInline) {
+				// `_processInput` continues with the pending input
+				m_flagCompletedInline = sl_true;
+				return;
+			}
+			pending = m_bufPending;
+			m_bufPending.setNull();
+		}
+		if (pending.isNotNull()) {
+			_processInput(pending.getData(), (sl_uint32)(pending.getSize()));
 		} else {
 			_read();
 		}
@@ -249,13 +298,31 @@ namespace slib
 		}
 	}
 
+	Ref<HttpServiceContext> HttpServiceConnection::_createContext()
+	{
+		Ref<HttpServiceContext> context = m_contextLast;
+		// referenced only by `m_contextLast` and `context`
+		if (context.isNotNull() && context->getReferenceCount() == 2) {
+			context->_reset();
+			context->m_connection = this;
+			return context;
+		}
+		context = HttpServiceContext::create(this);
+		m_contextLast = context;
+		return context;
+	}
+
 	void HttpServiceConnection::_processInput(const void* _data, sl_uint32 size)
 	{
-		Ref<HttpService> service = m_service;
-		if (service.isNull()) {
+		Ref<_Http2ServiceSession> http2 = m_http2;
+		if (http2.isNotNull()) {
+			http2->processInput(_data, size);
+			_read();
 			return;
 		}
-		if (m_flagClosed) {
+		
+		Ref<HttpService> service = m_service;
+		if (service.isNull()) {
 			return;
 		}
 		
@@ -264,94 +331,174 @@ namespace slib
 		sl_uint64 maxRequestBodySize = param.maxRequestBodySize;
 
 		char* data = (char*)_data;
-		Ref<HttpServiceContext> _context = m_contextCurrent;
-		if (_context.isNull()) {
-			_context = HttpServiceContext::create(this);
-			if (_context.isNull()) {
-				sendResponse_ServerError();
+		// memory holding `data`, referenced by the pending input instead of copying
+		Memory input;
+		if (data >= (char*)(m_bufRead.getData()) && data < (char*)(m_bufRead.getData()) + m_bufRead.getSize()) {
+			input = m_bufRead;
+		}
+		
+		for (;;) {
+			
+			if (m_flagClosed) {
 				return;
 			}
-			m_contextCurrent = _context;
-			_context->setProcessingByThread(param.flagProcessByThreads);
-		}
-		HttpServiceContext* context = _context.get();
-		if (context->m_requestHeader.isEmpty()) {
-			sl_size posBody;
-			if (context->m_requestHeaderReader.add(data, size, posBody)) {
-				context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
-				if (context->m_requestHeader.isEmpty()) {
-					sendResponse_ServerError();
-					return;
-				}
-				if (posBody > size) {
+			
+			Ref<HttpServiceContext> _context = m_contextCurrent;
+			if (_context.isNull()) {
+				_context = _createContext();
+				if (_context.isNull()) {
 					sendResponse_ServerError();
 					return;
 				}
-				context->m_requestHeaderReader.clear();
-				Memory header = context->getRawRequestHeader();
-				sl_reg iRet = context->parseRequestPacket(header.getData(), header.getSize());
-				if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
-					sendResponse_BadRequest();
-					return;
+				m_contextCurrent = _context;
+				_context->setProcessingByThread(param.flagProcessByThreads);
+			}
+			HttpServiceContext* context = _context.get();
+			if (context->m_requestHeader.isEmpty()) {
+				sl_size posBody;
+				if (context->m_requestHeaderReader.add(data, size, posBody)) {
+					context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
+					if (context->m_requestHeader.isEmpty()) {
+						sendResponse_ServerError();
+						return;
+					}
+					if (posBody > size) {
+						sendResponse_ServerError();
+						return;
+					}
+					context->m_requestHeaderReader.clear();
+					Memory header = context->getRawRequestHeader();
+					sl_reg iRet = context->parseRequestPacket(header);
+					if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
+						sendResponse_BadRequest();
+						return;
+					}
+					if (param.flagUseHttp2) {
+						// "PRI * HTTP/2.0" of the connection preface: the client knows that HTTP/2 is supported
+						SLIB_STATIC_STRING(s_method, "PRI")
+						SLIB_STATIC_STRING(s_version, "HTTP/2.0")
+						if (context->getMethodText() == s_method && context->getRequestVersion() == s_version) {
+							m_contextCurrent.setNull();
+							_startHttp2(data + posBody, size - (sl_uint32)posBody);
+							return;
+						}
+					}
+					context->m_requestContentLength = context->getRequestContentLengthHeader();
+					if (context->m_requestContentLength > maxRequestBodySize) {
+						sendResponse_BadRequest();
+						return;
+					}
+					data += posBody;
+					size -= (sl_uint32)posBody;
+					sl_uint32 sizeBody = size;
+					if (sizeBody > context->m_requestContentLength) {
+						sizeBody = (sl_uint32)(context->m_requestContentLength);
+					}
+					context->m_requestBody = Memory::create(data, sizeBody);
+					if (!(context->m_requestBodyBuffer.add(context->m_requestBody))) {
+						sendResponse_ServerError();
+						return;
+					}
+					data += sizeBody;
+					size -= sizeBody;
+					context->applyQueryToParameters();
+					if (service->preprocessRequest(context)) {
+						return;
+					}
+				} else {
+					if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
+						sendResponse_BadRequest();
+						return;
+					}
+					size = 0;
 				}
-				context->m_requestContentLength = context->getRequestContentLengthHeader();
-				if (context->m_requestContentLength > maxRequestBodySize) {
-					sendResponse_BadRequest();
-					return;
+			} else {
+				sl_uint64 sizeRemain = context->m_requestContentLength - context->m_requestBodyBuffer.getSize();
+				sl_uint32 sizeBody = size;
+				if (sizeBody > sizeRemain) {
+					sizeBody = (sl_uint32)sizeRemain;
 				}
-				context->m_requestBody = Memory::create(data + posBody, size - (sl_uint32)posBody);
-				if (!(context->m_requestBodyBuffer.add(context->m_requestBody))) {
+				if (!(context->m_requestBodyBuffer.add(Memory::create(data, sizeBody)))) {
 					sendResponse_ServerError();
 					return;
 				}
-				context->applyQueryToParameters();
-				if (service->preprocessRequest(context)) {
-					return;
-				}
-			} else {
-				if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
-					sendResponse_BadRequest();
-					return;
-				}
+				data += sizeBody;
+				size -= sizeBody;
 			}
-		} else {
-			if (!(context->m_requestBodyBuffer.add(Memory::create(data, size)))) {
+			if (context->m_requestHeader.isEmpty() || context->m_requestBodyBuffer.getSize() < context->m_requestContentLength) {
+				break;
+			}
+
+			m_contextCurrent.setNull();
+
+			context->m_requestBody = context->m_requestBodyBuffer.merge();
+			if (context->m_requestContentLength > 0 && context->m_requestBody.isEmpty()) {
 				sendResponse_ServerError();
 				return;
 			}
-		}
-		if (context->m_requestHeader.isNotEmpty()) {
-			if (context->m_requestBodyBuffer.getSize() >= context->m_requestContentLength) {
-
-				m_contextCurrent.setNull();
+			context->m_requestBodyBuffer.clear();
 
-				context->m_requestBody = context->m_requestBodyBuffer.merge();
-				if (context->m_requestContentLength > 0 && context->m_requestBody.isEmpty()) {
-					sendResponse_ServerError();
-					return;
+			if (context->getMethod() == HttpMethod::POST) {
+				String reqContentType = context->getRequestContentTypeNoParams();
+				if (reqContentType == ContentTypes::WebForm) {
+					Memory body = context->getRequestBody();
+					context->applyPostParameters(body.getData(), body.getSize());
 				}
-				context->m_requestBodyBuffer.clear();
-
-				if (context->getMethod() == HttpMethod::POST) {
-					String reqContentType = context->getRequestContentTypeNoParams();
-					if (reqContentType == ContentTypes::WebForm) {
-						Memory body = context->getRequestBody();
-						context->applyPostParameters(body.getData(), body.getSize());
-					}
+			}
+			
+			if (param.flagUseHttp2) {
+				if (_upgradeHttp2(_context, data, size)) {
+					_read();
+					return;
 				}
-				
-				if (context->isProcessingByThread()) {
-					Ref<ThreadPool> threadPool = service->getThreadPool();
-					if (threadPool.isNotNull()) {
-						threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, this, _context));
+			}
+			
+			// the following requests are processed after the response is completed, so the responses are kept in order
+			{
+				ObjectLocker lock(this);
+				if (size > 0) {
+					char* base = (char*)(input.getData());
+					if (input.isNotNull() && data >= base && data + size <= base + input.getSize()) {
+						m_bufPending = input.sub(data - base, size);
 					} else {
-						sendResponse_ServerError();
-						return;
+						m_bufPending = Memory::create(data, size);
 					}
 				} else {
-					_processContext(context);
+					m_bufPending.setNull();
 				}
 			}
+			
+			if (context->isProcessingByThread()) {
+				Ref<ThreadPool> threadPool = service->getThreadPool();
+				if (threadPool.isNotNull()) {
+					threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, this, _context));
+				} else {
+					sendResponse_ServerError();
+				}
+				return;
+			}
+			
+			{
+				ObjectLocker lock(this);
+				m_flagProcessingInline = sl_true;
+				m_flagCompletedInline = sl_false;
+			}
+			_processContext(context);
+			{
+				ObjectLocker lock(this);
+				m_flagProcessingInline = sl_false;
+				if (!m_flagCompletedInline) {
+					// asynchronous response: `start()` will process the pending input
+					return;
+				}
+				input = m_bufPending;
+				m_bufPending.setNull();
+			}
+			if (input.isNull()) {
+				break;
+			}
+			data = (char*)(input.getData());
+			size = (sl_uint32)(input.getSize());
 		}
 		_read();
 	}
@@ -363,7 +510,12 @@ namespace slib
 			return;
 		}
 		if (context->getMethod() == HttpMethod::CONNECT) {
-			sendConnectResponse_Failed();
+			if (context->getStreamId()) {
+				context->setResponseCode(HttpStatus::NotImplemented);
+				context->completeResponse();
+			} else {
+				sendConnectResponse_Failed();
+			}
 			return;
 		}
 		service->processRequest(context.get());
@@ -374,6 +526,13 @@ namespace slib
 
 	void HttpServiceConnection::_completeResponse(HttpServiceContext* context)
 	{
+		if (context->m_streamId) {
+			Ref<_Http2ServiceSession> http2 = m_http2;
+			if (http2.isNotNull()) {
+				http2->completeResponse(context);
+			}
+			return;
+		}
 		context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(context->getResponseContentLength()));
 		String oldResponseContentType = context->getResponseContentType();
 		if (oldResponseContentType.isEmpty()) {
@@ -393,6 +552,73 @@ namespace slib
 		start();
 	}
 
+	void HttpServiceConnection::_startHttp2(const void* data, sl_uint32 size)
+	{
+		// "SM\r\n\r\n" is left in the preface
+		Ref<_Http2ServiceSession> http2 = _Http2ServiceSession::create(this, SLIB_HTTP2_CONNECTION_PREFACE_SIZE - 6);
+		if (http2.isNull()) {
+			close();
+			return;
+		}
+		m_http2 = http2;
+		http2->start();
+		if (size > 0) {
+			http2->processInput(data, size);
+		}
+		_read();
+	}
+
+	sl_bool HttpServiceConnection::_upgradeHttp2(const Ref<HttpServiceContext>& context, const void* data, sl_uint32 size)
+	{
+		String upgrade = context->getRequestHeader(HttpHeaders::Upgrade);
+		if (upgrade.isEmpty()) {
+			return sl_false;
+		}
+		sl_bool flagH2C = sl_false;
+		ListElements<String> protocols(upgrade.split(","));
+		for (sl_size i = 0; i < protocols.count; i++) {
+			if (protocols[i].trim().equalsIgnoreCase("h2c")) {
+				flagH2C = sl_true;
+				break;
+			}
+		}
+		if (!flagH2C) {
+			return sl_false;
+		}
+		List<String> listSettings = context->getRequestHeaderValues(HttpHeaders::HTTP2Settings);
+		if (listSettings.getCount() != 1) {
+			return sl_false;
+		}
+		// base64url without padding
+		String strSettings = listSettings.getValueAt(0).trim().replaceAll("-", "+").replaceAll("_", "/");
+		sl_size lenSettings = strSettings.getLength();
+		if (lenSettings & 3) {
+			strSettings += String('=', 4 - (lenSettings & 3));
+		}
+		Memory settings;
+		if (lenSettings) {
+			settings = Base64::decode(strSettings);
+			if (settings.isNull()) {
+				return sl_false;
+			}
+		}
+		Ref<_Http2ServiceSession> http2 = _Http2ServiceSession::create(this, 0);
+		if (http2.isNull()) {
+			return sl_false;
+		}
+		SLIB_STATIC_STRING(s, "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n");
+		if (!(m_output->write(Memory::create(s.getData(), s.getLength())))) {
+			return sl_false;
+		}
+		m_http2 = http2;
+		m_contextLast.setNull();
+		http2->startUpgrade(context, settings);
+		if (size > 0) {
+			http2->processInput(data, size);
+		}
+		return sl_true;
+	}
+
 	void HttpServiceConnection::onReadStream(AsyncStreamResult* result)
 	{
 		m_flagReading = sl_false;
@@ -405,6 +631,10 @@ namespace slib
 
 	void HttpServiceConnection::onAsyncOutputComplete(AsyncOutput* output)
 	{
+		Ref<_Http2ServiceSession> http2 = m_http2;
+		if (http2.isNotNull()) {
+			http2->onOutputComplete();
+		}
 	}
 
 	void HttpServiceConnection::onAsyncOutputError(AsyncOutput* output)
@@ -518,12 +748,14 @@ namespace slib
 	class _DefaultHttpServiceConnectionProvider : public HttpServiceConnectionProvider, public IAsyncTcpServerListener
 	{
 	public:
-		Ref<AsyncTcpServer> m_server;
-		Ref<AsyncIoLoop> m_loop;
+		List< Ref<AsyncTcpServer> > m_servers;
+		List< Ref<AsyncIoLoop> > m_loops;
+		sl_int32 m_indexLoopNext;
 
 	public:
 		_DefaultHttpServiceConnectionProvider()
 		{
+			m_indexLoopNext = 0;
 		}
 
 		~_DefaultHttpServiceConnectionProvider()
@@ -534,19 +766,40 @@ namespace slib
 	public:
 		static Ref<HttpServiceConnectionProvider> create(HttpService* service, const SocketAddress& addressListen)
 		{
-			Ref<AsyncIoLoop> loop = service->getAsyncIoLoop();
-			if (loop.isNotNull()) {
+			List< Ref<AsyncIoLoop> > loops = service->getAsyncIoLoops();
+			sl_size nLoops = loops.getCount();
+			if (nLoops > 0) {
 				Ref<_DefaultHttpServiceConnectionProvider> ret = new _DefaultHttpServiceConnectionProvider;
 				if (ret.isNotNull()) {
-					ret->m_loop = loop;
+					ret->m_loops = loops;
 					ret->setService(service);
-					AsyncTcpServerParam sp;
-					sp.bindAddress = addressListen;
-					sp.listener.setWeak(ret);
-					sp.ioLoop = loop;
-					Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
-					if (server.isNotNull()) {
-						ret->m_server = server;
+					ListElements< Ref<AsyncIoLoop> > listLoops(loops);
+					for (sl_size i = 0; i < listLoops.count; i++) {
+						AsyncTcpServerParam sp;
+						sp.bindAddress = addressListen;
+						sp.listener.setWeak(ret);
+						sp.ioLoop = listLoops[i];
+						// every loop listens on the same port, and the kernel distributes the incoming connections
+						sp.flagReusePort = nLoops > 1;
+						if (sp.flagReusePort) {
+							sp.flagLogError = sl_false;
+						}
+						Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
+						if (server.isNull()) {
+							if (i == 0) {
+								// SO_REUSEPORT is not supported: the first listener distributes the connections to the loops in turn
+								sp.flagReusePort = sl_false;
+								sp.flagLogError = sl_true;
+								server = AsyncTcpServer::create(sp);
+								if (server.isNotNull()) {
+									ret->m_servers.add(server);
+								}
+							}
+							break;
+						}
+						ret->m_servers.add(server);
+					}
+					if (ret->m_servers.getCount() > 0) {
 						return ret;
 					}
 				}
@@ -557,8 +810,9 @@ namespace slib
 		void release()
 		{
 			ObjectLocker lock(this);
-			if (m_server.isNotNull()) {
-				m_server->close();
+			ListElements< Ref<AsyncTcpServer> > servers(m_servers);
+			for (sl_size i = 0; i < servers.count; i++) {
+				servers[i]->close();
 			}
 		}
 
@@ -566,7 +820,15 @@ namespace slib
 		{
 			Ref<HttpService> service = getService();
 			if (service.isNotNull()) {
-				Ref<AsyncIoLoop> loop = m_loop;
+				Ref<AsyncIoLoop> loop;
+				sl_size nLoops = m_loops.getCount();
+				if (m_servers.getCount() == nLoops) {
+					loop = socketListen->getIoLoop();
+				} else if (nLoops > 0) {
+					// several listeners may accept at the same time
+					sl_uint32 index = (sl_uint32)(Base::interlockedIncrement32(&m_indexLoopNext)) - 1;
+					loop = m_loops.getValueAt(index % nLoops);
+				}
 				if (loop.isNull()) {
 					return;
 				}
@@ -604,6 +866,8 @@ namespace slib
 	{
 		port = 80;
 		
+		ioLoopsCount = 1;
+		
 		maxThreadsCount = 32;
 		flagProcessByThreads = sl_true;
 		
@@ -615,6 +879,11 @@ namespace slib
 		flagAllowCrossOrigin = sl_false;
 		flagAlwaysRespondAcceptRangesHeader = sl_true;
 		
+		flagUseSendFile = sl_true;
+		
+		flagUseHttp2 = sl_true;
+		http2MaxConcurrentStreams = 100;
+		
 		flagLogDebug = sl_false;
 	}
 
@@ -639,7 +908,19 @@ namespace slib
 
 	sl_bool HttpService::_init(const HttpServiceParam& param)
 	{
-		Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create(sl_false);
+		sl_uint32 nLoops = param.ioLoopsCount;
+		if (nLoops == 0) {
+			nLoops = System::getProcessorsCount();
+		}
+		for (sl_uint32 i = 0; i < nLoops; i++) {
+			Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create(sl_false);
+			if (ioLoop.isNull()) {
+				return sl_false;
+			}
+			m_ioLoops.add(ioLoop);
+			m_connectionTables.add(Map< HttpServiceConnection*, Ref<HttpServiceConnection> >::createHash());
+		}
+		Ref<AsyncIoLoop> ioLoop = m_ioLoops.getValueAt(0);
 		if (ioLoop.isNotNull()) {
 			Ref<ThreadPool> threadPool = ThreadPool::create();
 			if (threadPool.isNotNull()) {
@@ -657,7 +938,10 @@ namespace slib
 					addProcessor(param.processor);
 				}
 				
-				ioLoop->start();
+				ListLocker< Ref<AsyncIoLoop> > loops(m_ioLoops);
+				for (sl_size i = 0; i < loops.count; i++) {
+					loops[i]->start();
+				}
 
 				return sl_true;
 			}
@@ -694,18 +978,26 @@ namespace slib
 		}
 		m_connectionProviders.removeAll();
 		
-		Ref<AsyncIoLoop> ioLoop = m_ioLoop;
-		if (ioLoop.isNotNull()) {
-			ioLoop->release();
-			m_ioLoop.setNull();
+		{
+			ListLocker< Ref<AsyncIoLoop> > loops(m_ioLoops);
+			for (sl_size i = 0; i < loops.count; i++) {
+				loops[i]->release();
+			}
 		}
+		m_ioLoop.setNull();
+		
 		Ref<ThreadPool> threadPool = m_threadPool;
 		if (threadPool.isNotNull()) {
 			threadPool->release();
 			m_threadPool.setNull();
 		}
 		
-		m_connections.removeAll();
+		{
+			ListLocker< Map< HttpServiceConnection*, Ref<HttpServiceConnection> > > tables(m_connectionTables);
+			for (sl_size i = 0; i < tables.count; i++) {
+				tables[i].removeAll();
+			}
+		}
 	}
 
 	sl_bool HttpService::isRunning()
@@ -718,6 +1010,11 @@ namespace slib
 		return m_ioLoop;
 	}
 
+	List< Ref<AsyncIoLoop> > HttpService::getAsyncIoLoops()
+	{
+		return m_ioLoops.duplicate();
+	}
+
 	Ref<ThreadPool> HttpService::getThreadPool()
 	{
 		return m_threadPool;
@@ -851,6 +1148,15 @@ namespace slib
 			}
 
 			context->setResponseAcceptRanges(sl_true);
+			
+			sl_bool flagSendFile = sl_false;
+			// HTTP/2 frames the bodies, so they are read into the user space
+			if (m_param.flagUseSendFile && !(context->getStreamId())) {
+				Ref<AsyncStream> io = context->getIO();
+				if (io.isNotNull()) {
+					flagSendFile = io->isSendFileSupported();
+				}
+			}
 
 			String rangeHeader = context->getRequestRange();
 			
@@ -861,7 +1167,7 @@ namespace slib
 				
 				if (processRangeRequest(context, totalSize, rangeHeader, start, len)) {
 
-					Ref<AsyncFile> file = AsyncFile::openForRead(path, m_threadPool);
+					Ref<AsyncStream> file = openFile(context, path, flagSendFile);
 					if (file.isNotNull()) {
 						file->seek(start);
 						context->copyFrom(file.get(), len);
@@ -873,9 +1179,12 @@ namespace slib
 				}
 				
 			} else {
-				if (totalSize > 100000) {
-					context->copyFromFile(path, m_threadPool);
-					return sl_true;
+				if (flagSendFile || totalSize > 100000) {
+					Ref<AsyncStream> file = openFile(context, path, flagSendFile);
+					if (file.isNotNull()) {
+						context->copyFrom(file.get(), totalSize);
+						return sl_true;
+					}
 				} else {
 					Memory mem = File::readAllBytes(path);
 					if (mem.isNotEmpty()) {
@@ -891,6 +1200,21 @@ namespace slib
 		
 	}
 
+	Ref<AsyncStream> HttpService::openFile(const Ref<HttpServiceContext>& context, const String& path, sl_bool flagSendFile)
+	{
+		// file bodies are sent by sendfile() only if they are read by `AsyncFile`
+		if (!flagSendFile) {
+			Ref<AsyncIoLoop> loop = context->getAsyncIoLoop();
+			if (loop.isNotNull() && loop->isUsingIoUring()) {
+				Ref<AsyncStream> file = AsyncFile::openIoUring(path, FileMode::Read, loop);
+				if (file.isNotNull()) {
+					return file;
+				}
+			}
+		}
+		return AsyncFile::openForRead(path, m_threadPool);
+	}
+
 	sl_bool HttpService::processRangeRequest(const Ref<HttpServiceContext>& context, sl_uint64 totalLength, const String& range, sl_uint64& outStart, sl_uint64& outLength)
 	{
 		if (range.getLength() < 2 || !(range.startsWith("bytes="))) {
@@ -918,7 +1242,7 @@ namespace slib
 				return sl_false;
 			}
 		}
-		if (indexSplit == 0) {
+		if (s1.isEmpty()) {
 			if (n2 == 0) {
 				context->setResponseCode(HttpStatus::NoContent);
 				return sl_false;
@@ -929,7 +1253,7 @@ namespace slib
 				return sl_false;
 			}
 			outStart = totalLength - n2;
-			outLength = totalLength - 1;
+			outLength = n2;
 		} else {
 			if (n1 >= totalLength) {
 				context->setResponseCode(HttpStatus::RequestRangeNotSatisfiable);
@@ -979,7 +1303,7 @@ namespace slib
 			}
 			connection->setRemoteAddress(remoteAddress);
 			connection->setLocalAddress(localAddress);
-			m_connections.put(connection.get(), connection);
+			_getConnectionTable(connection.get()).put(connection.get(), connection);
 			connection->start();
 		}
 		return connection;
@@ -990,7 +1314,24 @@ namespace slib
 		if (m_param.flagLogDebug) {
 			Log(SERVICE_TAG, "[%s] Connection Closed", String::fromPointerValue(connection));
 		}
-		m_connections.remove(connection);
+		_getConnectionTable(connection).remove(connection);
+	}
+
+	Map< HttpServiceConnection*, Ref<HttpServiceConnection> > HttpService::_getConnectionTable(HttpServiceConnection* connection)
+	{
+		ListLocker< Ref<AsyncIoLoop> > loops(m_ioLoops);
+		if (loops.count > 1) {
+			Ref<AsyncStream> io = connection->getIO();
+			if (io.isNotNull()) {
+				Ref<AsyncIoLoop> loop = io->getIoLoop();
+				for (sl_size i = 0; i < loops.count; i++) {
+					if (loops[i] == loop) {
+						return m_connectionTables.getValueAt(i);
+					}
+				}
+			}
+		}
+		return m_connectionTables.getValueAt(0);
 	}
 
 	void HttpService::addProcessor(const Ptr<IHttpServiceProcessor>& processor)
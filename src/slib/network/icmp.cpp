@@ -61,7 +61,7 @@ namespace slib
 
 	sl_bool IcmpHeaderFormat::check(sl_uint32 sizeContent) const
 	{
-		if (sizeContent < sizeof(IcmpHeaderFormat)) {
+		if (!(checkSize(sizeContent))) {
 			return sl_false;
 		}
 		if (!(checkChecksum(sizeContent))) {
@@ -70,6 +70,14 @@ namespace slib
 		return sl_true;
 	}
 
+	sl_bool IcmpHeaderFormat::checkSize(sl_uint32 sizeContent) const
+	{
+		if (sizeContent < sizeof(IcmpHeaderFormat)) {
+			return sl_false;
+		}
+		return sl_true;
+	}
+
 	sl_uint16 IcmpHeaderFormat::getEchoIdentifier() const
 	{
 		return MIO::readUint16BE(_rest);
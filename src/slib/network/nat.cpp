@@ -11,6 +11,7 @@
 #include "../../../inc/slib/network/nat.h"
 
 #include "../../../inc/slib/core/new_helper.h"
+#include "../../../inc/slib/core/system.h"
 
 namespace slib
 {
@@ -26,6 +27,9 @@ namespace slib
 		udpPortEnd = 60000;
 
 		icmpEchoIdentifier = 30000;
+
+		tcpMappingTimeout = 7440000;
+		udpMappingTimeout = 300000;
 	}
 
 	NatTableParam::~NatTableParam()
@@ -50,8 +54,68 @@ namespace slib
 	{
 		ObjectLocker lock(this);
 		m_param = param;
-		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd);
-		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd);
+		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd, param.tcpMappingTimeout);
+		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd, param.udpMappingTimeout);
+	}
+
+	// rewrites the source or destination address of the IPv4 header, and adjusts the checksums of the header and the transport layer (covering the pseudo header)
+	static sl_uint16 _NatTable_setAddress(IPv4Packet* ipHeader, sl_bool flagSource, const IPv4Address& address, sl_uint16 checksumContent)
+	{
+		IPv4Address addressOld;
+		if (flagSource) {
+			addressOld = ipHeader->getSourceAddress();
+			ipHeader->setSourceAddress(address);
+		} else {
+			addressOld = ipHeader->getDestinationAddress();
+			ipHeader->setDestinationAddress(address);
+		}
+		ipHeader->setChecksum(TCP_IP::adjustChecksum(ipHeader->getChecksum(), addressOld, address));
+		return TCP_IP::adjustChecksum(checksumContent, addressOld, address);
+	}
+
+	static void _NatTable_translateTcp(IPv4Packet* ipHeader, TcpSegment* tcp, sl_bool flagSource, const IPv4Address& address, sl_uint16 port)
+	{
+		sl_uint16 checksum = _NatTable_setAddress(ipHeader, flagSource, address, tcp->getChecksum());
+		sl_uint16 portOld;
+		if (flagSource) {
+			portOld = tcp->getSourcePort();
+			tcp->setSourcePort(port);
+		} else {
+			portOld = tcp->getDestinationPort();
+			tcp->setDestinationPort(port);
+		}
+		tcp->setChecksum(TCP_IP::adjustChecksum(checksum, portOld, port));
+	}
+
+	static void _NatTable_translateUdp(IPv4Packet* ipHeader, UdpDatagram* udp, sl_bool flagSource, const IPv4Address& address, sl_uint16 port)
+	{
+		sl_uint16 checksum = _NatTable_setAddress(ipHeader, flagSource, address, udp->getChecksum());
+		sl_uint16 portOld;
+		if (flagSource) {
+			portOld = udp->getSourcePort();
+			udp->setSourcePort(port);
+		} else {
+			portOld = udp->getDestinationPort();
+			udp->setDestinationPort(port);
+		}
+		// zero checksum means the checksum is not used
+		if (udp->getChecksum()) {
+			checksum = TCP_IP::adjustChecksum(checksum, portOld, port);
+			if (checksum == 0) {
+				checksum = 0xFFFF;
+			}
+			udp->setChecksum(checksum);
+		}
+	}
+
+	static void _NatTable_translateIcmpEcho(IcmpHeaderFormat* icmp, sl_uint16 identifier, sl_uint16 sequenceNumber)
+	{
+		sl_uint16 checksum = icmp->getChecksum();
+		checksum = TCP_IP::adjustChecksum(checksum, icmp->getEchoIdentifier(), identifier);
+		checksum = TCP_IP::adjustChecksum(checksum, icmp->getEchoSequenceNumber(), sequenceNumber);
+		icmp->setEchoIdentifier(identifier);
+		icmp->setEchoSequenceNumber(sequenceNumber);
+		icmp->setChecksum(checksum);
 	}
 
 	sl_bool NatTable::translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent)
@@ -62,42 +126,33 @@ namespace slib
 		}
 		if (ipHeader->isTCP()) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (tcp->checkSize(sizeContent)) {
 				sl_uint16 targetPort;
 				if (m_mappingTcp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), tcp->getSourcePort()), targetPort)) {
-					tcp->setSourcePort(targetPort);
-					ipHeader->setSourceAddress(addressTarget);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					_NatTable_translateTcp(ipHeader, tcp, sl_true, addressTarget, targetPort);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isUDP()) {
 			UdpDatagram* udp = (UdpDatagram*)(ipContent);
-			if (udp->check(ipHeader, sizeContent)) {
+			if (udp->checkSize(sizeContent)) {
 				sl_uint16 targetPort;
 				if (m_mappingUdp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), udp->getSourcePort()), targetPort)) {
-					udp->setSourcePort(targetPort);
-					ipHeader->setSourceAddress(addressTarget);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					_NatTable_translateUdp(ipHeader, udp, sl_true, addressTarget, targetPort);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isICMP()) {
 			IcmpHeaderFormat* icmp = (IcmpHeaderFormat*)(ipContent);
-			if (icmp->check(sizeContent)) {
+			if (icmp->checkSize(sizeContent)) {
 				if (icmp->getType() == IcmpType::Echo) {
 					IcmpEchoAddress address;
 					address.ip = ipHeader->getSourceAddress();
 					address.identifier = icmp->getEchoIdentifier();
 					address.sequenceNumber = icmp->getEchoSequenceNumber();
 					sl_uint16 sn = getMappedIcmpEchoSequenceNumber(address);
-					icmp->setEchoIdentifier(m_param.icmpEchoIdentifier);
-					icmp->setEchoSequenceNumber(sn);
-					ipHeader->setSourceAddress(addressTarget);
-					icmp->updateChecksum(sizeContent);
-					ipHeader->updateChecksum();
+					_NatTable_translateIcmpEcho(icmp, m_param.icmpEchoIdentifier, sn);
+					_NatTable_setAddress(ipHeader, sl_true, addressTarget, 0);
 					return sl_true;
 				}
 			}
@@ -116,45 +171,42 @@ namespace slib
 		}
 		if (ipHeader->isTCP()) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (tcp->checkSize(sizeContent)) {
 				SocketAddress addressSource;
 				if (m_mappingTcp.mapToInternalAddress(tcp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
-					tcp->setDestinationPort(addressSource.port);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					_NatTable_translateTcp(ipHeader, tcp, sl_false, addressSource.ip.getIPv4(), addressSource.port);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isUDP()) {
-			UdpDatagram* udp = (UdpDatagram*)(ipHeader->getContent());
-			if (udp->check(ipHeader, sizeContent)) {
+			UdpDatagram* udp = (UdpDatagram*)(ipContent);
+			if (udp->checkSize(sizeContent)) {
 				SocketAddress addressSource;
 				if (m_mappingUdp.mapToInternalAddress(udp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
-					udp->setDestinationPort(addressSource.port);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					_NatTable_translateUdp(ipHeader, udp, sl_false, addressSource.ip.getIPv4(), addressSource.port);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isICMP()) {
 			IcmpHeaderFormat* icmp = (IcmpHeaderFormat*)(ipContent);
-			if (icmp->check(sizeContent)) {
+			if (icmp->checkSize(sizeContent)) {
 				IcmpType type = icmp->getType();
 				if (type == IcmpType::EchoReply) {
 					if (icmp->getEchoIdentifier() == m_param.icmpEchoIdentifier) {
 						IcmpEchoElement element;
-						if (m_mapIcmpEchoIncoming.get(icmp->getEchoSequenceNumber(), &element)) {
-							ipHeader->setDestinationAddress(element.addressSource.ip);
-							icmp->setEchoIdentifier(element.addressSource.identifier);
-							icmp->setEchoSequenceNumber(element.addressSource.sequenceNumber);
-							icmp->updateChecksum(sizeContent);
-							ipHeader->updateChecksum();
+						sl_bool flagFound;
+						{
+							SpinLocker lock(&m_lockIcmpEcho);
+							flagFound = m_mapIcmpEchoIncoming.get_NoLock(icmp->getEchoSequenceNumber(), &element);
+						}
+						if (flagFound) {
+							_NatTable_translateIcmpEcho(icmp, element.addressSource.identifier, element.addressSource.sequenceNumber);
+							_NatTable_setAddress(ipHeader, sl_false, element.addressSource.ip, 0);
 							return sl_true;
 						}
 					}
 				} else if (type == IcmpType::DestinationUnreachable || type == IcmpType::TimeExceeded) {
+					// the error messages are small, so the checksums are calculated again
 					IPv4Packet* ipOrig = (IPv4Packet*)(icmp->getContent());
 					sl_uint32 sizeOrig = sizeContent - sizeof(IcmpHeaderFormat);
 					if (sizeOrig == sizeof(IPv4Packet)+8 && IPv4Packet::checkHeader(ipOrig, sizeOrig) && ipOrig->getDestinationAddress() == addressTarget) {
@@ -193,39 +245,58 @@ namespace slib
 
 	sl_uint16 NatTable::getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address)
 	{
+		SpinLocker lock(&m_lockIcmpEcho);
 		IcmpEchoElement element;
-		if (m_mapIcmpEchoOutgoing.get(address, &element)) {
+		if (m_mapIcmpEchoOutgoing.get_NoLock(address, &element)) {
 			return element.sequenceNumberTarget;
 		}
 		sl_uint16 sn = ++ m_icmpEchoSequenceCurrent;
-		if (m_mapIcmpEchoIncoming.get(sn, &element)) {
-			m_mapIcmpEchoOutgoing.removeItems(element.addressSource);
+		if (m_mapIcmpEchoIncoming.get_NoLock(sn, &element)) {
+			m_mapIcmpEchoOutgoing.removeItems_NoLock(element.addressSource);
 		}
 		element.addressSource = address;
 		element.sequenceNumberTarget = sn;
-		m_mapIcmpEchoOutgoing.put(address, element);
-		m_mapIcmpEchoIncoming.put(sn, element);
+		m_mapIcmpEchoOutgoing.put_NoLock(address, element);
+		m_mapIcmpEchoIncoming.put_NoLock(sn, element);
 		return sn;
 	}
 
+	void NatTable::removeExpiredMappings()
+	{
+		m_mappingTcp.removeExpiredPorts();
+		m_mappingUdp.removeExpiredPorts();
+	}
+
 	_NatTablePort::_NatTablePort()
 	{
 		flagActive = sl_false;
-		timeLastAccess.setZero();
+		timeLastAccess = 0;
 	}
 
 	_NatTablePort::~_NatTablePort()
 	{
 	}
 
+	_NatTableMappingShard::_NatTableMappingShard()
+	{
+		nPorts = 0;
+		pos = 0;
+	}
+
+	_NatTableMappingShard::~_NatTableMappingShard()
+	{
+	}
+
 	_NatTableMapping::_NatTableMapping()
 	{
 		m_ports = sl_null;
 		m_nPorts = 0;
-		m_pos = 0;
 
 		m_portBegin = 0;
 		m_portEnd = 0;
+		m_timeout = 0;
+
+		m_nShards = 0;
 	}
 
 	_NatTableMapping::~_NatTableMapping()
@@ -233,82 +304,108 @@ namespace slib
 		NewHelper<_NatTablePort>::free(m_ports, m_nPorts);
 	}
 
-	void _NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd)
+	void _NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 timeout)
 	{
 		ObjectLocker lock(this);
 
-		m_mapPorts.removeAll_NoLock();
+		for (sl_uint32 i = 0; i < SLIB_NAT_TABLE_SHARDS_COUNT; i++) {
+			_NatTableMappingShard& shard = m_shards[i];
+			shard.mapPorts.removeAll_NoLock();
+			shard.nPorts = 0;
+			shard.pos = 0;
+		}
+		m_nShards = 0;
 
 		if (m_ports) {
 			NewHelper<_NatTablePort>::free(m_ports, m_nPorts);
 			m_ports = sl_null;
 		}
-		m_pos = 0;
 		m_nPorts = 0;
 
 		m_portBegin = portBegin;
 		m_portEnd = portEnd;
+		m_timeout = timeout;
 		if (portEnd >= portBegin) {
-			m_nPorts = portEnd - portBegin + 1;
-			m_ports = NewHelper<_NatTablePort>::create(m_nPorts);
+			sl_uint32 nPorts = (sl_uint32)(portEnd - portBegin) + 1;
+			m_ports = NewHelper<_NatTablePort>::create(nPorts);
+			if (m_ports) {
+				m_nPorts = nPorts;
+				sl_uint32 nShards = SLIB_NAT_TABLE_SHARDS_COUNT;
+				if (nShards > nPorts) {
+					nShards = nPorts;
+				}
+				for (sl_uint32 i = 0; i < nShards; i++) {
+					m_shards[i].nPorts = (nPorts - i + nShards - 1) / nShards;
+				}
+				m_nShards = nShards;
+			}
 		}
 	}
 
-	sl_bool _NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& _port)
+	sl_bool _NatTableMapping::_isExpired(_NatTablePort& port, sl_uint32 now)
 	{
-		ObjectLocker lock(this);
+		return m_timeout && (sl_uint32)(now - port.timeLastAccess) >= m_timeout;
+	}
 
-		if (!m_ports) {
-			return sl_false;
-		}
-		sl_uint32 n = m_nPorts;
-		if (!n) {
+	sl_bool _NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& _port)
+	{
+		sl_uint32 nShards = m_nShards;
+		if (!nShards) {
 			return sl_false;
 		}
+		sl_uint32 indexShard = address.hashCode() % nShards;
+		_NatTableMappingShard& shard = m_shards[indexShard];
+		sl_uint32 now = System::getTickCount();
+
+		SpinLocker lock(&(shard.lock));
 
 		sl_uint16 port;
-		if (m_mapPorts.get_NoLock(address, &port)) {
-			if (port >= m_portBegin && port <= m_portEnd) {
-				m_ports[port - m_portBegin].timeLastAccess = Time::now();
+		if (shard.mapPorts.get_NoLock(address, &port)) {
+			_NatTablePort& entry = m_ports[port - m_portBegin];
+			if (!(_isExpired(entry, now))) {
+				entry.timeLastAccess = now;
 				_port = port;
 				return sl_true;
-			} else {
-				m_mapPorts.remove_NoLock(address);
 			}
+			entry.flagActive = sl_false;
+			shard.mapPorts.remove_NoLock(address);
 		}
 
-		sl_uint16 pos = m_pos;
-		n *= 2;
-		sl_int64 timeAccessMin = 0;
-		sl_int64 timeAccessMax = 0;
-		for (sl_uint32 i = 0; i < n; i++) {
-			if (!(m_ports[pos].flagActive)) {
-				port = pos + m_portBegin;
-				m_ports[pos].flagActive = sl_true;
-				m_ports[pos].addressSource = address;
-				m_ports[pos].timeLastAccess = Time::now();
-				m_mapPorts.put_NoLock(address, port);
+		sl_uint32 n = shard.nPorts;
+		sl_uint32 pos = shard.pos;
+		sl_uint32 ageMax = 0;
+		for (sl_uint32 i = 0; i < n * 2; i++) {
+			sl_uint32 index = pos * nShards + indexShard;
+			_NatTablePort& entry = m_ports[index];
+			sl_bool flagFree = !(entry.flagActive);
+			if (!flagFree && _isExpired(entry, now)) {
+				shard.mapPorts.remove_NoLock(entry.addressSource);
+				flagFree = sl_true;
+			}
+			if (flagFree) {
+				port = (sl_uint16)(index + m_portBegin);
+				entry.flagActive = sl_true;
+				entry.addressSource = address;
+				entry.timeLastAccess = now;
+				shard.mapPorts.put_NoLock(address, port);
 				_port = port;
-				m_pos = (pos + 1) % m_nPorts;
+				shard.pos = (pos + 1) % n;
 				return sl_true;
 			} else {
-				sl_int64 t = m_ports[pos].timeLastAccess.toInt();
-				if (t > timeAccessMax) {
-					timeAccessMax = t;
-				}
-				if (timeAccessMin == 0 || t < timeAccessMin) {
-					timeAccessMin = t;
+				sl_uint32 age = now - entry.timeLastAccess;
+				if (age > ageMax) {
+					ageMax = age;
 				}
 			}
-			pos = (pos + 1) % m_nPorts;
-			if (i == m_nPorts) {
-				sl_int64 mid = (timeAccessMin + timeAccessMax) / 2;
-				for (sl_uint16 k = 0; k < m_nPorts; k++) {
-					if (m_ports[k].flagActive) {
-						if (m_ports[k].timeLastAccess.toInt() <= mid) {
-							m_ports[k].flagActive = sl_false;
-							m_mapPorts.remove_NoLock(m_ports[k].addressSource);
-						}
+			pos = (pos + 1) % n;
+			if (i + 1 == n) {
+				// all ports of the shard are in use: releases the older half
+				sl_uint32 ageMid = ageMax / 2;
+				for (sl_uint32 k = 0; k < n; k++) {
+					_NatTablePort& item = m_ports[k * nShards + indexShard];
+					if (item.flagActive && (sl_uint32)(now - item.timeLastAccess) >= ageMid) {
+						item.flagActive = sl_false;
+						shard.mapPorts.remove_NoLock(item.addressSource);
 					}
 				}
 			}
@@ -318,22 +415,44 @@ namespace slib
 
 	sl_bool _NatTableMapping::mapToInternalAddress(sl_uint16 port, SocketAddress& address)
 	{
-		ObjectLocker lock(this);
-		if (!m_ports) {
-			return sl_false;
-		}
-		if (!m_nPorts) {
+		sl_uint32 nShards = m_nShards;
+		if (!nShards) {
 			return sl_false;
 		}
 		if (port >= m_portBegin && port <= m_portEnd) {
-			sl_uint32 k = port - m_portBegin;
-			if (m_ports[k].flagActive) {
-				m_ports[k].timeLastAccess = Time::now();
-				address = m_ports[k].addressSource;
+			sl_uint32 index = port - m_portBegin;
+			_NatTableMappingShard& shard = m_shards[index % nShards];
+			sl_uint32 now = System::getTickCount();
+			SpinLocker lock(&(shard.lock));
+			_NatTablePort& entry = m_ports[index];
+			if (entry.flagActive && !(_isExpired(entry, now))) {
+				entry.timeLastAccess = now;
+				address = entry.addressSource;
 				return sl_true;
 			}
 		}
 		return sl_false;
 	}
+
+	void _NatTableMapping::removeExpiredPorts()
+	{
+		if (!m_timeout) {
+			return;
+		}
+		sl_uint32 nShards = m_nShards;
+		for (sl_uint32 indexShard = 0; indexShard < nShards; indexShard++) {
+			_NatTableMappingShard& shard = m_shards[indexShard];
+			sl_uint32 now = System::getTickCount();
+			SpinLocker lock(&(shard.lock));
+			sl_uint32 n = shard.nPorts;
+			for (sl_uint32 k = 0; k < n; k++) {
+				_NatTablePort& entry = m_ports[k * nShards + indexShard];
+				if (entry.flagActive && _isExpired(entry, now)) {
+					entry.flagActive = sl_false;
+					shard.mapPorts.remove_NoLock(entry.addressSource);
+				}
+			}
+		}
+	}
 	
 }
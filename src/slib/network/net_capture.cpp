@@ -19,6 +19,16 @@
 #include "../../../inc/slib/network/tcpip.h"
 #include "../../../inc/slib/network/ethernet.h"
 
+#if defined(SLIB_PLATFORM_IS_LINUX)
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
 #define TAG "NetCapture"
 
 #define MAX_PACKET_SIZE 65535
@@ -41,6 +51,14 @@ namespace slib
 	{
 	}
 	
+	NetCaptureStatistics::NetCaptureStatistics(): countPackets(0), sizePackets(0), countDropped(0)
+	{
+	}
+	
+	NetCaptureStatistics::~NetCaptureStatistics()
+	{
+	}
+	
 	INetCaptureListener::INetCaptureListener()
 	{
 	}
@@ -48,6 +66,13 @@ namespace slib
 	INetCaptureListener::~INetCaptureListener()
 	{
 	}
+	
+	void INetCaptureListener::onCapturePackets(NetCapture* capture, NetCapturePacket* packets, sl_uint32 count)
+	{
+		for (sl_uint32 i = 0; i < count; i++) {
+			onCapturePacket(capture, packets + i);
+		}
+	}
 
 	NetCaptureParam::NetCaptureParam()
 	{
@@ -57,6 +82,11 @@ namespace slib
 		
 		preferedLinkDeviceType = NetworkLinkDeviceType::Ethernet;
 		
+		sizeRingBlock = 0x100000; // 1MB
+		countRingBlocks = 64;
+		timeoutRingBlock = 10;
+		countFanoutThreads = 1;
+		
 		flagAutoStart = sl_true;
 	}
 	
@@ -69,6 +99,8 @@ namespace slib
 	
 	NetCapture::NetCapture()
 	{
+		m_countPackets = 0;
+		m_sizePackets = 0;
 	}
 	
 	NetCapture::~NetCapture()
@@ -85,14 +117,24 @@ namespace slib
 		return sl_null;
 	}
 	
+	void NetCapture::getStatistics(NetCaptureStatistics& _out)
+	{
+		_out.countPackets = m_countPackets;
+		_out.sizePackets = m_sizePackets;
+		_out.countDropped = 0;
+	}
+	
 	void NetCapture::_initWithParam(const NetCaptureParam& param)
 	{
 		m_listener = param.listener;
 		m_onCapturePacket = param.onCapturePacket;
+		m_onCapturePackets = param.onCapturePackets;
 	}
 	
 	void NetCapture::_onCapturePacket(NetCapturePacket* packet)
 	{
+		Base::interlockedIncrement64(&m_countPackets);
+		Base::interlockedAdd64(&m_sizePackets, packet->length);
 		PtrLocker<INetCaptureListener> listener(m_listener);
 		if (listener.isNotNull()) {
 			listener->onCapturePacket(this, packet);
@@ -100,6 +142,29 @@ namespace slib
 		m_onCapturePacket(this, packet);
 	}
 	
+	void NetCapture::_onCapturePackets(NetCapturePacket* packets, sl_uint32 count)
+	{
+		if (!count) {
+			return;
+		}
+		sl_int64 size = 0;
+		for (sl_uint32 i = 0; i < count; i++) {
+			size += packets[i].length;
+		}
+		Base::interlockedAdd64(&m_countPackets, count);
+		Base::interlockedAdd64(&m_sizePackets, size);
+		PtrLocker<INetCaptureListener> listener(m_listener);
+		if (listener.isNotNull()) {
+			listener->onCapturePackets(this, packets, count);
+		}
+		if (m_onCapturePacket.isNotNull()) {
+			for (sl_uint32 i = 0; i < count; i++) {
+				m_onCapturePacket(this, packets + i);
+			}
+		}
+		m_onCapturePackets(this, packets, count);
+	}
+	
 	
 	class _NetRawPacketCapture : public NetCapture
 	{
@@ -303,6 +368,357 @@ namespace slib
 		return _NetRawPacketCapture::create(param);
 	}
 	
+#if defined(SLIB_PLATFORM_IS_LINUX)
+	
+	class _NetPacketRing : public Referable
+	{
+	public:
+		Ref<Socket> socket;
+		sl_uint8* ring;
+		sl_size sizeRing;
+		sl_uint32 sizeBlock;
+		sl_uint32 nBlocks;
+		Ref<Thread> thread;
+		
+	public:
+		_NetPacketRing()
+		{
+			ring = sl_null;
+			sizeRing = 0;
+			sizeBlock = 0;
+			nBlocks = 0;
+		}
+		
+		~_NetPacketRing()
+		{
+			if (ring) {
+				::munmap(ring, sizeRing);
+			}
+		}
+		
+	public:
+		sl_bool open(const NetCaptureParam& param, NetworkLinkDeviceType deviceType, sl_uint32 iface, sl_uint32 fanoutGroup)
+		{
+			if (deviceType == NetworkLinkDeviceType::Raw) {
+				socket = Socket::openPacketDatagram(NetworkLinkProtocol::All);
+			} else {
+				socket = Socket::openPacketRaw(NetworkLinkProtocol::All);
+			}
+			if (socket.isNull()) {
+				LogError(TAG, "Failed to create Packet socket");
+				return sl_false;
+			}
+			int fd = (int)(socket->getHandle());
+			int version = TPACKET_V3;
+			if (::setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version))) {
+				LogError(TAG, "Failed to set TPACKET_V3");
+				return sl_false;
+			}
+			sizeBlock = param.sizeRingBlock;
+			// the block size should be a multiple of the page size
+			sl_uint32 sizePage = (sl_uint32)(::getpagesize());
+			sizeBlock = (sizeBlock + sizePage - 1) / sizePage * sizePage;
+			nBlocks = param.countRingBlocks;
+			if (!sizeBlock || !nBlocks) {
+				return sl_false;
+			}
+			tpacket_req3 req;
+			Base::zeroMemory(&req, sizeof(req));
+			req.tp_block_size = sizeBlock;
+			req.tp_block_nr = nBlocks;
+			req.tp_frame_size = TPACKET_ALIGNMENT << 7;
+			req.tp_frame_nr = (sl_uint32)((sl_uint64)sizeBlock * nBlocks / req.tp_frame_size);
+			req.tp_retire_blk_tov = param.timeoutRingBlock;
+			if (::setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))) {
+				LogError(TAG, "Failed to set PACKET_RX_RING");
+				return sl_false;
+			}
+			sizeRing = (sl_size)sizeBlock * nBlocks;
+			void* p = ::mmap(sl_null, sizeRing, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, fd, 0);
+			if (p == MAP_FAILED) {
+				// MAP_LOCKED needs CAP_IPC_LOCK or RLIMIT_MEMLOCK
+				p = ::mmap(sl_null, sizeRing, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				if (p == MAP_FAILED) {
+					LogError(TAG, "Failed to map the ring buffer");
+					return sl_false;
+				}
+			}
+			ring = (sl_uint8*)p;
+			sockaddr_ll addr;
+			Base::zeroMemory(&addr, sizeof(addr));
+			addr.sll_family = AF_PACKET;
+			addr.sll_protocol = htons(ETH_P_ALL);
+			addr.sll_ifindex = (int)iface;
+			if (::bind(fd, (sockaddr*)&addr, sizeof(addr))) {
+				LogError(TAG, "Failed to bind the packet socket");
+				return sl_false;
+			}
+			if (fanoutGroup) {
+				int fanout = (int)((fanoutGroup & 0xFFFF) | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16));
+				if (::setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout))) {
+					LogError(TAG, "Failed to join the fanout group");
+					return sl_false;
+				}
+			}
+			return sl_true;
+		}
+		
+		// returns the count of the packets dropped since the last call
+		sl_uint64 getDroppedCount()
+		{
+			tpacket_stats_v3 stats;
+			socklen_t len = sizeof(stats);
+			Base::zeroMemory(&stats, sizeof(stats));
+			if (socket.isNotNull() && !(::getsockopt((int)(socket->getHandle()), SOL_PACKET, PACKET_STATISTICS, &stats, &len))) {
+				return stats.tp_drops;
+			}
+			return 0;
+		}
+		
+	};
+	
+	class _NetPacketRingCapture : public NetCapture
+	{
+	public:
+		CList< Ref<_NetPacketRing> > m_rings;
+		
+		NetworkLinkDeviceType m_deviceType;
+		sl_uint32 m_ifaceIndex;
+		
+		sl_bool m_flagInit;
+		sl_bool m_flagRunning;
+		
+		sl_int64 m_countDropped;
+		
+	public:
+		_NetPacketRingCapture()
+		{
+			m_deviceType = NetworkLinkDeviceType::Ethernet;
+			m_ifaceIndex = 0;
+			
+			m_flagInit = sl_false;
+			m_flagRunning = sl_false;
+			
+			m_countDropped = 0;
+		}
+		
+		~_NetPacketRingCapture()
+		{
+			release();
+		}
+		
+	public:
+		static Ref<_NetPacketRingCapture> create(const NetCaptureParam& param)
+		{
+			sl_uint32 iface = 0;
+			String deviceName = param.deviceName;
+			if (deviceName.isNotEmpty()) {
+				iface = Network::getInterfaceIndexFromName(deviceName);
+				if (iface == 0) {
+					LogError(TAG, "Failed to find the interface index of device: %s", deviceName);
+					return sl_null;
+				}
+			}
+			NetworkLinkDeviceType deviceType = param.preferedLinkDeviceType;
+			if (deviceType != NetworkLinkDeviceType::Raw) {
+				deviceType = NetworkLinkDeviceType::Ethernet;
+			}
+			Ref<_NetPacketRingCapture> ret = new _NetPacketRingCapture;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			ret->_initWithParam(param);
+			ret->m_deviceType = deviceType;
+			ret->m_ifaceIndex = iface;
+			sl_uint32 nThreads = param.countFanoutThreads;
+			if (nThreads < 1) {
+				nThreads = 1;
+			}
+			sl_uint32 fanoutGroup = 0;
+			if (nThreads > 1) {
+				static sl_int32 counter = 0;
+				fanoutGroup = ((sl_uint32)(::getpid()) + (sl_uint32)(Base::interlockedIncrement32(&counter))) & 0xFFFF;
+				if (!fanoutGroup) {
+					fanoutGroup = 1;
+				}
+			}
+			for (sl_uint32 i = 0; i < nThreads; i++) {
+				Ref<_NetPacketRing> ring = new _NetPacketRing;
+				if (ring.isNull()) {
+					return sl_null;
+				}
+				if (!(ring->open(param, deviceType, iface, fanoutGroup))) {
+					return sl_null;
+				}
+				if (i == 0 && iface > 0 && param.flagPromiscuous) {
+					if (!(ring->socket->setPromiscuousMode(deviceName, sl_true))) {
+						Log(TAG, "Failed to set promiscuous mode to the network device: %s", deviceName);
+					}
+				}
+				ring->thread = Thread::create(SLIB_BIND_CLASS(void(), _NetPacketRingCapture, _run, ret.get(), ring.get()));
+				if (ring->thread.isNull()) {
+					LogError(TAG, "Failed to create thread");
+					return sl_null;
+				}
+				ret->m_rings.add_NoLock(ring);
+			}
+			ret->m_flagInit = sl_true;
+			if (param.flagAutoStart) {
+				ret->start();
+			}
+			return ret;
+		}
+		
+		void release()
+		{
+			ObjectLocker lock(this);
+			if (!m_flagInit) {
+				return;
+			}
+			m_flagInit = sl_false;
+			
+			m_flagRunning = sl_false;
+			ListElements< Ref<_NetPacketRing> > rings(m_rings);
+			for (sl_size i = 0; i < rings.count; i++) {
+				if (rings[i]->thread.isNotNull()) {
+					rings[i]->thread->finishAndWait();
+					rings[i]->thread.setNull();
+				}
+			}
+			m_rings.removeAll_NoLock();
+		}
+		
+		void start()
+		{
+			ObjectLocker lock(this);
+			if (!m_flagInit) {
+				return;
+			}
+			if (m_flagRunning) {
+				return;
+			}
+			ListElements< Ref<_NetPacketRing> > rings(m_rings);
+			for (sl_size i = 0; i < rings.count; i++) {
+				if (rings[i]->thread.isNotNull()) {
+					if (rings[i]->thread->start()) {
+						m_flagRunning = sl_true;
+					}
+				}
+			}
+		}
+		
+		sl_bool isRunning()
+		{
+			return m_flagRunning;
+		}
+		
+		void _run(_NetPacketRing* ring)
+		{
+			int fd = (int)(ring->socket->getHandle());
+			sl_uint32 indexBlock = 0;
+			CList<NetCapturePacket> packets;
+			
+			while (Thread::isNotStoppingCurrent()) {
+				tpacket_block_desc* desc = (tpacket_block_desc*)(ring->ring + (sl_size)indexBlock * ring->sizeBlock);
+				if (!(__atomic_load_n(&(desc->hdr.bh1.block_status), __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+					pollfd pfd;
+					pfd.fd = fd;
+					pfd.events = POLLIN | POLLERR;
+					pfd.revents = 0;
+					::poll(&pfd, 1, 100);
+					continue;
+				}
+				sl_uint32 n = desc->hdr.bh1.num_pkts;
+				if (packets.getCount() < n) {
+					packets.setCount_NoLock(n);
+				}
+				NetCapturePacket* p = packets.getData();
+				if (p) {
+					tpacket3_hdr* hdr = (tpacket3_hdr*)((sl_uint8*)desc + desc->hdr.bh1.offset_to_first_pkt);
+					for (sl_uint32 i = 0; i < n; i++) {
+						p[i].data = (sl_uint8*)hdr + hdr->tp_mac;
+						p[i].length = hdr->tp_snaplen;
+						sl_uint64 t = hdr->tp_sec;
+						p[i].time = t * 1000000 + hdr->tp_nsec / 1000;
+						hdr = (tpacket3_hdr*)((sl_uint8*)hdr + hdr->tp_next_offset);
+					}
+					_onCapturePackets(p, n);
+				}
+				// returns the block to the kernel
+				__atomic_store_n(&(desc->hdr.bh1.block_status), TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+				indexBlock = (indexBlock + 1) % ring->nBlocks;
+			}
+		}
+		
+		NetworkLinkDeviceType getLinkType()
+		{
+			return m_deviceType;
+		}
+		
+		sl_bool sendPacket(const void* buf, sl_uint32 size)
+		{
+			if (m_ifaceIndex == 0) {
+				return sl_false;
+			}
+			if (m_flagInit) {
+				L2PacketInfo info;
+				info.type = L2PacketType::OutGoing;
+				info.iface = m_ifaceIndex;
+				if (m_deviceType == NetworkLinkDeviceType::Ethernet) {
+					EthernetFrame* frame = (EthernetFrame*)buf;
+					if (size < EthernetFrame::HeaderSize) {
+						return sl_false;
+					}
+					info.protocol = frame->getProtocol();
+					info.setMacAddress(frame->getDestinationAddress());
+				} else {
+					info.protocol = NetworkLinkProtocol::IPv4;
+					info.clearAddress();
+				}
+				Ref<_NetPacketRing> ring;
+				if (m_rings.getAt(0, &ring)) {
+					Ref<Socket> socket = ring->socket;
+					if (socket.isNotNull()) {
+						sl_uint32 ret = socket->sendPacket(buf, size, info);
+						if (ret == size) {
+							return sl_true;
+						}
+					}
+				}
+			}
+			return sl_false;
+		}
+		
+		void getStatistics(NetCaptureStatistics& _out)
+		{
+			sl_int64 nDropped = 0;
+			{
+				ObjectLocker lock(this);
+				ListElements< Ref<_NetPacketRing> > rings(m_rings);
+				for (sl_size i = 0; i < rings.count; i++) {
+					nDropped += rings[i]->getDroppedCount();
+				}
+			}
+			NetCapture::getStatistics(_out);
+			_out.countDropped = Base::interlockedAdd64(&m_countDropped, nDropped);
+		}
+		
+	};
+	
+	Ref<NetCapture> NetCapture::createPacketRing(const NetCaptureParam& param)
+	{
+		return _NetPacketRingCapture::create(param);
+	}
+	
+#else
+	
+	Ref<NetCapture> NetCapture::createPacketRing(const NetCaptureParam& param)
+	{
+		return sl_null;
+	}
+	
+#endif
+	
 	class _NetRawIPv4Capture : public NetCapture
 	{
 	public:
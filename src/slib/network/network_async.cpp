@@ -142,7 +142,9 @@ namespace slib
 			}
 			Ref<AsyncTcpSocket> ret = new AsyncTcpSocket;
 			if (ret.isNotNull()) {
-				if (ret->_initialize(instance.get(), AsyncIoMode::InOut, loop)) {
+				// completion based sockets are not attached for readiness events
+				AsyncIoMode mode = loop->isUsingIoUring() ? AsyncIoMode::None : AsyncIoMode::InOut;
+				if (ret->_initialize(instance.get(), mode, loop)) {
 					ret->m_listener = param.listener;
 					ret->m_onConnect = param.onConnect;
 					ret->m_onError = param.onError;
@@ -346,6 +348,7 @@ namespace slib
 		
 		flagAutoStart = sl_true;
 		flagLogError = sl_true;
+		flagReusePort = sl_false;
 	}
 
 	AsyncTcpServerParam::~AsyncTcpServerParam()
@@ -387,6 +390,14 @@ namespace slib
 			// So, we set ReuseAddress flag on Server sockets to avoid this issue
 			socket->setOption_ReuseAddress(sl_true);
 #endif
+			if (param.flagReusePort) {
+				if (!(socket->setOption_ReusePort(sl_true))) {
+					if (param.flagLogError) {
+						LogError(TAG, "AsyncTcpServer reuse-port error: %s", socket->getLastErrorMessage());
+					}
+					return sl_null;
+				}
+			}
 
 			if (!(socket->bind(param.bindAddress))) {
 				if (param.flagLogError) {
@@ -14,6 +14,12 @@
 
 #include "network_async.h"
 
+#include <errno.h>
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+#include <sys/sendfile.h>
+#endif
+
 namespace slib
 {
 
@@ -26,6 +32,10 @@ namespace slib
 		
 		sl_bool m_flagConnecting;
 		
+		// used when the loop is driven by io_uring
+		AsyncIoOperation m_operationRead;
+		AsyncIoOperation m_operationWrite;
+		
 	public:
 		_Unix_AsyncTcpSocketInstance()
 		{
@@ -103,6 +113,38 @@ namespace slib
 			}
 		}
 
+		sl_bool isSendFileSupported()
+		{
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			return sl_true;
+#else
+			return sl_false;
+#endif
+		}
+
+		sl_int32 sendFile(Socket* socket, AsyncStreamRequest* request, sl_uint32 size)
+		{
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			Ref<File> file = request->file;
+			if (file.isNull() || !(file->isOpened())) {
+				return -1;
+			}
+			off_t offset = (off_t)(request->fileOffset + m_sizeWritten);
+			ssize_t n = ::sendfile((int)(socket->getHandle()), (int)(file->getHandle()), &offset, size);
+			if (n > 0) {
+				return (sl_int32)n;
+			} else if (n < 0) {
+				int err = errno;
+				if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR) {
+					return 0;
+				}
+			}
+			return -1;
+#else
+			return -1;
+#endif
+		}
+
 		void processWrite(sl_bool flagError)
 		{
 			Ref<Socket> socket = m_socket;
@@ -127,7 +169,12 @@ namespace slib
 					}
 				}
 				sl_uint32 size = request->size - m_sizeWritten;
-				sl_int32 n = socket->send((char*)(request->data) + m_sizeWritten, size);
+				sl_int32 n;
+				if (request->file.isNotNull()) {
+					n = sendFile(socket.get(), request.get(), size);
+				} else {
+					n = socket->send((char*)(request->data) + m_sizeWritten, size);
+				}
 				if (n > 0) {
 					m_sizeWritten += n;
 					if (m_sizeWritten >= request->size) {
@@ -150,6 +197,137 @@ namespace slib
 			}
 		}
 		
+		void submitRead(AsyncIoLoop* loop)
+		{
+			if (m_operationRead.isPending()) {
+				return;
+			}
+			Ref<AsyncStreamRequest> request = m_requestReading;
+			if (request.isNull()) {
+				if (!(popReadRequest(request))) {
+					return;
+				}
+				if (request.isNull()) {
+					return;
+				}
+				m_requestReading = request;
+			}
+			m_operationRead.type = AsyncIoOperationType::Receive;
+			m_operationRead.data = request->data;
+			m_operationRead.size = request->size;
+			if (!(loop->submitOperation(this, &m_operationRead))) {
+				m_requestReading.setNull();
+				_onReceive(request.get(), 0, sl_true);
+			}
+		}
+		
+		void onReadCompleted()
+		{
+			Ref<AsyncStreamRequest> request = m_requestReading;
+			if (request.isNull()) {
+				return;
+			}
+			sl_int32 n = m_operationRead.result;
+			if (n == -EAGAIN || n == -EINTR) {
+				// submitted again on next order
+				return;
+			}
+			m_requestReading.setNull();
+			if (n > 0) {
+				_onReceive(request.get(), n, sl_false);
+			} else {
+				_onReceive(request.get(), 0, sl_true);
+			}
+		}
+		
+		void submitWrite(AsyncIoLoop* loop)
+		{
+			if (m_operationWrite.isPending()) {
+				return;
+			}
+			Ref<Socket> socket = m_socket;
+			if (socket.isNull()) {
+				return;
+			}
+			while (Thread::isNotStoppingCurrent()) {
+				Ref<AsyncStreamRequest> request = m_requestWriting;
+				if (request.isNull()) {
+					if (!(popWriteRequest(request))) {
+						return;
+					}
+					if (request.isNull()) {
+						return;
+					}
+					m_sizeWritten = 0;
+					m_requestWriting = request;
+				}
+				sl_uint32 size = request->size - m_sizeWritten;
+				if (request->file.isNotNull()) {
+					// sendfile() has no counterpart in io_uring, so waits for the writable state by poll operation
+					sl_int32 n = sendFile(socket.get(), request.get(), size);
+					if (n > 0) {
+						m_sizeWritten += n;
+						if (m_sizeWritten >= request->size) {
+							m_requestWriting.setNull();
+							_onSend(request.get(), request->size, sl_false);
+						}
+						continue;
+					} else if (n == 0) {
+						m_operationWrite.type = AsyncIoOperationType::Poll;
+						m_operationWrite.pollMode = AsyncIoMode::Out;
+					} else {
+						m_requestWriting.setNull();
+						_onSend(request.get(), m_sizeWritten, sl_true);
+						continue;
+					}
+				} else {
+					m_operationWrite.type = AsyncIoOperationType::Send;
+					m_operationWrite.data = (sl_uint8*)(request->data) + m_sizeWritten;
+					m_operationWrite.size = size;
+				}
+				if (!(loop->submitOperation(this, &m_operationWrite))) {
+					m_requestWriting.setNull();
+					_onSend(request.get(), m_sizeWritten, sl_true);
+				}
+				return;
+			}
+		}
+		
+		void onWriteCompleted(EventDesc* pev)
+		{
+			if (m_flagConnecting) {
+				m_flagConnecting = sl_false;
+				if (pev->flagOut && !(pev->flagError)) {
+					_onConnect(sl_false);
+				} else {
+					_onConnect(sl_true);
+				}
+				return;
+			}
+			Ref<AsyncStreamRequest> request = m_requestWriting;
+			if (request.isNull()) {
+				return;
+			}
+			sl_int32 n = m_operationWrite.result;
+			if (m_operationWrite.type == AsyncIoOperationType::Poll) {
+				if (!(pev->flagOut)) {
+					m_requestWriting.setNull();
+					_onSend(request.get(), m_sizeWritten, sl_true);
+				}
+				return;
+			}
+			if (n > 0) {
+				m_sizeWritten += n;
+				if (m_sizeWritten >= request->size) {
+					m_requestWriting.setNull();
+					_onSend(request.get(), request->size, sl_false);
+				}
+			} else if (n != -EAGAIN && n != -EINTR) {
+				m_requestWriting.setNull();
+				_onSend(request.get(), m_sizeWritten, sl_true);
+			}
+		}
+		
 		void onOrder()
 		{
 			Ref<Socket> socket = m_socket;
@@ -159,21 +337,48 @@ namespace slib
 			if (m_flagConnecting) {
 				return;
 			}
+			Ref<AsyncIoLoop> loop = getLoop();
+			if (loop.isNull()) {
+				return;
+			}
+			sl_bool flagIoUring = loop->isUsingIoUring();
 			if (m_flagRequestConnect) {
 				m_flagRequestConnect = sl_false;
 				if (socket->connect(m_addressRequestConnect)) {
 					m_flagConnecting = sl_true;
+					if (flagIoUring) {
+						m_operationWrite.type = AsyncIoOperationType::Poll;
+						m_operationWrite.pollMode = AsyncIoMode::Out;
+						if (!(loop->submitOperation(this, &m_operationWrite))) {
+							m_flagConnecting = sl_false;
+							_onConnect(sl_true);
+						}
+					}
 				} else {
 					_onConnect(sl_true);
 				}
 				return;
 			}
+			if (flagIoUring) {
+				submitRead(loop.get());
+				submitWrite(loop.get());
+				return;
+			}
 			processRead(sl_false);
 			processWrite(sl_false);
 		}
 		
 		void onEvent(EventDesc* pev)
 		{
+			if (pev->pOperation) {
+				if (pev->pOperation == &m_operationRead) {
+					onReadCompleted();
+				} else if (pev->pOperation == &m_operationWrite) {
+					onWriteCompleted(pev);
+				}
+				requestOrder();
+				return;
+			}
 			sl_bool flagProcessed = sl_false;
 			if (pev->flagIn) {
 				processRead(pev->flagError);
@@ -44,6 +44,29 @@ namespace slib
 		sl_uint16 sum = TCP_IP::calculateOneComplementSum(data, size);
 		return (sl_uint16)(~sum); // 1's complement
 	}
+
+	sl_uint16 TCP_IP::adjustChecksum(sl_uint16 checksum, sl_uint16 oldValue, sl_uint16 newValue)
+	{
+		// HC' = ~(~HC + ~m + m')
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~oldValue);
+		sum += newValue;
+		sum = (sum & 0xFFFF) + (sum >> 16);
+		sum = (sum & 0xFFFF) + (sum >> 16);
+		return (sl_uint16)(~sum);
+	}
+
+	sl_uint16 TCP_IP::adjustChecksum(sl_uint16 checksum, const IPv4Address& oldAddress, const IPv4Address& newAddress)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~((oldAddress.a << 8) | oldAddress.b));
+		sum += (sl_uint16)(~((oldAddress.c << 8) | oldAddress.d));
+		sum += (sl_uint16)((newAddress.a << 8) | newAddress.b);
+		sum += (sl_uint16)((newAddress.c << 8) | newAddress.d);
+		sum = (sum & 0xFFFF) + (sum >> 16);
+		sum = (sum & 0xFFFF) + (sum >> 16);
+		return (sl_uint16)(~sum);
+	}
 	
 	
 	sl_uint32 IPv4Packet::getVersion() const
@@ -396,13 +419,21 @@ namespace slib
 	
 	sl_bool TcpSegment::check(IPv4Packet* ip, sl_uint32 sizeTcp) const
 	{
-		if (sizeTcp < sizeof(TcpSegment)) {
+		if (!(checkSize(sizeTcp))) {
 			return sl_false;
 		}
-		if (sizeTcp < getHeaderSize()) {
+		if (!(checkChecksum(ip, sizeTcp))) {
 			return sl_false;
 		}
-		if (!(checkChecksum(ip, sizeTcp))) {
+		return sl_true;
+	}
+
+	sl_bool TcpSegment::checkSize(sl_uint32 sizeTcp) const
+	{
+		if (sizeTcp < sizeof(TcpSegment)) {
+			return sl_false;
+		}
+		if (sizeTcp < getHeaderSize()) {
 			return sl_false;
 		}
 		return sl_true;
@@ -461,13 +492,21 @@ namespace slib
 	
 	sl_bool UdpDatagram::check(IPv4Packet* ip, sl_uint32 sizeUdp) const
 	{
-		if (sizeUdp < HeaderSize) {
+		if (!(checkSize(sizeUdp))) {
 			return sl_false;
 		}
-		if (sizeUdp != getTotalSize()) {
+		if (!(checkChecksum(ip))) {
 			return sl_false;
 		}
-		if (!(checkChecksum(ip))) {
+		return sl_true;
+	}
+
+	sl_bool UdpDatagram::checkSize(sl_uint32 sizeUdp) const
+	{
+		if (sizeUdp < HeaderSize) {
+			return sl_false;
+		}
+		if (sizeUdp != getTotalSize()) {
 			return sl_false;
 		}
 		return sl_true;
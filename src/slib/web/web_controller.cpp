@@ -16,12 +16,191 @@
 namespace slib
 {
 
+#define _WEB_ROUTE_METHODS_COUNT ((sl_uint32)(HttpMethod::TRACE) + 1)
+
+	class _WebRouteEndpoint
+	{
+	public:
+		WebHandler handler;
+		// names of the captured parameters in order, null for the unnamed wildcard
+		List<String> names;
+	};
+	
+	class _WebRouteNode;
+	
+	class _WebRouteChild
+	{
+	public:
+		String segment;
+		Ref<_WebRouteNode> node;
+	};
+	
+	class _WebRouteNode : public Referable
+	{
+	public:
+		// sorted by `_WebRoute_compareSegment`
+		CList<_WebRouteChild> children;
+		Ref<_WebRouteNode> param;
+		_WebRouteEndpoint endpoints[_WEB_ROUTE_METHODS_COUNT];
+		_WebRouteEndpoint wildcards[_WEB_ROUTE_METHODS_COUNT];
+	};
+	
+	static sl_int32 _WebRoute_compareSegment(const sl_char8* s1, sl_size len1, const sl_char8* s2, sl_size len2)
+	{
+		sl_int32 c = Base::compareMemory((const sl_uint8*)s1, (const sl_uint8*)s2, len1 < len2 ? len1 : len2);
+		if (c) {
+			return c;
+		}
+		if (len1 < len2) {
+			return -1;
+		}
+		if (len1 > len2) {
+			return 1;
+		}
+		return 0;
+	}
+	
+	// returns the index for inserting when not found
+	static sl_bool _WebRoute_findChild(_WebRouteNode* node, const sl_char8* segment, sl_size len, sl_size& outIndex)
+	{
+		_WebRouteChild* children = node->children.getData();
+		sl_size start = 0;
+		sl_size end = node->children.getCount();
+		while (start < end) {
+			sl_size mid = (start + end) >> 1;
+			const String& s = children[mid].segment;
+			sl_int32 c = _WebRoute_compareSegment(segment, len, s.getData(), s.getLength());
+			if (c == 0) {
+				outIndex = mid;
+				return sl_true;
+			}
+			if (c < 0) {
+				end = mid;
+			} else {
+				start = mid + 1;
+			}
+		}
+		outIndex = start;
+		return sl_false;
+	}
+	
+	static void _WebRoute_insert(_WebRouteNode* node, HttpMethod method, const String& path, const WebHandler& handler)
+	{
+		sl_uint32 m = (sl_uint32)method;
+		if (m >= _WEB_ROUTE_METHODS_COUNT) {
+			return;
+		}
+		List<String> names;
+		const sl_char8* sz = path.getData();
+		sl_size len = path.getLength();
+		sl_size pos = 0;
+		for (;;) {
+			sl_size end = pos;
+			while (end < len && sz[end] != '/') {
+				end++;
+			}
+			const sl_char8* segment = sz + pos;
+			sl_size n = end - pos;
+			sl_bool flagLast = end == len;
+			if (flagLast && n == 1 && segment[0] == '*') {
+				names.add_NoLock(String::null());
+				node->wildcards[m].handler = handler;
+				node->wildcards[m].names = names;
+				return;
+			}
+			if (n >= 2 && segment[0] == '{' && segment[n - 1] == '}') {
+				if (flagLast && n >= 3 && segment[n - 2] == '*') {
+					names.add_NoLock(String::fromUtf8(segment + 1, n - 3));
+					node->wildcards[m].handler = handler;
+					node->wildcards[m].names = names;
+					return;
+				}
+				names.add_NoLock(String::fromUtf8(segment + 1, n - 2));
+				if (node->param.isNull()) {
+					node->param = new _WebRouteNode;
+					if (node->param.isNull()) {
+						return;
+					}
+				}
+				node = node->param.get();
+			} else {
+				sl_size index;
+				if (_WebRoute_findChild(node, segment, n, index)) {
+					node = node->children.getData()[index].node.get();
+				} else {
+					_WebRouteChild child;
+					child.segment = String::fromUtf8(segment, n);
+					child.node = new _WebRouteNode;
+					if (child.node.isNull()) {
+						return;
+					}
+					if (!(node->children.insert_NoLock(index, child))) {
+						return;
+					}
+					node = child.node.get();
+				}
+			}
+			if (flagLast) {
+				break;
+			}
+			pos = end + 1;
+		}
+		node->endpoints[m].handler = handler;
+		node->endpoints[m].names = names;
+	}
+	
+	// `pos` is the start of the next segment, or greater than `len` at the end of the path
+	static const _WebRouteEndpoint* _WebRoute_match(_WebRouteNode* node, sl_uint32 method, const sl_char8* sz, sl_size len, sl_size pos, sl_size* starts, sl_size* lengths, sl_uint32 depth)
+	{
+		if (pos > len) {
+			const _WebRouteEndpoint& endpoint = node->endpoints[method];
+			if (endpoint.handler.isNotNull()) {
+				return &endpoint;
+			}
+			return sl_null;
+		}
+		sl_size end = pos;
+		while (end < len && sz[end] != '/') {
+			end++;
+		}
+		sl_size next = end + 1;
+		sl_size index;
+		if (_WebRoute_findChild(node, sz + pos, end - pos, index)) {
+			const _WebRouteEndpoint* ret = _WebRoute_match(node->children.getData()[index].node.get(), method, sz, len, next, starts, lengths, depth);
+			if (ret) {
+				return ret;
+			}
+		}
+		if (depth < SLIB_WEB_ROUTE_MAX_PARAMS) {
+			if (node->param.isNotNull() && end > pos) {
+				starts[depth] = pos;
+				lengths[depth] = end - pos;
+				const _WebRouteEndpoint* ret = _WebRoute_match(node->param.get(), method, sz, len, next, starts, lengths, depth + 1);
+				if (ret) {
+					return ret;
+				}
+			}
+			const _WebRouteEndpoint& wildcard = node->wildcards[method];
+			if (wildcard.handler.isNotNull()) {
+				starts[depth] = pos;
+				lengths[depth] = len - pos;
+				return &wildcard;
+			}
+		}
+		return sl_null;
+	}
+	
+
 	SLIB_DEFINE_OBJECT(WebController, Object)
 
 	WebController::WebController()
 	{
 	}
 
+	WebController::~WebController()
+	{
+	}
+
 	Ref<WebController> WebController::create()
 	{
 		return new WebController;
@@ -30,45 +209,74 @@ namespace slib
 	void WebController::registerHandler(HttpMethod method, const String& path, const WebHandler& handler)
 	{
 		if (handler.isNotNull()) {
-			String sig = _getHandlerSignature(method, path);
-			m_handlers.put(sig, handler);
+			ObjectLocker lock(this);
+			_Route route;
+			route.method = method;
+			route.path = path;
+			route.handler = handler;
+			if (!(m_routes.add_NoLock(route))) {
+				return;
+			}
+			// the published trie is not modified, so it is looked up without locking
+			Ref<_WebRouteNode> root = new _WebRouteNode;
+			if (root.isNull()) {
+				return;
+			}
+			_Route* routes = m_routes.getData();
+			sl_size n = m_routes.getCount();
+			for (sl_size i = 0; i < n; i++) {
+				_WebRoute_insert(root.get(), routes[i].method, routes[i].path, routes[i].handler);
+			}
+			m_routeRoot = root;
 		}
 	}
 
 	sl_bool WebController::onHttpRequest(const Ref<HttpServiceContext>& context)
 	{
+		Ref<_WebRouteNode> root = m_routeRoot;
+		if (root.isNull()) {
+			return sl_false;
+		}
 		HttpMethod method = context->getMethod();
+		if ((sl_uint32)method >= _WEB_ROUTE_METHODS_COUNT) {
+			return sl_false;
+		}
 		String path = context->getPath();
-		String sig = _getHandlerSignature(method, path);
-		WebHandler handler;
-		if (m_handlers.get(sig, &handler)) {
-			Variant ret(handler(context, method, path));
-			if (ret.isNotNull()) {
-				if (ret.isObject()) {
-					Ref<Referable> obj = ret.getObject();
-					if (obj.isNotNull()) {
-						if (IsInstanceOf< Map<String, Variant> >(obj)) {
-							context->write(ret.toJsonString());
-						} else if (XmlDocument* xml = CastInstance<XmlDocument>(obj.get())) {
-							context->write(xml->toString());
-						} else if (CMemory* mem = CastInstance<CMemory>(obj.get())) {
-							context->write(mem);
-						}
+		const sl_char8* sz = path.getData();
+		sl_size starts[SLIB_WEB_ROUTE_MAX_PARAMS];
+		sl_size lengths[SLIB_WEB_ROUTE_MAX_PARAMS];
+		const _WebRouteEndpoint* endpoint = _WebRoute_match(root.get(), (sl_uint32)method, sz, path.getLength(), 0, starts, lengths, 0);
+		if (!endpoint) {
+			return sl_false;
+		}
+		ListElements<String> names(endpoint->names);
+		for (sl_size i = 0; i < names.count; i++) {
+			if (names[i].isNotNull()) {
+				context->setPathParameter(names[i], String::fromUtf8(sz + starts[i], lengths[i]));
+			}
+		}
+		WebHandler handler = endpoint->handler;
+		Variant ret(handler(context, method, path));
+		if (ret.isNotNull()) {
+			if (ret.isObject()) {
+				Ref<Referable> obj = ret.getObject();
+				if (obj.isNotNull()) {
+					if (IsInstanceOf< Map<String, Variant> >(obj)) {
+						context->write(ret.toJsonString());
+					} else if (XmlDocument* xml = CastInstance<XmlDocument>(obj.get())) {
+						context->write(xml->toString());
+					} else if (CMemory* mem = CastInstance<CMemory>(obj.get())) {
+						context->write(mem);
 					}
-				} else {
-					context->write(ret.getString());
 				}
-				return sl_true;
+			} else {
+				context->write(ret.getString());
 			}
+			return sl_true;
 		}
 		return sl_false;
 	}
 
-	String WebController::_getHandlerSignature(HttpMethod method, const String& path)
-	{
-		return HttpMethods::toString(method) + " " + path;
-	}
-
 
 	WebModule::WebModule(const String& path)
 	: m_path(path)
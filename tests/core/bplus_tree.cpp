@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../test.h"
+
+#include "../../inc/slib/core/bplus_tree.h"
+#include "../../inc/slib/core/tree.h"
+#include "../../inc/slib/core/map.h"
+#include "../../inc/slib/core/string.h"
+
+using namespace slib;
+
+// the items of both trees are iterated in the same key order, in both directions
+static void compareItems(BPlusTree<sl_uint32, sl_uint32>& tree, BTree<sl_uint32, sl_uint32>& btree)
+{
+	TEST_CHECK(tree.getCount() == btree.getCount());
+	BPlusTreePosition pos;
+	TreePosition posOld;
+	sl_uint32 k1, v1, k2, v2;
+	sl_uint64 sum1 = 0, sum2 = 0;
+	sl_size n = 0;
+	while (tree.getNextPosition(pos, &k1, &v1)) {
+		if (!(btree.getNextPosition(posOld, &k2, &v2)) || k1 != k2) {
+			TEST_CHECK(sl_false);
+			return;
+		}
+		// the order of the values under a duplicated key is not compared
+		sum1 += v1;
+		sum2 += v2;
+		n++;
+	}
+	TEST_CHECK(!(btree.getNextPosition(posOld)));
+	TEST_CHECK(n == tree.getCount());
+	TEST_CHECK(sum1 == sum2);
+	pos.setNull();
+	posOld.setNull();
+	while (tree.getPrevPosition(pos, &k1)) {
+		if (!(btree.getPrevPosition(posOld, &k2)) || k1 != k2) {
+			TEST_CHECK(sl_false);
+			return;
+		}
+	}
+}
+
+// random operations on BPlusTree and BTree give the same results
+static void testRandomOperations()
+{
+	BPlusTree<sl_uint32, sl_uint32> tree;
+	BTree<sl_uint32, sl_uint32> btree;
+	sl_uint32 seed = 1;
+	for (sl_uint32 i = 0; i < 200000; i++) {
+		seed = seed * 1103515245 + 12345;
+		sl_uint32 r = seed >> 8;
+		sl_uint32 key = r % 5000;
+		sl_uint32 op = (r >> 16) % 10;
+		if (op < 4) {
+			TEST_CHECK(tree.put(key, i) == btree.put(key, i));
+		} else if (op < 5) {
+			// duplicated keys
+			key = 5000 + key % 100;
+			TEST_CHECK(tree.put(key, i, MapPutMode::AddAlways) == btree.put(key, i, MapPutMode::AddAlways));
+		} else if (op < 7) {
+			TEST_CHECK(tree.removeItems(key) == btree.removeItems(key));
+		} else {
+			sl_uint32 v1 = 0, v2 = 0;
+			sl_bool f1 = tree.get(key, &v1);
+			sl_bool f2 = btree.get(key, &v2);
+			TEST_CHECK(f1 == f2);
+			if (f1 && f2 && key < 5000) {
+				TEST_CHECK(v1 == v2);
+			}
+			TEST_CHECK(tree.getValues(key).getCount() == btree.getValues(key).getCount());
+		}
+		if (tree.getCount() != btree.getCount()) {
+			TEST_CHECK(tree.getCount() == btree.getCount());
+			return;
+		}
+		if (i % 50000 == 0) {
+			compareItems(tree, btree);
+		}
+	}
+	compareItems(tree, btree);
+	// removing everything one by one merges the nodes back to an empty root
+	BPlusTreePosition pos;
+	sl_uint32 key;
+	while (tree.getFirstPosition(pos, &key)) {
+		TEST_CHECK(tree.remove(key));
+		TEST_CHECK(btree.remove(key));
+	}
+	TEST_CHECK(tree.getCount() == 0);
+	TEST_CHECK(btree.getCount() == 0);
+}
+
+// the bounds agree with a linear scan over the sorted keys
+static void testBounds()
+{
+	BPlusTree<sl_uint32, sl_uint32> tree;
+	const sl_uint32 N = 3000;
+	for (sl_uint32 i = 0; i < N; i++) {
+		// keys 0, 3, 6, ... with three items per key
+		tree.put((i / 3) * 3, i, MapPutMode::AddAlways);
+	}
+	for (sl_uint32 key = 0; key < N + 5; key++) {
+		sl_uint32 lower = (key + 2) / 3 * 3;
+		sl_uint32 upper = key / 3 * 3 + 3;
+		BPlusTreePosition pos;
+		sl_uint32 k;
+		if (lower < N) {
+			TEST_CHECK(tree.getLowerBound(key, &pos) && tree.getAt(pos, &k) && k == lower);
+			// the lower bound is the first of the duplicated items
+			if (key == lower) {
+				BPlusTreePosition prev = pos;
+				TEST_CHECK(!(tree.getPrevPosition(prev, &k)) || k < key);
+			}
+		} else {
+			TEST_CHECK(!(tree.getLowerBound(key, &pos)));
+		}
+		if (upper < N) {
+			TEST_CHECK(tree.getUpperBound(key, &pos) && tree.getAt(pos, &k) && k == upper);
+		} else {
+			TEST_CHECK(!(tree.getUpperBound(key, &pos)));
+		}
+	}
+}
+
+static void testTreeMap()
+{
+	Map<String, sl_int32> map = Map<String, sl_int32>::createTree();
+	for (sl_int32 i = 999; i >= 0; i--) {
+		map.put(String::fromInt32(i), i);
+	}
+	TEST_CHECK(map.getCount() == 1000);
+	String last;
+	sl_int32 sum = 0;
+	for (auto& item : map) {
+		TEST_CHECK(last < item.key);
+		TEST_CHECK(item.key == String::fromInt32(item.value));
+		last = item.key;
+		sum += item.value;
+	}
+	TEST_CHECK(sum == 999 * 1000 / 2);
+	Map<String, sl_int32> dup = map.duplicate();
+	map.remove("777");
+	TEST_CHECK(!(map.contains("777")));
+	TEST_CHECK(dup.getValue("777") == 777);
+}
+
+static void benchmark()
+{
+	const sl_uint32 N = 200000;
+	{
+		BTree<sl_uint32, sl_uint32> btree;
+		TimeCounter t;
+		for (sl_uint32 i = 0; i < N; i++) {
+			btree.put(i * 2654435761u, i);
+		}
+		sl_uint64 sum = 0;
+		for (sl_uint32 i = 0; i < N; i++) {
+			sl_uint32* p = btree.getItemPointer(((i * 7919) % N) * 2654435761u);
+			if (p) {
+				sum += *p;
+			}
+		}
+		TEST_CHECK(sum == (sl_uint64)N * (N - 1) / 2);
+		TEST_PRINT_TIME("BTree insert+lookup", t);
+	}
+	{
+		BPlusTree<sl_uint32, sl_uint32> tree;
+		TimeCounter t;
+		for (sl_uint32 i = 0; i < N; i++) {
+			tree.put(i * 2654435761u, i);
+		}
+		sl_uint64 sum = 0;
+		for (sl_uint32 i = 0; i < N; i++) {
+			sl_uint32* p = tree.getItemPointer(((i * 7919) % N) * 2654435761u);
+			if (p) {
+				sum += *p;
+			}
+		}
+		TEST_CHECK(sum == (sl_uint64)N * (N - 1) / 2);
+		TEST_PRINT_TIME("BPlusTree insert+lookup", t);
+	}
+}
+
+int main(int argc, const char * argv[])
+{
+	testRandomOperations();
+	testBounds();
+	testTreeMap();
+	benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../test.h"
+
+#include "../../inc/slib/core/flat_hashtable.h"
+#include "../../inc/slib/core/hashtable.h"
+#include "../../inc/slib/core/map.h"
+#include "../../inc/slib/core/string.h"
+#include "../../inc/slib/core/math.h"
+
+using namespace slib;
+
+// random operations on FlatHashTable and HashTable give the same results
+static void testRandomOperations()
+{
+	FlatHashTable<sl_uint32, sl_uint32> flat;
+	HashTable<sl_uint32, sl_uint32> table;
+	sl_uint32 seed = 1;
+	for (sl_uint32 i = 0; i < 300000; i++) {
+		seed = seed * 1103515245 + 12345;
+		sl_uint32 r = seed >> 8;
+		sl_uint32 key = r % 5000;
+		sl_uint32 op = (r >> 16) % 10;
+		if (op < 5) {
+			TEST_CHECK(flat.put(key, i) == table.put(key, i));
+		} else if (op < 6) {
+			// duplicated keys
+			key = 5000 + key % 100;
+			TEST_CHECK(flat.put(key, i, MapPutMode::AddAlways) == table.put(key, i, MapPutMode::AddAlways));
+		} else if (op < 8) {
+			TEST_CHECK(flat.removeItems(key) == table.removeItems(key));
+		} else {
+			sl_uint32 v1 = 0, v2 = 0;
+			sl_bool f1 = flat.get(key, &v1);
+			sl_bool f2 = table.get(key, &v2);
+			TEST_CHECK(f1 == f2);
+			if (f1 && f2 && key < 5000) {
+				TEST_CHECK(v1 == v2);
+			}
+			TEST_CHECK(flat.getValues(key).getCount() == table.getValues(key).getCount());
+		}
+		if (flat.getCount() != table.getCount()) {
+			TEST_CHECK(flat.getCount() == table.getCount());
+			return;
+		}
+	}
+	sl_size n = 0;
+	for (FlatHashEntry<sl_uint32, sl_uint32>* entry = flat.getFirstEntry(); entry; entry = flat.getNextEntry(entry)) {
+		TEST_CHECK(table.searchKeyAndValue(entry->key, entry->value) != sl_null);
+		n++;
+	}
+	TEST_CHECK(n == table.getCount());
+	flat.removeAll();
+	TEST_CHECK(flat.getCount() == 0);
+	TEST_CHECK(flat.getFirstEntry() == sl_null);
+}
+
+static void testMap()
+{
+	Map<String, sl_int32> map = Map<String, sl_int32>::createFlatHash();
+	for (sl_int32 i = 0; i < 1000; i++) {
+		map.put(String::fromInt32(i), i);
+	}
+	TEST_CHECK(map.getCount() == 1000);
+	sl_int32 sum = 0;
+	for (auto& item : map) {
+		TEST_CHECK(item.key == String::fromInt32(item.value));
+		sum += item.value;
+	}
+	TEST_CHECK(sum == 999 * 1000 / 2);
+	Map<String, sl_int32> dup = map.duplicate();
+	TEST_CHECK(dup.getValue("777") == 777);
+	TEST_CHECK(!(dup.contains("1000")));
+	map.remove("777");
+	TEST_CHECK(!(map.contains("777")));
+	TEST_CHECK(dup.contains("777"));
+}
+
+static void benchmark()
+{
+	const sl_uint32 N = 200000;
+	for (int k = 0; k < 2; k++) {
+		Map<sl_uint32, sl_uint32> map = k ? Map<sl_uint32, sl_uint32>::createFlatHash() : Map<sl_uint32, sl_uint32>::createHash();
+		TimeCounter t;
+		for (sl_uint32 i = 0; i < N; i++) {
+			map.put_NoLock(i * 2654435761u, i);
+		}
+		sl_uint64 sum = 0;
+		for (sl_uint32 i = 0; i < N; i++) {
+			sl_uint32* p = map.getItemPointer(((i * 7919) % N) * 2654435761u);
+			if (p) {
+				sum += *p;
+			}
+		}
+		TEST_CHECK(sum == (sl_uint64)N * (N - 1) / 2);
+		TEST_PRINT_TIME(k ? "FlatHashMap insert+lookup" : "HashMap insert+lookup", t);
+	}
+}
+
+int main(int argc, const char * argv[])
+{
+	testRandomOperations();
+	testMap();
+	benchmark();
+	return TEST_RESULT();
+}
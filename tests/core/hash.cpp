@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../test.h"
+
+#include "../../inc/slib/core/hash.h"
+#include "../../inc/slib/core/string.h"
+#include "../../inc/slib/core/map.h"
+#include "../../inc/slib/core/variant.h"
+
+using namespace slib;
+
+// the hash used by the strings before HashBytes
+static sl_uint32 _oldStringHash(const sl_char8* buf, sl_size len)
+{
+	sl_uint32 hash = 0;
+	for (sl_size i = 0; i < len; i++) {
+		hash = hash * 31 + (sl_uint8)(buf[i]);
+	}
+	return Rehash(hash);
+}
+
+static void testStrings()
+{
+	for (sl_uint32 len = 0; len < 100; len++) {
+		String s8 = String::fromUint32(len);
+		while (s8.getLength() < len) {
+			s8 += "x";
+		}
+		String16 s16 = s8;
+		TEST_CHECK(s8.getHashCode() == s16.getHashCode());
+		TEST_CHECK(s8.getHashCode() == String(s8.getData(), s8.getLength()).getHashCode());
+		TEST_CHECK(s8.getHashCodeIgnoreCase() == s8.toUpper().getHashCodeIgnoreCase());
+	}
+	// longer than the stack buffer used to narrow String16
+	String s8 = String::fromUint32(7);
+	for (int i = 0; i < 100; i++) {
+		s8 += "abcdefgh";
+	}
+	TEST_CHECK(s8.getHashCode() == String16(s8).getHashCode());
+	TEST_CHECK(HashBytes("abc", 3) == HashBytes("abc", 3));
+	TEST_CHECK(HashBytes64("abc", 3, 1) != HashBytes64("abc", 3, 2));
+}
+
+// the keys differing in a few bytes are spread over the buckets as well as the old hash does
+static void testDistribution()
+{
+	const sl_uint32 nKeys = 65536;
+	const sl_uint32 nBuckets = 65536;
+	sl_uint8* bucketsNew = new sl_uint8[nBuckets];
+	sl_uint8* bucketsOld = new sl_uint8[nBuckets];
+	Base::zeroMemory(bucketsNew, nBuckets);
+	Base::zeroMemory(bucketsOld, nBuckets);
+	sl_uint32 nCollisionsNew = 0;
+	sl_uint32 nCollisionsOld = 0;
+	for (sl_uint32 i = 0; i < nKeys; i++) {
+		String key = String::format("/api/v1/users/%d/items", i);
+		sl_uint32 h1 = key.getHashCode() & (nBuckets - 1);
+		sl_uint32 h2 = _oldStringHash(key.getData(), key.getLength()) & (nBuckets - 1);
+		if (bucketsNew[h1]) {
+			nCollisionsNew++;
+		}
+		if (bucketsOld[h2]) {
+			nCollisionsOld++;
+		}
+		bucketsNew[h1] = 1;
+		bucketsOld[h2] = 1;
+	}
+	delete[] bucketsNew;
+	delete[] bucketsOld;
+	printf("collisions: new %d, old %d (random: about %d)\n", nCollisionsNew, nCollisionsOld, (int)(nKeys * 0.368));
+	// a random function collides about 36.8% of the keys
+	TEST_CHECK(nCollisionsNew < nKeys * 2 / 5);
+}
+
+static void benchmark()
+{
+	char buf[64];
+	Base::resetMemory(buf, 'a', sizeof(buf));
+	sl_uint32 sum = 0;
+	TimeCounter t;
+	for (sl_uint32 i = 0; i < 1000000; i++) {
+		buf[i & 63] = (char)i;
+		sum += HashBytes(buf, sizeof(buf));
+	}
+	TEST_PRINT_TIME("HashBytes 64 bytes x 1M", t);
+	t.reset();
+	for (sl_uint32 i = 0; i < 1000000; i++) {
+		buf[i & 63] = (char)i;
+		sum += _oldStringHash(buf, sizeof(buf));
+	}
+	TEST_PRINT_TIME("old string hash 64 bytes x 1M", t);
+	printf("(%d)\n", (int)(sum & 1));
+}
+
+int main(int argc, const char * argv[])
+{
+	testStrings();
+	testDistribution();
+	benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,224 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../test.h"
+
+#include "../../inc/slib/core/msgpack.h"
+#include "../../inc/slib/core/json.h"
+#include "../../inc/slib/core/string_buffer.h"
+
+using namespace slib;
+
+static sl_bool isHex(const Memory& mem, const char* hex)
+{
+	return String::makeHexString(mem).toLower() == hex;
+}
+
+// encodings from the specification
+static void testEncodings()
+{
+	TEST_CHECK(isHex(MsgPack::serialize(Variant()), "c0"));
+	TEST_CHECK(isHex(MsgPack::serialize(sl_true), "c3"));
+	TEST_CHECK(isHex(MsgPack::serialize(sl_false), "c2"));
+	TEST_CHECK(isHex(MsgPack::serialize(0), "00"));
+	TEST_CHECK(isHex(MsgPack::serialize(127), "7f"));
+	TEST_CHECK(isHex(MsgPack::serialize(128), "cc80"));
+	TEST_CHECK(isHex(MsgPack::serialize(65536), "ce00010000"));
+	TEST_CHECK(isHex(MsgPack::serialize(SLIB_INT64(4294967296)), "cf0000000100000000"));
+	TEST_CHECK(isHex(MsgPack::serialize(-1), "ff"));
+	TEST_CHECK(isHex(MsgPack::serialize(-32), "e0"));
+	TEST_CHECK(isHex(MsgPack::serialize(-33), "d0df"));
+	TEST_CHECK(isHex(MsgPack::serialize(-32769), "d2ffff7fff"));
+	TEST_CHECK(isHex(MsgPack::serialize(1.5), "cb3ff8000000000000"));
+	TEST_CHECK(isHex(MsgPack::serialize("abc"), "a3616263"));
+	TEST_CHECK(isHex(MsgPack::serialize(String("")), "a0"));
+	TEST_CHECK(isHex(MsgPack::serialize(Memory::create("ab", 2)), "c4026162"));
+	VariantList list = VariantList::create();
+	list.add(1);
+	list.add("a");
+	TEST_CHECK(isHex(MsgPack::serialize(list), "9201a161"));
+	VariantMap map = VariantMap::createTree();
+	map.put("a", 1);
+	TEST_CHECK(isHex(MsgPack::serialize(map), "81a16101"));
+	// timestamp 32, one second after the epoch
+	TEST_CHECK(isHex(MsgPack::serialize(Time(SLIB_INT64(1000000))), "d6ff00000001"));
+}
+
+static void writeRandomJson(StringBuffer& buf, sl_uint32& seed, sl_uint32 depth)
+{
+	seed = seed * 1103515245 + 12345;
+	sl_uint32 r = seed >> 8;
+	sl_uint32 type = depth > 3 ? r % 6 : r % 8;
+	switch (type) {
+		case 0:
+			buf.addStatic("null", 4);
+			break;
+		case 1:
+			buf.add((r >> 4) & 1 ? "true" : "false");
+			break;
+		case 2:
+			{
+				// integers around the boundaries of the encodings
+				static const sl_int64 values[] = {0, 1, 127, 128, 255, 256, 65535, 65536, SLIB_INT64(4294967295), SLIB_INT64(4294967296), -1, -32, -33, -128, -129, -32768, -32769, SLIB_INT64(-2147483648), SLIB_INT64(-2147483649), SLIB_INT64(9007199254740993), SLIB_INT64(-9007199254740993)};
+				buf.add(String::fromInt64(values[(r >> 4) % (sizeof(values) / sizeof(values[0]))]));
+			}
+			break;
+		case 3:
+			buf.add(String::fromInt32((sl_int32)(r >> 4) - (1 << 22)));
+			buf.addStatic(".25", 3);
+			break;
+		case 4:
+		case 5:
+			{
+				sl_uint32 len = (r >> 4) % 40;
+				if ((r >> 12) % 10 == 0) {
+					len = 200 + (r >> 4) % 70000;
+				}
+				String s = String::allocate(len);
+				for (sl_uint32 i = 0; i < len; i++) {
+					s.getData()[i] = 'a' + (char)((i * 7 + r) % 26);
+				}
+				buf.addStatic("\"", 1);
+				buf.add(s);
+				buf.addStatic("\"", 1);
+			}
+			break;
+		case 6:
+			{
+				sl_uint32 n = (r >> 4) % 20;
+				buf.addStatic("[", 1);
+				for (sl_uint32 i = 0; i < n; i++) {
+					if (i) {
+						buf.addStatic(",", 1);
+					}
+					writeRandomJson(buf, seed, depth + 1);
+				}
+				buf.addStatic("]", 1);
+			}
+			break;
+		default:
+			{
+				sl_uint32 n = (r >> 4) % 20;
+				buf.addStatic("{", 1);
+				for (sl_uint32 i = 0; i < n; i++) {
+					if (i) {
+						buf.addStatic(",", 1);
+					}
+					buf.add(String::format("\"k%d\":", i));
+					writeRandomJson(buf, seed, depth + 1);
+				}
+				buf.addStatic("}", 1);
+			}
+			break;
+	}
+}
+
+// random documents survive the round trip and are read back as the Json parser reads them
+static void testJsonRoundTrip()
+{
+	sl_uint32 seed = 9;
+	for (sl_uint32 i = 0; i < 300; i++) {
+		StringBuffer buf;
+		writeRandomJson(buf, seed, 0);
+		String text = buf.merge();
+		Json json = Json::parseJson(text);
+		String expected = json.toJsonString();
+		Memory mem = MsgPack::serialize(json);
+		TEST_CHECK(MsgPack::deserialize(mem).toJsonString() == expected);
+		MsgPackReader reader(mem);
+		TEST_CHECK(reader.getEncodedSize() == mem.getSize());
+		TEST_CHECK(reader.toJson().toJsonString() == expected);
+		if (reader.isMap()) {
+			VariantMap map = json.getVariantMap();
+			TEST_CHECK(reader.getCount() == map.getCount());
+			for (auto& item : map) {
+				TEST_CHECK(reader.getItem(item.key).toVariant().toJsonString() == item.value.toJsonString());
+			}
+			TEST_CHECK(!(reader.getItem("missing").isValid()));
+		} else if (reader.isArray()) {
+			VariantList list = json.getVariantList();
+			TEST_CHECK(reader.getCount() == list.getCount());
+			for (sl_uint32 k = 0; k < reader.getCount(); k++) {
+				TEST_CHECK(reader.getElement(k).toVariant().toJsonString() == list.getValueAt(k).toJsonString());
+			}
+		}
+		// truncated data is never accepted
+		if (mem.getSize() < 10000) {
+			for (sl_size n = 0; n < mem.getSize(); n++) {
+				MsgPackReader truncated(mem.getData(), n);
+				if (truncated.getEncodedSize()) {
+					TEST_CHECK(sl_false);
+					break;
+				}
+			}
+		}
+	}
+}
+
+static void testTimeAndBinary()
+{
+	VariantList list = VariantList::create();
+	Time now = Time::now();
+	list.add(now);
+	list.add(Time(SLIB_INT64(-1500000)));
+	list.add(Memory::create("abc", 3));
+	Memory mem = MsgPack::serialize(list);
+	MsgPackReader reader(mem);
+	TEST_CHECK(reader.getElement(0).isTime() && reader.getElement(0).getTime() == now);
+	TEST_CHECK(reader.getElement(1).getTime().toInt() == SLIB_INT64(-1500000));
+	Memory bin = reader.getElement(2).getBinary();
+	TEST_CHECK(bin.getSize() == 3 && Base::equalsMemory(bin.getData(), "abc", 3));
+}
+
+static void benchmark()
+{
+	Json json = Json::parseJson(String("{\"id\": 12345, \"neg\": -70000, \"big\": 9000000000, \"pi\": 3.25, \"ok\": true, \"name\": \"hello world\", \"tags\": [\"a\", \"bb\", \"ccc\", 1, 2, -3, null], \"child\": {\"x\": 1.5, \"y\": [1, 2, {\"z\": \"deep\"}]}}"));
+	String text = json.toJsonString();
+	Memory mem = MsgPack::serialize(json);
+	printf("Json %d bytes, MessagePack %d bytes\n", (int)(text.getLength()), (int)(mem.getSize()));
+	const sl_uint32 N = 20000;
+	sl_size total = 0;
+	TimeCounter t;
+	for (sl_uint32 i = 0; i < N; i++) {
+		total += json.toJsonString().getLength();
+	}
+	TEST_PRINT_TIME("Json write x 20000", t);
+	t.reset();
+	for (sl_uint32 i = 0; i < N; i++) {
+		total += MsgPack::serialize(json).getSize();
+	}
+	TEST_PRINT_TIME("MessagePack write x 20000", t);
+	t.reset();
+	for (sl_uint32 i = 0; i < N; i++) {
+		total += Json::parseJson(text).getVariantMap().getCount();
+	}
+	TEST_PRINT_TIME("Json read x 20000", t);
+	t.reset();
+	for (sl_uint32 i = 0; i < N; i++) {
+		total += MsgPack::deserialize(mem).getVariantMap().getCount();
+	}
+	TEST_PRINT_TIME("MessagePack read x 20000", t);
+	t.reset();
+	for (sl_uint32 i = 0; i < N; i++) {
+		MsgPackReader reader(mem.getData(), mem.getSize());
+		total += reader.getItem("child").getItem("y").getElement(2).getItem("z").equalsString("deep", 4);
+	}
+	TEST_PRINT_TIME("MessagePack zero-copy lookup x 20000", t);
+	printf("(%d)\n", (int)(total & 1));
+}
+
+int main(int argc, const char * argv[])
+{
+	testEncodings();
+	testJsonRoundTrip();
+	testTimeAndBinary();
+	benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,225 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../test.h"
+
+#include "../../inc/slib/core/sort.h"
+#include "../../inc/slib/core/thread_pool.h"
+#include "../../inc/slib/core/list.h"
+
+using namespace slib;
+
+static sl_uint32 g_seed = 11;
+
+static sl_uint32 random32()
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+template <class T>
+static T randomValue(sl_uint32 pattern);
+
+template <>
+sl_int32 randomValue<sl_int32>(sl_uint32 pattern)
+{
+	return pattern == 3 ? (sl_int32)(random32() % 5) - 2 : (sl_int32)((random32() << 8) ^ random32());
+}
+
+template <>
+sl_uint64 randomValue<sl_uint64>(sl_uint32 pattern)
+{
+	return pattern == 3 ? random32() % 5 : ((sl_uint64)random32() << 40) ^ ((sl_uint64)random32() << 16) ^ random32();
+}
+
+template <>
+double randomValue<double>(sl_uint32 pattern)
+{
+	return pattern == 3 ? (double)(random32() % 5) - 2.5 : ((double)random32() - 8388608.0) * 1.0e-3;
+}
+
+template <>
+float randomValue<float>(sl_uint32 pattern)
+{
+	return pattern == 3 ? (float)(random32() % 5) - 2.5f : ((float)random32() - 8388608.0f) * 1.0e-2f;
+}
+
+// patterns: 0 random, 1 ascending, 2 descending, 3 few unique values
+template <class T>
+static void fillList(T* list, sl_size n, sl_uint32 pattern)
+{
+	for (sl_size i = 0; i < n; i++) {
+		list[i] = randomValue<T>(pattern);
+	}
+	if (pattern == 1) {
+		QuickSort::sortAsc(list, n);
+	} else if (pattern == 2) {
+		QuickSort::sortDesc(list, n);
+	}
+}
+
+// RadixSort, MergeSort, ParallelSort and InsertionSort give the same results as QuickSort
+template <class T>
+static void testType(ThreadPool* pool)
+{
+	sl_size sizes[] = {0, 1, 2, 3, 15, 16, 17, 100, 1000, 4097, 100000};
+	for (sl_size k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+		sl_size n = sizes[k];
+		T* src = new T[n + 1];
+		T* expected = new T[n + 1];
+		T* list = new T[n + 1];
+		for (sl_uint32 pattern = 0; pattern < 4; pattern++) {
+			fillList(src, n, pattern);
+			for (int flagAsc = 0; flagAsc < 2; flagAsc++) {
+				Base::copyMemory(expected, src, n * sizeof(T));
+				QuickSort::sort(expected, n, flagAsc != 0);
+
+				Base::copyMemory(list, src, n * sizeof(T));
+				TEST_CHECK(RadixSort::sort(list, n, flagAsc != 0));
+				TEST_CHECK(Base::equalsMemory(list, expected, n * sizeof(T)));
+
+				Base::copyMemory(list, src, n * sizeof(T));
+				TEST_CHECK(MergeSort::sort(list, n, flagAsc != 0));
+				TEST_CHECK(Base::equalsMemory(list, expected, n * sizeof(T)));
+
+				Base::copyMemory(list, src, n * sizeof(T));
+				TEST_CHECK(ParallelSort::sort(list, n, flagAsc != 0, Compare<T>(), pool));
+				TEST_CHECK(Base::equalsMemory(list, expected, n * sizeof(T)));
+
+				if (n <= 1000) {
+					Base::copyMemory(list, src, n * sizeof(T));
+					InsertionSort::sort(list, n, flagAsc != 0);
+					TEST_CHECK(Base::equalsMemory(list, expected, n * sizeof(T)));
+				}
+			}
+		}
+		delete[] src;
+		delete[] expected;
+		delete[] list;
+	}
+}
+
+struct Item
+{
+	sl_int32 key;
+	sl_uint32 index;
+};
+
+class CompareItem
+{
+public:
+	int operator()(const Item& a, const Item& b) const
+	{
+		return Compare<sl_int32>()(a.key, b.key);
+	}
+};
+
+class GetItemKey
+{
+public:
+	sl_int32 operator()(const Item& item) const
+	{
+		return item.key;
+	}
+};
+
+// the items of the same key keep their order
+static sl_bool isStable(const Item* list, sl_size n, sl_bool flagAscending)
+{
+	for (sl_size i = 1; i < n; i++) {
+		if (list[i - 1].key == list[i].key) {
+			if (list[i - 1].index > list[i].index) {
+				return sl_false;
+			}
+		} else if ((list[i - 1].key < list[i].key) != flagAscending) {
+			return sl_false;
+		}
+	}
+	return sl_true;
+}
+
+static void testStability()
+{
+	const sl_size n = 20000;
+	Item* list = new Item[n];
+	for (int flagAsc = 0; flagAsc < 2; flagAsc++) {
+		for (sl_size i = 0; i < n; i++) {
+			list[i].key = (sl_int32)(random32() % 100) - 50;
+			list[i].index = (sl_uint32)i;
+		}
+		TEST_CHECK(MergeSort::sort(list, n, flagAsc != 0, CompareItem()));
+		TEST_CHECK(isStable(list, n, flagAsc != 0));
+		for (sl_size i = 0; i < n; i++) {
+			list[i].key = (sl_int32)(random32() % 100) - 50;
+			list[i].index = (sl_uint32)i;
+		}
+		TEST_CHECK(RadixSort::sortByKey(list, n, GetItemKey(), flagAsc != 0));
+		TEST_CHECK(isStable(list, n, flagAsc != 0));
+	}
+	delete[] list;
+}
+
+static void testList()
+{
+	List<sl_int32> list;
+	for (sl_int32 i = 0; i < 1000; i++) {
+		list.add((i * 7919) % 1000);
+	}
+	List<sl_int32> list2 = list.duplicate();
+	List<sl_int32> list3 = list.duplicate();
+	list.sort();
+	TEST_CHECK(list2.sortByKey());
+	TEST_CHECK(list3.sortParallel(sl_false));
+	for (sl_int32 i = 0; i < 1000; i++) {
+		TEST_CHECK(list.getValueAt(i) == i);
+		TEST_CHECK(list2.getValueAt(i) == i);
+		TEST_CHECK(list3.getValueAt(i) == 999 - i);
+	}
+}
+
+static void benchmark(ThreadPool* pool)
+{
+	const sl_size n = 1000000;
+	sl_int32* src = new sl_int32[n];
+	sl_int32* list = new sl_int32[n];
+	fillList(src, n, 0);
+	Base::copyMemory(list, src, n * sizeof(sl_int32));
+	TimeCounter t;
+	QuickSort::sortAsc(list, n);
+	TEST_PRINT_TIME("QuickSort 1M int32", t);
+	Base::copyMemory(list, src, n * sizeof(sl_int32));
+	t.reset();
+	RadixSort::sortAsc(list, n);
+	TEST_PRINT_TIME("RadixSort 1M int32", t);
+	Base::copyMemory(list, src, n * sizeof(sl_int32));
+	t.reset();
+	MergeSort::sortAsc(list, n);
+	TEST_PRINT_TIME("MergeSort 1M int32", t);
+	Base::copyMemory(list, src, n * sizeof(sl_int32));
+	t.reset();
+	ParallelSort::sortAsc(list, n, Compare<sl_int32>(), pool);
+	TEST_PRINT_TIME("ParallelSort 1M int32", t);
+	delete[] src;
+	delete[] list;
+}
+
+int main(int argc, const char * argv[])
+{
+	Ref<ThreadPool> pool = ThreadPool::create(0, 4);
+	testType<sl_int32>(pool.get());
+	testType<sl_uint64>(pool.get());
+	testType<double>(sl_null);
+	testType<float>(sl_null);
+	testStability();
+	testList();
+	benchmark(pool.get());
+	pool->release();
+	return TEST_RESULT();
+}
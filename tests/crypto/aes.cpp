@@ -0,0 +1,196 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../test.h"
+
+#include "../../inc/slib/crypto/aes.h"
+#include "../../inc/slib/core/string.h"
+
+using namespace slib;
+
+static sl_bool isHex(const void* data, sl_size size, const char* hex)
+{
+	return String::makeHexString(data, size).toLower() == hex;
+}
+
+static void fillRandom(sl_uint8* buf, sl_size size, sl_uint32& seed)
+{
+	for (sl_size i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = (sl_uint8)(seed >> 16);
+	}
+}
+
+// FIPS-197 Appendix C
+static void testBlockVectors()
+{
+	const char* results[] = {
+		"69c4e0d86a7b0430d8cdb78070b4c55a",
+		"dda97ca4864cdfe06eaf70a0ec0d7191",
+		"8ea2b7ca516745bfeafc49904b496089"
+	};
+	sl_uint8 key[32], plain[16], cipher[16], decrypted[16];
+	for (sl_uint32 i = 0; i < 32; i++) {
+		key[i] = (sl_uint8)i;
+	}
+	for (sl_uint32 i = 0; i < 16; i++) {
+		plain[i] = (sl_uint8)(i * 0x11);
+	}
+	for (int k = 0; k < 2; k++) {
+		for (sl_uint32 n = 0; n < 3; n++) {
+			AES aes;
+			aes.setUsingHardware(k == 0);
+			aes.setKey(key, 16 + n * 8);
+			aes.encryptBlock(plain, cipher);
+			TEST_CHECK(isHex(cipher, 16, results[n]));
+			aes.decryptBlock(cipher, decrypted);
+			TEST_CHECK(Base::equalsMemory(plain, decrypted, 16));
+		}
+	}
+}
+
+// The Galois/Counter Mode of Operation (GCM), Test Case 2 and 3
+static void testGcmVectors()
+{
+	sl_uint8 key[16] = {0};
+	sl_uint8 iv[12] = {0};
+	sl_uint8 plain[64] = {0};
+	sl_uint8 cipher[64];
+	sl_uint8 tag[16];
+	for (int k = 0; k < 2; k++) {
+		AES aes;
+		aes.setUsingHardware(k == 0);
+		aes.setKey(key, 16);
+		GCM<AES> gcm(&aes);
+		gcm.flagCLMUL = gcm.flagCLMUL && k == 0;
+		TEST_CHECK(gcm.encrypt(iv, 12, sl_null, 0, plain, cipher, 16, tag));
+		TEST_CHECK(isHex(cipher, 16, "0388dace60b6a392f328c2b971b2fe78"));
+		TEST_CHECK(isHex(tag, 16, "ab6e47d42cec13bdf53a67b21257bddf"));
+	}
+	String("feffe9928665731c6d6a8f9467308308").parseHexString(key);
+	String("cafebabefacedbaddecaf888").parseHexString(iv);
+	String("d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255").parseHexString(plain);
+	for (int k = 0; k < 2; k++) {
+		AES aes;
+		aes.setUsingHardware(k == 0);
+		aes.setKey(key, 16);
+		GCM<AES> gcm(&aes);
+		gcm.flagCLMUL = gcm.flagCLMUL && k == 0;
+		TEST_CHECK(gcm.encrypt(iv, 12, sl_null, 0, plain, cipher, 64, tag));
+		TEST_CHECK(isHex(cipher, 64, "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985"));
+		TEST_CHECK(isHex(tag, 16, "4d5c2af327cd64a62cf35abd2ba6fab4"));
+		sl_uint8 decrypted[64];
+		TEST_CHECK(gcm.decrypt(iv, 12, sl_null, 0, cipher, decrypted, 64, tag));
+		TEST_CHECK(Base::equalsMemory(plain, decrypted, 64));
+		tag[0] ^= 1;
+		TEST_CHECK(!(gcm.decrypt(iv, 12, sl_null, 0, cipher, decrypted, 64, tag)));
+	}
+}
+
+// the AES-NI code gives the same output as the T-tables on random inputs
+static void testHardwareAgainstTables()
+{
+	if (!(AES::isHardwareAccelerated())) {
+		printf("AES-NI is not available\n");
+		return;
+	}
+	const sl_size N = 1000;
+	sl_uint8 key[32], iv[16], aad[40];
+	sl_uint8 input[N], output1[N + 16], output2[N + 16], tag1[16], tag2[16];
+	sl_uint32 seed = 3;
+	for (sl_uint32 i = 0; i < 200; i++) {
+		fillRandom(key, sizeof(key), seed);
+		fillRandom(iv, sizeof(iv), seed);
+		fillRandom(aad, sizeof(aad), seed);
+		fillRandom(input, N, seed);
+		sl_uint32 lenKey = 16 + (i % 3) * 8;
+		sl_size len = seed % N;
+		AES aes1, aes2;
+		aes1.setKey(key, lenKey);
+		aes2.setKey(key, lenKey);
+		aes2.setUsingHardware(sl_false);
+		TEST_CHECK(aes1.isUsingHardware() && !(aes2.isUsingHardware()));
+
+		sl_size n = len & ~((sl_size)15);
+		aes1.encryptBlocks(input, output1, n);
+		aes2.encryptBlocks(input, output2, n);
+		TEST_CHECK(Base::equalsMemory(output1, output2, n));
+		aes1.decryptBlocks(input, output1, n);
+		aes2.decryptBlocks(input, output2, n);
+		TEST_CHECK(Base::equalsMemory(output1, output2, n));
+
+		sl_size n1 = aes1.encrypt_CBC_PKCS7Padding(iv, input, len, output1);
+		sl_size n2 = aes2.encrypt_CBC_PKCS7Padding(iv, input, len, output2);
+		TEST_CHECK(n1 == n2 && Base::equalsMemory(output1, output2, n1));
+
+		// the counter is carried across the 32-bit boundary
+		sl_uint64 pos = ((sl_uint64)0xFFFFFFFF << 4) - (seed & 255);
+		aes1.encrypt_CTR(iv, pos, input, len, output1);
+		aes2.encrypt_CTR(iv, pos, input, len, output2);
+		TEST_CHECK(Base::equalsMemory(output1, output2, len));
+
+		GCM<AES> gcm1(&aes1);
+		GCM<AES> gcm2(&aes2);
+		gcm2.flagCLMUL = sl_false;
+		sl_size lenAAD = i % sizeof(aad);
+		gcm1.encrypt(iv, 12, aad, lenAAD, input, output1, len, tag1);
+		gcm2.encrypt(iv, 12, aad, lenAAD, input, output2, len, tag2);
+		TEST_CHECK(Base::equalsMemory(output1, output2, len));
+		TEST_CHECK(Base::equalsMemory(tag1, tag2, 16));
+		// IV longer than 12 bytes goes through GHASH
+		gcm1.encrypt(iv, 16, aad, lenAAD, input, output1, len, tag1);
+		gcm2.encrypt(iv, 16, aad, lenAAD, input, output2, len, tag2);
+		TEST_CHECK(Base::equalsMemory(output1, output2, len));
+		TEST_CHECK(Base::equalsMemory(tag1, tag2, 16));
+	}
+}
+
+static void benchmark()
+{
+	const sl_size N = 1 << 16;
+	const sl_uint32 nRepeat = 64;
+	sl_uint8* input = new sl_uint8[N];
+	sl_uint8* output = new sl_uint8[N];
+	Base::zeroMemory(input, N);
+	sl_uint8 key[16] = {1};
+	sl_uint8 iv[16] = {2};
+	sl_uint8 tag[16];
+	for (int k = 0; k < 2; k++) {
+		AES aes;
+		aes.setUsingHardware(k == 0);
+		aes.setKey(key, 16);
+		if (k == 0 && !(aes.isUsingHardware())) {
+			continue;
+		}
+		TimeCounter t;
+		for (sl_uint32 i = 0; i < nRepeat; i++) {
+			aes.encrypt_CTR(iv, 0, input, N, output);
+		}
+		TEST_PRINT_TIME(k ? "T-tables CTR 4MB" : "AES-NI CTR 4MB", t);
+		GCM<AES> gcm(&aes);
+		gcm.flagCLMUL = gcm.flagCLMUL && k == 0;
+		t.reset();
+		for (sl_uint32 i = 0; i < nRepeat; i++) {
+			gcm.encrypt(iv, 12, sl_null, 0, input, output, N, tag);
+		}
+		TEST_PRINT_TIME(k ? "T-tables GCM 4MB" : "AES-NI GCM 4MB", t);
+	}
+	delete[] input;
+	delete[] output;
+}
+
+int main(int argc, const char * argv[])
+{
+	testBlockVectors();
+	testGcmVectors();
+	testHardwareAgainstTables();
+	benchmark();
+	return TEST_RESULT();
+}
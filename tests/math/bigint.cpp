@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../test.h"
+
+#include "../../inc/slib/math/bigint.h"
+#include "../../inc/slib/crypto/rsa.h"
+
+using namespace slib;
+
+static sl_uint32 g_seed = 5;
+
+static BigInt randomBigInt(sl_size nBytes)
+{
+	sl_uint8 buf[1024];
+	for (sl_size i = 0; i < nBytes; i++) {
+		g_seed = g_seed * 1103515245 + 12345;
+		buf[i] = (sl_uint8)(g_seed >> 16);
+	}
+	return BigInt::fromBytesBE(buf, nBytes);
+}
+
+static BigInt randomOdd(sl_size nBytes)
+{
+	BigInt M = randomBigInt(nBytes);
+	if (!(M.getBit(0))) {
+		M = M + 1;
+	}
+	if (M.compare((sl_uint32)1) <= 0) {
+		M = 3;
+	}
+	return M;
+}
+
+// Montgomery exponentiation gives the same results as BigInt::pow_mod
+static void testPow()
+{
+	// Karatsuba is used from 40 limbs (320 bytes)
+	sl_size sizes[] = {1, 7, 8, 9, 16, 63, 64, 65, 128, 191, 192, 193, 255, 256, 319, 320, 321};
+	for (sl_size k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+		sl_size size = sizes[k];
+		BigInt M = randomOdd(size);
+		Ref<BigIntMontgomery> context = BigIntMontgomery::create(M);
+		TEST_CHECK(context.isNotNull() && context->getModulus() == M);
+		for (sl_uint32 t = 0; t < 6; t++) {
+			// the base can be larger than the modulus, or negative
+			BigInt A = randomBigInt(size + (t % 3));
+			if (t & 1) {
+				A = -A;
+			}
+			BigInt E;
+			if (t == 0) {
+				E = 2;
+			} else if (t < 3) {
+				E = randomBigInt(4);
+			} else {
+				E = randomBigInt(size < 16 ? size : 16);
+			}
+			BigInt expected = BigInt::pow_mod(A, E, M);
+			TEST_CHECK(BigInt::pow_montgomery(A, E, M) == expected);
+			TEST_CHECK(context->pow(A, E) == expected);
+		}
+		TEST_CHECK(context->pow(randomBigInt(size), 0) == 1);
+		TEST_CHECK(context->pow(0, randomBigInt(4) + 1) == 0);
+	}
+	// even modulus is rejected
+	TEST_CHECK(BigIntMontgomery::create(BigInt(100)).isNull());
+}
+
+static sl_bool isProbablePrime(const BigInt& N)
+{
+	sl_uint32 bases[] = {2, 3, 5, 7, 11, 13};
+	for (sl_uint32 i = 0; i < 6; i++) {
+		if (BigInt::pow_mod(bases[i], N - 1, N) != 1) {
+			return sl_false;
+		}
+	}
+	return sl_true;
+}
+
+static BigInt randomPrime(sl_size nBytes)
+{
+	BigInt P = randomOdd(nBytes);
+	while (!(isProbablePrime(P))) {
+		P = P + 2;
+	}
+	return P;
+}
+
+static void createKey(RSAPrivateKey& key, sl_size nBytes)
+{
+	for (;;) {
+		BigInt P = randomPrime(nBytes / 2);
+		BigInt Q = randomPrime(nBytes / 2);
+		if (P == Q) {
+			continue;
+		}
+		BigInt phi = (P - 1) * (Q - 1);
+		BigInt E = 65537;
+		BigInt D = BigInt::inverseMod(E, phi);
+		if (D.isNull()) {
+			continue;
+		}
+		key.N = P * Q;
+		key.E = E;
+		key.D = D;
+		key.P = P;
+		key.Q = Q;
+		key.DP = BigInt::mod(D, P - 1);
+		key.DQ = BigInt::mod(D, Q - 1);
+		key.IQ = BigInt::inverseMod(Q, P);
+		return;
+	}
+}
+
+// the RSA operations through the cached contexts agree with BigInt::pow_mod
+static void testRSA()
+{
+	RSAPrivateKey priv;
+	RSAPublicKey pub;
+	for (sl_uint32 t = 0; t < 2; t++) {
+		// a new key in the same objects replaces the cached contexts
+		createKey(priv, t ? 48 : 32);
+		pub.N = priv.N;
+		pub.E = priv.E;
+		sl_size n = priv.N.getMostSignificantBytes();
+		sl_uint8 src[64], dst[64], back[64];
+		BigInt M = BigInt::mod(randomBigInt(n), priv.N);
+		TEST_CHECK(M.getBytesBE(src, n));
+		TEST_CHECK(RSA::executePublic(pub, src, dst));
+		TEST_CHECK(BigInt::fromBytesBE(dst, n) == BigInt::pow_mod(M, priv.E, priv.N));
+		TEST_CHECK(RSA::executePrivate(priv, dst, back));
+		TEST_CHECK(Base::equalsMemory(src, back, n));
+		TEST_CHECK(RSA::executePrivate(priv, src, dst));
+		TEST_CHECK(BigInt::fromBytesBE(dst, n) == BigInt::pow_mod(M, priv.D, priv.N));
+	}
+}
+
+static void benchmark()
+{
+	BigInt M = randomOdd(128);
+	BigInt A = randomBigInt(127);
+	BigInt E = randomBigInt(128);
+	TimeCounter t;
+	BigInt r1 = BigInt::pow_mod(A, E, M);
+	TEST_PRINT_TIME("pow_mod 1024 bits", t);
+	Ref<BigIntMontgomery> context = BigIntMontgomery::create(M);
+	t.reset();
+	BigInt r2 = context->pow(A, E);
+	TEST_PRINT_TIME("Montgomery 1024 bits", t);
+	TEST_CHECK(r1 == r2);
+}
+
+int main(int argc, const char * argv[])
+{
+	testPow();
+	testRSA();
+	benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_TESTS_TEST
+#define CHECKHEADER_SLIB_TESTS_TEST
+
+/*
+	Every test is an executable which compares a component with the existing
+	implementation (or known data), and returns non-zero when a check fails.
+	The timings are printed for information, and are not checked.
+*/
+
+#include "../inc/slib/core/time.h"
+
+#include <stdio.h>
+
+static int _g_test_nFailures = 0;
+
+#define TEST_CHECK(EXPR) \
+	do { \
+		if (!(EXPR)) { \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #EXPR); \
+			_g_test_nFailures++; \
+		} \
+	} while (0)
+
+// returns from `main()`
+#define TEST_RESULT() \
+	(printf(_g_test_nFailures ? "FAILED (%d)\n" : "OK\n", _g_test_nFailures), _g_test_nFailures ? 1 : 0)
+
+#define TEST_PRINT_TIME(NAME, TIME_COUNTER) \
+	printf("%s: %d ms\n", NAME, (int)((TIME_COUNTER).getElapsedMilliseconds()))
+
+#endif
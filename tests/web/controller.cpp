@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../test.h"
+
+#include "../../inc/slib/web/controller.h"
+#include "../../inc/slib/network/http_service.h"
+#include "../../inc/slib/core/map.h"
+#include "../../inc/slib/core/variant.h"
+
+using namespace slib;
+
+class TestContext : public HttpServiceContext
+{
+public:
+	static Ref<HttpServiceContext> create(HttpMethod method, const String& path)
+	{
+		Ref<HttpServiceContext> ret = new TestContext;
+		ret->setMethod(method);
+		ret->setPath(path);
+		return ret;
+	}
+};
+
+static String g_strMatched;
+
+static WebHandler createHandler(const String& tag)
+{
+	return [tag](const Ref<HttpServiceContext>& context, HttpMethod method, const String& path) -> Variant {
+		g_strMatched = tag;
+		return tag;
+	};
+}
+
+// the tag of the matched handler, or null
+static String dispatch(const Ref<WebController>& controller, const Ref<HttpServiceContext>& context)
+{
+	g_strMatched.setNull();
+	IHttpServiceProcessor* processor = controller.get();
+	if (processor->onHttpRequest(context)) {
+		return g_strMatched;
+	}
+	return sl_null;
+}
+
+// literal routes are matched exactly as the signature map used before the trie
+static void testLiterals()
+{
+	Ref<WebController> controller = WebController::create();
+	TreeMap<String, String> signatures;
+	sl_uint32 seed = 7;
+	for (sl_uint32 i = 0; i < 300; i++) {
+		seed = seed * 1103515245 + 12345;
+		HttpMethod method = (seed >> 20) & 1 ? HttpMethod::POST : HttpMethod::GET;
+		String path = String::format("/api/v%d/item%d/sub%d", (seed >> 8) % 3, (seed >> 12) % 20, i % 7);
+		String tag = String::fromUint32(i);
+		controller->registerHandler(method, path, createHandler(tag));
+		signatures.put(HttpMethods::toString(method) + " " + path, tag);
+	}
+	for (sl_uint32 i = 0; i < 3000; i++) {
+		seed = seed * 1103515245 + 12345;
+		HttpMethod method = (seed >> 20) & 1 ? HttpMethod::POST : HttpMethod::GET;
+		String path = String::format("/api/v%d/item%d/sub%d", (seed >> 8) % 4, (seed >> 12) % 22, (seed >> 16) % 8);
+		String expected;
+		signatures.get(HttpMethods::toString(method) + " " + path, &expected);
+		TEST_CHECK(dispatch(controller, TestContext::create(method, path)) == expected);
+	}
+}
+
+static void testParameters()
+{
+	Ref<WebController> controller = WebController::create();
+	controller->registerHandler(HttpMethod::GET, "/", createHandler("root"));
+	controller->registerHandler(HttpMethod::GET, "/users", createHandler("users"));
+	controller->registerHandler(HttpMethod::GET, "/users/me", createHandler("me"));
+	controller->registerHandler(HttpMethod::GET, "/users/{id}", createHandler("user"));
+	controller->registerHandler(HttpMethod::POST, "/users/{uid}", createHandler("post user"));
+	controller->registerHandler(HttpMethod::GET, "/users/{id}/posts/{post}", createHandler("post"));
+	controller->registerHandler(HttpMethod::GET, "/files/*", createHandler("files"));
+	controller->registerHandler(HttpMethod::GET, "/static/{rest*}", createHandler("static"));
+
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::GET, "/")) == "root");
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::GET, "/users")) == "users");
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::GET, "/users/me")) == "me");
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::PUT, "/users/42")).isNull());
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::GET, "/users/42/posts")).isNull());
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::GET, "/files")).isNull());
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::GET, "/nothing")).isNull());
+
+	Ref<HttpServiceContext> context = TestContext::create(HttpMethod::GET, "/users/42");
+	TEST_CHECK(dispatch(controller, context) == "user");
+	TEST_CHECK(context->getPathParameter("id") == "42");
+	TEST_CHECK(context->getParameter("id") == "42");
+
+	context = TestContext::create(HttpMethod::POST, "/users/42");
+	TEST_CHECK(dispatch(controller, context) == "post user");
+	TEST_CHECK(context->getPathParameter("uid") == "42");
+
+	context = TestContext::create(HttpMethod::GET, "/users/42/posts/7");
+	TEST_CHECK(dispatch(controller, context) == "post");
+	TEST_CHECK(context->getPathParameter("id") == "42");
+	TEST_CHECK(context->getPathParameter("post") == "7");
+
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::GET, "/files/a/b.txt")) == "files");
+	context = TestContext::create(HttpMethod::GET, "/static/css/site.css");
+	TEST_CHECK(dispatch(controller, context) == "static");
+	TEST_CHECK(context->getPathParameter("rest") == "css/site.css");
+
+	// the later registration replaces the handler
+	controller->registerHandler(HttpMethod::GET, "/users/me", createHandler("me2"));
+	TEST_CHECK(dispatch(controller, TestContext::create(HttpMethod::GET, "/users/me")) == "me2");
+}
+
+static void benchmark()
+{
+	Ref<WebController> controller = WebController::create();
+	TreeMap<String, WebHandler> signatures;
+	for (sl_uint32 i = 0; i < 500; i++) {
+		String path = String::format("/api/v1/r%d/items", i);
+		controller->registerHandler(HttpMethod::GET, path, createHandler("r"));
+		signatures.put(HttpMethods::toString(HttpMethod::GET) + " " + path, createHandler("r"));
+	}
+	Ref<HttpServiceContext> context = TestContext::create(HttpMethod::GET, "/api/v1/r250/items");
+	IHttpServiceProcessor* processor = controller.get();
+	sl_uint32 n = 0;
+	TimeCounter t;
+	for (sl_uint32 i = 0; i < 200000; i++) {
+		WebHandler handler;
+		if (signatures.get(HttpMethods::toString(context->getMethod()) + " " + context->getPath(), &handler)) {
+			n++;
+		}
+	}
+	TEST_PRINT_TIME("signature lookup", t);
+	t.reset();
+	for (sl_uint32 i = 0; i < 200000; i++) {
+		if (processor->onHttpRequest(context)) {
+			n++;
+		}
+	}
+	TEST_PRINT_TIME("trie dispatch", t);
+	TEST_CHECK(n == 400000);
+}
+
+int main(int argc, const char * argv[])
+{
+	testLiterals();
+	testParameters();
+	benchmark();
+	return TEST_RESULT();
+}